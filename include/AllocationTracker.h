@@ -0,0 +1,128 @@
+#ifndef ALLOCATION_TRACKER_H
+#define ALLOCATION_TRACKER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <curl/curl.h>
+#include "PerfCounters.h"
+
+/**
+ * @brief Heap activity counted by the allocation hook
+ */
+struct AllocationStats {
+    std::uint64_t allocations = 0; ///< operator new calls, plus libcurl mallocs after init_curl()
+    std::uint64_t bytes = 0;       ///< Bytes requested by those calls
+    std::uint64_t frees = 0;       ///< Blocks released (wherever they were allocated)
+
+    void merge(const AllocationStats& other);
+};
+
+/**
+ * @brief Heap activity of one or more requests, split by request phase
+ */
+struct AllocationProfile {
+    std::uint64_t requests = 0;                               ///< AllocationScopes recorded
+    AllocationStats total;                                    ///< Everything inside the scopes
+    std::array<AllocationStats, REQUEST_PHASE_COUNT> phases;  ///< While a PhaseScope of that phase was open
+
+    const AllocationStats& operator[](RequestPhase phase) const { return phases[static_cast<std::size_t>(phase)]; }
+
+    /**
+     * @brief Part of total outside every phase (retry loop, response assembly, caller code)
+     */
+    AllocationStats unphased() const;
+
+    void merge(const AllocationProfile& other);
+};
+
+/**
+ * @brief Counting hook behind AllocationScope
+ *
+ * The replacement operator new/delete in AllocationHook.cpp calls
+ * record_allocation()/record_free(); only special build targets such as
+ * http_loadgen_alloc link it, so regular builds keep the default allocator
+ * and every profile stays empty.
+ */
+class AllocationTracker {
+public:
+    /**
+     * @brief Whether the counting operator new is linked into this program
+     */
+    static bool installed() { return installed_; }
+
+    /**
+     * @brief Counts an allocation for the calling thread's open AllocationScope, if any
+     */
+    static void record_allocation(std::size_t bytes) {
+        if (AllocationProfile* profile = active_) {
+            count(profile->total, bytes);
+            RequestPhase phase = PhaseScope::current();
+            if (phase != RequestPhase::COUNT) {
+                count(profile->phases[static_cast<std::size_t>(phase)], bytes);
+            }
+        }
+    }
+
+    /**
+     * @brief Counts a deallocation for the calling thread's open AllocationScope, if any
+     */
+    static void record_free() {
+        if (AllocationProfile* profile = active_) {
+            ++profile->total.frees;
+            RequestPhase phase = PhaseScope::current();
+            if (phase != RequestPhase::COUNT) {
+                ++profile->phases[static_cast<std::size_t>(phase)].frees;
+            }
+        }
+    }
+
+    /**
+     * @brief curl_global_init() that, with the hook installed, also counts libcurl's own mallocs
+     *
+     * Header lists, handles and connection buffers are allocated by libcurl
+     * with malloc rather than operator new; routing them through the tracker
+     * makes them part of each request's profile.
+     */
+    static CURLcode init_curl(long flags = CURL_GLOBAL_DEFAULT);
+
+    /**
+     * @brief Called once by the hook during static initialisation
+     */
+    static void mark_installed() { installed_ = true; }
+
+private:
+    friend class AllocationScope;
+
+    static void count(AllocationStats& stats, std::size_t bytes) {
+        ++stats.allocations;
+        stats.bytes += bytes;
+    }
+
+    static inline bool installed_ = false;
+    /// Profile of the innermost AllocationScope on this thread; trivially initialised so the hook may read it at any time
+    static inline thread_local AllocationProfile* active_ = nullptr;
+};
+
+/**
+ * @brief Attributes the calling thread's allocations during its lifetime to a profile
+ *
+ * Typically wraps one make_request(). Scopes nest; the innermost one
+ * receives the counts. Memory freed by other threads is not seen.
+ */
+class AllocationScope {
+public:
+    explicit AllocationScope(AllocationProfile& profile) : previous_(AllocationTracker::active_) {
+        ++profile.requests;
+        AllocationTracker::active_ = &profile;
+    }
+    ~AllocationScope() { AllocationTracker::active_ = previous_; }
+
+    AllocationScope(const AllocationScope&) = delete;
+    AllocationScope& operator=(const AllocationScope&) = delete;
+
+private:
+    AllocationProfile* previous_;
+};
+
+#endif // ALLOCATION_TRACKER_H
@@ -0,0 +1,505 @@
+#ifndef ASYNC_HTTP_CLIENT_H
+#define ASYNC_HTTP_CLIENT_H
+
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <list>
+#include <memory>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <curl/curl.h>
+#include "Backoff.h"
+#include "CurlShare.h"
+#include "EventLoop.h"
+#include "HttpClient.h"
+#include "HttpUtils.h"
+#include "RequestOptions.h"
+#include "RequestScheduler.h"
+#include "Task.h"
+#include "WorkStealingPool.h"
+
+/**
+ * @brief Coroutine-based HTTP client driven by a single-threaded cURL multi executor
+ *
+ * The executor uses cURL's socket-action API: cURL's sockets and timeouts are
+ * registered with an EventLoop (the built-in EpollEventLoop by default, or a
+ * caller-supplied one), so only ready sockets are serviced.
+ *
+ * Requests are Task<HttpResponse> coroutines that suspend while their transfer
+ * is in flight, so many logical request flows share one thread and one
+ * connection cache:
+ * @code
+ * Task<void> flow(AsyncHttpClient& client) {
+ *     std::vector<Task<HttpResponse>> calls;
+ *     calls.push_back(client.get(a));
+ *     calls.push_back(client.get(b));
+ *     auto responses = co_await when_all(std::move(calls)); // both in flight
+ * }
+ * client.sync_wait(flow(client));
+ * @endcode
+ *
+ * Retry semantics match HttpClient (retryable cURL errors, 5xx and 429 with
+ * exponential backoff), but backoff suspends the coroutine instead of
+ * sleeping the thread. Only retries and failures are logged. A
+ * RequestOptions deadline bounds all attempts and backoff; cancelling its
+ * token removes the in-flight transfer (or ends the backoff) on the next
+ * loop turn. With set_scheduler(), attempts first wait for a slot by
+ * RequestOptions::priority.
+ *
+ * CPU-heavy processing of a response (JSON parsing, business logic) can be
+ * moved off the I/O thread with offload(), which runs a callable on a
+ * WorkStealingPool and resumes the coroutine back on the I/O thread:
+ * @code
+ * HttpResponse response = co_await client.get(url);
+ * json parsed = co_await client.offload(pool, [&] { return json::parse(response.body); });
+ * @endcode
+ *
+ * The client and every coroutine using it must live on the same thread, and
+ * all tasks awaiting it must be destroyed before the client. post() is the
+ * only member that may be called from other threads.
+ */
+class AsyncHttpClient {
+private:
+    /**
+     * @brief State of one transfer attempt while it is attached to the multi handle
+     */
+    struct Transfer {
+        CURL* easy = nullptr;                     ///< Easy handle from the pool
+        struct curl_slist* header_list = nullptr; ///< Request headers
+        HttpResponse* response = nullptr;         ///< Destination for status and body
+        CURLcode result = CURLE_OK;               ///< cURL result once finished
+        std::coroutine_handle<> waiter;           ///< Coroutine to resume on completion
+        const RequestOptions* options = nullptr;  ///< Deadline and cancellation token
+        std::uint64_t cancel_id = 0;              ///< Entry in cancel_handlers_ (0 if none)
+        CancellationToken::SubscriptionId subscription = 0;
+    };
+
+    /**
+     * @brief Awaitable performing a single transfer attempt (no retries)
+     */
+    class TransferAwaiter {
+    public:
+        TransferAwaiter(AsyncHttpClient& client,
+                        const std::string& url,
+                        const std::string& method,
+                        const std::string& data,
+                        const std::vector<std::string>& headers,
+                        const RequestOptions& options,
+                        HttpResponse& response);
+        ~TransferAwaiter();
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> awaiting);
+        CURLcode await_resume() const noexcept { return transfer_.result; }
+
+        TransferAwaiter(const TransferAwaiter&) = delete;
+        TransferAwaiter& operator=(const TransferAwaiter&) = delete;
+
+    private:
+        AsyncHttpClient& client_;
+        const std::string& url_;
+        const std::string& method_;
+        const std::string& data_;
+        const std::vector<std::string>& headers_;
+        Transfer transfer_;
+    };
+
+    /**
+     * @brief Awaitable waiting for a RequestScheduler slot, bounded by the request budget
+     *
+     * co_await yields the held permit, or an empty one if the request was
+     * shed, or the deadline passed or the token was cancelled while queued.
+     */
+    class AdmissionAwaiter {
+    public:
+        AdmissionAwaiter(AsyncHttpClient& client,
+                         std::shared_ptr<RequestScheduler> scheduler,
+                         std::string host,
+                         const RequestOptions& options);
+        ~AdmissionAwaiter();
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> awaiting);
+        RequestScheduler::Permit await_resume();
+
+        AdmissionAwaiter(const AdmissionAwaiter&) = delete;
+        AdmissionAwaiter& operator=(const AdmissionAwaiter&) = delete;
+
+    private:
+        // Shared with the grant callback, which can run after the awaiter is gone
+        struct State {
+            std::shared_ptr<RequestScheduler> scheduler;
+            std::string host;
+            AdmissionAwaiter* awaiter = nullptr; ///< Null once no longer waiting
+        };
+
+        void give_up();
+        void stop_waiting();
+        void finish(bool granted);
+
+        AsyncHttpClient& client_;
+        const RequestOptions& options_;
+        std::shared_ptr<State> state_;
+        RequestScheduler::Ticket ticket_;
+        std::coroutine_handle<> waiter_;
+        EventLoop::TimerId timer_;
+        std::uint64_t cancel_id_;
+        CancellationToken::SubscriptionId subscription_;
+        bool granted_;
+    };
+
+    std::unique_ptr<EventLoop> owned_loop_; ///< Built-in loop when none is supplied
+    EventLoop& loop_;                    ///< Loop driving cURL's sockets and timers
+    CURLM* multi_;                       ///< cURL multi handle (shared connection cache)
+    int timeout_seconds_;                ///< Per-attempt timeout in seconds
+    int max_retries_;                    ///< Retries after the first attempt
+    BackoffConfig backoff_;              ///< Delays between attempts
+    std::vector<CURL*> idle_handles_;    ///< Reusable easy handles
+    int in_flight_;                      ///< Transfers attached to the multi handle
+    std::unordered_set<curl_socket_t> sockets_; ///< Sockets registered with loop_
+    EventLoop::TimerId curl_timer_;      ///< Pending cURL timeout (0 if none)
+    int sleeping_;                       ///< Coroutines suspended in sleep_for
+    std::list<Task<void>> spawned_;      ///< Detached tasks owned by the client
+    int offloaded_;                      ///< offload() calls still running on a pool
+    std::unordered_map<std::uint64_t, std::function<void()>> cancel_handlers_; ///< Run on the loop when a token fires
+    std::uint64_t next_cancel_id_;
+    std::shared_ptr<char> alive_;        ///< Expires with the client; checked by callbacks posted to loop_
+    std::shared_ptr<RequestScheduler> scheduler_; ///< Admission control (nullptr: none)
+    std::unordered_map<std::string, std::string> unix_sockets_; ///< host_key() -> socket for set_unix_socket()
+    std::shared_ptr<CurlShare> share_;   ///< Shared DNS/TLS caches (nullptr: none)
+    long max_connections_;               ///< CURLMOPT_MAXCONNECTS set by warmup() (0: cURL default)
+    EventLoop::TimerId warm_timer_;      ///< Next keep_warm() round (0 if none)
+    std::vector<std::string> warm_hosts_;
+    std::size_t warm_per_host_;
+    std::chrono::milliseconds warm_interval_{0};
+    bool warming_;                       ///< A keep_warm() round is running
+
+    AsyncHttpClient(std::unique_ptr<EventLoop> owned_loop, EventLoop* loop, int timeout_seconds);
+
+    static int socket_callback(CURL* easy, curl_socket_t socket, int what, void* userp, void* socketp);
+    static int timer_callback(CURLM* multi, long timeout_ms, void* userp);
+    void socket_action(curl_socket_t socket, int events);
+
+    CURL* acquire_handle();
+    void release_handle(CURL* easy);
+    bool start_transfer(Transfer& transfer,
+                        const std::string& url,
+                        const std::string& method,
+                        const std::string& data,
+                        const std::vector<std::string>& headers);
+    void finish_transfer(Transfer& transfer);
+    void abort_transfer(Transfer& transfer);
+    std::uint64_t watch_cancellation(const CancellationToken& token,
+                                     std::function<void()> on_cancel,
+                                     CancellationToken::SubscriptionId& subscription);
+    void unwatch_cancellation(const CancellationToken& token,
+                              std::uint64_t id,
+                              CancellationToken::SubscriptionId subscription);
+    Task<HttpResponse> probe(std::string url, RequestOptions options);
+    void arm_keep_warm();
+    Task<void> refresh_warm();
+    void complete_finished_transfers();
+    void reap_spawned();
+    bool has_pending_work() const;
+
+public:
+    /**
+     * @brief Awaitable that resumes the coroutine after a delay, or early on cancellation
+     *
+     * co_await yields true if the sleep was ended by the cancellation token.
+     */
+    class SleepAwaiter {
+    public:
+        SleepAwaiter(AsyncHttpClient& client, std::chrono::milliseconds delay, CancellationToken cancellation);
+        ~SleepAwaiter();
+
+        bool await_ready() const noexcept { return delay_.count() <= 0 || cancellation_.is_cancelled(); }
+        void await_suspend(std::coroutine_handle<> awaiting);
+        bool await_resume() const noexcept { return cancellation_.is_cancelled(); }
+
+    private:
+        void wake();
+
+        AsyncHttpClient& client_;
+        std::chrono::milliseconds delay_;
+        CancellationToken cancellation_;
+        std::coroutine_handle<> waiter_;
+        EventLoop::TimerId timer_;
+        std::uint64_t cancel_id_;
+        CancellationToken::SubscriptionId subscription_;
+        bool pending_;
+    };
+
+    /**
+     * @brief Awaitable that runs a callable on a thread pool and resumes on the I/O thread
+     */
+    template <typename F>
+    class OffloadAwaiter {
+    public:
+        using Result = std::invoke_result_t<F&>;
+
+        OffloadAwaiter(AsyncHttpClient& client, WorkStealingPool& pool, F fn)
+            : client_(client), pool_(pool), state_(std::make_shared<State>(std::move(fn))) {}
+
+        // Runs on the I/O thread when the awaiting frame is destroyed, e.g. by
+        // ~AsyncHttpClient while the job is still running
+        ~OffloadAwaiter() { state_->abandoned = true; }
+
+        OffloadAwaiter(const OffloadAwaiter&) = delete;
+        OffloadAwaiter& operator=(const OffloadAwaiter&) = delete;
+
+        bool await_ready() const noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<> awaiting) {
+            ++client_.offloaded_;
+            // The job shares the state, not the frame, so it may outlive the awaiter
+            AsyncHttpClient* client = &client_;
+            pool_.post([client, state = state_, awaiting] {
+                try {
+                    if constexpr (std::is_void_v<Result>) {
+                        state->fn();
+                    } else {
+                        state->result.emplace(state->fn());
+                    }
+                } catch (...) {
+                    state->exception = std::current_exception();
+                }
+                client->post([client, state, awaiting] {
+                    --client->offloaded_;
+                    if (!state->abandoned) {
+                        awaiting.resume();
+                    }
+                });
+            });
+        }
+
+        Result await_resume() {
+            if (state_->exception) {
+                std::rethrow_exception(state_->exception);
+            }
+            if constexpr (!std::is_void_v<Result>) {
+                return std::move(*state_->result);
+            }
+        }
+
+    private:
+        using Storage = std::conditional_t<std::is_void_v<Result>, char, Result>;
+
+        struct State {
+            explicit State(F callable) : fn(std::move(callable)) {}
+
+            F fn;
+            std::optional<Storage> result;
+            std::exception_ptr exception;
+            bool abandoned = false; ///< Only touched on the I/O thread
+        };
+
+        AsyncHttpClient& client_;
+        WorkStealingPool& pool_;
+        std::shared_ptr<State> state_;
+    };
+
+    /**
+     * @brief Constructs an AsyncHttpClient on its own EpollEventLoop
+     * @param timeout_seconds Request timeout in seconds (default: 30)
+     * @throws std::runtime_error if cURL multi or event loop initialization fails
+     */
+    explicit AsyncHttpClient(int timeout_seconds = DEFAULT_TIMEOUT_SECONDS);
+
+    /**
+     * @brief Constructs an AsyncHttpClient on a caller-owned event loop
+     *
+     * The caller drives the loop; run_once()/sync_wait() drive it too.
+     * @param loop Event loop; must outlive the client
+     * @param timeout_seconds Request timeout in seconds (default: 30)
+     * @throws std::runtime_error if cURL multi initialization fails
+     */
+    explicit AsyncHttpClient(EventLoop& loop, int timeout_seconds = DEFAULT_TIMEOUT_SECONDS);
+
+    /**
+     * @brief Destructor - destroys spawned tasks and cleans up cURL handles
+     */
+    ~AsyncHttpClient();
+
+    /**
+     * @brief Makes an HTTP request with retry logic; runs when awaited
+     * @param url Target URL
+     * @param method HTTP method (GET, POST, PUT, DELETE)
+     * @param data Request body data (for POST/PUT)
+     * @param headers HTTP headers to include
+     * @param options Deadline bounding all attempts and backoff, and a cancellation token
+     * @return Task yielding the HttpResponse (success=false on final failure)
+     */
+    Task<HttpResponse> request(std::string url,
+                               std::string method = "GET",
+                               std::string data = "",
+                               std::vector<std::string> headers = {},
+                               RequestOptions options = RequestOptions());
+
+    /**
+     * @brief Convenience wrapper for GET requests
+     */
+    Task<HttpResponse> get(std::string url,
+                           std::vector<std::string> headers = {},
+                           RequestOptions options = RequestOptions());
+
+    /**
+     * @brief Convenience wrapper for POST requests
+     */
+    Task<HttpResponse> post(std::string url,
+                            std::string data,
+                            std::vector<std::string> headers = {},
+                            RequestOptions options = RequestOptions());
+
+    /**
+     * @brief Convenience wrapper for PUT requests
+     */
+    Task<HttpResponse> put(std::string url,
+                           std::string data,
+                           std::vector<std::string> headers = {},
+                           RequestOptions options = RequestOptions());
+
+    /**
+     * @brief Opens connections to each host in parallel so later requests skip DNS, TCP and TLS setup
+     *
+     * Sends connections_per_host concurrent HEAD requests to each host's
+     * root; every one that gets any response leaves its connection in this
+     * client's cache, which is enlarged to hold them. Idle connections are
+     * reused by the probes, so a repeat call only tops a host up to
+     * connections_per_host free connections. With CurlShare::global() set,
+     * the resolved names and TLS sessions also serve clients created later.
+     * @param hosts Base URLs, e.g. "https://api.example.com"
+     * @param connections_per_host Connections to have open per host
+     * @param options Deadline and cancellation bounding the whole warmup
+     * @return Task yielding the number of probes that got a response
+     */
+    Task<std::size_t> warmup(std::vector<std::string> hosts,
+                             std::size_t connections_per_host,
+                             RequestOptions options = RequestOptions());
+
+    /**
+     * @brief Runs warmup() now and every interval while the loop is driven
+     *
+     * Keeps at least min_idle_per_host free connections to each host, and
+     * keeps them from hitting the server's idle timeout. The timer alone does
+     * not keep run() from returning.
+     */
+    void keep_warm(std::vector<std::string> hosts, std::size_t min_idle_per_host, std::chrono::milliseconds interval);
+
+    /**
+     * @brief Stops keep_warm(); a round already running completes
+     */
+    void stop_keep_warm();
+
+    /**
+     * @brief Suspends the awaiting coroutine for the given delay without blocking the thread
+     * @param delay Time to sleep
+     * @param cancellation Ends the sleep early when cancelled
+     */
+    SleepAwaiter sleep_for(std::chrono::milliseconds delay, CancellationToken cancellation = CancellationToken()) {
+        return SleepAwaiter(*this, delay, std::move(cancellation));
+    }
+
+    /**
+     * @brief Runs fn on the pool and resumes the awaiting coroutine on this client's thread
+     * @param pool Pool executing fn; must outlive the await
+     * @param fn Callable; its result (or exception) is returned by co_await
+     */
+    template <typename F>
+    OffloadAwaiter<F> offload(WorkStealingPool& pool, F fn) {
+        return OffloadAwaiter<F>(*this, pool, std::move(fn));
+    }
+
+    /**
+     * @brief Thread-safe: queues a callback for the event-loop thread and wakes the loop
+     */
+    void post(std::function<void()> callback);
+
+    /**
+     * @brief Starts a task and lets the client own it until it completes
+     * @param task Task to run; exceptions escaping it are logged
+     */
+    void spawn(Task<void> task);
+
+    /**
+     * @brief Runs the event loop until the task completes and returns its result
+     *
+     * Must not be called from inside a coroutine running on this client.
+     */
+    template <typename T>
+    T sync_wait(Task<T> task) {
+        task.start();
+        while (!task.done()) {
+            run_once();
+        }
+        return task.result();
+    }
+
+    /**
+     * @brief Runs the event loop until all spawned tasks and transfers are finished
+     */
+    void run();
+
+    /**
+     * @brief Runs the event loop once and resumes every coroutine that became ready
+     * @param max_wait_ms Upper bound on the time spent waiting
+     * @return true if transfers, timers or spawned tasks are still pending
+     */
+    bool run_once(int max_wait_ms = 1000);
+
+    /**
+     * @brief The event loop this client is registered with
+     */
+    EventLoop& loop() { return loop_; }
+
+    /**
+     * @brief Number of transfers currently in flight
+     */
+    int in_flight() const { return in_flight_; }
+
+    /**
+     * @brief Sets the number of retries after the first attempt (default: MAX_RETRIES)
+     */
+    void set_max_retries(int max_retries) { max_retries_ = max_retries; }
+
+    /**
+     * @brief Sets the jitter strategy and limits of the delay before each retry
+     * @throws std::invalid_argument if the limits are invalid
+     */
+    void set_backoff(const BackoffConfig& config) {
+        Backoff check(config);
+        backoff_ = config;
+    }
+
+    /**
+     * @brief Routes every attempt through a shared RequestScheduler
+     *
+     * Each attempt suspends until a slot is granted according to
+     * RequestOptions::priority; the slot is released before any backoff.
+     * @param scheduler Scheduler shared with other clients (nullptr disables scheduling)
+     */
+    void set_scheduler(std::shared_ptr<RequestScheduler> scheduler) { scheduler_ = std::move(scheduler); }
+
+    /**
+     * @brief Sends requests for a host over a Unix domain socket instead of TCP
+     *
+     * Same mapping as HttpClient::set_unix_socket(); RequestOptions::unix_socket
+     * overrides it for a single request.
+     * @param host Base URL, e.g. "http://sidecar:15001"
+     * @param socket_path Socket file, "@name" for the abstract namespace, or empty to use TCP again
+     */
+    void set_unix_socket(const std::string& host, const std::string& socket_path);
+
+    // Disable copy constructor and assignment operator
+    AsyncHttpClient(const AsyncHttpClient&) = delete;
+    AsyncHttpClient& operator=(const AsyncHttpClient&) = delete;
+};
+
+#endif // ASYNC_HTTP_CLIENT_H
@@ -0,0 +1,106 @@
+#ifndef BACKOFF_H
+#define BACKOFF_H
+
+#include <cstdint>
+#include <string>
+#include "HttpUtils.h"
+
+/**
+ * @brief Small, fast pseudo-random generator (SplitMix64) for jitter
+ *
+ * Eight bytes of state and a few arithmetic instructions per number, where
+ * std::mt19937 carries 5KB and std::random_device costs a system call.
+ * Not for anything security-related.
+ */
+class FastRandom {
+public:
+    explicit FastRandom(std::uint64_t seed) : state_(seed) {}
+
+    std::uint64_t next() {
+        std::uint64_t z = (state_ += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    /**
+     * @brief Uniform in [0, 1)
+     */
+    double uniform() { return static_cast<double>(next() >> 11) * 0x1.0p-53; }
+
+    /**
+     * @brief Uniform in [low, high)
+     */
+    double uniform(double low, double high) { return low + (high - low) * uniform(); }
+
+    /**
+     * @brief Generator of the calling thread, seeded once from std::random_device
+     */
+    static FastRandom& thread_instance();
+
+private:
+    std::uint64_t state_;
+};
+
+/**
+ * @brief How the exponential delay before a retry is randomised
+ *
+ * With base = min(initial * 2^(retry - 1), max):
+ */
+enum class JitterStrategy {
+    PROPORTIONAL, ///< base * [0.5, 1.5) (backoff_delay_ms(), the client default)
+    FULL,         ///< [0, base)
+    EQUAL,        ///< base / 2 + [0, base / 2)
+    DECORRELATED  ///< min(max, [initial, 3 * previous delay)), independent of the retry number
+};
+
+/**
+ * @brief Name used on command lines and in reports, e.g. "full"
+ */
+const char* jitter_strategy_name(JitterStrategy strategy);
+
+/**
+ * @brief Parses a jitter_strategy_name()
+ * @throws std::invalid_argument for an unknown name
+ */
+JitterStrategy parse_jitter_strategy(const std::string& name);
+
+/**
+ * @brief Backoff parameters
+ */
+struct BackoffConfig {
+    JitterStrategy strategy = JitterStrategy::PROPORTIONAL;
+    int initial_ms = INITIAL_BACKOFF_MS;
+    int max_ms = MAX_BACKOFF_MS;
+};
+
+/**
+ * @brief Delays between the attempts of one request
+ *
+ * Keep one per request (decorrelated jitter depends on the previous delay);
+ * the state is reset at attempt 0. Like backoff_delay_ms(), the first retry
+ * is immediate.
+ */
+class Backoff {
+public:
+    /**
+     * @param random Source of jitter; nullptr uses FastRandom::thread_instance()
+     * @throws std::invalid_argument if initial_ms is not positive or max_ms is below it
+     */
+    explicit Backoff(BackoffConfig config = BackoffConfig(), FastRandom* random = nullptr);
+
+    /**
+     * @brief Delay before retrying after attempt `attempt` (0-based) failed
+     * @return 0 for attempt 0
+     */
+    int delay_ms(int attempt);
+
+    const BackoffConfig& config() const { return config_; }
+
+private:
+    BackoffConfig config_;
+    FastRandom* random_;
+    int previous_ms_; ///< DECORRELATED: last delay handed out
+};
+
+#endif // BACKOFF_H
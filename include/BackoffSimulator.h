@@ -0,0 +1,50 @@
+#ifndef BACKOFF_SIMULATOR_H
+#define BACKOFF_SIMULATOR_H
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include "Backoff.h"
+
+/**
+ * @brief A fleet of clients retrying against a server that fails and then recovers
+ *
+ * Simulated time in milliseconds; no network or sleeping is involved.
+ */
+struct RetryStormConfig {
+    int clients = 1000;               ///< Clients each making one request
+    int arrival_spread_ms = 1000;     ///< First attempts start uniformly over [0, spread)
+    int outage_ms = 5000;             ///< Every attempt fails before this time
+    int capacity_per_second = 2000;   ///< Attempts served per second after the outage; the rest are rejected
+    int window_ms = 100;              ///< Interval over which capacity and load are counted
+    int max_retries = 10;             ///< A client gives up after this many retries
+    BackoffConfig backoff;            ///< Strategy under test and its limits
+    std::uint64_t seed = 1;           ///< Same seed, same run
+};
+
+/**
+ * @brief Outcome of one simulated retry storm
+ */
+struct RetryStormReport {
+    JitterStrategy strategy = JitterStrategy::PROPORTIONAL;
+    std::uint64_t attempts = 0;       ///< Attempts the server received, first ones included
+    std::uint64_t rejected = 0;       ///< Attempts after the outage turned away for lack of capacity
+    int succeeded = 0;
+    int gave_up = 0;
+    std::uint64_t peak_window_attempts = 0; ///< Busiest window_ms of load after the outage
+    double recovery_ms = 0;           ///< From the end of the outage until the last client succeeded or gave up
+};
+
+/**
+ * @brief Runs the simulation for config.backoff.strategy
+ * @throws std::invalid_argument if a count or duration is not positive
+ */
+RetryStormReport simulate_retry_storm(const RetryStormConfig& config);
+
+/**
+ * @brief Writes a table with one row per report
+ */
+void print_retry_storm_reports(const RetryStormConfig& config, const std::vector<RetryStormReport>& reports,
+                               std::ostream& out);
+
+#endif // BACKOFF_SIMULATOR_H
@@ -0,0 +1,78 @@
+#ifndef BULK_UPLOAD_H
+#define BULK_UPLOAD_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "HttpUtils.h"
+
+class WorkStealingPool;
+
+/**
+ * @brief How records are sent to the endpoint
+ */
+enum class BulkMode {
+    NDJSON_BATCHES, ///< Many records per POST as newline-delimited JSON (bulk endpoints)
+    PER_RECORD      ///< One POST per record, several in flight (endpoints without a bulk form)
+};
+
+/**
+ * @brief Bulk upload parameters
+ */
+struct BulkConfig {
+    std::string url;                          ///< Endpoint receiving the POSTs
+    BulkMode mode = BulkMode::NDJSON_BATCHES;
+    std::size_t batch_records = 1000;         ///< NDJSON: records per request at most
+    std::size_t batch_bytes = 1 << 20;        ///< NDJSON: body bytes per request at most (one record may exceed it)
+    int concurrency = 4;                      ///< Requests in flight (one HttpClient each)
+    std::vector<std::string> headers;         ///< Extra headers; a Content-Type is added unless given
+    int timeout_seconds = DEFAULT_TIMEOUT_SECONDS;
+    int max_retries = MAX_RETRIES;
+};
+
+/**
+ * @brief Bulk upload results
+ */
+struct BulkReport {
+    std::uint64_t records = 0;            ///< Valid records sent
+    std::uint64_t invalid_records = 0;    ///< Non-empty lines that are not valid JSON (skipped)
+    std::uint64_t first_invalid_line = 0; ///< 1-based line of the first invalid record (0: none)
+    std::uint64_t requests = 0;
+    std::uint64_t failed_requests = 0;
+    std::uint64_t failed_records = 0;     ///< Records in failed requests
+    std::uint64_t bytes = 0;              ///< Request body bytes sent
+    std::map<std::string, std::uint64_t> errors; ///< Failed requests per error message
+    std::chrono::duration<double> elapsed{0};
+};
+
+/**
+ * @brief Uploads every JSON record of an NDJSON (JSON lines) buffer
+ *
+ * The input is split at line boundaries into chunks that are validated and
+ * grouped into batches on the pool, while config.concurrency sender threads
+ * POST them. A batch only references its records in the input; NDJSON
+ * batches are streamed with chunked transfer encoding, so no request body
+ * is assembled in memory. Prepared requests wait in a queue of twice the
+ * concurrency, so parsing stops when the endpoint falls behind and memory
+ * stays bounded however large the input is. Requests complete out of
+ * order; blank lines are ignored and invalid lines are counted, not sent.
+ * @throws std::invalid_argument if the URL is empty or a limit is not positive
+ */
+BulkReport run_bulk_upload(const char* data, std::size_t size, const BulkConfig& config, WorkStealingPool& pool);
+
+/**
+ * @brief run_bulk_upload() over a memory-mapped file
+ * @throws std::runtime_error if the file cannot be mapped
+ */
+BulkReport run_bulk_upload_file(const std::string& path, const BulkConfig& config, WorkStealingPool& pool);
+
+/**
+ * @brief Writes record, request and error counts with throughput
+ */
+void print_bulk_report(const BulkReport& report, std::ostream& out);
+
+#endif // BULK_UPLOAD_H
@@ -0,0 +1,59 @@
+#ifndef CURL_SHARE_H
+#define CURL_SHARE_H
+
+#include <memory>
+#include <mutex>
+#include <curl/curl.h>
+
+/**
+ * @brief DNS and TLS session caches shared by every cURL handle attached to it
+ *
+ * Each easy handle normally keeps its own DNS cache and TLS sessions, so a
+ * new HttpClient resolves and does a full handshake again. Handles attached
+ * to one CurlShare look names up once per process and resume TLS sessions
+ * negotiated by any other handle, which also lets
+ * AsyncHttpClient::warmup() prime both caches for the clients created later.
+ *
+ * Connections themselves are not shared: libcurl's shared connection cache
+ * is not safe across threads, while each client here is used from its own
+ * thread. Pre-opened connections therefore live in the client that opened
+ * them (see AsyncHttpClient::warmup()).
+ *
+ * Thread-safe; handles on any thread may use the share at once.
+ */
+class CurlShare {
+public:
+    /**
+     * @throws std::runtime_error if the cURL share handle cannot be created
+     */
+    CurlShare();
+    ~CurlShare();
+
+    /**
+     * @brief Makes a handle use the shared caches; repeat after curl_easy_reset()
+     */
+    void attach(CURL* curl) const;
+
+    /**
+     * @brief Share joined by every CurlTransport and AsyncHttpClient created afterwards
+     * @param share New process-wide share (nullptr: handles keep private caches)
+     */
+    static void set_global(std::shared_ptr<CurlShare> share);
+
+    /**
+     * @brief The process-wide share, or nullptr if none is set
+     */
+    static std::shared_ptr<CurlShare> global();
+
+    CurlShare(const CurlShare&) = delete;
+    CurlShare& operator=(const CurlShare&) = delete;
+
+private:
+    static void lock(CURL* curl, curl_lock_data data, curl_lock_access access, void* userp);
+    static void unlock(CURL* curl, curl_lock_data data, void* userp);
+
+    CURLSH* share_;
+    std::mutex mutexes_[CURL_LOCK_DATA_LAST]; ///< One per kind of shared data
+};
+
+#endif // CURL_SHARE_H
@@ -0,0 +1,119 @@
+#ifndef DISK_CACHE_H
+#define DISK_CACHE_H
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include "ResponseCache.h"
+
+/**
+ * @brief Sizing for a DiskCache
+ */
+struct DiskCacheConfig {
+    std::string directory;                      ///< Created if missing; holds "index" and segment files
+    std::uint64_t max_bytes = 256ull << 20;     ///< Record bytes kept before the oldest entries are dropped
+    std::uint64_t segment_bytes = 16ull << 20;  ///< Size of each append-only segment file
+    std::uint64_t index_slots = 1 << 16;        ///< Initial index capacity (rounded up to a power of two)
+};
+
+/**
+ * @brief Persistent response cache: mmap'd append-only segments plus a mapped hash index
+ *
+ * Entries are appended to segment files ("segment-N.dat") and located
+ * through an open-addressing hash table with fixed-size slots that lives in
+ * a mapped "index" file, so lookups are O(1) and touch one index slot and
+ * one record. Both are shared mappings: a new process opening the same
+ * directory starts warm, without reading or parsing anything up front.
+ *
+ * Overwritten, erased and expired entries leave dead records behind.
+ * compact() rewrites the live entries into fresh segments and rebuilds the
+ * index; it runs automatically when dead bytes outweigh live ones, when
+ * the index fills up, or when max_bytes is exceeded (then the oldest
+ * entries are dropped). The index is replaced by an atomic rename, so a
+ * crash during compaction leaves the previous generation intact.
+ *
+ * Slot keys are 64-bit FNV-1a hashes; records store the full key, which is
+ * compared on every hit. Thread-safe within one process; the directory must
+ * not be opened by two processes at once.
+ */
+class DiskCache : public ResponseCache {
+public:
+    /**
+     * @brief Opens or creates a cache directory
+     *
+     * An index from an incompatible version or with a bad layout is
+     * discarded together with its segments.
+     * @throws std::runtime_error if the directory or files cannot be created or mapped
+     */
+    explicit DiskCache(DiskCacheConfig config);
+
+    /**
+     * @brief Schedules dirty pages for write-back and unmaps everything
+     */
+    ~DiskCache() override;
+
+    bool get(const std::string& key, CachedResponse& entry) override;
+    void put(const std::string& key, const CachedResponse& entry) override;
+    void erase(const std::string& key) override;
+
+    /**
+     * @brief Rewrites live entries into new segments and drops dead space
+     */
+    void compact();
+
+    /**
+     * @brief Writes the index and segments to disk (msync)
+     */
+    void flush();
+
+    /**
+     * @brief Number of live entries (expired entries count until touched or compacted)
+     */
+    std::uint64_t size() const;
+
+    /**
+     * @brief Record bytes in segments, live and dead
+     */
+    std::uint64_t disk_bytes() const;
+
+    DiskCache(const DiskCache&) = delete;
+    DiskCache& operator=(const DiskCache&) = delete;
+
+private:
+    struct Segment {
+        int fd = -1;
+        char* data = nullptr;
+        std::uint64_t size = 0;
+    };
+
+    struct Slot;
+    struct IndexHeader;
+    struct Cursor;
+
+    void open_index();
+    void write_index(const std::string& path, IndexHeader state, const Slot* slots);
+    void map_index(const std::string& path);
+    void unmap_index();
+    Segment& open_segment(std::uint32_t id, std::uint64_t create_size);
+    void close_segment(Segment& segment);
+    void remove_segment_file(std::uint32_t id);
+    std::string segment_path(std::uint32_t id) const;
+
+    Slot* find_slot(const std::string& key, std::uint64_t hash, Slot** free_slot);
+    const char* record_at(const Slot& slot) const;
+    char* allocate(std::uint64_t length, Cursor& cursor, Slot& location);
+    void kill_slot(Slot& slot);
+    void compact_locked(std::uint64_t keep_bytes);
+
+    DiskCacheConfig config_;
+    mutable std::mutex mutex_;
+    int index_fd_;
+    char* index_map_;
+    std::uint64_t index_size_;
+    IndexHeader* header_;
+    Slot* slots_;
+    std::map<std::uint32_t, Segment> segments_;
+};
+
+#endif // DISK_CACHE_H
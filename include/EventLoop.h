@@ -0,0 +1,132 @@
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Reactor interface AsyncHttpClient registers cURL's sockets and timers with
+ *
+ * Implement it to embed the client in an existing event loop, or use the
+ * built-in EpollEventLoop. All members except post() are called from the
+ * loop thread only.
+ */
+class EventLoop {
+public:
+    /// Event bits used by watch() and passed to FdCallback
+    enum Events {
+        READABLE = 1,
+        WRITABLE = 2,
+        ERROR = 4
+    };
+
+    using FdCallback = std::function<void(int events)>;
+    using Callback = std::function<void()>;
+    using TimerId = std::uint64_t;
+
+    virtual ~EventLoop() = default;
+
+    /**
+     * @brief Starts or updates watching a file descriptor
+     * @param fd File descriptor
+     * @param events Combination of READABLE and WRITABLE
+     * @param callback Invoked with the ready events; replaces any previous callback
+     */
+    virtual void watch(int fd, int events, FdCallback callback) = 0;
+
+    /**
+     * @brief Stops watching a file descriptor (no-op if not watched)
+     */
+    virtual void unwatch(int fd) = 0;
+
+    /**
+     * @brief Schedules a one-shot timer
+     * @return Identifier usable with cancel_timer()
+     */
+    virtual TimerId add_timer(std::chrono::milliseconds delay, Callback callback) = 0;
+
+    /**
+     * @brief Cancels a pending timer (no-op if it already fired)
+     */
+    virtual void cancel_timer(TimerId id) = 0;
+
+    /**
+     * @brief Thread-safe: queues a callback to run on the loop thread and wakes the loop
+     */
+    virtual void post(Callback callback) = 0;
+
+    /**
+     * @brief Waits for events once and dispatches everything that became ready
+     * @param max_wait_ms Upper bound on the time spent waiting (0 polls)
+     */
+    virtual void run_once(int max_wait_ms) = 0;
+};
+
+/**
+ * @brief Built-in Linux EventLoop on epoll, with eventfd wake-ups and a timerfd for timers
+ *
+ * Standalone use: call run_once() in a loop. To nest inside another epoll
+ * loop, register fd() for EPOLLIN there and call run_once(0) whenever it is
+ * readable; socket readiness, timer expiry and post() all make fd() readable.
+ */
+class EpollEventLoop : public EventLoop {
+public:
+    /**
+     * @throws std::runtime_error if epoll, eventfd or timerfd creation fails
+     */
+    EpollEventLoop();
+    ~EpollEventLoop() override;
+
+    void watch(int fd, int events, FdCallback callback) override;
+    void unwatch(int fd) override;
+    TimerId add_timer(std::chrono::milliseconds delay, Callback callback) override;
+    void cancel_timer(TimerId id) override;
+    void post(Callback callback) override;
+    void run_once(int max_wait_ms) override;
+
+    /**
+     * @brief The epoll descriptor, for nesting this loop inside an external one
+     */
+    int fd() const { return epoll_fd_; }
+
+    /**
+     * @brief Number of file descriptors currently watched
+     */
+    std::size_t watched_count() const { return watches_.size(); }
+
+    EpollEventLoop(const EpollEventLoop&) = delete;
+    EpollEventLoop& operator=(const EpollEventLoop&) = delete;
+
+private:
+    using Clock = std::chrono::steady_clock;
+    using TimerKey = std::pair<Clock::time_point, TimerId>;
+
+    struct Watch {
+        int events;
+        FdCallback callback;
+    };
+
+    int epoll_fd_;
+    int event_fd_;                                         ///< post() wake-ups
+    int timer_fd_;                                         ///< Armed for the earliest timer
+    std::unordered_map<int, std::shared_ptr<Watch>> watches_;
+    std::map<TimerKey, Callback> timers_;
+    std::unordered_map<TimerId, Clock::time_point> timer_deadlines_;
+    TimerId next_timer_id_;
+    Clock::time_point armed_for_;                          ///< Deadline timer_fd_ is set to
+    std::mutex posted_mutex_;
+    std::vector<Callback> posted_;
+
+    void arm_timer_fd();
+    void fire_due_timers();
+    void run_posted();
+};
+
+#endif // EVENT_LOOP_H
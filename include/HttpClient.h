@@ -1,10 +1,24 @@
 #ifndef HTTP_CLIENT_H
 #define HTTP_CLIENT_H
 
+#include <chrono>
+#include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <curl/curl.h>
 #include "ApiException.h"
+#include "HttpClientPolicies.h"
+#include "HttpTransport.h"
+#include "PerfCounters.h"
+#include "ReplicaSet.h"
+#include "RequestBody.h"
+#include "RequestOptions.h"
+#include "RequestScheduler.h"
+#include "ResponseCache.h"
+#include "ResponseSink.h"
+#include "Tracing.h"
 
 /**
  * @brief HTTP Response structure containing response data and metadata
@@ -12,6 +26,7 @@
 struct HttpResponse {
     int status_code;           ///< HTTP status code
     std::string body;          ///< Response body
+    std::map<std::string, std::string> headers; ///< Response headers by lower-cased name (repeats joined by ", ")
     std::string error_message; ///< Error message if request failed
     bool success;              ///< Whether the request was successful
     
@@ -27,29 +42,93 @@ struct HttpResponse {
  * - SSL verification
  * - Comprehensive error handling
  * - Resource cleanup
+ *
+ * Retries, backoff, logging and metrics are compile-time policies (see
+ * HttpClientPolicies.h). HttpClient is the instantiation with all of them
+ * on; TrustedHttpClient turns them all off for calls to trusted services,
+ * leaving one attempt with no log formatting or counter updates. Both are
+ * compiled once in HttpClient.cpp; other combinations need
+ * HttpClientImpl.h in the translation unit that uses them.
+ * @tparam RetryPolicy Retry limit and which failures to retry
+ * @tparam BackoffPolicy Delay before each retry
+ * @tparam LogPolicy Destination of log messages (never formatted if LogPolicy::enabled is false or accepts(level) rejects them)
+ * @tparam SinkPolicy Destination of request metrics
  */
-class HttpClient {
+template <typename RetryPolicy, typename BackoffPolicy, typename LogPolicy, typename SinkPolicy>
+class BasicHttpClient {
 private:
-    CURL* curl_;                    ///< cURL handle
+    std::shared_ptr<HttpTransport> transport_;   ///< Performs each attempt
     int timeout_seconds_;           ///< Request timeout in seconds
+    [[no_unique_address]] RetryPolicy retry_;
+    [[no_unique_address]] BackoffPolicy backoff_;
+    std::shared_ptr<RequestScheduler> scheduler_; ///< Admission control (nullptr: none)
+    std::shared_ptr<ResponseCache> cache_;        ///< Successful GET responses (nullptr: none)
+    std::chrono::seconds cache_ttl_;              ///< Lifetime of cached responses
+    std::shared_ptr<Tracer> tracer_;              ///< Span collector (nullptr: no tracing)
+    std::unordered_map<std::string, std::string> unix_sockets_; ///< host_key() -> socket for set_unix_socket()
     
     /**
-     * @brief Sets up common cURL options for all requests
+     * @brief Sleeps for the backoff delay unless that would overrun the request budget
+     * @param attempt Attempt that just failed (0-based)
+     * @param options Request deadline and cancellation token
+     * @param trace Receives a span for the sleep
+     * @param response Receives the budget error message when giving up
+     * @return true if the request should be retried
      */
-    void setup_common_options();
+    bool wait_before_retry(int attempt, const RequestOptions& options, RequestTrace& trace, HttpResponse& response);
+    
+    /**
+     * @brief Retry loop shared by both make_request overloads
+     * @param data In-memory body, or nullptr when body is set
+     * @param body Streamed body, or nullptr when data is set
+     * @param sink Destination of a successful response body (nullptr: HttpResponse::body)
+     */
+    HttpResponse execute(const std::string& url,
+                         const std::string& method,
+                         const std::string* data,
+                         RequestBodySource* body,
+                         ResponseSink* sink,
+                         const std::vector<std::string>& headers,
+                         const RequestOptions& options);
+    
+    /**
+     * @brief Stores a successful GET response in cache_, logging failures
+     */
+    void store_in_cache(const std::string& url, const HttpResponse& response);
+    
+    /**
+     * @brief Builds the message with `message` and passes it to LogPolicy
+     *
+     * Nothing is built when the policy is disabled or does not accept the level.
+     */
+    template <typename Message>
+    static void log(LogLevel level, Message&& message) {
+        if constexpr (LogPolicy::enabled) {
+            if (!LogPolicy::accepts(level)) {
+                return;
+            }
+            PhaseScope phase(RequestPhase::LOGGING);
+            LogPolicy::write(level, message());
+        }
+    }
     
 public:
     /**
      * @brief Constructs an HttpClient with specified timeout
+     *
+     * The transport comes from make_default_transport(), so HTTP_RECORD_FILE
+     * and HTTP_REPLAY_FILE apply to every client.
      * @param timeout_seconds Request timeout in seconds (default: 30)
      * @throws std::runtime_error if cURL initialization fails
      */
-    HttpClient(int timeout_seconds = 30);
+    BasicHttpClient(int timeout_seconds = 30);
     
     /**
-     * @brief Destructor - cleans up cURL handle
+     * @brief Constructs an HttpClient over a specific transport
+     * @param transport Transport performing each attempt (e.g. a ReplayTransport)
+     * @param timeout_seconds Request timeout in seconds
      */
-    ~HttpClient();
+    explicit BasicHttpClient(std::shared_ptr<HttpTransport> transport, int timeout_seconds = 30);
     
     /**
      * @brief Makes an HTTP request with retry logic and error handling
@@ -57,16 +136,152 @@ public:
      * @param method HTTP method (GET, POST, PUT, DELETE)
      * @param data Request body data (for POST/PUT)
      * @param headers HTTP headers to include
+     * @param options Deadline bounding all attempts and backoff, and a cancellation token
      * @return HttpResponse containing response data and status
      */
     HttpResponse make_request(const std::string& url, 
                              const std::string& method = "GET",
                              const std::string& data = "",
-                             const std::vector<std::string>& headers = {});
+                             const std::vector<std::string>& headers = {},
+                             const RequestOptions& options = RequestOptions());
+    
+    /**
+     * @brief Makes a request whose body is read from a source while it is sent
+     *
+     * Only one transfer buffer of the body is in memory at a time, so files
+     * and generated payloads of any size can be uploaded. Each retry first
+     * rewinds the source; a source that cannot rewind ends the request after
+     * the first failed attempt. Streamed requests are never cached.
+     * @param url Target URL
+     * @param method HTTP method (POST, PUT, PATCH, ...)
+     * @param body Request body; must outlive the call
+     * @param headers HTTP headers to include
+     * @param options Deadline bounding all attempts and backoff, and a cancellation token
+     * @return HttpResponse containing response data and status
+     */
+    HttpResponse make_request(const std::string& url,
+                             const std::string& method,
+                             RequestBodySource& body,
+                             const std::vector<std::string>& headers = {},
+                             const RequestOptions& options = RequestOptions());
+    
+    /**
+     * @brief GETs a resource into a sink instead of HttpResponse::body
+     *
+     * With a MappedFileSink the body is written through to a pre-sized
+     * mapped file as it arrives, so large artifacts never pass through a
+     * std::string. The sink is reset before every attempt and finished
+     * after a successful one; error bodies are still in HttpResponse::body.
+     * Downloads are never cached.
+     * @param url Target URL
+     * @param sink Destination of the body; must outlive the call
+     * @param headers HTTP headers to include
+     * @param options Deadline bounding all attempts and backoff, and a cancellation token
+     * @return HttpResponse with status and errors (body empty on success)
+     */
+    HttpResponse download(const std::string& url,
+                          ResponseSink& sink,
+                          const std::vector<std::string>& headers = {},
+                          const RequestOptions& options = RequestOptions());
+    
+    /**
+     * @brief Sets the number of retries after the first attempt (default: MAX_RETRIES)
+     *
+     * Only for retry policies with an adjustable limit.
+     */
+    void set_max_retries(int max_retries)
+        requires requires(RetryPolicy& policy, int limit) { policy.set_limit(limit); }
+    {
+        retry_.set_limit(max_retries);
+    }
+    
+    /**
+     * @brief The retry policy, for policies with settings of their own
+     */
+    RetryPolicy& retry_policy() { return retry_; }
+    
+    /**
+     * @brief The backoff policy, for policies with settings of their own
+     */
+    BackoffPolicy& backoff_policy() { return backoff_; }
+    
+    /**
+     * @brief Routes every attempt through a shared RequestScheduler
+     *
+     * Each attempt waits for a slot according to RequestOptions::priority;
+     * the slot is released before any backoff.
+     * @param scheduler Scheduler shared with other clients (nullptr disables scheduling)
+     */
+    void set_scheduler(std::shared_ptr<RequestScheduler> scheduler) { scheduler_ = std::move(scheduler); }
+    
+    /**
+     * @brief Serves GET requests from a cache and stores successful GET responses in it
+     *
+     * Entries are keyed by URL alone, so do not share a cache between
+     * clients whose headers (e.g. credentials) change the response.
+     * @param cache Cache, e.g. a TieredCache over a DiskCache (nullptr disables caching)
+     * @param ttl Lifetime of stored responses
+     */
+    void set_cache(std::shared_ptr<ResponseCache> cache, std::chrono::seconds ttl = std::chrono::seconds(300)) {
+        cache_ = std::move(cache);
+        cache_ttl_ = ttl;
+    }
+    
+    /**
+     * @brief Traces requests: a span per request, attempt and backoff, and a traceparent header
+     *
+     * A traceparent passed in headers makes each request a child of that
+     * span and keeps its sampling decision; otherwise the tracer samples.
+     * Unsampled requests still propagate their trace ID downstream.
+     * @param tracer Tracer shared with other clients (nullptr disables tracing)
+     */
+    void set_tracer(std::shared_ptr<Tracer> tracer) { tracer_ = std::move(tracer); }
+    
+    /**
+     * @brief Balances requests across equivalent replicas
+     *
+     * Wraps the current transport in a BalancedTransport, so every attempt,
+     * including each retry, goes to a replica picked by the set, and request
+     * URLs may be plain paths such as "/posts/1". Call set_transport() first
+     * if both are needed.
+     * @param replicas Replica set shared with other clients
+     */
+    void set_replicas(std::shared_ptr<ReplicaSet> replicas);
+    
+    /**
+     * @brief Sends requests for a host over a Unix domain socket instead of TCP
+     *
+     * Meant for sidecar proxies on the same machine, where the socket skips
+     * the loopback TCP stack. URLs are unchanged, so the Host header and path
+     * still come from them; RequestOptions::unix_socket overrides this
+     * mapping for a single request.
+     * @param host Base URL, e.g. "http://sidecar:15001" (matched via RequestScheduler::host_key())
+     * @param socket_path Socket file, "@name" for the abstract namespace, or empty to use TCP again
+     */
+    void set_unix_socket(const std::string& host, const std::string& socket_path);
+    
+    /**
+     * @brief Replaces the transport used for subsequent requests
+     */
+    void set_transport(std::shared_ptr<HttpTransport> transport) { transport_ = std::move(transport); }
     
     // Disable copy constructor and assignment operator
-    HttpClient(const HttpClient&) = delete;
-    HttpClient& operator=(const HttpClient&) = delete;
+    BasicHttpClient(const BasicHttpClient&) = delete;
+    BasicHttpClient& operator=(const BasicHttpClient&) = delete;
 };
 
+/**
+ * @brief The default client: retries with exponential backoff, logs and records metrics
+ */
+using HttpClient = BasicHttpClient<DefaultRetryPolicy, ExponentialBackoffPolicy, StdLogPolicy, MetricsSinkPolicy>;
+
+/**
+ * @brief Single-attempt client without logging or metrics, for calls to trusted services
+ */
+using TrustedHttpClient = BasicHttpClient<NoRetryPolicy, NoBackoffPolicy, NullLogPolicy, NullSinkPolicy>;
+
+// Compiled once in HttpClient.cpp
+extern template class BasicHttpClient<DefaultRetryPolicy, ExponentialBackoffPolicy, StdLogPolicy, MetricsSinkPolicy>;
+extern template class BasicHttpClient<NoRetryPolicy, NoBackoffPolicy, NullLogPolicy, NullSinkPolicy>;
+
 #endif // HTTP_CLIENT_H 
\ No newline at end of file
@@ -0,0 +1,319 @@
+#ifndef HTTP_CLIENT_IMPL_H
+#define HTTP_CLIENT_IMPL_H
+
+// Member definitions of BasicHttpClient. HttpClient.cpp instantiates
+// HttpClient and TrustedHttpClient from them; include this header only in
+// a translation unit that uses another combination of policies.
+
+#include "HttpClient.h"
+#include "HttpUtils.h"
+#include "Metrics.h"
+#include "Tracing.h"
+#include <curl/curl.h>
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+
+namespace detail {
+
+/// Counts a request, and on every return path records its outcome and closes its trace
+template <typename SinkPolicy>
+class RequestOutcome {
+public:
+    RequestOutcome(const HttpResponse& response, RequestTrace& trace) : response_(response), trace_(trace) {
+        SinkPolicy::add(Metric::REQUESTS);
+    }
+    ~RequestOutcome() {
+        SinkPolicy::add(response_.success ? Metric::SUCCESSES : Metric::FAILURES);
+        trace_.finish(response_.status_code);
+    }
+
+private:
+    const HttpResponse& response_;
+    RequestTrace& trace_;
+};
+
+} // namespace detail
+
+template <typename RetryPolicy, typename BackoffPolicy, typename LogPolicy, typename SinkPolicy>
+BasicHttpClient<RetryPolicy, BackoffPolicy, LogPolicy, SinkPolicy>::BasicHttpClient(int timeout_seconds)
+    : BasicHttpClient(make_default_transport(timeout_seconds), timeout_seconds) {}
+
+template <typename RetryPolicy, typename BackoffPolicy, typename LogPolicy, typename SinkPolicy>
+BasicHttpClient<RetryPolicy, BackoffPolicy, LogPolicy, SinkPolicy>::BasicHttpClient(
+    std::shared_ptr<HttpTransport> transport, int timeout_seconds)
+    : transport_(std::move(transport)), timeout_seconds_(timeout_seconds), cache_ttl_(std::chrono::seconds(300)) {}
+
+template <typename RetryPolicy, typename BackoffPolicy, typename LogPolicy, typename SinkPolicy>
+void BasicHttpClient<RetryPolicy, BackoffPolicy, LogPolicy, SinkPolicy>::set_unix_socket(
+    const std::string& host, const std::string& socket_path) {
+    if (socket_path.empty()) {
+        unix_sockets_.erase(RequestScheduler::host_key(host));
+    } else {
+        unix_sockets_[RequestScheduler::host_key(host)] = socket_path;
+    }
+}
+
+template <typename RetryPolicy, typename BackoffPolicy, typename LogPolicy, typename SinkPolicy>
+void BasicHttpClient<RetryPolicy, BackoffPolicy, LogPolicy, SinkPolicy>::set_replicas(
+    std::shared_ptr<ReplicaSet> replicas) {
+    transport_ = std::make_shared<BalancedTransport>(std::move(transport_), std::move(replicas));
+}
+
+template <typename RetryPolicy, typename BackoffPolicy, typename LogPolicy, typename SinkPolicy>
+HttpResponse BasicHttpClient<RetryPolicy, BackoffPolicy, LogPolicy, SinkPolicy>::make_request(
+    const std::string& url,
+    const std::string& method,
+    const std::string& data,
+    const std::vector<std::string>& headers,
+    const RequestOptions& options) {
+    return execute(url, method, &data, nullptr, nullptr, headers, options);
+}
+
+template <typename RetryPolicy, typename BackoffPolicy, typename LogPolicy, typename SinkPolicy>
+HttpResponse BasicHttpClient<RetryPolicy, BackoffPolicy, LogPolicy, SinkPolicy>::make_request(
+    const std::string& url,
+    const std::string& method,
+    RequestBodySource& body,
+    const std::vector<std::string>& headers,
+    const RequestOptions& options) {
+    return execute(url, method, nullptr, &body, nullptr, headers, options);
+}
+
+template <typename RetryPolicy, typename BackoffPolicy, typename LogPolicy, typename SinkPolicy>
+HttpResponse BasicHttpClient<RetryPolicy, BackoffPolicy, LogPolicy, SinkPolicy>::download(
+    const std::string& url,
+    ResponseSink& sink,
+    const std::vector<std::string>& headers,
+    const RequestOptions& options) {
+    static const std::string no_data;
+    return execute(url, "GET", &no_data, nullptr, &sink, headers, options);
+}
+
+template <typename RetryPolicy, typename BackoffPolicy, typename LogPolicy, typename SinkPolicy>
+HttpResponse BasicHttpClient<RetryPolicy, BackoffPolicy, LogPolicy, SinkPolicy>::execute(
+    const std::string& url,
+    const std::string& method,
+    const std::string* data,
+    RequestBodySource* body,
+    ResponseSink* sink,
+    const std::vector<std::string>& headers,
+    const RequestOptions& request_options) {
+
+    // A per-host socket applies unless the request names its own
+    RequestOptions routed;
+    const RequestOptions* selected = &request_options;
+    if (request_options.unix_socket.empty() && !unix_sockets_.empty()) {
+        auto socket = unix_sockets_.find(RequestScheduler::host_key(url));
+        if (socket != unix_sockets_.end()) {
+            routed = request_options;
+            routed.unix_socket = socket->second;
+            selected = &routed;
+        }
+    }
+    const RequestOptions& options = *selected;
+
+    HttpResponse response;
+    RequestTrace trace = tracer_ ? RequestTrace(*tracer_, method, url, headers) : RequestTrace();
+    detail::RequestOutcome<SinkPolicy> outcome(response, trace);
+
+    // Cached GET responses skip the network entirely
+    bool cacheable = cache_ && method == "GET" && data && !sink;
+    if (cacheable) {
+        CachedResponse cached;
+        if (cache_->get(url, cached)) {
+            SinkPolicy::add(Metric::CACHE_HITS);
+            log(LogLevel::INFO, [&] { return "Cache hit for " + url; });
+            response.status_code = cached.status_code;
+            response.body = std::move(cached.body);
+            response.success = true;
+            return response;
+        }
+    }
+
+    const int max_retries = retry_.limit();
+    for (int attempt = 0; attempt <= max_retries; ++attempt) {
+        try {
+            // Callers whose budget is already spent get no further attempts
+            if (const char* budget_error = request_budget_error(options)) {
+                response.error_message = budget_error;
+                log(LogLevel::WARNING, [&] { return response.error_message + " before " + method + " request to " + url; });
+                return response;
+            }
+
+            // Wait for an admission slot when requests are scheduled
+            RequestScheduler::Permit permit;
+            if (scheduler_) {
+                permit = scheduler_->acquire(RequestScheduler::host_key(url), options);
+                if (!permit) {
+                    const char* budget_error = request_budget_error(options);
+                    response.error_message = budget_error ? budget_error : "Request shed: too many requests queued for host";
+                    log(LogLevel::WARNING, [&] {
+                        return response.error_message + " while queued for " + method + " request to " + url;
+                    });
+                    return response;
+                }
+            }
+
+            // A streamed body has been consumed by the previous attempt
+            if (body && attempt > 0 && !body->rewind()) {
+                response.error_message = "Request body cannot be replayed for a retry";
+                log(LogLevel::WARNING, [&] { return response.error_message + " (" + method + " " + url + ")"; });
+                return response;
+            }
+
+            log(LogLevel::INFO, [&] {
+                return "Making " + method + " request to " + url + " (attempt " + std::to_string(attempt + 1) + ")";
+            });
+
+            SinkPolicy::add(Metric::ATTEMPTS);
+            if (attempt > 0) {
+                SinkPolicy::add(Metric::RETRIES);
+            }
+            if (data) {
+                SinkPolicy::add(Metric::BYTES_SENT, data->size());
+            } else if (body->size() > 0) {
+                SinkPolicy::add(Metric::BYTES_SENT, static_cast<std::uint64_t>(body->size()));
+            }
+
+            // Traced attempts carry their own traceparent header
+            std::vector<std::string> traced_headers;
+            if (trace.active()) {
+                traced_headers = trace.start_attempt(headers);
+            }
+            const std::vector<std::string>& attempt_headers = trace.active() ? traced_headers : headers;
+
+            // Perform request
+            TransportResult result;
+            if (sink) {
+                sink->reset(); // drop a partial body from the previous attempt
+                result = transport_->perform_download(url, *sink, attempt_headers, options);
+            } else if (body) {
+                result = transport_->perform_streaming(url, method, *body, attempt_headers, options);
+            } else {
+                result = transport_->perform(url, method, *data, attempt_headers, options);
+            }
+            // Backoff must not hold the slot; the attempt's latency tunes an adaptive limit
+            permit.release(request_budget_error(options) ? AttemptOutcome::IGNORED
+                                                         : attempt_outcome(result.code, result.status_code));
+            trace.end_attempt(attempt + 1, result);
+
+            CURLcode res = result.code;
+            response.status_code = result.status_code;
+            response.body = std::move(result.body);
+            response.headers = std::move(result.headers);
+            SinkPolicy::add(Metric::BYTES_RECEIVED, response.body.size() + result.sink_bytes);
+            SinkPolicy::add_response(response.status_code);
+
+            // Check for cURL errors
+            if (res != CURLE_OK) {
+                SinkPolicy::add(Metric::TRANSPORT_ERRORS);
+                response.error_message = result.error_message;
+                log(LogLevel::ERROR, [&] { return "cURL error: " + response.error_message; });
+
+                // Aborted by the cancellation token or cut short by the deadline
+                if (const char* budget_error = request_budget_error(options)) {
+                    response.error_message = budget_error;
+                    return response;
+                }
+
+                if (retry_.retry_transport(res) && attempt < max_retries) {
+                    if (!wait_before_retry(attempt, options, trace, response)) {
+                        return response;
+                    }
+                    continue;
+                } else {
+                    throw ApiException("cURL error: " + response.error_message);
+                }
+            }
+
+            // Check HTTP status code
+            if (response.status_code >= 200 && response.status_code < 300) {
+                if (sink) {
+                    sink->finish();
+                }
+                response.success = true;
+                log(LogLevel::INFO, [&] {
+                    return "Request successful with status code: " + std::to_string(response.status_code);
+                });
+                if (cacheable) {
+                    store_in_cache(url, response);
+                }
+                return response;
+            } else {
+                response.error_message = "HTTP " + std::to_string(response.status_code);
+                log(LogLevel::WARNING, [&] { return "HTTP error: " + response.error_message; });
+
+                if (retry_.retry_status(response.status_code) && attempt < max_retries) {
+                    if (!wait_before_retry(attempt, options, trace, response)) {
+                        return response;
+                    }
+                    continue;
+                } else {
+                    throw ApiException("HTTP error: " + std::to_string(response.status_code), response.status_code);
+                }
+            }
+
+        } catch (const std::exception& e) {
+            log(LogLevel::ERROR, [&] { return "Request failed: " + std::string(e.what()); });
+            if (attempt >= max_retries) {
+                response.error_message = e.what();
+                return response;
+            }
+            if (!wait_before_retry(attempt, options, trace, response)) {
+                return response;
+            }
+        }
+    }
+
+    return response;
+}
+
+template <typename RetryPolicy, typename BackoffPolicy, typename LogPolicy, typename SinkPolicy>
+bool BasicHttpClient<RetryPolicy, BackoffPolicy, LogPolicy, SinkPolicy>::wait_before_retry(
+    int attempt, const RequestOptions& options, RequestTrace& trace, HttpResponse& response) {
+    int backoff_ms = backoff_.delay_ms(attempt);
+
+    // Sleeping past the deadline only to fail afterwards wastes a connection slot
+    if (options.deadline.is_set() && options.deadline.remaining() <= std::chrono::milliseconds(backoff_ms)) {
+        response.error_message = "Deadline exceeded";
+        log(LogLevel::WARNING, [&] {
+            return "Not retrying: " + std::to_string(backoff_ms) + "ms backoff would exceed the request deadline";
+        });
+        return false;
+    }
+
+    if (backoff_ms > 0) {
+        log(LogLevel::INFO, [&] {
+            return "Retrying in " + std::to_string(backoff_ms) + "ms (attempt " + std::to_string(attempt + 1) + ")";
+        });
+        auto start = std::chrono::steady_clock::now();
+        bool cancelled = options.cancellation.wait_for(std::chrono::milliseconds(backoff_ms));
+        auto end = std::chrono::steady_clock::now();
+        SinkPolicy::add(Metric::BACKOFF_MICROSECONDS, static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()));
+        trace.record_backoff(start, end);
+        if (cancelled) {
+            response.error_message = "Request cancelled";
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename RetryPolicy, typename BackoffPolicy, typename LogPolicy, typename SinkPolicy>
+void BasicHttpClient<RetryPolicy, BackoffPolicy, LogPolicy, SinkPolicy>::store_in_cache(
+    const std::string& url, const HttpResponse& response) {
+    CachedResponse entry;
+    entry.status_code = response.status_code;
+    entry.body = response.body;
+    entry.expires = std::chrono::system_clock::now() + cache_ttl_;
+    try {
+        cache_->put(url, entry);
+    } catch (const std::exception& e) {
+        // A full or broken cache must not fail a request that succeeded
+        log(LogLevel::WARNING, [&] { return "Failed to cache response for " + url + ": " + e.what(); });
+    }
+}
+
+#endif // HTTP_CLIENT_IMPL_H
@@ -0,0 +1,104 @@
+#ifndef HTTP_CLIENT_POLICIES_H
+#define HTTP_CLIENT_POLICIES_H
+
+#include <cstdint>
+#include <string>
+#include <curl/curl.h>
+#include "Backoff.h"
+#include "HttpUtils.h"
+#include "Metrics.h"
+
+// Compile-time policies of BasicHttpClient. Each kind has HttpClient's
+// behaviour and a no-op form; the no-op forms are empty and answer in
+// constexpr, so a client built from them keeps no retry loop, backoff,
+// log formatting or metric updates after optimisation.
+
+/**
+ * @brief Retries transient transport errors and retryable HTTP statuses (HttpClient default)
+ */
+struct DefaultRetryPolicy {
+    int max_retries = MAX_RETRIES; ///< Retries after the first attempt
+
+    int limit() const { return max_retries; }
+    void set_limit(int retries) { max_retries = retries; }
+    static bool retry_transport(CURLcode code) { return is_retryable_curl_error(code); }
+    static bool retry_status(int status_code) { return is_retryable_error(status_code); }
+};
+
+/**
+ * @brief Exactly one attempt per request
+ */
+struct NoRetryPolicy {
+    static constexpr int limit() { return 0; }
+    static constexpr bool retry_transport(CURLcode) { return false; }
+    static constexpr bool retry_status(int) { return false; }
+};
+
+/**
+ * @brief Exponential backoff with jitter (HttpClient default: proportional, as backoff_delay_ms())
+ */
+struct ExponentialBackoffPolicy {
+    Backoff backoff; ///< Jitter strategy and limits; replace to configure
+
+    int delay_ms(int attempt) { return backoff.delay_ms(attempt); }
+};
+
+/**
+ * @brief Retries immediately
+ */
+struct NoBackoffPolicy {
+    static constexpr int delay_ms(int) { return 0; }
+};
+
+/**
+ * @brief Writes through log_info(), log_warning() and log_error() (HttpClient default)
+ */
+struct StdLogPolicy {
+    static constexpr bool enabled = true;
+
+    /// Checked before a message is built, so set_log_level() drops it unformatted
+    static bool accepts(LogLevel level) { return level >= get_log_level(); }
+
+    static void write(LogLevel level, const std::string& message) {
+        switch (level) {
+        case LogLevel::INFO:
+            log_info(message);
+            break;
+        case LogLevel::WARNING:
+            log_warning(message);
+            break;
+        default:
+            log_error(message);
+            break;
+        }
+    }
+};
+
+/**
+ * @brief Drops every message; messages are not even formatted
+ */
+struct NullLogPolicy {
+    static constexpr bool enabled = false;
+
+    static constexpr bool accepts(LogLevel) { return false; }
+
+    static void write(LogLevel, const std::string&) {}
+};
+
+/**
+ * @brief Counts requests, attempts and bytes in HttpMetrics (HttpClient default)
+ */
+struct MetricsSinkPolicy {
+    static void add(Metric metric, std::uint64_t amount = 1) { HttpMetrics::add(metric, amount); }
+    static void add_response(int status_code) { HttpMetrics::add_response(status_code); }
+};
+
+/**
+ * @brief Records no metrics
+ */
+struct NullSinkPolicy {
+    static void add(Metric, std::uint64_t = 1) {}
+    static void add_response(int) {}
+};
+
+#endif // HTTP_CLIENT_POLICIES_H
@@ -0,0 +1,286 @@
+#ifndef HTTP_TRANSPORT_H
+#define HTTP_TRANSPORT_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <curl/curl.h>
+#include "CurlShare.h"
+#include "MappedFile.h"
+#include "RequestBody.h"
+#include "RequestOptions.h"
+#include "ResponseSink.h"
+
+/**
+ * @brief When each phase of a transfer completed, in microseconds from its start
+ *
+ * Values come from cURL's *_TIME_T infos; a reused connection reports 0
+ * for name lookup and connect, a plain-HTTP one 0 for TLS, and transports
+ * without a network leave -1.
+ */
+struct TransferTimings {
+    std::int64_t dns_us = -1;        ///< Name resolved
+    std::int64_t connect_us = -1;    ///< TCP connected
+    std::int64_t tls_us = -1;        ///< TLS handshake done
+    std::int64_t first_byte_us = -1; ///< First response byte received
+    std::int64_t total_us = -1;      ///< Transfer finished
+};
+
+/**
+ * @brief Outcome of a single transfer, before HttpClient applies retry policy
+ */
+struct TransportResult {
+    CURLcode code;             ///< CURLE_OK unless the transfer failed
+    int status_code;           ///< HTTP status code (0 if no response)
+    std::string body;          ///< Response body
+    std::map<std::string, std::string> headers; ///< Response headers, names lowercased
+    std::string error_message; ///< Transfer error text when code != CURLE_OK
+    std::uint64_t sink_bytes;  ///< Body bytes handed to a ResponseSink instead of body
+    TransferTimings timings;   ///< Phase timings (network transports only)
+
+    TransportResult() : code(CURLE_OK), status_code(0), sink_bytes(0) {}
+};
+
+/**
+ * @brief Performs one HTTP attempt for HttpClient
+ *
+ * HttpClient owns retries, backoff and scheduling; a transport only moves
+ * bytes. Swapping it lets tests and benchmarks run against recorded traffic.
+ */
+class HttpTransport {
+public:
+    virtual ~HttpTransport() = default;
+
+    /**
+     * @brief Performs a single attempt
+     * @param url Target URL
+     * @param method HTTP method (GET, POST, PUT, DELETE)
+     * @param data Request body data (for POST/PUT)
+     * @param headers HTTP headers to include
+     * @param options Deadline and cancellation token bounding this attempt
+     */
+    virtual TransportResult perform(const std::string& url,
+                                    const std::string& method,
+                                    const std::string& data,
+                                    const std::vector<std::string>& headers,
+                                    const RequestOptions& options) = 0;
+
+    /**
+     * @brief Performs a single attempt whose body is read while it is sent
+     *
+     * The default reads the whole body into memory and calls perform(), which
+     * is what recording and replay need to match requests.
+     * @param body Request body, positioned at its start
+     */
+    virtual TransportResult perform_streaming(const std::string& url,
+                                              const std::string& method,
+                                              RequestBodySource& body,
+                                              const std::vector<std::string>& headers,
+                                              const RequestOptions& options);
+
+    /**
+     * @brief Performs a single GET whose successful body goes to a sink
+     *
+     * The default performs a buffered GET and writes the body to the sink
+     * afterwards. Error bodies stay in TransportResult::body.
+     * @param sink Receives the body of a 2xx response (reset by the caller)
+     */
+    virtual TransportResult perform_download(const std::string& url,
+                                             ResponseSink& sink,
+                                             const std::vector<std::string>& headers,
+                                             const RequestOptions& options);
+};
+
+/**
+ * @brief Network transport over a reusable cURL easy handle (not thread-safe)
+ *
+ * Joins CurlShare::global() as it was when the transport was created.
+ */
+class CurlTransport : public HttpTransport {
+public:
+    /**
+     * @param timeout_seconds Per-attempt timeout in seconds
+     * @throws std::runtime_error if cURL initialization fails
+     */
+    explicit CurlTransport(int timeout_seconds = 30);
+    ~CurlTransport() override;
+
+    TransportResult perform(const std::string& url,
+                            const std::string& method,
+                            const std::string& data,
+                            const std::vector<std::string>& headers,
+                            const RequestOptions& options) override;
+
+    /**
+     * @brief Streams the body through CURLOPT_READFUNCTION; unknown sizes go out chunked
+     */
+    TransportResult perform_streaming(const std::string& url,
+                                      const std::string& method,
+                                      RequestBodySource& body,
+                                      const std::vector<std::string>& headers,
+                                      const RequestOptions& options) override;
+
+    /**
+     * @brief Hands each received block to the sink, sized up front from Content-Length
+     */
+    TransportResult perform_download(const std::string& url,
+                                     ResponseSink& sink,
+                                     const std::vector<std::string>& headers,
+                                     const RequestOptions& options) override;
+
+    CurlTransport(const CurlTransport&) = delete;
+    CurlTransport& operator=(const CurlTransport&) = delete;
+
+private:
+    void reset_handle();
+
+    CURL* curl_;
+    int timeout_seconds_;
+    std::shared_ptr<CurlShare> share_; ///< Shared DNS/TLS caches (nullptr: none)
+};
+
+/**
+ * @brief Appends request/response pairs to a recording file (thread-safe)
+ *
+ * File layout (host byte order): the 4-byte magic "HTRC" and a uint32
+ * version, then one record per exchange: uint32 lengths of method, URL,
+ * request body, response body and error message; int32 cURL code; int32
+ * HTTP status; uint64 latency in microseconds; then the five byte strings.
+ * Every record is flushed as it is written, so a crash loses at most the
+ * record in progress.
+ */
+class TransportRecorder {
+public:
+    /**
+     * @brief Creates (truncates) the recording file
+     * @throws std::runtime_error if it cannot be opened
+     */
+    explicit TransportRecorder(const std::string& path);
+    ~TransportRecorder();
+
+    /**
+     * @brief Appends one exchange
+     */
+    void append(const std::string& method,
+                const std::string& url,
+                const std::string& data,
+                const TransportResult& result,
+                std::chrono::microseconds latency);
+
+    /**
+     * @brief Exchanges written so far
+     */
+    std::size_t count() const;
+
+    TransportRecorder(const TransportRecorder&) = delete;
+    TransportRecorder& operator=(const TransportRecorder&) = delete;
+
+private:
+    mutable std::mutex mutex_;
+    FILE* file_;
+    std::size_t count_;
+};
+
+/**
+ * @brief Forwards to another transport and records every exchange with its latency
+ */
+class RecordingTransport : public HttpTransport {
+public:
+    /**
+     * @param inner Transport doing the real work (owned by this client only)
+     * @param recorder Destination, may be shared by many clients
+     */
+    RecordingTransport(std::shared_ptr<HttpTransport> inner, std::shared_ptr<TransportRecorder> recorder);
+
+    TransportResult perform(const std::string& url,
+                            const std::string& method,
+                            const std::string& data,
+                            const std::vector<std::string>& headers,
+                            const RequestOptions& options) override;
+
+private:
+    std::shared_ptr<HttpTransport> inner_;
+    std::shared_ptr<TransportRecorder> recorder_;
+};
+
+/**
+ * @brief How a ReplayTransport paces responses
+ */
+enum class ReplayTiming {
+    FULL_SPEED, ///< Respond immediately
+    ORIGINAL    ///< Wait the recorded latency (bounded by deadline and cancellation)
+};
+
+/**
+ * @brief Serves responses from a recording instead of the network (thread-safe)
+ *
+ * The file is memory-mapped and indexed once. Requests are matched on
+ * method, URL and request body (request headers are ignored) and get the
+ * recorded status, body and response headers; repeated requests get
+ * the recorded responses in order, wrapping around when exhausted, so a
+ * recorded retry sequence replays the same way. Unmatched requests fail
+ * with CURLE_READ_ERROR.
+ */
+class ReplayTransport : public HttpTransport {
+public:
+    /**
+     * @brief Maps and indexes a recording made by TransportRecorder
+     * @throws std::runtime_error if the file is missing or not a recording
+     */
+    explicit ReplayTransport(const std::string& path, ReplayTiming timing = ReplayTiming::FULL_SPEED);
+
+    TransportResult perform(const std::string& url,
+                            const std::string& method,
+                            const std::string& data,
+                            const std::vector<std::string>& headers,
+                            const RequestOptions& options) override;
+
+    /**
+     * @brief Number of exchanges in the recording
+     */
+    std::size_t size() const { return size_; }
+
+private:
+    struct Exchange {
+        std::string_view body;
+        std::string_view error_message;
+        std::string_view headers; ///< name\0value\0 pairs
+        CURLcode code;
+        int status_code;
+        std::chrono::microseconds latency;
+    };
+
+    struct Entry {
+        std::vector<Exchange> exchanges;
+        std::size_t next = 0;
+    };
+
+    static std::string key(std::string_view method, std::string_view url, std::string_view data);
+
+    MappedFile file_;
+    ReplayTiming timing_;
+    std::size_t size_;
+    std::mutex mutex_; ///< Guards Entry::next
+    std::unordered_map<std::string, Entry> entries_;
+};
+
+/**
+ * @brief Transport for a new HttpClient, chosen from the environment
+ *
+ * With HTTP_REPLAY_FILE set, every client shares one ReplayTransport over
+ * that file (HTTP_REPLAY_TIMING=original keeps recorded latencies). With
+ * HTTP_RECORD_FILE set, each client records through its own CurlTransport
+ * into one shared file. Otherwise a plain CurlTransport is returned. This
+ * lets the existing network tests run offline from a recording.
+ * @param timeout_seconds Per-attempt timeout for network transports
+ */
+std::shared_ptr<HttpTransport> make_default_transport(int timeout_seconds);
+
+#endif // HTTP_TRANSPORT_H
@@ -1,8 +1,14 @@
 #ifndef HTTP_UTILS_H
 #define HTTP_UTILS_H
 
+#include <map>
 #include <string>
+#include <vector>
 #include <curl/curl.h>
+#include "RequestOptions.h"
+#include "RequestScheduler.h"
+
+class RequestBodySource;
 
 // Configuration constants
 const int DEFAULT_TIMEOUT_SECONDS = 30;
@@ -21,6 +27,27 @@ enum class HttpStatus {
     INTERNAL_SERVER_ERROR = 500
 };
 
+/**
+ * @brief Minimum severity written by the log functions
+ */
+enum class LogLevel {
+    INFO = 0,
+    WARNING = 1,
+    ERROR = 2,
+    SILENT = 3
+};
+
+/**
+ * @brief Sets the process-wide minimum log level (default: LogLevel::INFO)
+ * @param level Messages below this level are dropped
+ */
+void set_log_level(LogLevel level);
+
+/**
+ * @brief Returns the process-wide minimum log level
+ */
+LogLevel get_log_level();
+
 /**
  * @brief Logs an informational message with timestamp
  * @param message Message to log
@@ -39,6 +66,13 @@ void log_error(const std::string& message);
  */
 void log_warning(const std::string& message);
 
+/**
+ * @brief Computes the exponential backoff delay with jitter, without sleeping
+ * @param attempt Current attempt number (0-based)
+ * @return Delay in milliseconds (0 for the first attempt)
+ */
+int backoff_delay_ms(int attempt);
+
 /**
  * @brief Implements exponential backoff with jitter
  * @param attempt Current attempt number (0-based)
@@ -59,6 +93,14 @@ bool is_retryable_error(int status_code);
  */
 bool is_retryable_curl_error(CURLcode code);
 
+/**
+ * @brief Classifies an attempt for RequestScheduler's adaptive limit
+ * @param code cURL result of the attempt
+ * @param status_code HTTP status (when code is CURLE_OK)
+ * @return OVERLOADED for timeouts, 429 and 503; IGNORED for other transport errors; otherwise COMPLETED
+ */
+AttemptOutcome attempt_outcome(CURLcode code, int status_code);
+
 /**
  * @brief cURL write callback function
  * @param contents Pointer to received data
@@ -69,4 +111,94 @@ bool is_retryable_curl_error(CURLcode code);
  */
 size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp);
 
+/**
+ * @brief Applies the client-wide cURL options (timeouts, TLS, redirects, user agent)
+ * @param curl cURL easy handle
+ * @param timeout_seconds Request timeout in seconds
+ */
+void setup_common_curl_options(CURL* curl, int timeout_seconds);
+
+/**
+ * @brief Applies a request's deadline and cancellation token to one attempt
+ *
+ * Clamps the attempt timeout to the time left before the deadline and, if the
+ * token can be cancelled, installs a progress callback that aborts the
+ * transfer (CURLE_ABORTED_BY_CALLBACK) once it is.
+ * @param curl cURL easy handle
+ * @param timeout_seconds Client per-attempt timeout in seconds
+ * @param options Request options; must outlive the transfer
+ */
+void setup_budget_options(CURL* curl, int timeout_seconds, const RequestOptions& options);
+
+/**
+ * @brief Routes one attempt over RequestOptions::unix_socket, if set
+ *
+ * The URL still supplies the Host header and path. A name starting with
+ * '@' is a Linux abstract-namespace socket (no file on disk).
+ * @param curl cURL easy handle
+ * @param options Request options; must outlive the transfer
+ */
+void setup_socket_options(CURL* curl, const RequestOptions& options);
+
+/**
+ * @brief Collects the headers of a finished transfer's final response
+ * @param curl cURL easy handle, before it is reset or reused
+ * @param headers Receives the headers by lower-cased name; repeated headers are joined by ", "
+ */
+void read_response_headers(CURL* curl, std::map<std::string, std::string>& headers);
+
+/**
+ * @brief Builds a cURL header list from "Name: value" strings
+ * @param headers HTTP headers to include
+ * @return Header list (nullptr if empty); caller frees with curl_slist_free_all
+ */
+struct curl_slist* build_header_list(const std::vector<std::string>& headers);
+
+/**
+ * @brief Applies per-request cURL options: URL, method, body, headers and write target
+ * @param curl cURL easy handle
+ * @param url Target URL
+ * @param method HTTP method (GET, POST, PUT, DELETE)
+ * @param data Request body data; must outlive the transfer
+ * @param header_list Header list from build_header_list (may be nullptr)
+ * @param body Response body buffer written by WriteCallback
+ */
+void setup_request_options(CURL* curl,
+                           const std::string& url,
+                           const std::string& method,
+                           const std::string& data,
+                           struct curl_slist* header_list,
+                           std::string* body);
+
+/**
+ * @brief cURL read callback pulling the request body from a RequestBodySource
+ * @param buffer Destination for the next part of the body
+ * @param size Size of each data element
+ * @param nitems Number of data elements
+ * @param userp User pointer (RequestBodySource)
+ * @return Number of bytes copied, or CURL_READFUNC_ABORT if the source threw
+ */
+size_t ReadCallback(char* buffer, size_t size, size_t nitems, void* userp);
+
+/**
+ * @brief Applies per-request cURL options for a body read while it is sent
+ *
+ * A source already in memory is passed to CURLOPT_POSTFIELDS without a
+ * copy. Otherwise POST keeps its method and other methods upload with
+ * CURLOPT_UPLOAD; the caller adds "Transfer-Encoding: chunked" to the
+ * headers when the source size is unknown.
+ * @param curl cURL easy handle
+ * @param url Target URL
+ * @param method HTTP method (POST, PUT, PATCH, ...)
+ * @param source Request body; must outlive the transfer
+ * @param header_list Header list from build_header_list (may be nullptr)
+ * @param body Response body buffer written by WriteCallback
+ */
+void setup_streaming_request_options(CURL* curl,
+                                     const std::string& url,
+                                     const std::string& method,
+                                     RequestBodySource& source,
+                                     struct curl_slist* header_list,
+                                     std::string* body);
+
 #endif // HTTP_UTILS_H 
\ No newline at end of file
@@ -0,0 +1,142 @@
+#ifndef INT_STREAM_H
+#define INT_STREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+#include "SimdLevel.h"
+
+class WorkStealingPool;
+
+/**
+ * @brief Large write buffer flushed to a file descriptor with few write() calls
+ */
+class OutputBuffer {
+public:
+    /**
+     * @param fd Destination descriptor (not closed)
+     * @param capacity Buffer size in bytes
+     */
+    explicit OutputBuffer(int fd, std::size_t capacity = 1 << 20);
+
+    /**
+     * @brief Flushes remaining data; errors are ignored here, call flush() to see them
+     */
+    ~OutputBuffer();
+
+    /**
+     * @brief Returns space for at least n bytes, flushing first if needed
+     */
+    char* reserve(std::size_t n);
+
+    /**
+     * @brief Marks the bytes up to end (within the last reserve()) as written
+     */
+    void commit(char* end) { used_ = static_cast<std::size_t>(end - buffer_.data()); }
+
+    /**
+     * @brief Writes buffered data to the descriptor
+     * @throws std::runtime_error on write errors
+     */
+    void flush();
+
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+private:
+    int fd_;
+    std::vector<char> buffer_;
+    std::size_t used_;
+};
+
+/**
+ * @brief Outcome of parse_ints()
+ */
+struct IntParseResult {
+    std::size_t count;  ///< Integers written to the output array
+    const char* next;   ///< Where parsing stopped
+    bool invalid;       ///< Stopped at a token `std::cin >> int` would reject
+};
+
+/**
+ * @brief Parses integers exactly as repeated `std::cin >> int` does in the "C" locale
+ *
+ * Skips whitespace, then reads an optional sign and a run of digits; values
+ * outside the int range and tokens that do not start with a digit are
+ * invalid. Character classes are found 16 or 32 bytes at a time with
+ * SSE2/AVX2 (chosen at runtime), and long digit runs are converted 8 at a
+ * time.
+ *
+ * Stops when the output array is full, at an invalid token, or, unless
+ * at_eof, at a token touching `end` that may continue in the next chunk.
+ * @param begin Start of input
+ * @param end End of input
+ * @param at_eof Whether `end` is the end of the whole stream
+ * @param out Destination array
+ * @param capacity Size of out
+ */
+IntParseResult parse_ints(const char* begin, const char* end, bool at_eof, std::int32_t* out, std::size_t capacity);
+
+/**
+ * @brief Multiplies every value by factor in place, wrapping on overflow
+ */
+void scale_ints(std::int32_t* values, std::size_t count, std::int32_t factor);
+
+/**
+ * @brief Formats values as "v " each (the boosttest output format)
+ * @param out Destination; needs 12 bytes per value
+ * @return End of the written text
+ */
+char* format_ints(const std::int32_t* values, std::size_t count, char* out);
+
+/**
+ * @brief Parses, scales and writes every integer in a buffer
+ * @param consumed Receives the number of input bytes fully processed
+ * @return false if an invalid token ended the stream
+ */
+bool transform_int_buffer(const char* data,
+                          std::size_t size,
+                          bool at_eof,
+                          std::int32_t factor,
+                          OutputBuffer& out,
+                          std::size_t& consumed);
+
+/**
+ * @brief Streams integers from in_fd to out_fd multiplied by factor
+ *
+ * Regular files are memory-mapped; pipes and terminals are read in large
+ * blocks. Output matches `std::cout << v * factor << " "` for each value.
+ * @return false if an invalid token ended the stream early
+ * @throws std::runtime_error on read or write errors
+ */
+bool transform_int_stream(int in_fd, int out_fd, std::int32_t factor);
+
+/**
+ * @brief Parallel transform_int_buffer() over a whole in-memory input
+ *
+ * Splits the input at whitespace into chunks of about chunk_size bytes,
+ * transforms them on the pool and writes the results in input order as
+ * each finishes (ordered reassembly). At most a few chunks per worker are
+ * outstanding, bounding memory. If a chunk hits an invalid token, output
+ * ends there and later chunks are skipped, as in the sequential version.
+ * @return false if an invalid token ended the stream early
+ * @throws std::runtime_error on write errors
+ */
+bool transform_int_buffer_parallel(const char* data,
+                                   std::size_t size,
+                                   std::int32_t factor,
+                                   int out_fd,
+                                   WorkStealingPool& pool,
+                                   std::size_t chunk_size = 4 << 20);
+
+/**
+ * @brief transform_int_stream() using the pool for regular (mappable) files
+ *
+ * Pipes cannot be split without reading them first, so they fall back to
+ * the sequential streaming path.
+ */
+bool transform_int_stream_parallel(int in_fd, int out_fd, std::int32_t factor, WorkStealingPool& pool);
+
+#endif // INT_STREAM_H
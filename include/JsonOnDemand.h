@@ -0,0 +1,293 @@
+#ifndef JSON_ON_DEMAND_H
+#define JSON_ON_DEMAND_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "SimdLevel.h"
+
+/**
+ * @brief Malformed JSON, or a value read as the wrong type
+ */
+class JsonError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/**
+ * @brief Kind of a JSON value, from its first character
+ */
+enum class JsonType {
+    OBJECT,
+    ARRAY,
+    STRING,
+    NUMBER,
+    BOOLEAN,
+    NUL
+};
+
+class JsonDocument;
+class JsonField;
+class JsonArray;
+class JsonObject;
+
+/**
+ * @brief Read-only handle to one value of a JsonDocument
+ *
+ * Cheap to copy (a document pointer and an index). Each accessor validates
+ * only the part of the document it touches and throws JsonError if that part
+ * is malformed or of another type.
+ */
+class JsonValue {
+public:
+    JsonValue() = default;
+
+    JsonType type() const;
+    bool is_null() const;
+
+    /**
+     * @brief String contents with escapes decoded (\uXXXX to UTF-8)
+     */
+    std::string get_string() const;
+
+    /**
+     * @brief Exact source text of the value, e.g. "\"a\\nb\"" or "[1, 2]"
+     */
+    std::string_view raw() const;
+
+    std::int64_t get_int64() const;
+    double get_double() const;
+    bool get_bool() const;
+
+    /**
+     * @brief Member of an object
+     * @throws JsonError if this is not an object or the key is missing
+     */
+    JsonValue operator[](std::string_view key) const;
+
+    /**
+     * @brief Member of an object, if present
+     * @return false if the key is missing
+     * @throws JsonError if this is not an object
+     */
+    bool find(std::string_view key, JsonValue& value) const;
+
+    /**
+     * @brief Elements of an array, in order
+     */
+    JsonArray elements() const;
+
+    /**
+     * @brief Members of an object, in order
+     */
+    JsonObject fields() const;
+
+    /**
+     * @brief Number of array elements or object members (walks the container)
+     */
+    std::size_t size() const;
+
+private:
+    friend class JsonDocument;
+    friend class JsonArray;
+    friend class JsonObject;
+
+    JsonValue(const JsonDocument* document, std::uint32_t index) : document_(document), index_(index) {}
+
+    const JsonDocument* document_ = nullptr;
+    std::uint32_t index_ = 0; ///< Position of the value's first structural character
+};
+
+/**
+ * @brief Object member yielded by JsonValue::fields()
+ */
+class JsonField {
+public:
+    /**
+     * @brief Key with escapes decoded
+     */
+    std::string key() const;
+
+    /**
+     * @brief Key text between the quotes, escapes undecoded
+     */
+    std::string_view raw_key() const { return raw_key_; }
+
+    JsonValue value() const { return value_; }
+
+private:
+    friend class JsonObject;
+
+    std::string_view raw_key_;
+    JsonValue value_;
+};
+
+/**
+ * @brief Forward range over the elements of an array
+ */
+class JsonArray {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = JsonValue;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = JsonValue;
+
+        JsonValue operator*() const { return JsonValue(document_, index_); }
+        iterator& operator++();
+        bool operator==(const iterator& other) const { return index_ == other.index_; }
+        bool operator!=(const iterator& other) const { return index_ != other.index_; }
+
+    private:
+        friend class JsonArray;
+
+        iterator(const JsonDocument* document, std::uint32_t index, std::uint32_t close)
+            : document_(document), index_(index), close_(close) {}
+
+        const JsonDocument* document_;
+        std::uint32_t index_;
+        std::uint32_t close_; ///< Index of the closing ']' (also the end position)
+    };
+
+    iterator begin() const;
+    iterator end() const { return iterator(document_, close_, close_); }
+
+private:
+    friend class JsonValue;
+
+    JsonArray(const JsonDocument* document, std::uint32_t open, std::uint32_t close)
+        : document_(document), open_(open), close_(close) {}
+
+    const JsonDocument* document_;
+    std::uint32_t open_;
+    std::uint32_t close_;
+};
+
+/**
+ * @brief Forward range over the members of an object
+ */
+class JsonObject {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = JsonField;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const JsonField*;
+        using reference = const JsonField&;
+
+        const JsonField& operator*() const { return field_; }
+        const JsonField* operator->() const { return &field_; }
+        iterator& operator++();
+        bool operator==(const iterator& other) const { return index_ == other.index_; }
+        bool operator!=(const iterator& other) const { return index_ != other.index_; }
+
+    private:
+        friend class JsonObject;
+
+        iterator(const JsonDocument* document, std::uint32_t index, std::uint32_t close);
+
+        /// Reads the key and ':' of the member starting at index_
+        void load();
+
+        const JsonDocument* document_;
+        std::uint32_t index_; ///< Index of the member's key
+        std::uint32_t close_; ///< Index of the closing '}' (also the end position)
+        JsonField field_;
+    };
+
+    iterator begin() const;
+    iterator end() const { return iterator(document_, close_, close_); }
+
+private:
+    friend class JsonValue;
+
+    JsonObject(const JsonDocument* document, std::uint32_t open, std::uint32_t close)
+        : document_(document), open_(open), close_(close) {}
+
+    const JsonDocument* document_;
+    std::uint32_t open_;
+    std::uint32_t close_;
+};
+
+/**
+ * @brief JSON text indexed for on-demand access, without building a tree
+ *
+ * parse() makes one pass over the text in 64-byte blocks (SSE2 or AVX2
+ * compares with a scalar fallback, chosen by active_simd_level()) that marks
+ * quotes, brackets, separators and the first character of each number or
+ * literal, skipping everything inside strings. A second pass pairs the
+ * brackets so containers can be skipped in O(1). Values are then decoded
+ * only when read, which is what makes picking a few fields out of a large
+ * response cheap.
+ *
+ * parse() checks string termination and bracket nesting; everything else
+ * (separators, numbers, literals, escapes) is checked by the accessors on the
+ * values they read. UTF-8 is not validated.
+ *
+ * The text is not copied and must outlive the document, and values are
+ * only valid until the document is parsed again, moved or destroyed. A
+ * document can be reused for another parse() to keep its buffers.
+ */
+class JsonDocument {
+public:
+    JsonDocument() = default;
+
+    /**
+     * @throws JsonError if the text is malformed
+     */
+    explicit JsonDocument(std::string_view text);
+
+    /**
+     * @brief Indexes new text, replacing the previous document
+     * @throws JsonError on an unterminated string, mismatched brackets,
+     *         an empty document, trailing content or text over 4 GiB
+     */
+    void parse(std::string_view text);
+
+    /**
+     * @brief The top-level value
+     */
+    JsonValue root() const;
+
+    JsonDocument(JsonDocument&&) = default;
+    JsonDocument& operator=(JsonDocument&&) = default;
+    JsonDocument(const JsonDocument&) = delete;
+    JsonDocument& operator=(const JsonDocument&) = delete;
+
+private:
+    friend class JsonValue;
+    friend class JsonArray;
+    friend class JsonObject;
+
+    /// Marks structural characters (stage 1)
+    void index_structurals();
+
+    /// Pairs brackets and checks the document is one value (stage 2)
+    void match_brackets();
+
+    /// Character at a structural index ('\0' past the end)
+    char at(std::uint32_t index) const;
+
+    /// Index just past the value starting at index
+    std::uint32_t skip(std::uint32_t index) const;
+
+    /// Index of the bracket matching the one at index
+    std::uint32_t partner(std::uint32_t index) const { return jumps_[index]; }
+
+    /// Text between the quotes of the string starting at index
+    std::string_view string_body(std::uint32_t index) const;
+
+    std::string_view text_;
+    std::vector<std::uint32_t> positions_; ///< Offset of each structural character
+    std::vector<std::uint32_t> jumps_;     ///< Matching bracket index (brackets only)
+    std::vector<std::uint32_t> stack_;     ///< Open brackets during matching
+};
+
+#endif // JSON_ON_DEMAND_H
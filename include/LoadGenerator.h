@@ -0,0 +1,138 @@
+#ifndef LOAD_GENERATOR_H
+#define LOAD_GENERATOR_H
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "AllocationTracker.h"
+#include "HttpTransport.h"
+
+/**
+ * @brief Log-linear latency histogram with microsecond resolution
+ *
+ * Values below 128us are exact; larger values fall into buckets of 64 per
+ * power of two (under 1.6% relative error), so memory is fixed regardless of
+ * the number of samples and per-thread histograms merge cheaply.
+ */
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    /**
+     * @brief Records one sample (negative values count as zero)
+     */
+    void record(std::chrono::microseconds latency);
+
+    /**
+     * @brief Adds all samples of another histogram
+     */
+    void merge(const LatencyHistogram& other);
+
+    /**
+     * @brief Value at or below which p percent of samples fall
+     * @param p Percentile in [0, 100]
+     * @return Upper bound of the bucket holding the percentile (0 if empty)
+     */
+    std::chrono::microseconds percentile(double p) const;
+
+    std::uint64_t count() const { return count_; }
+    std::chrono::microseconds min() const;
+    std::chrono::microseconds max() const { return std::chrono::microseconds(max_); }
+    std::chrono::microseconds mean() const;
+
+private:
+    static std::size_t bucket_index(std::uint64_t value);
+    static std::uint64_t bucket_upper_bound(std::size_t index);
+
+    std::vector<std::uint64_t> buckets_;
+    std::uint64_t count_;
+    std::uint64_t min_;
+    std::uint64_t max_;
+    long double sum_;
+};
+
+/**
+ * @brief How the load generator issues requests
+ */
+enum class LoadMode {
+    OPEN_LOOP,   ///< Fixed arrival rate regardless of response times (AsyncHttpClient)
+    CLOSED_LOOP  ///< Fixed number of workers, each sending its next request on completion (HttpClient)
+};
+
+/**
+ * @brief Load test parameters
+ */
+struct LoadConfig {
+    std::vector<std::string> urls;             ///< Targets, used round-robin
+    std::string method = "GET";
+    std::string data;                          ///< Request body for POST/PUT
+    std::vector<std::string> headers;
+    LoadMode mode = LoadMode::CLOSED_LOOP;
+    double rate = 100.0;                       ///< Open loop: requests per second
+    int concurrency = 8;                       ///< Closed loop: worker threads
+    std::chrono::milliseconds duration{10000}; ///< Time during which requests are started
+    int timeout_seconds = 10;                  ///< Per-attempt timeout
+    int max_retries = 0;                       ///< Client retries (0 measures raw attempts)
+    std::string record_path;                   ///< Closed loop: record exchanges to this file
+    std::string replay_path;                   ///< Closed loop: serve responses from this recording
+    ReplayTiming replay_timing = ReplayTiming::FULL_SPEED;
+};
+
+/**
+ * @brief Load test results
+ */
+struct LoadReport {
+    LatencyHistogram latency;                  ///< All completed requests, failures included
+    std::uint64_t successes = 0;
+    std::uint64_t failures = 0;
+    std::map<std::string, std::uint64_t> errors; ///< Failure count per error message
+    std::chrono::duration<double> elapsed{0};  ///< First send to last completion
+    AllocationProfile allocations;             ///< Closed loop: heap use of make_request() (needs the allocation hook)
+
+    /**
+     * @brief Adds another report's counts and samples (elapsed is not summed)
+     */
+    void merge(const LoadReport& other);
+
+    /**
+     * @brief Completed requests per second
+     */
+    double throughput() const;
+};
+
+/**
+ * @brief Runs an open-loop test: requests are started on a fixed schedule
+ *
+ * Latency is measured from each request's intended send time rather than
+ * the time it was actually issued, so stalls in the client or the server
+ * show up in the percentiles instead of silently lowering the offered load
+ * (coordinated omission correction).
+ */
+LoadReport run_open_loop(const LoadConfig& config);
+
+/**
+ * @brief Runs a closed-loop test: config.concurrency threads, each with its own HttpClient
+ *
+ * With replay_path set no network is used, which makes runs repeatable for
+ * regression checks; record_path captures a run for later replay. Each
+ * make_request() runs in an AllocationScope, so builds with the allocation
+ * hook (http_loadgen_alloc) also report heap use per request and phase.
+ */
+LoadReport run_closed_loop(const LoadConfig& config);
+
+/**
+ * @brief Runs the test selected by config.mode
+ * @throws std::invalid_argument if no URLs are given, rate/concurrency is not positive,
+ *         or recording/replay is requested in open-loop mode
+ */
+LoadReport run_load(const LoadConfig& config);
+
+/**
+ * @brief Writes throughput, error counts and latency percentiles, and per-request allocations if counted
+ */
+void print_report(const LoadConfig& config, const LoadReport& report, std::ostream& out);
+
+#endif // LOAD_GENERATOR_H
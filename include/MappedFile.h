@@ -0,0 +1,39 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief Read-only memory mapping of a whole file
+ */
+class MappedFile {
+public:
+    /**
+     * @brief Maps the file at path
+     * @throws std::runtime_error if it cannot be opened or mapped
+     */
+    explicit MappedFile(const std::string& path);
+
+    /**
+     * @brief Maps an already open regular file (the descriptor is not closed)
+     * @throws std::runtime_error if it cannot be mapped
+     */
+    explicit MappedFile(int fd);
+
+    ~MappedFile();
+
+    const char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+private:
+    void map(int fd, const std::string& name);
+
+    const char* data_;
+    std::size_t size_;
+};
+
+#endif // MAPPED_FILE_H
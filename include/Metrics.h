@@ -0,0 +1,145 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Counters maintained by HttpClient
+ */
+enum class Metric : std::size_t {
+    REQUESTS,             ///< make_request()/download() calls
+    SUCCESSES,            ///< Calls that returned a 2xx response
+    FAILURES,             ///< Calls that gave up
+    ATTEMPTS,             ///< Transfers performed
+    RETRIES,              ///< Attempts after the first
+    TRANSPORT_ERRORS,     ///< Attempts that failed below HTTP (cURL errors)
+    CACHE_HITS,           ///< GETs answered from the response cache
+    BYTES_SENT,           ///< Request body bytes (known sizes only)
+    BYTES_RECEIVED,       ///< Response body bytes
+    BACKOFF_MICROSECONDS, ///< Time slept between attempts
+    COUNT
+};
+
+const std::size_t METRIC_COUNT = static_cast<std::size_t>(Metric::COUNT);
+
+/**
+ * @brief Counter totals at one point in time
+ */
+struct MetricsSnapshot {
+    std::array<std::uint64_t, METRIC_COUNT> counters{};
+    std::map<int, std::uint64_t> responses; ///< Responses per HTTP status code
+
+    std::uint64_t operator[](Metric metric) const { return counters[static_cast<std::size_t>(metric)]; }
+};
+
+/**
+ * @brief Process-wide client counters, sharded per thread
+ *
+ * Each thread increments its own cache-line-aligned shard with plain
+ * relaxed loads and stores, so the hot path has no locked instructions and
+ * no false sharing. snapshot() sums the live shards under a lock, plus the
+ * totals of threads that have exited.
+ */
+class HttpMetrics {
+public:
+    /**
+     * @brief Adds to a counter of the calling thread
+     */
+    static void add(Metric metric, std::uint64_t amount = 1);
+
+    /**
+     * @brief Counts one response with the given status (ignored outside 100-599)
+     */
+    static void add_response(int status_code);
+
+    /**
+     * @brief Sums all threads' counters
+     */
+    static MetricsSnapshot snapshot();
+
+    /**
+     * @brief Writes a snapshot in the Prometheus text exposition format
+     */
+    static void write_prometheus(std::ostream& out);
+
+    /**
+     * @brief write_prometheus() into a string
+     */
+    static std::string prometheus();
+
+private:
+    static const int MIN_STATUS = 100;
+    static const int STATUS_COUNT = 500; ///< 100-599
+
+    struct alignas(64) Shard {
+        std::array<std::atomic<std::uint64_t>, METRIC_COUNT> counters{};
+        std::array<std::atomic<std::uint64_t>, STATUS_COUNT> responses{};
+    };
+
+    /// Registers a thread's shard on first use and retires it at thread exit
+    struct ShardHandle {
+        ShardHandle();
+        ~ShardHandle();
+        Shard* shard;
+    };
+
+    static HttpMetrics& instance();
+    static Shard& local_shard();
+    static void increment(std::atomic<std::uint64_t>& counter, std::uint64_t amount) {
+        // Only the owning thread writes, so no read-modify-write is needed
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<Shard>> shards_; ///< Live threads
+    MetricsSnapshot retired_;                    ///< Totals of exited threads
+};
+
+/**
+ * @brief Serves HttpMetrics at http://127.0.0.1:PORT/metrics for scraping
+ *
+ * GET /profile returns the PhaseProfiler report while profiling is enabled.
+ * One background thread answers requests one at a time; it is meant for a
+ * local Prometheus agent or curl, not for untrusted clients.
+ */
+class MetricsServer {
+public:
+    /**
+     * @brief Starts listening on the loopback interface
+     * @param port TCP port (0 picks a free one)
+     * @throws std::runtime_error if the socket cannot be bound
+     */
+    explicit MetricsServer(std::uint16_t port = 0);
+    ~MetricsServer();
+
+    std::uint16_t port() const { return port_; }
+
+    /**
+     * @brief URL of the metrics page
+     */
+    std::string url() const;
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+private:
+    void serve();
+    void respond(int fd);
+
+    int listen_fd_;
+    int wake_fd_;
+    std::uint16_t port_;
+    std::thread thread_;
+};
+
+#endif // METRICS_H
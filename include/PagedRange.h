@@ -0,0 +1,161 @@
+#ifndef PAGED_RANGE_H
+#define PAGED_RANGE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "HttpClient.h"
+#include "HttpUtils.h"
+#include "RequestOptions.h"
+
+/**
+ * @brief How a list endpoint hands out its pages
+ */
+enum class PageStyle {
+    OFFSET, ///< ?_start=N&_limit=M; the first short or failed page is the last
+    CURSOR, ///< ?cursor=C, with the next cursor read from each response body
+    LINK    ///< Follows the Link: <url>; rel="next" response header
+};
+
+/**
+ * @brief Paginated listing parameters
+ */
+struct PageConfig {
+    std::string url;                          ///< First page; may carry its own query
+    PageStyle style = PageStyle::OFFSET;
+    std::size_t page_size = 20;               ///< OFFSET: items asked for per page
+    std::string offset_param = "_start";      ///< OFFSET: query parameter of the first item
+    std::string limit_param = "_limit";       ///< OFFSET: query parameter of the page size
+    std::string items_field;                  ///< Body member holding the items (empty: the body is the array)
+    std::string cursor_param = "cursor";      ///< CURSOR: query parameter carrying the cursor
+    std::string cursor_field = "next_cursor"; ///< CURSOR: body member with the next cursor (missing, null or "": last page)
+    int prefetch = 2;                         ///< Pages fetched ahead of the one being consumed
+    std::vector<std::string> headers;         ///< Extra headers sent with every page
+    int timeout_seconds = DEFAULT_TIMEOUT_SECONDS;
+    int max_retries = MAX_RETRIES;
+};
+
+/**
+ * @brief One page of a listing
+ */
+struct Page {
+    std::size_t index = 0;  ///< 0-based position in the listing
+    std::string url;        ///< URL the page was fetched from
+    std::size_t items = 0;  ///< Items on the page (0 if it failed)
+    HttpResponse response;  ///< Fetch result; on failure the listing ends with this page
+};
+
+/**
+ * @brief Lazy range over the pages of a list endpoint, prefetching ahead of the caller
+ *
+ * Nothing is fetched until the first next() (or begin()). From then on up to
+ * config.prefetch pages past the one the caller holds are fetched in the
+ * background, each worker thread with its own HttpClient, so a scan of a
+ * whole collection costs about one round trip per prefetch pages instead of
+ * one per page. Pages are always handed out in order.
+ *
+ * OFFSET pages are independent and are fetched concurrently; a short page
+ * ends the listing, and pages already requested past it are discarded.
+ * CURSOR and LINK pages each name the next one, so they are fetched one at a
+ * time, ahead of the caller but not in parallel.
+ *
+ * A failed page (transport error, HTTP error or a body that is not the
+ * expected JSON) is handed out and ends the listing. Destroying the range
+ * early cancels in-flight fetches.
+ *
+ * @code
+ * PageConfig config;
+ * config.url = "https://api.example.com/posts";
+ * for (const Page& page : PagedRange(config)) {
+ *     process(page.response.body);
+ * }
+ * @endcode
+ */
+class PagedRange {
+public:
+    /**
+     * @brief Input iterator over the pages; advancing may block for the next page
+     */
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Page;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Page*;
+        using reference = const Page&;
+
+        iterator() = default;
+
+        reference operator*() const { return page_; }
+        pointer operator->() const { return &page_; }
+        iterator& operator++();
+        void operator++(int) { ++*this; }
+
+        bool operator==(const iterator& other) const { return range_ == other.range_; }
+        bool operator!=(const iterator& other) const { return range_ != other.range_; }
+
+    private:
+        friend class PagedRange;
+        explicit iterator(PagedRange* range);
+
+        PagedRange* range_ = nullptr; ///< nullptr once past the last page
+        Page page_;
+    };
+
+    /**
+     * @throws std::invalid_argument if the URL is empty, prefetch is not positive,
+     *         or an OFFSET page size or parameter is missing
+     */
+    explicit PagedRange(PageConfig config);
+    ~PagedRange();
+
+    /**
+     * @brief Moves the next page into `page`, waiting for it if needed
+     * @return false once the listing is exhausted
+     */
+    bool next(Page& page);
+
+    /**
+     * @brief Starts iteration; a range can be iterated once
+     */
+    iterator begin() { return iterator(this); }
+    iterator end() { return iterator(); }
+
+    /**
+     * @brief Target of the rel="next" entry of a Link header, resolved against the request URL
+     * @return Empty if the header has no next link
+     */
+    static std::string next_link(const std::string& link_header, const std::string& request_url);
+
+    PagedRange(const PagedRange&) = delete;
+    PagedRange& operator=(const PagedRange&) = delete;
+
+private:
+    void start();
+    void offset_worker();
+    void sequential_worker();
+    Page fetch(HttpClient& client, std::size_t index, const std::string& url, std::string* next_url);
+    void publish(Page page, bool last);
+
+    PageConfig config_;
+    RequestOptions options_;
+    CancellationSource cancel_;
+
+    std::mutex mutex_;
+    std::condition_variable ready_cv_; ///< A page arrived or the listing ended
+    std::condition_variable space_cv_; ///< The caller took a page or the range is closing
+    std::map<std::size_t, Page> ready_;
+    std::size_t consumed_ = 0;   ///< Index of the next page handed out
+    std::size_t next_fetch_ = 0; ///< OFFSET: next page index to claim
+    std::size_t end_;            ///< One past the last page, once known
+    bool started_ = false;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+};
+
+#endif // PAGED_RANGE_H
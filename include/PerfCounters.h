@@ -0,0 +1,230 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/**
+ * @brief Hardware and software events counted by PerfCounters
+ */
+enum class PerfEvent : std::size_t {
+    CYCLES,           ///< CPU cycles
+    INSTRUCTIONS,     ///< Instructions retired
+    CACHE_MISSES,     ///< Last-level cache misses
+    CONTEXT_SWITCHES, ///< Times the thread was switched out
+    COUNT
+};
+
+const std::size_t PERF_EVENT_COUNT = static_cast<std::size_t>(PerfEvent::COUNT);
+
+/**
+ * @brief Short name of an event ("cycles", "instructions", ...)
+ */
+const char* perf_event_name(PerfEvent event);
+
+/**
+ * @brief Counter values at one point in time (0 for unavailable events)
+ */
+struct PerfSample {
+    std::array<std::uint64_t, PERF_EVENT_COUNT> values{};
+
+    std::uint64_t operator[](PerfEvent event) const { return values[static_cast<std::size_t>(event)]; }
+};
+
+/**
+ * @brief perf_event_open counters of the calling thread
+ *
+ * The events form one group, so read() is a single system call and all
+ * values cover the same interval; when the PMU multiplexes the group the
+ * values are scaled by its enabled/running time. Events the kernel refuses
+ * (no PMU in a VM or container, seccomp, perf_event_paranoid) are left
+ * unavailable and read as 0, and kernel-mode counting is dropped when only
+ * user-mode counting is permitted.
+ */
+class PerfCounters {
+public:
+    /**
+     * @brief Opens and starts every event the kernel allows for the calling thread
+     */
+    PerfCounters();
+    ~PerfCounters();
+
+    bool available(PerfEvent event) const { return slots_[static_cast<std::size_t>(event)] >= 0; }
+
+    /**
+     * @brief Whether at least one event could be opened
+     */
+    bool any_available() const { return leader_fd_ >= 0; }
+
+    /**
+     * @brief Whether kernel-mode activity is excluded from the counts
+     */
+    bool user_only() const { return user_only_; }
+
+    /**
+     * @brief errno of the last event the kernel refused (0: none)
+     */
+    int error() const { return error_; }
+
+    /**
+     * @brief Current totals since construction
+     */
+    PerfSample read() const;
+
+    /**
+     * @brief Counters of the calling thread, opened on first use
+     */
+    static PerfCounters& thread_instance();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+private:
+    int leader_fd_;
+    std::array<int, PERF_EVENT_COUNT> fds_;
+    std::array<int, PERF_EVENT_COUNT> slots_; ///< Position in the group read (-1: unavailable)
+    std::size_t opened_;
+    bool user_only_;
+    int error_;
+};
+
+/**
+ * @brief Parts of a request that PhaseScope attributes cost to
+ */
+enum class RequestPhase : std::size_t {
+    SETUP,   ///< Handle reset, header list and option setup
+    PERFORM, ///< curl_easy_perform: connecting, sending, receiving and the write callbacks
+    PARSE,   ///< Reading status, timings and headers back from the handle
+    LOGGING, ///< Formatting and writing the client's log messages
+    COUNT
+};
+
+const std::size_t REQUEST_PHASE_COUNT = static_cast<std::size_t>(RequestPhase::COUNT);
+
+/**
+ * @brief Short name of a phase ("setup", "perform", ...)
+ */
+const char* request_phase_name(RequestPhase phase);
+
+/**
+ * @brief Totals of one phase
+ */
+struct PhaseStats {
+    std::uint64_t calls = 0;
+    std::uint64_t wall_ns = 0;
+    PerfSample counters;
+};
+
+/**
+ * @brief PhaseProfiler totals at one point in time
+ */
+struct PhaseProfile {
+    std::array<PhaseStats, REQUEST_PHASE_COUNT> phases;
+    std::array<bool, PERF_EVENT_COUNT> available{}; ///< Events the calling thread could open
+
+    const PhaseStats& operator[](RequestPhase phase) const { return phases[static_cast<std::size_t>(phase)]; }
+};
+
+/**
+ * @brief Opt-in, process-wide per-phase cost of HttpClient requests
+ *
+ * Off by default: a disabled PhaseScope costs one relaxed load. Enabled,
+ * every scope reads the thread's PerfCounters on entry and exit (two
+ * system calls) and adds the difference and its wall time to the phase.
+ * Phases are recorded by CurlTransport and by HttpClient's logging, so
+ * replayed or mocked transports only contribute logging.
+ */
+class PhaseProfiler {
+public:
+    /**
+     * @brief Starts or stops recording; totals are kept until reset()
+     */
+    static void enable(bool on = true) { enabled_.store(on, std::memory_order_relaxed); }
+
+    static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Adds one measured interval to a phase
+     */
+    static void add(RequestPhase phase, std::chrono::nanoseconds wall, const PerfSample& counters);
+
+    /**
+     * @brief Totals of every phase
+     */
+    static PhaseProfile snapshot();
+
+    /**
+     * @brief Clears all totals
+     */
+    static void reset();
+
+    /**
+     * @brief Writes per-call averages of every phase as a table
+     */
+    static void write_report(std::ostream& out);
+
+    /**
+     * @brief write_report() into a string
+     */
+    static std::string report();
+
+private:
+    struct Totals {
+        std::atomic<std::uint64_t> calls{0};
+        std::atomic<std::uint64_t> wall_ns{0};
+        std::array<std::atomic<std::uint64_t>, PERF_EVENT_COUNT> counters{};
+    };
+
+    static inline std::atomic<bool> enabled_{false};
+    static std::array<Totals, REQUEST_PHASE_COUNT>& totals();
+};
+
+/**
+ * @brief Attributes the counters and wall time of its lifetime to a phase
+ *
+ * Scopes also mark the calling thread's current phase, which
+ * AllocationTracker uses whether or not PhaseProfiler is enabled.
+ */
+class PhaseScope {
+public:
+    explicit PhaseScope(RequestPhase phase)
+        : phase_(phase), previous_(current_), active_(PhaseProfiler::enabled()) {
+        current_ = phase;
+        if (active_) {
+            start();
+        }
+    }
+    ~PhaseScope() {
+        if (active_) {
+            stop();
+        }
+        current_ = previous_;
+    }
+
+    /**
+     * @brief Phase of the innermost scope open on the calling thread (RequestPhase::COUNT: none)
+     */
+    static RequestPhase current() { return current_; }
+
+    PhaseScope(const PhaseScope&) = delete;
+    PhaseScope& operator=(const PhaseScope&) = delete;
+
+private:
+    void start();
+    void stop();
+
+    static inline thread_local RequestPhase current_ = RequestPhase::COUNT;
+
+    RequestPhase phase_;
+    RequestPhase previous_;
+    bool active_;
+    PerfSample begin_;
+    std::chrono::steady_clock::time_point started_;
+};
+
+#endif // PERF_COUNTERS_H
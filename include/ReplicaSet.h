@@ -0,0 +1,199 @@
+#ifndef REPLICA_SET_H
+#define REPLICA_SET_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+#include "HttpTransport.h"
+
+/**
+ * @brief Load-balancing and outlier-ejection parameters for a ReplicaSet
+ */
+struct ReplicaConfig {
+    std::chrono::milliseconds decay{10000};             ///< EWMA time constant: older samples fade over this span
+    std::chrono::milliseconds initial_latency{0};       ///< Latency assumed before the first response (0: try new replicas first)
+    std::chrono::milliseconds failure_penalty{1000};    ///< Latency sample recorded for a retryable failure
+    int consecutive_failures = 5;                       ///< Retryable failures in a row that eject a replica
+    std::chrono::milliseconds base_ejection{30000};     ///< First ejection; doubles with each repeat
+    std::chrono::milliseconds max_ejection{300000};     ///< Cap on the ejection time
+    double max_ejected_fraction = 0.5;                  ///< Never eject more than this share of replicas
+};
+
+/**
+ * @brief Health and load of one replica, as seen by this process
+ */
+struct ReplicaStats {
+    std::string endpoint;
+    double latency_ms = 0;       ///< Peak-sensitive EWMA of response time
+    std::size_t in_flight = 0;   ///< Attempts currently using the replica
+    std::uint64_t requests = 0;  ///< Attempts completed
+    std::uint64_t failures = 0;  ///< Attempts that ended in a retryable error
+    bool ejected = false;
+};
+
+/**
+ * @brief Equivalent upstream endpoints with client-side load balancing
+ *
+ * acquire() uses power-of-two-choices: it samples two replicas at random
+ * and takes the one with the lower cost, latency EWMA × (in-flight + 1).
+ * That spreads load almost as evenly as comparing every replica, without
+ * herding all clients onto the single fastest one. The EWMA weighs samples
+ * by age rather than count and jumps straight up to a slower sample, so a
+ * replica that turns slow is avoided at once; while a replica gets no
+ * traffic its estimate fades toward zero, so it is probed again later.
+ *
+ * Attempts that fail with an error HttpClient would retry (see
+ * is_retryable_error() and is_retryable_curl_error()) count against the
+ * replica; after consecutive_failures of them in a row it is ejected from
+ * selection for base_ejection, doubling on each repeat ejection. Other
+ * responses, including 4xx, count as healthy. At most max_ejected_fraction
+ * of the replicas are ejected at once, so a fault shared by every replica
+ * does not empty the set.
+ *
+ * Thread-safe; one set may be shared by any number of clients.
+ */
+class ReplicaSet {
+public:
+    /**
+     * @brief One attempt's claim on a replica; counts as in flight until completed
+     *
+     * A lease dropped without complete() (e.g. the transport threw) is
+     * released without affecting the replica's statistics.
+     */
+    class Lease {
+    public:
+        Lease() : set_(nullptr), index_(0) {}
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+        ~Lease();
+
+        /**
+         * @brief Base URL of the chosen replica, e.g. "http://10.0.0.7:8080"
+         */
+        const std::string& endpoint() const;
+
+        std::size_t index() const { return index_; }
+
+        /**
+         * @brief Records the attempt's outcome and releases the replica
+         * @param latency Time the attempt took
+         * @param failed Whether it ended in a retryable error
+         */
+        void complete(std::chrono::microseconds latency, bool failed);
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+    private:
+        friend class ReplicaSet;
+        Lease(ReplicaSet* set, std::size_t index) : set_(set), index_(index) {}
+
+        ReplicaSet* set_;
+        std::size_t index_;
+    };
+
+    /**
+     * @param endpoints Base URLs ("scheme://host[:port]"); a trailing '/' is ignored
+     * @throws std::invalid_argument if endpoints is empty, an endpoint has no scheme,
+     *         or the config is out of range
+     */
+    explicit ReplicaSet(std::vector<std::string> endpoints, ReplicaConfig config = ReplicaConfig());
+
+    /**
+     * @brief Picks a replica for one attempt
+     */
+    Lease acquire();
+
+    /**
+     * @brief Current view of every replica, in endpoint order
+     */
+    std::vector<ReplicaStats> stats() const;
+
+    std::size_t size() const { return replicas_.size(); }
+
+    /**
+     * @brief Points a URL at an endpoint
+     *
+     * A URL starting with '/' is appended to the endpoint; otherwise its
+     * scheme and authority are replaced, keeping path and query.
+     */
+    static std::string resolve(const std::string& url, const std::string& endpoint);
+
+    ReplicaSet(const ReplicaSet&) = delete;
+    ReplicaSet& operator=(const ReplicaSet&) = delete;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Replica {
+        std::string endpoint;
+        double latency_us = 0;
+        Clock::time_point updated;      ///< When latency_us was last updated
+        std::size_t in_flight = 0;
+        std::uint64_t requests = 0;
+        std::uint64_t failures = 0;
+        int failure_streak = 0;
+        int ejections = 0;              ///< Consecutive ejections, for the doubling
+        Clock::time_point ejected_until;
+    };
+
+    /// Selection cost at now; lower is better
+    double cost(const Replica& replica, Clock::time_point now) const;
+
+    void release(std::size_t index, std::chrono::microseconds latency, bool failed, bool record);
+
+    ReplicaConfig config_;
+    mutable std::mutex mutex_;
+    std::vector<Replica> replicas_;
+    std::mt19937_64 random_;
+    std::vector<std::size_t> candidates_; ///< Scratch for acquire()
+};
+
+/**
+ * @brief Sends every attempt to a replica chosen by a ReplicaSet
+ *
+ * Wraps the transport that does the real work; the request URL's scheme and
+ * authority are replaced by the chosen replica's (a URL may also be just a
+ * path). Because HttpClient calls the transport once per attempt, a retry
+ * picks again and usually lands on another replica.
+ */
+class BalancedTransport : public HttpTransport {
+public:
+    /**
+     * @param inner Transport doing the real work (owned by this client only)
+     * @param replicas Replica set, may be shared by many clients
+     */
+    BalancedTransport(std::shared_ptr<HttpTransport> inner, std::shared_ptr<ReplicaSet> replicas);
+
+    TransportResult perform(const std::string& url,
+                            const std::string& method,
+                            const std::string& data,
+                            const std::vector<std::string>& headers,
+                            const RequestOptions& options) override;
+
+    TransportResult perform_streaming(const std::string& url,
+                                      const std::string& method,
+                                      RequestBodySource& body,
+                                      const std::vector<std::string>& headers,
+                                      const RequestOptions& options) override;
+
+    TransportResult perform_download(const std::string& url,
+                                     ResponseSink& sink,
+                                     const std::vector<std::string>& headers,
+                                     const RequestOptions& options) override;
+
+private:
+    /// Runs one attempt against a leased replica and reports how it went
+    template <typename Perform>
+    TransportResult balanced(const std::string& url, const RequestOptions& options, Perform perform);
+
+    std::shared_ptr<HttpTransport> inner_;
+    std::shared_ptr<ReplicaSet> replicas_;
+};
+
+#endif // REPLICA_SET_H
@@ -0,0 +1,118 @@
+#ifndef REQUEST_BODY_H
+#define REQUEST_BODY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include "MappedFile.h"
+
+/**
+ * @brief Request body produced piecewise while it is being sent
+ *
+ * HttpClient pulls data through CURLOPT_READFUNCTION, so only one transfer
+ * buffer is in memory at a time; sources whose body is already in memory
+ * are sent from it directly. Bodies of unknown size go out with chunked
+ * transfer encoding.
+ */
+class RequestBodySource {
+public:
+    virtual ~RequestBodySource() = default;
+
+    /**
+     * @brief Total body size in bytes, or -1 if unknown until the end
+     */
+    virtual std::int64_t size() const = 0;
+
+    /**
+     * @brief Copies the next bytes of the body
+     * @param buffer Destination
+     * @param capacity Bytes available in buffer
+     * @return Bytes copied; 0 at the end of the body
+     */
+    virtual std::size_t read(char* buffer, std::size_t capacity) = 0;
+
+    /**
+     * @brief Restarts the body from the beginning (before a retry)
+     * @return false if the body cannot be produced again
+     */
+    virtual bool rewind() = 0;
+
+    /**
+     * @brief The whole body if it is already in memory, else nullptr
+     *
+     * cURL then sends straight from this memory instead of copying the body
+     * through the read callback.
+     */
+    virtual const char* contiguous() const { return nullptr; }
+};
+
+/**
+ * @brief Body from an in-memory string
+ */
+class BufferBodySource : public RequestBodySource {
+public:
+    explicit BufferBodySource(std::string data) : data_(std::move(data)), offset_(0) {}
+
+    std::int64_t size() const override { return static_cast<std::int64_t>(data_.size()); }
+    std::size_t read(char* buffer, std::size_t capacity) override;
+    bool rewind() override;
+    const char* contiguous() const override { return data_.data(); }
+
+private:
+    std::string data_;
+    std::size_t offset_;
+};
+
+/**
+ * @brief Body from a memory-mapped file; pages are read in as they are sent
+ *
+ * CurlTransport sends directly from the mapping, so the file is never
+ * copied into a user-space buffer.
+ */
+class FileBodySource : public RequestBodySource {
+public:
+    /**
+     * @throws std::runtime_error if the file cannot be opened or mapped
+     */
+    explicit FileBodySource(const std::string& path);
+
+    std::int64_t size() const override { return static_cast<std::int64_t>(file_.size()); }
+    std::size_t read(char* buffer, std::size_t capacity) override;
+    bool rewind() override;
+    const char* contiguous() const override { return file_.data(); }
+
+private:
+    MappedFile file_;
+    std::size_t offset_;
+};
+
+/**
+ * @brief Body produced by a callback as the transfer needs it (size unknown, sent chunked)
+ */
+class GeneratorBodySource : public RequestBodySource {
+public:
+    /**
+     * @brief Fills up to capacity bytes of buffer and returns the count; 0 ends the body
+     */
+    using Generator = std::function<std::size_t(char* buffer, std::size_t capacity)>;
+
+    /**
+     * @param generator Called repeatedly until it returns 0
+     * @param restart Called by rewind() to start the body over; without it the body cannot be retried
+     */
+    explicit GeneratorBodySource(Generator generator, std::function<void()> restart = nullptr)
+        : generator_(std::move(generator)), restart_(std::move(restart)), finished_(false) {}
+
+    std::int64_t size() const override { return -1; }
+    std::size_t read(char* buffer, std::size_t capacity) override;
+    bool rewind() override;
+
+private:
+    Generator generator_;
+    std::function<void()> restart_;
+    bool finished_;
+};
+
+#endif // REQUEST_BODY_H
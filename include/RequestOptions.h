@@ -0,0 +1,152 @@
+#ifndef REQUEST_OPTIONS_H
+#define REQUEST_OPTIONS_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+/**
+ * @brief Absolute point in time by which a request, including all retries, must finish
+ *
+ * A default-constructed Deadline is unbounded.
+ */
+class Deadline {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    Deadline() : at_(Clock::time_point::max()) {}
+
+    /**
+     * @brief Deadline a fixed budget from now
+     */
+    static Deadline after(std::chrono::milliseconds budget) { return Deadline(Clock::now() + budget); }
+
+    /**
+     * @brief Deadline at an absolute time point, e.g. propagated from an upstream caller
+     */
+    static Deadline at(Clock::time_point when) { return Deadline(when); }
+
+    bool is_set() const { return at_ != Clock::time_point::max(); }
+    bool expired() const { return is_set() && Clock::now() >= at_; }
+    Clock::time_point time_point() const { return at_; }
+
+    /**
+     * @brief Time left before the deadline (zero once expired, max() if unbounded)
+     */
+    std::chrono::milliseconds remaining() const;
+
+private:
+    explicit Deadline(Clock::time_point at) : at_(at) {}
+
+    Clock::time_point at_;
+};
+
+namespace detail {
+struct CancellationState;
+}
+
+/**
+ * @brief Read side of a cancellation signal; cheap to copy
+ *
+ * A default-constructed token can never be cancelled and costs nothing to check.
+ */
+class CancellationToken {
+public:
+    using SubscriptionId = std::uint64_t;
+
+    CancellationToken() = default;
+
+    /**
+     * @brief Whether this token is connected to a CancellationSource
+     */
+    bool can_be_cancelled() const { return static_cast<bool>(state_); }
+
+    /**
+     * @brief Thread-safe check of the cancellation flag
+     */
+    bool is_cancelled() const;
+
+    /**
+     * @brief Blocks for up to `duration`, returning early if the token is cancelled
+     * @return true if cancelled
+     */
+    bool wait_for(std::chrono::milliseconds duration) const;
+
+    /**
+     * @brief Registers a callback run (on the cancelling thread) when cancel() is called
+     *
+     * Runs immediately if already cancelled.
+     * @return Id for unsubscribe(); 0 if the token can never be cancelled
+     */
+    SubscriptionId subscribe(std::function<void()> callback) const;
+
+    /**
+     * @brief Removes a callback registered with subscribe()
+     *
+     * If cancel() is running the callback on another thread, waits for it to
+     * return; afterwards the callback is guaranteed not to run.
+     */
+    void unsubscribe(SubscriptionId id) const;
+
+private:
+    friend class CancellationSource;
+    explicit CancellationToken(std::shared_ptr<detail::CancellationState> state) : state_(std::move(state)) {}
+
+    std::shared_ptr<detail::CancellationState> state_;
+};
+
+/**
+ * @brief Write side of a cancellation signal
+ *
+ * @code
+ * CancellationSource source;
+ * RequestOptions options;
+ * options.cancellation = source.token();
+ * // another thread: source.cancel(); aborts the in-flight transfer
+ * @endcode
+ */
+class CancellationSource {
+public:
+    CancellationSource();
+
+    CancellationToken token() const { return CancellationToken(state_); }
+
+    /**
+     * @brief Thread-safe: cancels every request holding this source's token
+     */
+    void cancel();
+
+    bool is_cancelled() const;
+
+private:
+    std::shared_ptr<detail::CancellationState> state_;
+};
+
+/**
+ * @brief Scheduling class of a request when a RequestScheduler is attached
+ */
+enum class RequestPriority {
+    Interactive = 0, ///< Latency-sensitive; may also use the reserved slots
+    Normal = 1,
+    Bulk = 2         ///< Batch work; yields to the other classes under contention
+};
+
+/**
+ * @brief Per-request options that are not part of the HTTP message itself
+ */
+struct RequestOptions {
+    Deadline deadline;               ///< Bounds total time across attempts and backoff
+    CancellationToken cancellation;  ///< Aborts the request, including an in-flight transfer
+    RequestPriority priority = RequestPriority::Normal; ///< Admission class (see RequestScheduler)
+    std::string unix_socket;         ///< Connect over this Unix domain socket instead of TCP ("@name": abstract)
+};
+
+/**
+ * @brief Checks whether a request may (still) proceed
+ * @return nullptr if it may, otherwise the error message to report
+ */
+const char* request_budget_error(const RequestOptions& options);
+
+#endif // REQUEST_OPTIONS_H
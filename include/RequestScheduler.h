@@ -0,0 +1,269 @@
+#ifndef REQUEST_SCHEDULER_H
+#define REQUEST_SCHEDULER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "RequestOptions.h"
+
+/**
+ * @brief Admission limits and class weights for a RequestScheduler
+ */
+struct SchedulerConfig {
+    std::size_t max_in_flight = 32;        ///< Requests admitted at once across all hosts
+    std::size_t max_per_host = 6;          ///< Requests admitted at once per scheme://host:port (ceiling if adaptive)
+    std::size_t reserved_interactive = 2;  ///< Slots of max_in_flight only Interactive may use
+    unsigned weights[3] = {16, 4, 1};      ///< Share of slots per RequestPriority under contention
+    bool adaptive_per_host = false;        ///< Learn each host's limit from response times (AdaptiveLimit)
+    std::size_t min_per_host = 1;          ///< Floor of an adaptive per-host limit
+    std::size_t initial_per_host = 4;      ///< Adaptive per-host limit before any response
+    std::size_t max_queued_per_host = 0;   ///< Requests that may wait per host before new ones are shed (0: unbounded)
+};
+
+/**
+ * @brief What a finished attempt says about the upstream's load
+ */
+enum class AttemptOutcome {
+    COMPLETED,   ///< A response arrived; its round trip is a latency sample
+    OVERLOADED,  ///< Timed out or was refused for load (429, 503)
+    IGNORED      ///< No signal (connection refused, cancelled, out of budget, ...)
+};
+
+/**
+ * @brief Concurrency limit learned from round-trip times (TCP Vegas applied to requests)
+ *
+ * The smallest round trip seen is taken as the no-load latency. With limit
+ * requests in flight at latency rtt, about limit × (1 − no_load / rtt) of
+ * them are waiting in the upstream's queues rather than being served. The
+ * limit grows while that estimated queue is short, holds while it is
+ * between alpha and beta, and shrinks once it is longer, so concurrency
+ * settles where the upstream is busy but latency stays near the no-load
+ * minimum. Thresholds scale with log10(limit). Timeouts and explicit
+ * overload responses cut the limit by 10% at once.
+ *
+ * The no-load latency is forgotten every 30 × limit samples so a change in
+ * the upstream's baseline (e.g. a failover to a farther region) is learned
+ * again. Samples taken while fewer than half the slots are used do not raise
+ * the limit: they show the caller is idle, not that the upstream has room.
+ *
+ * Not thread-safe; RequestScheduler guards it with its own lock.
+ */
+class AdaptiveLimit {
+public:
+    /**
+     * @param initial Limit before the first sample
+     * @param min Lowest limit (at least 1)
+     * @param max Highest limit
+     */
+    AdaptiveLimit(std::size_t initial, std::size_t min, std::size_t max);
+
+    std::size_t limit() const { return static_cast<std::size_t>(limit_); }
+
+    /**
+     * @brief Records one completed attempt
+     * @param rtt Time from admission to response
+     * @param in_flight Attempts in flight to the upstream when it completed, itself included
+     */
+    void on_sample(std::chrono::microseconds rtt, std::size_t in_flight);
+
+    /**
+     * @brief Records a timeout or overload response
+     */
+    void on_overload();
+
+    /**
+     * @brief Current no-load latency estimate (0 before the first sample)
+     */
+    std::chrono::microseconds min_rtt() const { return std::chrono::microseconds(min_rtt_us_); }
+
+private:
+    void clamp();
+
+    double limit_;
+    double min_;
+    double max_;
+    std::int64_t min_rtt_us_;           ///< 0 while unknown
+    std::uint64_t samples_;             ///< Since the no-load latency was last reset
+};
+
+/**
+ * @brief Admission control for outbound requests: priority classes with weighted fair queuing
+ *
+ * Requests are admitted while the global and per-host limits allow; beyond
+ * that they queue in one flow per (host, priority). Freed slots go to the
+ * queued request with the smallest virtual finish time (self-clocked fair
+ * queuing), where each admission advances its flow by 1 / weight. Under
+ * contention an Interactive flow therefore gets 16 slots for every Bulk one,
+ * hosts share fairly within a class, and a backlog on one host never blocks
+ * another host that still has capacity. reserved_interactive slots are never
+ * given to other classes, so interactive calls bypass a saturating batch job.
+ *
+ * Thread-safe; one scheduler may be shared by any number of HttpClient and
+ * AsyncHttpClient instances via set_scheduler().
+ *
+ * With adaptive_per_host each host's limit is an AdaptiveLimit between
+ * min_per_host and max_per_host, fed by Permit::release(); an upstream that
+ * slows down under load therefore gets fewer concurrent requests instead of
+ * a growing queue. max_queued_per_host bounds the wait behind that limit:
+ * beyond it, requests are shed at once rather than left to time out.
+ */
+class RequestScheduler {
+public:
+    using Ticket = std::uint64_t;
+    using Grant = std::function<void()>;
+
+    /// Returned by enqueue() when the host's queue is full and the request is shed
+    static constexpr Ticket REJECTED = ~Ticket(0);
+
+    /**
+     * @brief Admission slot; releases it on destruction
+     */
+    class Permit {
+    public:
+        Permit() : scheduler_(nullptr) {}
+        Permit(RequestScheduler* scheduler, std::string host)
+            : scheduler_(scheduler), host_(std::move(host)), admitted_(std::chrono::steady_clock::now()) {}
+        Permit(Permit&& other) noexcept
+            : scheduler_(other.scheduler_), host_(std::move(other.host_)), admitted_(other.admitted_) {
+            other.scheduler_ = nullptr;
+        }
+        Permit& operator=(Permit&& other) noexcept {
+            if (this != &other) {
+                release();
+                scheduler_ = other.scheduler_;
+                host_ = std::move(other.host_);
+                admitted_ = other.admitted_;
+                other.scheduler_ = nullptr;
+            }
+            return *this;
+        }
+        ~Permit() { release(); }
+
+        explicit operator bool() const { return scheduler_ != nullptr; }
+
+        /**
+         * @brief Frees the slot early (no-op if empty)
+         * @param outcome How the attempt went; the time since admission is its round trip
+         */
+        void release(AttemptOutcome outcome = AttemptOutcome::IGNORED) {
+            if (scheduler_) {
+                scheduler_->release(host_, outcome, std::chrono::duration_cast<std::chrono::microseconds>(
+                                                        std::chrono::steady_clock::now() - admitted_));
+                scheduler_ = nullptr;
+            }
+        }
+
+        Permit(const Permit&) = delete;
+        Permit& operator=(const Permit&) = delete;
+
+    private:
+        RequestScheduler* scheduler_;
+        std::string host_;
+        std::chrono::steady_clock::time_point admitted_;
+    };
+
+    explicit RequestScheduler(SchedulerConfig config = SchedulerConfig());
+
+    /**
+     * @brief Requests a slot for a request to host
+     *
+     * If a slot is free it is taken at once, 0 is returned and grant is not
+     * called. Otherwise the request is queued and grant runs exactly once when
+     * it is admitted (on the thread calling release(), outside the lock)
+     * unless withdraw() removes it first. Every admission must be matched by
+     * one release().
+     * @param host Key from host_key()
+     * @param priority Scheduling class
+     * @param grant Callback run on admission
+     * @return 0 if admitted immediately, REJECTED if shed (grant is never called),
+     *         otherwise a ticket for withdraw()
+     */
+    Ticket enqueue(const std::string& host, RequestPriority priority, Grant grant);
+
+    /**
+     * @brief Removes a queued request
+     * @return true if removed; false if it was already admitted (its grant ran or is running)
+     */
+    bool withdraw(Ticket ticket);
+
+    /**
+     * @brief Frees a slot for host and admits the next queued requests
+     */
+    void release(const std::string& host) { release(host, AttemptOutcome::IGNORED, std::chrono::microseconds(0)); }
+
+    /**
+     * @brief Frees a slot for host, feeding the attempt's outcome to the host's adaptive limit
+     * @param rtt Time from admission to completion (used for COMPLETED only)
+     */
+    void release(const std::string& host, AttemptOutcome outcome, std::chrono::microseconds rtt);
+
+    /**
+     * @brief Blocks until admitted, or until the request's deadline or cancellation
+     * @return Held permit, or an empty one if shed or if the budget ran out while queued
+     */
+    Permit acquire(const std::string& host, const RequestOptions& options);
+
+    /**
+     * @brief Scheduling key of a URL: its lower-cased scheme://host[:port]
+     */
+    static std::string host_key(const std::string& url);
+
+    /**
+     * @brief Requests admitted and not yet released
+     */
+    std::size_t in_flight() const;
+
+    /**
+     * @brief Requests waiting for a slot
+     */
+    std::size_t queued() const;
+
+    /**
+     * @brief Requests host may currently have in flight (the adaptive limit, if enabled)
+     */
+    std::size_t host_limit(const std::string& host) const;
+
+    RequestScheduler(const RequestScheduler&) = delete;
+    RequestScheduler& operator=(const RequestScheduler&) = delete;
+
+private:
+    using FlowKey = std::pair<std::string, int>; ///< (host, priority)
+
+    struct Entry {
+        Ticket ticket;
+        double finish;                  ///< Virtual finish time
+        Grant grant;
+    };
+
+    struct Flow {
+        std::deque<Entry> entries;
+        double last_finish = 0.0;       ///< Finish time of the flow's newest entry
+    };
+
+    SchedulerConfig config_;
+    mutable std::mutex mutex_;
+    std::map<FlowKey, Flow> flows_;
+    std::unordered_map<Ticket, FlowKey> queued_;        ///< Ticket -> flow, while queued
+    std::unordered_map<std::string, std::size_t> host_in_flight_;
+    std::unordered_map<std::string, std::size_t> host_queued_;     ///< Erased at 0
+    std::unordered_map<std::string, AdaptiveLimit> host_limits_;  ///< Created on first admission
+    std::size_t in_flight_;
+    double virtual_time_;               ///< Finish time of the last admitted entry
+    Ticket next_ticket_;
+
+    std::size_t limit_for(const std::string& host) const;
+    bool has_capacity(const std::string& host, int priority) const;
+    void dequeued(const std::string& host);
+    void admit(const std::string& host);
+    std::vector<Grant> admit_queued();
+};
+
+#endif // REQUEST_SCHEDULER_H
@@ -0,0 +1,98 @@
+#ifndef RESPONSE_CACHE_H
+#define RESPONSE_CACHE_H
+
+#include <chrono>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @brief A cached response body with its status and expiry time
+ */
+struct CachedResponse {
+    int status_code = 0;
+    std::string body;
+    std::chrono::system_clock::time_point expires = std::chrono::system_clock::time_point::max();
+
+    bool expired() const { return std::chrono::system_clock::now() >= expires; }
+};
+
+/**
+ * @brief Key/value store for responses, e.g. behind HttpClient::set_cache()
+ *
+ * Implementations are thread-safe and never return expired entries.
+ */
+class ResponseCache {
+public:
+    virtual ~ResponseCache() = default;
+
+    /**
+     * @brief Looks up a fresh entry
+     * @return true and fills entry on a hit
+     */
+    virtual bool get(const std::string& key, CachedResponse& entry) = 0;
+
+    /**
+     * @brief Inserts or replaces an entry
+     */
+    virtual void put(const std::string& key, const CachedResponse& entry) = 0;
+
+    /**
+     * @brief Removes an entry if present
+     */
+    virtual void erase(const std::string& key) = 0;
+};
+
+/**
+ * @brief In-process LRU cache bounded by total key and body bytes
+ */
+class MemoryCache : public ResponseCache {
+public:
+    /**
+     * @param max_bytes Least recently used entries are dropped beyond this size
+     */
+    explicit MemoryCache(std::size_t max_bytes = 64 << 20);
+
+    bool get(const std::string& key, CachedResponse& entry) override;
+    void put(const std::string& key, const CachedResponse& entry) override;
+    void erase(const std::string& key) override;
+
+    std::size_t size() const;
+    std::size_t bytes() const;
+
+private:
+    using Item = std::pair<std::string, CachedResponse>;
+
+    void remove(std::list<Item>::iterator item);
+
+    mutable std::mutex mutex_;
+    std::size_t max_bytes_;
+    std::size_t bytes_;
+    std::list<Item> items_; ///< Most recently used first
+    std::unordered_map<std::string, std::list<Item>::iterator> index_;
+};
+
+/**
+ * @brief Two-level cache: a fast front tier backed by a larger, slower one
+ *
+ * Lookups try the front first and promote back-tier hits into it; writes
+ * and erases go to both tiers, so a persistent back tier (DiskCache) keeps
+ * everything the front has seen across restarts.
+ */
+class TieredCache : public ResponseCache {
+public:
+    TieredCache(std::shared_ptr<ResponseCache> front, std::shared_ptr<ResponseCache> back);
+
+    bool get(const std::string& key, CachedResponse& entry) override;
+    void put(const std::string& key, const CachedResponse& entry) override;
+    void erase(const std::string& key) override;
+
+private:
+    std::shared_ptr<ResponseCache> front_;
+    std::shared_ptr<ResponseCache> back_;
+};
+
+#endif // RESPONSE_CACHE_H
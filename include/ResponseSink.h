@@ -0,0 +1,83 @@
+#ifndef RESPONSE_SINK_H
+#define RESPONSE_SINK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Destination for a response body written while it is received
+ *
+ * HttpClient::download() hands each block from cURL's write callback to the
+ * sink instead of appending it to HttpResponse::body. Only successful (2xx)
+ * responses reach the sink; error bodies still go to HttpResponse::body.
+ */
+class ResponseSink {
+public:
+    virtual ~ResponseSink() = default;
+
+    /**
+     * @brief Discards anything written by a previous attempt
+     */
+    virtual void reset() = 0;
+
+    /**
+     * @brief Announces the body size once Content-Length is known
+     */
+    virtual void reserve(std::uint64_t size) = 0;
+
+    /**
+     * @brief Appends the next block of the body
+     * @throws std::runtime_error if it cannot be stored (the transfer is aborted)
+     */
+    virtual void write(const char* data, std::size_t size) = 0;
+
+    /**
+     * @brief Called once after the whole body has been received
+     */
+    virtual void finish() = 0;
+};
+
+/**
+ * @brief Writes a download straight into a memory-mapped file
+ *
+ * The file is sized from Content-Length up front (and grown geometrically
+ * when the length is unknown), so each block is copied once from cURL's
+ * buffer into the page cache with no intermediate string. finish() trims
+ * the file to the bytes received.
+ */
+class MappedFileSink : public ResponseSink {
+public:
+    /**
+     * @brief Creates (truncates) the file at path
+     * @throws std::runtime_error if it cannot be opened
+     */
+    explicit MappedFileSink(const std::string& path);
+    ~MappedFileSink() override;
+
+    void reset() override;
+    void reserve(std::uint64_t size) override;
+    void write(const char* data, std::size_t size) override;
+    void finish() override;
+
+    /**
+     * @brief Bytes written so far
+     */
+    std::uint64_t size() const { return size_; }
+
+    MappedFileSink(const MappedFileSink&) = delete;
+    MappedFileSink& operator=(const MappedFileSink&) = delete;
+
+private:
+    /// Resizes the file to capacity bytes and maps all of it
+    void remap(std::size_t capacity);
+    void unmap();
+
+    std::string path_;
+    int fd_;
+    char* data_;
+    std::size_t capacity_;
+    std::size_t size_;
+};
+
+#endif // RESPONSE_SINK_H
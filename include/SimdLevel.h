@@ -0,0 +1,32 @@
+#ifndef SIMD_LEVEL_H
+#define SIMD_LEVEL_H
+
+/**
+ * @brief Instruction sets the vectorized text kernels can use
+ *
+ * Shared by the integer stream and on-demand JSON kernels, so one switch
+ * selects the code path for both.
+ */
+enum class SimdLevel {
+    SCALAR = 0,
+    SSE2 = 1,
+    AVX2 = 2
+};
+
+/**
+ * @brief Best level supported by this CPU (checked once at startup)
+ */
+SimdLevel detected_simd_level();
+
+/**
+ * @brief Level currently used by the kernels
+ */
+SimdLevel active_simd_level();
+
+/**
+ * @brief Restricts the kernels to a lower level, e.g. to compare code paths
+ * @param level Requested level; clamped to detected_simd_level()
+ */
+void set_simd_level(SimdLevel level);
+
+#endif // SIMD_LEVEL_H
@@ -0,0 +1,303 @@
+#ifndef TASK_H
+#define TASK_H
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+template <typename T = void>
+class Task;
+
+namespace detail {
+
+/**
+ * @brief Promise state shared by Task<T> and Task<void>
+ *
+ * Tasks are lazy: the body starts on the first co_await (or start()).
+ * When the body finishes, control transfers straight to the awaiting
+ * coroutine (symmetric transfer), so long await chains do not grow the stack.
+ */
+class TaskPromiseBase {
+public:
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            std::coroutine_handle<> continuation = handle.promise().continuation_;
+            return continuation ? continuation : std::noop_coroutine();
+        }
+
+        void await_resume() noexcept {}
+    };
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    FinalAwaiter final_suspend() noexcept { return {}; }
+    void unhandled_exception() noexcept { exception_ = std::current_exception(); }
+
+    void set_continuation(std::coroutine_handle<> continuation) noexcept {
+        continuation_ = continuation;
+    }
+
+protected:
+    void rethrow_if_failed() const {
+        if (exception_) {
+            std::rethrow_exception(exception_);
+        }
+    }
+
+private:
+    std::coroutine_handle<> continuation_;
+    std::exception_ptr exception_;
+};
+
+template <typename T>
+class TaskPromise : public TaskPromiseBase {
+public:
+    Task<T> get_return_object() noexcept;
+
+    template <typename U>
+    void return_value(U&& value) {
+        value_.emplace(std::forward<U>(value));
+    }
+
+    T result() {
+        rethrow_if_failed();
+        return std::move(*value_);
+    }
+
+private:
+    std::optional<T> value_;
+};
+
+template <>
+class TaskPromise<void> : public TaskPromiseBase {
+public:
+    Task<void> get_return_object() noexcept;
+    void return_void() noexcept {}
+    void result() { rethrow_if_failed(); }
+};
+
+} // namespace detail
+
+/**
+ * @brief Lazily started, move-only coroutine returning a T
+ *
+ * Usage:
+ * @code
+ * Task<HttpResponse> fetch(AsyncHttpClient& client) {
+ *     HttpResponse response = co_await client.get(url);
+ *     co_return response;
+ * }
+ * @endcode
+ *
+ * Tasks are not thread-safe; they are resumed by the executor that owns the
+ * operation they are suspended on (see AsyncHttpClient).
+ */
+template <typename T>
+class Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    Task() noexcept = default;
+    explicit Task(handle_type handle) noexcept : handle_(handle) {}
+
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle_) {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+
+    ~Task() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    /**
+     * @brief Checks whether the coroutine has run to completion
+     */
+    bool done() const noexcept { return !handle_ || handle_.done(); }
+
+    /**
+     * @brief Starts the coroutine without an awaiting continuation
+     *
+     * Used by executors (e.g. AsyncHttpClient::sync_wait); the task runs
+     * until its first suspension point.
+     */
+    void start() {
+        if (handle_ && !handle_.done()) {
+            handle_.resume();
+        }
+    }
+
+    /**
+     * @brief Returns the result of a completed task, rethrowing its exception
+     */
+    T result() { return handle_.promise().result(); }
+
+    // Awaitable interface: co_await task yields its result
+    bool await_ready() const noexcept { return done(); }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle_.promise().set_continuation(awaiting);
+        return handle_;
+    }
+
+    T await_resume() { return result(); }
+
+    /**
+     * @brief Awaitable that completes when the task does, without taking its result
+     */
+    auto when_ready() noexcept {
+        struct ReadyAwaiter {
+            handle_type handle;
+
+            bool await_ready() const noexcept { return !handle || handle.done(); }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                handle.promise().set_continuation(awaiting);
+                return handle;
+            }
+
+            void await_resume() const noexcept {}
+        };
+        return ReadyAwaiter{handle_};
+    }
+
+private:
+    handle_type handle_;
+};
+
+namespace detail {
+
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() noexcept {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() noexcept {
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+struct WhenAllLatch;
+
+/**
+ * @brief Coroutine driving one when_all child, owned by its WhenAllLatch
+ *
+ * The frame stays suspended at its final point until the latch destroys it,
+ * so a when_all torn down mid-flight never leaks children or lets them
+ * resume into a freed parent.
+ */
+struct WhenAllChild {
+    struct promise_type {
+        WhenAllLatch* latch = nullptr;
+
+        struct FinalAwaiter {
+            bool await_ready() const noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept;
+            void await_resume() const noexcept {}
+        };
+
+        WhenAllChild get_return_object() noexcept {
+            return WhenAllChild{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        FinalAwaiter final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+struct WhenAllLatch {
+    std::size_t remaining;
+    std::coroutine_handle<> waiter;
+    std::vector<std::coroutine_handle<>> children;
+
+    explicit WhenAllLatch(std::size_t count) : remaining(count) { children.reserve(count); }
+
+    ~WhenAllLatch() {
+        for (std::coroutine_handle<> child : children) {
+            child.destroy();
+        }
+    }
+
+    WhenAllLatch(const WhenAllLatch&) = delete;
+    WhenAllLatch& operator=(const WhenAllLatch&) = delete;
+
+    void start(WhenAllChild child) {
+        child.handle.promise().latch = this;
+        children.push_back(child.handle);
+        child.handle.resume();
+    }
+
+    bool await_ready() const noexcept { return remaining == 0; }
+    void await_suspend(std::coroutine_handle<> awaiting) noexcept { waiter = awaiting; }
+    void await_resume() const noexcept {}
+};
+
+// The last child to finish hands control to the waiter by symmetric
+// transfer, so the child is already suspended if the waiter destroys it.
+inline std::coroutine_handle<> WhenAllChild::promise_type::FinalAwaiter::await_suspend(
+    std::coroutine_handle<promise_type> handle) noexcept {
+    WhenAllLatch& latch = *handle.promise().latch;
+    if (--latch.remaining == 0 && latch.waiter) {
+        return latch.waiter;
+    }
+    return std::noop_coroutine();
+}
+
+template <typename T>
+WhenAllChild when_all_child(Task<T>& task) {
+    co_await task.when_ready();
+}
+
+} // namespace detail
+
+/**
+ * @brief Runs all tasks concurrently and completes when every one has finished
+ *
+ * Each task starts immediately and runs until its first suspension, so
+ * independent requests are in flight at the same time. Results are returned
+ * in the order of the input; the first failed task's exception is rethrown.
+ */
+template <typename T>
+Task<std::conditional_t<std::is_void_v<T>, void, std::vector<T>>>
+when_all(std::vector<Task<T>> tasks) {
+    detail::WhenAllLatch latch(tasks.size());
+    for (auto& task : tasks) {
+        latch.start(detail::when_all_child(task));
+    }
+    co_await latch;
+
+    if constexpr (std::is_void_v<T>) {
+        for (auto& task : tasks) {
+            task.result();
+        }
+    } else {
+        std::vector<T> results;
+        results.reserve(tasks.size());
+        for (auto& task : tasks) {
+            results.push_back(task.result());
+        }
+        co_return results;
+    }
+}
+
+#endif // TASK_H
@@ -0,0 +1,213 @@
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "HttpTransport.h"
+
+/**
+ * @brief W3C trace context of one span (https://www.w3.org/TR/trace-context/)
+ */
+struct TraceContext {
+    std::array<std::uint8_t, 16> trace_id{};
+    std::uint64_t span_id = 0;
+    bool sampled = false;
+
+    bool valid() const;
+
+    /**
+     * @brief Formats the traceparent header value, e.g. "00-4bf9...-00f0...-01"
+     */
+    std::string traceparent() const;
+
+    /**
+     * @brief Parses a traceparent header value
+     * @return false if it is malformed or has an all-zero ID
+     */
+    static bool parse(const std::string& value, TraceContext& context);
+};
+
+/**
+ * @brief One finished span, fixed-size so it can be queued without allocation
+ */
+struct SpanRecord {
+    std::array<std::uint8_t, 16> trace_id{};
+    std::uint64_t span_id = 0;
+    std::uint64_t parent_id = 0;   ///< 0 for a root span
+    const char* name = "";         ///< Static string
+    std::int64_t start_us = 0;     ///< Microseconds since the Unix epoch
+    std::int64_t duration_us = 0;
+    int status_code = 0;
+    int attempt = 0;               ///< 1-based attempt number (attempt spans)
+    int curl_code = 0;
+    TransferTimings timings;       ///< Attempt spans only
+    char method[8] = {};
+    char url[200] = {};            ///< Truncated to fit
+};
+
+/**
+ * @brief Tracing parameters
+ */
+struct TracerConfig {
+    std::string path;                                ///< Span file (appended, one Zipkin v2 JSON span per line)
+    std::string service_name = "http-client";        ///< Zipkin localEndpoint.serviceName
+    double sample_rate = 0.01;                       ///< Fraction of new traces recorded (0 to 1)
+    std::size_t buffer_spans = 4096;                 ///< Spans queued between exports (rounded up to a power of two)
+    std::chrono::milliseconds flush_interval{1000};  ///< How often the background thread exports
+};
+
+/**
+ * @brief Head-sampled span collector with a lock-free queue and a file exporter
+ *
+ * The sampling decision is made once per request (or taken from an incoming
+ * traceparent), so unsampled requests only pay for ID generation and the
+ * propagated header. Finished spans go into a bounded multi-producer queue
+ * without locks; when it is full, spans are dropped and counted rather than
+ * blocking the request. A background thread appends queued spans to the
+ * file in Zipkin v2 JSON, one span per line (wrap the lines in [] to POST
+ * them to /api/v2/spans).
+ */
+class Tracer {
+public:
+    /**
+     * @throws std::invalid_argument if the sample rate is outside [0, 1] or the buffer is empty
+     * @throws std::runtime_error if the span file cannot be opened
+     */
+    explicit Tracer(TracerConfig config);
+
+    /**
+     * @brief Stops the exporter and writes the remaining spans
+     */
+    ~Tracer();
+
+    /**
+     * @brief Starts a trace context for a new request
+     * @param parent Incoming context (nullptr: start a new trace and sample it)
+     */
+    TraceContext start(const TraceContext* parent);
+
+    /**
+     * @brief Queues a finished span; never blocks
+     * @return false if the queue was full and the span was dropped
+     */
+    bool record(const SpanRecord& span);
+
+    /**
+     * @brief Writes all queued spans to the file now
+     */
+    void flush();
+
+    std::uint64_t exported() const { return exported_.load(std::memory_order_relaxed); }
+    std::uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Random non-zero 64-bit ID
+     */
+    static std::uint64_t random_id();
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+private:
+    /// Vyukov bounded queue cell: sequence tells producers and the consumer whose turn it is
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        SpanRecord span;
+    };
+
+    bool pop(SpanRecord& span);
+    void write_span(const SpanRecord& span);
+    void export_loop();
+
+    TracerConfig config_;
+    std::uint64_t sample_threshold_; ///< Sample when a random 64-bit value is below this
+    std::unique_ptr<Cell[]> cells_;
+    std::size_t mask_;
+    alignas(64) std::atomic<std::size_t> enqueue_pos_;
+    alignas(64) std::atomic<std::size_t> dequeue_pos_;
+    std::atomic<std::uint64_t> exported_;
+    std::atomic<std::uint64_t> dropped_;
+
+    std::mutex export_mutex_; ///< Serializes consumers and file writes
+    FILE* file_;
+    std::string line_;        ///< Reused JSON buffer
+
+    std::mutex stop_mutex_;
+    std::condition_variable stop_cv_;
+    bool stopping_;
+    std::thread exporter_;
+};
+
+/**
+ * @brief Spans of one HttpClient request: a root span, one per attempt and one per backoff sleep
+ *
+ * A default-constructed trace is inactive and every call is a no-op, which
+ * is what HttpClient uses when no tracer is set.
+ */
+class RequestTrace {
+public:
+    RequestTrace() = default;
+
+    /**
+     * @brief Starts the request's root span
+     *
+     * A traceparent header among headers makes this request a child of it
+     * and inherits its sampling decision.
+     */
+    RequestTrace(Tracer& tracer, const std::string& method, const std::string& url,
+                 const std::vector<std::string>& headers);
+
+    bool active() const { return tracer_ != nullptr; }
+
+    /**
+     * @brief Opens an attempt span and returns headers carrying its traceparent
+     *
+     * Any traceparent the caller passed is replaced.
+     */
+    std::vector<std::string> start_attempt(const std::vector<std::string>& headers);
+
+    /**
+     * @brief Closes the attempt span opened by start_attempt()
+     * @param attempt 1-based attempt number
+     */
+    void end_attempt(int attempt, const TransportResult& result);
+
+    /**
+     * @brief Records a backoff sleep between attempts
+     */
+    void record_backoff(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+
+    /**
+     * @brief Closes the root span
+     */
+    void finish(int status_code);
+
+private:
+    using SteadyClock = std::chrono::steady_clock;
+
+    /// Fills the fields shared by every span of this request
+    SpanRecord make_span(const char* name, std::uint64_t span_id, std::uint64_t parent_id,
+                         SteadyClock::time_point start, SteadyClock::time_point end) const;
+
+    Tracer* tracer_ = nullptr;
+    TraceContext context_;             ///< Root span
+    std::uint64_t parent_id_ = 0;      ///< Incoming parent span (0: none)
+    std::uint64_t attempt_span_ = 0;
+    SteadyClock::time_point start_;
+    SteadyClock::time_point attempt_start_;
+    std::int64_t start_epoch_us_ = 0;  ///< Wall-clock time of start_
+    std::string method_;
+    std::string url_;
+};
+
+#endif // TRACING_H
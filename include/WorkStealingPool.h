@@ -0,0 +1,96 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Fixed-size thread pool with per-worker deques and work stealing
+ *
+ * Jobs posted from a worker thread go to that worker's own deque and are
+ * popped LIFO (cache-warm); jobs posted from outside go to a shared FIFO
+ * injector queue. Idle workers take from the injector, then steal FIFO from
+ * the other end of their peers' deques, so one large job does not hold up
+ * the rest of the queue behind it.
+ *
+ * The destructor runs every job already posted before joining the workers.
+ */
+class WorkStealingPool {
+public:
+    using Job = std::function<void()>;
+
+    /**
+     * @brief Starts the worker threads
+     * @param threads Number of workers (0 means std::thread::hardware_concurrency())
+     */
+    explicit WorkStealingPool(std::size_t threads = 0);
+
+    /**
+     * @brief Drains posted jobs and joins the workers
+     */
+    ~WorkStealingPool();
+
+    /**
+     * @brief Queues a job; safe to call from any thread, including workers
+     * @param job Callable to run; exceptions escaping it are logged and dropped
+     */
+    void post(Job job);
+
+    /**
+     * @brief Queues a callable and returns a future for its result
+     */
+    template <typename F>
+    std::future<std::invoke_result_t<F>> submit(F&& fn) {
+        using Result = std::invoke_result_t<F>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(fn));
+        std::future<Result> future = task->get_future();
+        post([task] { (*task)(); });
+        return future;
+    }
+
+    /**
+     * @brief Number of worker threads
+     */
+    std::size_t size() const { return workers_.size(); }
+
+    /**
+     * @brief Number of jobs stolen from another worker's deque so far
+     */
+    std::size_t steal_count() const { return steals_.load(std::memory_order_relaxed); }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+private:
+    // Padded so neighbouring workers' locks do not share a cache line
+    struct alignas(64) Worker {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+    Worker injector_;                        ///< Jobs posted from non-worker threads
+    std::atomic<std::size_t> steals_;
+    std::atomic<std::size_t> pending_;       ///< Queued jobs; counted before they are pushed
+    std::atomic<std::size_t> sleepers_;      ///< Workers parked (or parking) on wake_
+    std::mutex sleep_mutex_;                 ///< Taken only to park or to wake a parked worker
+    std::condition_variable wake_;
+    bool stopping_;                          ///< Guarded by sleep_mutex_
+
+    void worker_loop(std::size_t index);
+    bool try_pop_local(std::size_t index, Job& job);
+    bool try_pop_injected(Job& job);
+    bool try_steal(std::size_t index, Job& job);
+};
+
+#endif // WORK_STEALING_POOL_H
@@ -0,0 +1,71 @@
+// Replacement global operator new/delete that feed AllocationTracker.
+// Linked only into allocation-profiling targets (see CMakeLists.txt);
+// never add this file to HTTP_CLIENT_SOURCES.
+
+#include "AllocationTracker.h"
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+[[maybe_unused]] const bool hook_installed = (AllocationTracker::mark_installed(), true);
+
+void* allocate(std::size_t size) {
+    AllocationTracker::record_allocation(size);
+    // malloc(0) may return nullptr, which operator new must not
+    if (void* block = std::malloc(size ? size : 1)) {
+        return block;
+    }
+    throw std::bad_alloc();
+}
+
+void* allocate_aligned(std::size_t size, std::align_val_t alignment) {
+    AllocationTracker::record_allocation(size);
+    std::size_t align = static_cast<std::size_t>(alignment);
+    // aligned_alloc requires a size that is a multiple of the alignment
+    std::size_t rounded = (size + align - 1) / align * align;
+    if (void* block = std::aligned_alloc(align, rounded ? rounded : align)) {
+        return block;
+    }
+    throw std::bad_alloc();
+}
+
+void release(void* block) {
+    if (block) {
+        AllocationTracker::record_free();
+        std::free(block);
+    }
+}
+
+} // namespace
+
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return allocate_aligned(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return allocate_aligned(size, alignment); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(size);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(size);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* block) noexcept { release(block); }
+void operator delete[](void* block) noexcept { release(block); }
+void operator delete(void* block, std::size_t) noexcept { release(block); }
+void operator delete[](void* block, std::size_t) noexcept { release(block); }
+void operator delete(void* block, std::align_val_t) noexcept { release(block); }
+void operator delete[](void* block, std::align_val_t) noexcept { release(block); }
+void operator delete(void* block, std::size_t, std::align_val_t) noexcept { release(block); }
+void operator delete[](void* block, std::size_t, std::align_val_t) noexcept { release(block); }
+void operator delete(void* block, const std::nothrow_t&) noexcept { release(block); }
+void operator delete[](void* block, const std::nothrow_t&) noexcept { release(block); }
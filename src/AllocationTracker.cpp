@@ -0,0 +1,75 @@
+#include "AllocationTracker.h"
+#include <cstdlib>
+#include <cstring>
+
+void AllocationStats::merge(const AllocationStats& other) {
+    allocations += other.allocations;
+    bytes += other.bytes;
+    frees += other.frees;
+}
+
+AllocationStats AllocationProfile::unphased() const {
+    AllocationStats rest = total;
+    for (const AllocationStats& phase : phases) {
+        rest.allocations -= phase.allocations;
+        rest.bytes -= phase.bytes;
+        rest.frees -= phase.frees;
+    }
+    return rest;
+}
+
+void AllocationProfile::merge(const AllocationProfile& other) {
+    requests += other.requests;
+    total.merge(other.total);
+    for (std::size_t i = 0; i < phases.size(); ++i) {
+        phases[i].merge(other.phases[i]);
+    }
+}
+
+namespace {
+
+void* counted_malloc(std::size_t size) {
+    AllocationTracker::record_allocation(size);
+    return std::malloc(size);
+}
+
+void counted_free(void* block) {
+    if (block) {
+        AllocationTracker::record_free();
+    }
+    std::free(block);
+}
+
+void* counted_realloc(void* block, std::size_t size) {
+    // A move to a new block of the given size, as far as the counts are concerned
+    if (block) {
+        AllocationTracker::record_free();
+    }
+    AllocationTracker::record_allocation(size);
+    return std::realloc(block, size);
+}
+
+char* counted_strdup(const char* text) {
+    std::size_t size = std::strlen(text) + 1;
+    AllocationTracker::record_allocation(size);
+    char* copy = static_cast<char*>(std::malloc(size));
+    if (copy) {
+        std::memcpy(copy, text, size);
+    }
+    return copy;
+}
+
+void* counted_calloc(std::size_t count, std::size_t size) {
+    AllocationTracker::record_allocation(count * size);
+    return std::calloc(count, size);
+}
+
+} // namespace
+
+CURLcode AllocationTracker::init_curl(long flags) {
+    if (!installed()) {
+        return curl_global_init(flags);
+    }
+    return curl_global_init_mem(flags, &counted_malloc, &counted_free, &counted_realloc, &counted_strdup,
+                                &counted_calloc);
+}
@@ -0,0 +1,654 @@
+#include "AsyncHttpClient.h"
+#include <algorithm>
+#include <stdexcept>
+
+AsyncHttpClient::AsyncHttpClient(int timeout_seconds)
+    : AsyncHttpClient(std::make_unique<EpollEventLoop>(), nullptr, timeout_seconds) {}
+
+AsyncHttpClient::AsyncHttpClient(EventLoop& loop, int timeout_seconds)
+    : AsyncHttpClient(nullptr, &loop, timeout_seconds) {}
+
+AsyncHttpClient::AsyncHttpClient(std::unique_ptr<EventLoop> owned_loop, EventLoop* loop, int timeout_seconds)
+    : owned_loop_(std::move(owned_loop)),
+      loop_(loop ? *loop : *owned_loop_),
+      timeout_seconds_(timeout_seconds),
+      max_retries_(MAX_RETRIES),
+      in_flight_(0),
+      curl_timer_(0),
+      sleeping_(0),
+      offloaded_(0),
+      next_cancel_id_(1),
+      alive_(std::make_shared<char>()),
+      share_(CurlShare::global()),
+      max_connections_(0),
+      warm_timer_(0),
+      warm_per_host_(0),
+      warming_(false) {
+    multi_ = curl_multi_init();
+    if (!multi_) {
+        throw std::runtime_error("Failed to initialize cURL multi handle");
+    }
+    curl_multi_setopt(multi_, CURLMOPT_SOCKETFUNCTION, &AsyncHttpClient::socket_callback);
+    curl_multi_setopt(multi_, CURLMOPT_SOCKETDATA, this);
+    curl_multi_setopt(multi_, CURLMOPT_TIMERFUNCTION, &AsyncHttpClient::timer_callback);
+    curl_multi_setopt(multi_, CURLMOPT_TIMERDATA, this);
+}
+
+AsyncHttpClient::~AsyncHttpClient() {
+    stop_keep_warm();
+    // Destroying suspended frames detaches their transfers and timers
+    spawned_.clear();
+    // Offloaded jobs still post back to this client; drain them without
+    // resuming the frames destroyed above
+    while (offloaded_ > 0) {
+        run_once();
+    }
+    for (CURL* easy : idle_handles_) {
+        curl_easy_cleanup(easy);
+    }
+    curl_multi_cleanup(multi_);
+
+    // Cleanup may close cached connections; drop anything still registered
+    for (curl_socket_t socket : sockets_) {
+        loop_.unwatch(socket);
+    }
+    if (curl_timer_) {
+        loop_.cancel_timer(curl_timer_);
+    }
+}
+
+int AsyncHttpClient::socket_callback(CURL*, curl_socket_t socket, int what, void* userp, void*) {
+    auto* client = static_cast<AsyncHttpClient*>(userp);
+    if (what == CURL_POLL_REMOVE) {
+        client->loop_.unwatch(socket);
+        client->sockets_.erase(socket);
+        return 0;
+    }
+
+    int events = 0;
+    if (what == CURL_POLL_IN || what == CURL_POLL_INOUT) events |= EventLoop::READABLE;
+    if (what == CURL_POLL_OUT || what == CURL_POLL_INOUT) events |= EventLoop::WRITABLE;
+    client->sockets_.insert(socket);
+    client->loop_.watch(socket, events, [client, socket](int ready) {
+        int flags = 0;
+        if (ready & EventLoop::READABLE) flags |= CURL_CSELECT_IN;
+        if (ready & EventLoop::WRITABLE) flags |= CURL_CSELECT_OUT;
+        if (ready & EventLoop::ERROR) flags |= CURL_CSELECT_ERR;
+        client->socket_action(socket, flags);
+    });
+    return 0;
+}
+
+int AsyncHttpClient::timer_callback(CURLM*, long timeout_ms, void* userp) {
+    auto* client = static_cast<AsyncHttpClient*>(userp);
+    if (client->curl_timer_) {
+        client->loop_.cancel_timer(client->curl_timer_);
+        client->curl_timer_ = 0;
+    }
+    if (timeout_ms >= 0) {
+        // Never call socket_action from inside this callback; defer through the loop
+        client->curl_timer_ = client->loop_.add_timer(std::chrono::milliseconds(timeout_ms), [client] {
+            client->curl_timer_ = 0;
+            client->socket_action(CURL_SOCKET_TIMEOUT, 0);
+        });
+    }
+    return 0;
+}
+
+void AsyncHttpClient::socket_action(curl_socket_t socket, int events) {
+    int running = 0;
+    curl_multi_socket_action(multi_, socket, events, &running);
+    complete_finished_transfers();
+}
+
+CURL* AsyncHttpClient::acquire_handle() {
+    CURL* easy = nullptr;
+    if (!idle_handles_.empty()) {
+        easy = idle_handles_.back();
+        idle_handles_.pop_back();
+        curl_easy_reset(easy);
+    } else {
+        easy = curl_easy_init();
+    }
+    if (easy) {
+        setup_common_curl_options(easy, timeout_seconds_);
+        if (share_) {
+            share_->attach(easy);
+        }
+    }
+    return easy;
+}
+
+void AsyncHttpClient::release_handle(CURL* easy) {
+    idle_handles_.push_back(easy);
+}
+
+bool AsyncHttpClient::start_transfer(Transfer& transfer,
+                                     const std::string& url,
+                                     const std::string& method,
+                                     const std::string& data,
+                                     const std::vector<std::string>& headers) {
+    transfer.easy = acquire_handle();
+    if (!transfer.easy) {
+        transfer.result = CURLE_FAILED_INIT;
+        return false;
+    }
+
+    transfer.header_list = build_header_list(headers);
+    setup_request_options(transfer.easy, url, method, data, transfer.header_list,
+                          &transfer.response->body);
+    setup_budget_options(transfer.easy, timeout_seconds_, *transfer.options);
+    setup_socket_options(transfer.easy, *transfer.options);
+    curl_easy_setopt(transfer.easy, CURLOPT_PRIVATE, &transfer);
+
+    if (curl_multi_add_handle(multi_, transfer.easy) != CURLM_OK) {
+        transfer.result = CURLE_FAILED_INIT;
+        finish_transfer(transfer);
+        return false;
+    }
+    ++in_flight_;
+
+    // The progress callback only runs when cURL services the handle; also
+    // remove the transfer as soon as the token fires, even if the socket is idle
+    const CancellationToken& token = transfer.options->cancellation;
+    if (token.can_be_cancelled()) {
+        transfer.cancel_id = watch_cancellation(token, [this, &transfer] { abort_transfer(transfer); },
+                                                transfer.subscription);
+    }
+    return true;
+}
+
+void AsyncHttpClient::abort_transfer(Transfer& transfer) {
+    curl_multi_remove_handle(multi_, transfer.easy);
+    --in_flight_;
+    transfer.result = CURLE_ABORTED_BY_CALLBACK;
+    finish_transfer(transfer);
+    transfer.waiter.resume();
+}
+
+std::uint64_t AsyncHttpClient::watch_cancellation(const CancellationToken& token,
+                                                  std::function<void()> on_cancel,
+                                                  CancellationToken::SubscriptionId& subscription) {
+    std::uint64_t id = next_cancel_id_++;
+    cancel_handlers_.emplace(id, std::move(on_cancel));
+    // Runs on the cancelling thread: hop to the loop, where the handler (or, with a
+    // caller-supplied loop, the client) may already be gone. unwatch_cancellation()
+    // waits out a running callback, so `this` is live until the post.
+    std::weak_ptr<char> alive = alive_;
+    subscription = token.subscribe([this, id, alive] {
+        post([this, id, alive] {
+            if (alive.expired()) {
+                return;
+            }
+            auto it = cancel_handlers_.find(id);
+            if (it == cancel_handlers_.end()) {
+                return;
+            }
+            std::function<void()> handler = std::move(it->second);
+            cancel_handlers_.erase(it);
+            handler();
+        });
+    });
+    return id;
+}
+
+void AsyncHttpClient::unwatch_cancellation(const CancellationToken& token,
+                                           std::uint64_t id,
+                                           CancellationToken::SubscriptionId subscription) {
+    token.unsubscribe(subscription);
+    cancel_handlers_.erase(id);
+}
+
+void AsyncHttpClient::finish_transfer(Transfer& transfer) {
+    if (transfer.cancel_id) {
+        unwatch_cancellation(transfer.options->cancellation, transfer.cancel_id, transfer.subscription);
+        transfer.cancel_id = 0;
+    }
+    if (transfer.header_list) {
+        curl_slist_free_all(transfer.header_list);
+        transfer.header_list = nullptr;
+    }
+    if (transfer.easy) {
+        release_handle(transfer.easy);
+        transfer.easy = nullptr;
+    }
+}
+
+void AsyncHttpClient::complete_finished_transfers() {
+    // Collect first: resumed coroutines may start new transfers
+    std::vector<Transfer*> finished;
+    CURLMsg* message = nullptr;
+    int remaining = 0;
+    while ((message = curl_multi_info_read(multi_, &remaining)) != nullptr) {
+        if (message->msg != CURLMSG_DONE) {
+            continue;
+        }
+        Transfer* transfer = nullptr;
+        curl_easy_getinfo(message->easy_handle, CURLINFO_PRIVATE, &transfer);
+        transfer->result = message->data.result;
+
+        long http_code = 0;
+        curl_easy_getinfo(message->easy_handle, CURLINFO_RESPONSE_CODE, &http_code);
+        transfer->response->status_code = static_cast<int>(http_code);
+        read_response_headers(message->easy_handle, transfer->response->headers);
+
+        curl_multi_remove_handle(multi_, message->easy_handle);
+        --in_flight_;
+        finish_transfer(*transfer);
+        finished.push_back(transfer);
+    }
+
+    for (Transfer* transfer : finished) {
+        transfer->waiter.resume();
+    }
+}
+
+void AsyncHttpClient::reap_spawned() {
+    for (auto it = spawned_.begin(); it != spawned_.end();) {
+        if (!it->done()) {
+            ++it;
+            continue;
+        }
+        try {
+            it->result();
+        } catch (const std::exception& e) {
+            log_error("Spawned task failed: " + std::string(e.what()));
+        }
+        it = spawned_.erase(it);
+    }
+}
+
+void AsyncHttpClient::post(std::function<void()> callback) {
+    loop_.post(std::move(callback));
+}
+
+bool AsyncHttpClient::has_pending_work() const {
+    return in_flight_ > 0 || offloaded_ > 0 || sleeping_ > 0 || !spawned_.empty();
+}
+
+bool AsyncHttpClient::run_once(int max_wait_ms) {
+    loop_.run_once(max_wait_ms);
+    reap_spawned();
+    return has_pending_work();
+}
+
+void AsyncHttpClient::run() {
+    reap_spawned();
+    while (has_pending_work()) {
+        run_once();
+    }
+}
+
+void AsyncHttpClient::spawn(Task<void> task) {
+    spawned_.push_back(std::move(task));
+    spawned_.back().start();
+}
+
+Task<HttpResponse> AsyncHttpClient::request(std::string url,
+                                            std::string method,
+                                            std::string data,
+                                            std::vector<std::string> headers,
+                                            RequestOptions options) {
+    HttpResponse response;
+    Backoff backoff(backoff_);
+
+    // A per-host socket applies unless the request names its own
+    if (options.unix_socket.empty() && !unix_sockets_.empty()) {
+        auto socket = unix_sockets_.find(RequestScheduler::host_key(url));
+        if (socket != unix_sockets_.end()) {
+            options.unix_socket = socket->second;
+        }
+    }
+
+    for (int attempt = 0; attempt <= max_retries_; ++attempt) {
+        // Callers whose budget is already spent get no further attempts
+        if (const char* budget_error = request_budget_error(options)) {
+            response.error_message = budget_error;
+            log_warning(response.error_message + " for " + method + " " + url);
+            co_return response;
+        }
+
+        // Wait for an admission slot when requests are scheduled
+        std::shared_ptr<RequestScheduler> scheduler = scheduler_;
+        RequestScheduler::Permit permit;
+        if (scheduler) {
+            permit = co_await AdmissionAwaiter(*this, scheduler, RequestScheduler::host_key(url), options);
+            if (!permit) {
+                const char* budget_error = request_budget_error(options);
+                response.error_message = budget_error ? budget_error : "Request shed: too many requests queued for host";
+                log_warning(response.error_message + " while queued for " + method + " " + url);
+                co_return response;
+            }
+        }
+
+        response = HttpResponse();
+        CURLcode res = co_await TransferAwaiter(*this, url, method, data, headers, options, response);
+        // Backoff must not hold the slot; the attempt's latency tunes an adaptive limit
+        permit.release(request_budget_error(options) ? AttemptOutcome::IGNORED
+                                                     : attempt_outcome(res, response.status_code));
+
+        // Check for cURL errors
+        if (res != CURLE_OK) {
+            response.error_message = curl_easy_strerror(res);
+            if (const char* budget_error = request_budget_error(options)) {
+                response.error_message = budget_error;
+                log_warning(response.error_message + " for " + method + " " + url);
+                co_return response;
+            }
+            if (!is_retryable_curl_error(res) || attempt >= max_retries_) {
+                log_error("cURL error: " + response.error_message + " for " + method + " " + url);
+                co_return response;
+            }
+            log_warning("cURL error: " + response.error_message + " for " + method + " " + url +
+                        " (attempt " + std::to_string(attempt + 1) + ")");
+        } else if (response.status_code >= 200 && response.status_code < 300) {
+            response.success = true;
+            co_return response;
+        } else {
+            response.error_message = "HTTP " + std::to_string(response.status_code);
+            if (!is_retryable_error(response.status_code) || attempt >= max_retries_) {
+                log_warning("HTTP error: " + response.error_message + " for " + method + " " + url);
+                co_return response;
+            }
+            log_warning("HTTP error: " + response.error_message + " for " + method + " " + url +
+                        " (attempt " + std::to_string(attempt + 1) + ")");
+        }
+
+        // Back off, unless the sleep alone would overrun the deadline
+        std::chrono::milliseconds delay(backoff.delay_ms(attempt));
+        if (options.deadline.is_set() && options.deadline.remaining() <= delay) {
+            response.error_message = "Deadline exceeded";
+            log_warning("Not retrying " + method + " " + url + ": backoff would exceed the request deadline");
+            co_return response;
+        }
+        if (co_await sleep_for(delay, options.cancellation)) {
+            response.error_message = "Request cancelled";
+            co_return response;
+        }
+    }
+
+    co_return response;
+}
+
+Task<HttpResponse> AsyncHttpClient::get(std::string url,
+                                        std::vector<std::string> headers,
+                                        RequestOptions options) {
+    return request(std::move(url), "GET", "", std::move(headers), std::move(options));
+}
+
+Task<HttpResponse> AsyncHttpClient::post(std::string url,
+                                         std::string data,
+                                         std::vector<std::string> headers,
+                                         RequestOptions options) {
+    return request(std::move(url), "POST", std::move(data), std::move(headers), std::move(options));
+}
+
+Task<HttpResponse> AsyncHttpClient::put(std::string url,
+                                        std::string data,
+                                        std::vector<std::string> headers,
+                                        RequestOptions options) {
+    return request(std::move(url), "PUT", std::move(data), std::move(headers), std::move(options));
+}
+
+void AsyncHttpClient::set_unix_socket(const std::string& host, const std::string& socket_path) {
+    if (socket_path.empty()) {
+        unix_sockets_.erase(RequestScheduler::host_key(host));
+    } else {
+        unix_sockets_[RequestScheduler::host_key(host)] = socket_path;
+    }
+}
+
+Task<HttpResponse> AsyncHttpClient::probe(std::string url, RequestOptions options) {
+    HttpResponse response;
+    std::string method = "HEAD";
+    std::string data;
+    std::vector<std::string> headers;
+    CURLcode res = co_await TransferAwaiter(*this, url, method, data, headers, options, response);
+    if (res != CURLE_OK) {
+        response.error_message = curl_easy_strerror(res);
+    }
+    co_return response;
+}
+
+Task<std::size_t> AsyncHttpClient::warmup(std::vector<std::string> hosts,
+                                          std::size_t connections_per_host,
+                                          RequestOptions options) {
+    // The multi handle otherwise keeps only 4 idle connections per transfer in flight
+    long needed = static_cast<long>(hosts.size() * connections_per_host);
+    if (needed > max_connections_) {
+        max_connections_ = needed;
+        curl_multi_setopt(multi_, CURLMOPT_MAXCONNECTS, max_connections_);
+    }
+
+    // Probes in flight at once each need a connection of their own
+    std::vector<Task<HttpResponse>> probes;
+    for (std::string& host : hosts) {
+        while (!host.empty() && host.back() == '/') {
+            host.pop_back();
+        }
+        for (std::size_t i = 0; i < connections_per_host; ++i) {
+            probes.push_back(probe(host + "/", options));
+        }
+    }
+    if (probes.empty()) {
+        co_return 0;
+    }
+    std::vector<HttpResponse> responses = co_await when_all(std::move(probes));
+
+    std::size_t warmed = 0;
+    for (std::size_t i = 0; i < responses.size(); ++i) {
+        if (responses[i].status_code != 0) {
+            ++warmed;
+        } else {
+            log_warning("Warmup of " + hosts[i / connections_per_host] + " failed: " + responses[i].error_message);
+        }
+    }
+    co_return warmed;
+}
+
+void AsyncHttpClient::keep_warm(std::vector<std::string> hosts,
+                                std::size_t min_idle_per_host,
+                                std::chrono::milliseconds interval) {
+    stop_keep_warm();
+    warm_hosts_ = std::move(hosts);
+    warm_per_host_ = min_idle_per_host;
+    warm_interval_ = interval;
+    spawn(refresh_warm());
+    arm_keep_warm();
+}
+
+void AsyncHttpClient::stop_keep_warm() {
+    if (warm_timer_) {
+        loop_.cancel_timer(warm_timer_);
+        warm_timer_ = 0;
+    }
+}
+
+void AsyncHttpClient::arm_keep_warm() {
+    warm_timer_ = loop_.add_timer(warm_interval_, [this] {
+        warm_timer_ = 0;
+        // A slow round that is still running already tops the hosts up
+        if (!warming_) {
+            spawn(refresh_warm());
+        }
+        arm_keep_warm();
+    });
+}
+
+Task<void> AsyncHttpClient::refresh_warm() {
+    warming_ = true;
+    co_await warmup(warm_hosts_, warm_per_host_);
+    warming_ = false;
+}
+
+AsyncHttpClient::TransferAwaiter::TransferAwaiter(AsyncHttpClient& client,
+                                                  const std::string& url,
+                                                  const std::string& method,
+                                                  const std::string& data,
+                                                  const std::vector<std::string>& headers,
+                                                  const RequestOptions& options,
+                                                  HttpResponse& response)
+    : client_(client), url_(url), method_(method), data_(data), headers_(headers) {
+    transfer_.response = &response;
+    transfer_.options = &options;
+}
+
+AsyncHttpClient::TransferAwaiter::~TransferAwaiter() {
+    // The awaiting frame was destroyed mid-transfer: detach it from the multi handle
+    if (transfer_.easy) {
+        curl_multi_remove_handle(client_.multi_, transfer_.easy);
+        --client_.in_flight_;
+        client_.finish_transfer(transfer_);
+    }
+}
+
+bool AsyncHttpClient::TransferAwaiter::await_suspend(std::coroutine_handle<> awaiting) {
+    transfer_.waiter = awaiting;
+    return client_.start_transfer(transfer_, url_, method_, data_, headers_);
+}
+
+AsyncHttpClient::AdmissionAwaiter::AdmissionAwaiter(AsyncHttpClient& client,
+                                                    std::shared_ptr<RequestScheduler> scheduler,
+                                                    std::string host,
+                                                    const RequestOptions& options)
+    : client_(client),
+      options_(options),
+      state_(std::make_shared<State>()),
+      ticket_(0),
+      timer_(0),
+      cancel_id_(0),
+      subscription_(0),
+      granted_(false) {
+    state_->scheduler = std::move(scheduler);
+    state_->host = std::move(host);
+}
+
+AsyncHttpClient::AdmissionAwaiter::~AdmissionAwaiter() {
+    // The awaiting frame was destroyed while queued
+    if (state_->awaiter) {
+        stop_waiting();
+        state_->scheduler->withdraw(ticket_); // if too late, the posted grant releases the slot
+    }
+}
+
+bool AsyncHttpClient::AdmissionAwaiter::await_suspend(std::coroutine_handle<> awaiting) {
+    AsyncHttpClient* client = &client_;
+    std::shared_ptr<State> state = state_;
+    ticket_ = state_->scheduler->enqueue(state_->host, options_.priority, [client, state] {
+        // May run on another client's thread: always hop to this loop
+        client->post([state] {
+            if (state->awaiter) {
+                state->awaiter->finish(true);
+            } else {
+                state->scheduler->release(state->host);
+            }
+        });
+    });
+    if (ticket_ == 0) {
+        granted_ = true;
+        return false;
+    }
+    if (ticket_ == RequestScheduler::REJECTED) {
+        granted_ = false; // shed: resume at once with an empty permit
+        return false;
+    }
+
+    waiter_ = awaiting;
+    state_->awaiter = this;
+    if (options_.deadline.is_set()) {
+        timer_ = client_.loop_.add_timer(options_.deadline.remaining(), [this] {
+            timer_ = 0;
+            give_up();
+        });
+    }
+    if (options_.cancellation.can_be_cancelled()) {
+        cancel_id_ = client_.watch_cancellation(options_.cancellation, [this] {
+            cancel_id_ = 0;
+            give_up();
+        }, subscription_);
+    }
+    return true;
+}
+
+RequestScheduler::Permit AsyncHttpClient::AdmissionAwaiter::await_resume() {
+    if (!granted_) {
+        return RequestScheduler::Permit();
+    }
+    return RequestScheduler::Permit(state_->scheduler.get(), state_->host);
+}
+
+void AsyncHttpClient::AdmissionAwaiter::give_up() {
+    if (state_->scheduler->withdraw(ticket_)) {
+        finish(false);
+    }
+    // Otherwise the grant is already posted and finishes the wait
+}
+
+void AsyncHttpClient::AdmissionAwaiter::stop_waiting() {
+    if (timer_) {
+        client_.loop_.cancel_timer(timer_);
+        timer_ = 0;
+    }
+    if (cancel_id_) {
+        client_.unwatch_cancellation(options_.cancellation, cancel_id_, subscription_);
+        cancel_id_ = 0;
+    }
+    state_->awaiter = nullptr;
+}
+
+void AsyncHttpClient::AdmissionAwaiter::finish(bool granted) {
+    stop_waiting();
+    granted_ = granted;
+    waiter_.resume();
+}
+
+AsyncHttpClient::SleepAwaiter::SleepAwaiter(AsyncHttpClient& client,
+                                            std::chrono::milliseconds delay,
+                                            CancellationToken cancellation)
+    : client_(client),
+      delay_(delay),
+      cancellation_(std::move(cancellation)),
+      timer_(0),
+      cancel_id_(0),
+      subscription_(0),
+      pending_(false) {}
+
+AsyncHttpClient::SleepAwaiter::~SleepAwaiter() {
+    if (pending_) {
+        client_.loop_.cancel_timer(timer_);
+        if (cancel_id_) {
+            client_.unwatch_cancellation(cancellation_, cancel_id_, subscription_);
+        }
+        --client_.sleeping_;
+    }
+}
+
+void AsyncHttpClient::SleepAwaiter::await_suspend(std::coroutine_handle<> awaiting) {
+    waiter_ = awaiting;
+    pending_ = true;
+    ++client_.sleeping_;
+    timer_ = client_.loop_.add_timer(delay_, [this] {
+        timer_ = 0;
+        wake();
+    });
+    if (cancellation_.can_be_cancelled()) {
+        cancel_id_ = client_.watch_cancellation(cancellation_, [this] {
+            cancel_id_ = 0;
+            wake();
+        }, subscription_);
+    }
+}
+
+void AsyncHttpClient::SleepAwaiter::wake() {
+    if (timer_) {
+        client_.loop_.cancel_timer(timer_);
+        timer_ = 0;
+    }
+    if (cancel_id_) {
+        client_.unwatch_cancellation(cancellation_, cancel_id_, subscription_);
+        cancel_id_ = 0;
+    }
+    pending_ = false;
+    --client_.sleeping_;
+    waiter_.resume();
+}
@@ -0,0 +1,72 @@
+#include "Backoff.h"
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+FastRandom& FastRandom::thread_instance() {
+    thread_local FastRandom random((static_cast<std::uint64_t>(std::random_device{}()) << 32) ^
+                                   std::hash<std::thread::id>()(std::this_thread::get_id()));
+    return random;
+}
+
+const char* jitter_strategy_name(JitterStrategy strategy) {
+    switch (strategy) {
+    case JitterStrategy::PROPORTIONAL:
+        return "proportional";
+    case JitterStrategy::FULL:
+        return "full";
+    case JitterStrategy::EQUAL:
+        return "equal";
+    case JitterStrategy::DECORRELATED:
+        return "decorrelated";
+    }
+    return "unknown";
+}
+
+JitterStrategy parse_jitter_strategy(const std::string& name) {
+    for (JitterStrategy strategy : {JitterStrategy::PROPORTIONAL, JitterStrategy::FULL, JitterStrategy::EQUAL,
+                                    JitterStrategy::DECORRELATED}) {
+        if (name == jitter_strategy_name(strategy)) {
+            return strategy;
+        }
+    }
+    throw std::invalid_argument("Unknown jitter strategy: " + name);
+}
+
+Backoff::Backoff(BackoffConfig config, FastRandom* random)
+    : config_(config), random_(random), previous_ms_(config.initial_ms) {
+    if (config_.initial_ms <= 0 || config_.max_ms < config_.initial_ms) {
+        throw std::invalid_argument("Invalid BackoffConfig");
+    }
+}
+
+int Backoff::delay_ms(int attempt) {
+    if (attempt <= 0) {
+        previous_ms_ = config_.initial_ms;
+        return 0;
+    }
+    FastRandom& random = random_ ? *random_ : FastRandom::thread_instance();
+    // Saturate instead of overflowing the shift for long retry chains
+    double base = std::min(static_cast<double>(config_.initial_ms) * static_cast<double>(1ULL << std::min(attempt - 1, 30)),
+                           static_cast<double>(config_.max_ms));
+    double delay = 0;
+    switch (config_.strategy) {
+    case JitterStrategy::PROPORTIONAL:
+        delay = base * random.uniform(0.5, 1.5);
+        break;
+    case JitterStrategy::FULL:
+        delay = random.uniform(0, base);
+        break;
+    case JitterStrategy::EQUAL:
+        delay = base / 2 + random.uniform(0, base / 2);
+        break;
+    case JitterStrategy::DECORRELATED:
+        delay = std::min(static_cast<double>(config_.max_ms),
+                         random.uniform(config_.initial_ms, 3.0 * previous_ms_));
+        previous_ms_ = static_cast<int>(delay);
+        break;
+    }
+    return static_cast<int>(delay);
+}
@@ -0,0 +1,101 @@
+#include "BackoffSimulator.h"
+#include <algorithm>
+#include <functional>
+#include <iomanip>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+/// Attempts and admissions counted over one window
+struct Window {
+    std::uint64_t attempts = 0;
+    std::uint64_t served = 0;
+};
+
+} // namespace
+
+RetryStormReport simulate_retry_storm(const RetryStormConfig& config) {
+    if (config.clients <= 0 || config.arrival_spread_ms < 0 || config.outage_ms < 0 ||
+        config.capacity_per_second <= 0 || config.window_ms <= 0 || config.max_retries < 0) {
+        throw std::invalid_argument("Invalid RetryStormConfig");
+    }
+
+    FastRandom random(config.seed);
+    std::vector<Backoff> backoffs(static_cast<std::size_t>(config.clients), Backoff(config.backoff, &random));
+    std::vector<int> failures(static_cast<std::size_t>(config.clients), 0);
+    std::uint64_t capacity = std::max<std::uint64_t>(
+        1, static_cast<std::uint64_t>(config.capacity_per_second) * static_cast<std::uint64_t>(config.window_ms) / 1000);
+
+    // (time, client) of every pending attempt, earliest first
+    using Event = std::pair<double, int>;
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> pending;
+    for (int client = 0; client < config.clients; ++client) {
+        pending.emplace(random.uniform(0, config.arrival_spread_ms), client);
+    }
+
+    RetryStormReport report;
+    report.strategy = config.backoff.strategy;
+    std::vector<Window> windows;
+    double last_done = 0;
+    while (!pending.empty()) {
+        auto [time, client] = pending.top();
+        pending.pop();
+
+        std::size_t index = static_cast<std::size_t>(time / config.window_ms);
+        if (index >= windows.size()) {
+            windows.resize(index + 1);
+        }
+        Window& window = windows[index];
+        ++window.attempts;
+        ++report.attempts;
+
+        bool recovered = time >= config.outage_ms;
+        if (recovered && window.served < capacity) {
+            ++window.served;
+            ++report.succeeded;
+            last_done = std::max(last_done, time);
+            continue;
+        }
+        if (recovered) {
+            ++report.rejected;
+        }
+
+        int failed_attempt = failures[static_cast<std::size_t>(client)]++;
+        if (failed_attempt >= config.max_retries) {
+            ++report.gave_up;
+            last_done = std::max(last_done, time);
+            continue;
+        }
+        pending.emplace(time + backoffs[static_cast<std::size_t>(client)].delay_ms(failed_attempt), client);
+    }
+
+    for (std::size_t i = 0; i < windows.size(); ++i) {
+        if (static_cast<double>((i + 1) * static_cast<std::size_t>(config.window_ms)) > config.outage_ms) {
+            report.peak_window_attempts = std::max(report.peak_window_attempts, windows[i].attempts);
+        }
+    }
+    report.recovery_ms = std::max(0.0, last_done - config.outage_ms);
+    return report;
+}
+
+void print_retry_storm_reports(const RetryStormConfig& config, const std::vector<RetryStormReport>& reports,
+                               std::ostream& out) {
+    std::uint64_t capacity = static_cast<std::uint64_t>(config.capacity_per_second) *
+                             static_cast<std::uint64_t>(config.window_ms) / 1000;
+    out << config.clients << " clients, " << config.outage_ms << "ms outage, capacity "
+        << config.capacity_per_second << "/s (" << capacity << " per " << config.window_ms << "ms), "
+        << config.max_retries << " retries, backoff " << config.backoff.initial_ms << "-" << config.backoff.max_ms
+        << "ms\n";
+    out << std::left << std::setw(14) << "strategy" << std::right << std::setw(10) << "attempts" << std::setw(12)
+        << "per-client" << std::setw(10) << "rejected" << std::setw(8) << "peak" << std::setw(11) << "succeeded"
+        << std::setw(9) << "gave-up" << std::setw(14) << "recovery-ms" << "\n";
+    for (const RetryStormReport& report : reports) {
+        out << std::left << std::setw(14) << jitter_strategy_name(report.strategy) << std::right << std::setw(10)
+            << report.attempts << std::setw(12) << std::fixed << std::setprecision(2)
+            << static_cast<double>(report.attempts) / config.clients << std::setw(10) << report.rejected
+            << std::setw(8) << report.peak_window_attempts << std::setw(11) << report.succeeded << std::setw(9)
+            << report.gave_up << std::setw(14) << std::setprecision(0) << report.recovery_ms << "\n";
+    }
+}
@@ -0,0 +1,318 @@
+#include "BulkUpload.h"
+#include "HttpClient.h"
+#include "MappedFile.h"
+#include "RequestBody.h"
+#include "WorkStealingPool.h"
+#include <nlohmann/json.hpp>
+#include <strings.h>
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <iomanip>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+
+using json = nlohmann::json;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/// Input bytes validated per pool job
+const std::size_t CHUNK_BYTES = 4 << 20;
+
+/// One request body: records still in the input buffer, each sent followed by a newline
+struct Batch {
+    std::vector<std::string_view> records;
+    std::size_t bytes = 0; ///< Body size including newlines
+};
+
+/// Produces a batch body into cURL's upload buffer, so it is never assembled in one string
+class BatchReader {
+public:
+    explicit BatchReader(const Batch& batch) : batch_(batch), record_(0), offset_(0) {}
+
+    std::size_t read(char* buffer, std::size_t capacity) {
+        std::size_t copied = 0;
+        while (copied < capacity && record_ < batch_.records.size()) {
+            std::string_view record = batch_.records[record_];
+            if (offset_ < record.size()) {
+                std::size_t count = std::min(capacity - copied, record.size() - offset_);
+                std::memcpy(buffer + copied, record.data() + offset_, count);
+                offset_ += count;
+                copied += count;
+            } else {
+                buffer[copied++] = '\n';
+                ++record_;
+                offset_ = 0;
+            }
+        }
+        return copied;
+    }
+
+    void restart() {
+        record_ = 0;
+        offset_ = 0;
+    }
+
+private:
+    const Batch& batch_;
+    std::size_t record_;
+    std::size_t offset_; ///< Bytes of the current record already copied
+};
+
+/// Batches prepared from one chunk of input
+struct PreparedChunk {
+    std::vector<Batch> batches;
+    std::size_t lines = 0;
+    std::size_t invalid = 0;
+    std::size_t first_invalid = 0; ///< 1-based line within the chunk (0: none)
+};
+
+/// Queue between the preparing thread and the senders; push blocks while full
+class BatchQueue {
+public:
+    explicit BatchQueue(std::size_t capacity) : capacity_(capacity), closed_(false) {}
+
+    void push(Batch batch) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_full_.wait(lock, [this] { return items_.size() < capacity_; });
+        items_.push_back(std::move(batch));
+        not_empty_.notify_one();
+    }
+
+    bool pop(Batch& batch) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [this] { return !items_.empty() || closed_; });
+        if (items_.empty()) {
+            return false;
+        }
+        batch = std::move(items_.front());
+        items_.pop_front();
+        not_full_.notify_one();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        not_empty_.notify_all();
+    }
+
+private:
+    std::size_t capacity_;
+    bool closed_;
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::deque<Batch> items_;
+};
+
+bool is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+PreparedChunk prepare_chunk(const char* begin, const char* end, const BulkConfig& config) {
+    PreparedChunk result;
+    Batch batch;
+    for (const char* line = begin; line < end;) {
+        const char* newline = static_cast<const char*>(std::memchr(line, '\n', static_cast<std::size_t>(end - line)));
+        const char* line_end = newline ? newline : end;
+        const char* next = newline ? newline + 1 : end;
+        ++result.lines;
+
+        while (line < line_end && is_blank(*line)) {
+            ++line;
+        }
+        while (line_end > line && is_blank(line_end[-1])) {
+            --line_end;
+        }
+        if (line == line_end) {
+            line = next;
+            continue;
+        }
+        // accept() validates without building a DOM; valid records are sent verbatim
+        if (!json::accept(line, line_end)) {
+            if (result.invalid++ == 0) {
+                result.first_invalid = result.lines;
+            }
+            line = next;
+            continue;
+        }
+
+        std::size_t length = static_cast<std::size_t>(line_end - line);
+        if (config.mode == BulkMode::PER_RECORD) {
+            Batch single;
+            single.records.emplace_back(line, length);
+            single.bytes = length;
+            result.batches.push_back(std::move(single));
+        } else {
+            if (!batch.records.empty() &&
+                (batch.records.size() >= config.batch_records || batch.bytes + length + 1 > config.batch_bytes)) {
+                result.batches.push_back(std::move(batch));
+                batch = Batch();
+            }
+            batch.records.emplace_back(line, length);
+            batch.bytes += length + 1;
+        }
+        line = next;
+    }
+    if (!batch.records.empty()) {
+        result.batches.push_back(std::move(batch));
+    }
+    return result;
+}
+
+std::vector<std::string> request_headers(const BulkConfig& config) {
+    std::vector<std::string> headers = config.headers;
+    bool has_content_type = std::any_of(headers.begin(), headers.end(), [](const std::string& header) {
+        return header.size() >= 13 && strncasecmp(header.c_str(), "Content-Type:", 13) == 0;
+    });
+    if (!has_content_type) {
+        headers.push_back(config.mode == BulkMode::PER_RECORD ? "Content-Type: application/json"
+                                                              : "Content-Type: application/x-ndjson");
+    }
+    return headers;
+}
+
+} // namespace
+
+BulkReport run_bulk_upload(const char* data, std::size_t size, const BulkConfig& config, WorkStealingPool& pool) {
+    if (config.url.empty()) {
+        throw std::invalid_argument("Bulk upload needs a URL");
+    }
+    if (config.concurrency <= 0 || config.batch_records == 0 || config.batch_bytes == 0) {
+        throw std::invalid_argument("Bulk upload concurrency and batch limits must be positive");
+    }
+
+    BulkReport report;
+    std::mutex report_mutex;
+    Clock::time_point start = Clock::now();
+    std::vector<std::string> headers = request_headers(config);
+
+    BatchQueue queue(static_cast<std::size_t>(config.concurrency) * 2);
+    std::vector<std::thread> senders;
+    for (int i = 0; i < config.concurrency; ++i) {
+        senders.emplace_back([&] {
+            BulkReport local;
+            HttpClient client(config.timeout_seconds);
+            client.set_max_retries(config.max_retries);
+            Batch batch;
+            while (queue.pop(batch)) {
+                HttpResponse response;
+                if (config.mode == BulkMode::PER_RECORD) {
+                    response = client.make_request(config.url, "POST", std::string(batch.records.front()), headers);
+                } else {
+                    BatchReader reader(batch);
+                    GeneratorBodySource body(
+                        [&reader](char* buffer, std::size_t capacity) { return reader.read(buffer, capacity); },
+                        [&reader] { reader.restart(); });
+                    response = client.make_request(config.url, "POST", body, headers);
+                }
+                ++local.requests;
+                local.bytes += batch.bytes;
+                if (!response.success) {
+                    ++local.failed_requests;
+                    local.failed_records += batch.records.size();
+                    ++local.errors[response.error_message.empty() ? "Unknown error" : response.error_message];
+                }
+            }
+            std::lock_guard<std::mutex> lock(report_mutex);
+            report.requests += local.requests;
+            report.bytes += local.bytes;
+            report.failed_requests += local.failed_requests;
+            report.failed_records += local.failed_records;
+            for (const auto& error : local.errors) {
+                report.errors[error.first] += error.second;
+            }
+        });
+    }
+
+    // Chunks are prepared a few at a time per worker and handed over in input order
+    std::size_t chunk_bytes = std::max(CHUNK_BYTES, config.batch_bytes);
+    std::size_t window = std::max<std::size_t>(pool.size(), 1) * 2;
+    std::deque<std::future<PreparedChunk>> pending;
+    std::uint64_t line_base = 0;
+    auto hand_over = [&] {
+        PreparedChunk chunk = pending.front().get();
+        pending.pop_front();
+        if (chunk.invalid > 0 && report.first_invalid_line == 0) {
+            report.first_invalid_line = line_base + chunk.first_invalid;
+        }
+        report.invalid_records += chunk.invalid;
+        line_base += chunk.lines;
+        for (Batch& batch : chunk.batches) {
+            report.records += batch.records.size(); // only this thread writes records
+            queue.push(std::move(batch));
+        }
+    };
+
+    try {
+        for (std::size_t offset = 0; offset < size;) {
+            std::size_t end = std::min(size, offset + chunk_bytes);
+            if (end < size) {
+                const char* newline = static_cast<const char*>(std::memchr(data + end, '\n', size - end));
+                end = newline ? static_cast<std::size_t>(newline - data) + 1 : size;
+            }
+            pending.push_back(pool.submit([data, offset, end, &config] {
+                return prepare_chunk(data + offset, data + end, config);
+            }));
+            offset = end;
+            if (pending.size() >= window) {
+                hand_over();
+            }
+        }
+        while (!pending.empty()) {
+            hand_over();
+        }
+    } catch (...) {
+        // Jobs reference the input and config; let them finish before unwinding
+        for (auto& job : pending) {
+            job.wait();
+        }
+        queue.close();
+        for (std::thread& sender : senders) {
+            sender.join();
+        }
+        throw;
+    }
+
+    queue.close();
+    for (std::thread& sender : senders) {
+        sender.join();
+    }
+    report.elapsed = Clock::now() - start;
+    return report;
+}
+
+BulkReport run_bulk_upload_file(const std::string& path, const BulkConfig& config, WorkStealingPool& pool) {
+    MappedFile file(path);
+    return run_bulk_upload(file.data(), file.size(), config, pool);
+}
+
+void print_bulk_report(const BulkReport& report, std::ostream& out) {
+    std::ios::fmtflags flags = out.flags();
+    out << std::fixed << std::setprecision(2);
+
+    double seconds = report.elapsed.count();
+    out << "Records:     " << report.records << " sent, " << report.failed_records << " failed, "
+        << report.invalid_records << " invalid";
+    if (report.first_invalid_line > 0) {
+        out << " (first at line " << report.first_invalid_line << ")";
+    }
+    out << "\n";
+    out << "Requests:    " << report.requests << " (" << report.failed_requests << " failed)\n";
+    out << "Elapsed:     " << seconds << " s\n";
+    if (seconds > 0) {
+        out << "Throughput:  " << static_cast<double>(report.records) / seconds << " records/s, "
+            << static_cast<double>(report.bytes) / seconds / (1 << 20) << " MiB/s\n";
+    }
+    for (const auto& error : report.errors) {
+        out << "Error:       " << error.first << " x" << error.second << "\n";
+    }
+    out.flags(flags);
+}
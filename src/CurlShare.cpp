@@ -0,0 +1,47 @@
+#include "CurlShare.h"
+#include <stdexcept>
+
+namespace {
+
+std::mutex g_global_mutex;
+std::shared_ptr<CurlShare> g_global;
+
+} // namespace
+
+CurlShare::CurlShare() {
+    share_ = curl_share_init();
+    if (!share_) {
+        throw std::runtime_error("Failed to initialize cURL share handle");
+    }
+    curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, &CurlShare::lock);
+    curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, &CurlShare::unlock);
+    curl_share_setopt(share_, CURLSHOPT_USERDATA, this);
+    curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+}
+
+CurlShare::~CurlShare() {
+    curl_share_cleanup(share_);
+}
+
+void CurlShare::attach(CURL* curl) const {
+    curl_easy_setopt(curl, CURLOPT_SHARE, share_);
+}
+
+void CurlShare::lock(CURL*, curl_lock_data data, curl_lock_access, void* userp) {
+    static_cast<CurlShare*>(userp)->mutexes_[data].lock();
+}
+
+void CurlShare::unlock(CURL*, curl_lock_data data, void* userp) {
+    static_cast<CurlShare*>(userp)->mutexes_[data].unlock();
+}
+
+void CurlShare::set_global(std::shared_ptr<CurlShare> share) {
+    std::lock_guard<std::mutex> lock(g_global_mutex);
+    g_global = std::move(share);
+}
+
+std::shared_ptr<CurlShare> CurlShare::global() {
+    std::lock_guard<std::mutex> lock(g_global_mutex);
+    return g_global;
+}
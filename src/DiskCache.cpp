@@ -0,0 +1,548 @@
+#include "DiskCache.h"
+#include "HttpUtils.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+struct DiskCache::IndexHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t active_segment; ///< Segment receiving appends
+    std::uint64_t slot_count;     ///< Power of two
+    std::uint64_t entries;
+    std::uint64_t tombstones;
+    std::uint64_t active_offset;  ///< Next append position in the active segment
+    std::uint64_t live_bytes;
+    std::uint64_t dead_bytes;
+    std::uint32_t first_segment;  ///< Segments below this belong to an older generation
+    std::uint32_t reserved;
+};
+
+struct DiskCache::Slot {
+    std::uint64_t hash;    ///< EMPTY_SLOT, TOMBSTONE or the key hash
+    std::uint64_t offset;  ///< Record position in its segment
+    std::int64_t expires;  ///< Milliseconds since the epoch
+    std::uint32_t segment;
+    std::uint32_t length;  ///< Record bytes, padding included
+};
+
+struct DiskCache::Cursor {
+    std::uint32_t segment;
+    std::uint64_t offset;
+};
+
+namespace {
+
+const char INDEX_MAGIC[8] = {'H', 'C', 'I', 'D', 'X', 'v', '0', '1'};
+const std::uint32_t INDEX_VERSION = 1;
+const std::uint64_t EMPTY_SLOT = 0;
+const std::uint64_t TOMBSTONE = 1;
+
+/// Fixed-size start of a segment record; key and body follow it
+struct RecordHeader {
+    std::uint32_t key_length;
+    std::uint32_t body_length;
+    std::int32_t status_code;
+    std::uint32_t reserved;
+    std::int64_t expires;
+};
+
+// Stable across builds and runs, unlike std::hash
+std::uint64_t hash_key(const std::string& key) {
+    std::uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : key) {
+        hash = (hash ^ c) * 1099511628211ull;
+    }
+    return hash <= TOMBSTONE ? hash + 2 : hash;
+}
+
+std::uint64_t round_up_pow2(std::uint64_t value) {
+    std::uint64_t result = 16;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+std::uint64_t align8(std::uint64_t value) {
+    return (value + 7) & ~std::uint64_t(7);
+}
+
+std::int64_t to_epoch_ms(std::chrono::system_clock::time_point when) {
+    if (when == std::chrono::system_clock::time_point::max()) {
+        return std::numeric_limits<std::int64_t>::max();
+    }
+    return std::chrono::duration_cast<std::chrono::milliseconds>(when.time_since_epoch()).count();
+}
+
+std::chrono::system_clock::time_point from_epoch_ms(std::int64_t ms) {
+    if (ms == std::numeric_limits<std::int64_t>::max()) {
+        return std::chrono::system_clock::time_point::max();
+    }
+    return std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::milliseconds(ms)));
+}
+
+std::int64_t now_ms() {
+    return to_epoch_ms(std::chrono::system_clock::now());
+}
+
+/// Segment id from "segment-N.dat", or 0 for other files
+std::uint32_t parse_segment_id(const std::string& name) {
+    const std::string prefix = "segment-";
+    const std::string suffix = ".dat";
+    if (name.size() <= prefix.size() + suffix.size() || name.compare(0, prefix.size(), prefix) != 0 ||
+        name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) {
+        return 0;
+    }
+    std::string digits = name.substr(prefix.size(), name.size() - prefix.size() - suffix.size());
+    if (digits.find_first_not_of("0123456789") != std::string::npos || digits.size() > 9) {
+        return 0;
+    }
+    return static_cast<std::uint32_t>(std::stoul(digits));
+}
+
+std::runtime_error io_error(const std::string& what, const std::string& path) {
+    return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+} // namespace
+
+DiskCache::DiskCache(DiskCacheConfig config)
+    : config_(std::move(config)), index_fd_(-1), index_map_(nullptr), index_size_(0), header_(nullptr), slots_(nullptr) {
+    if (config_.directory.empty()) {
+        throw std::runtime_error("DiskCache needs a directory");
+    }
+    std::error_code error;
+    std::filesystem::create_directories(config_.directory, error);
+    if (error) {
+        throw std::runtime_error("Cannot create cache directory " + config_.directory + ": " + error.message());
+    }
+    config_.index_slots = round_up_pow2(config_.index_slots);
+    config_.segment_bytes = std::max<std::uint64_t>(config_.segment_bytes, 4096);
+
+    try {
+        open_index();
+    } catch (...) {
+        for (auto& segment : segments_) {
+            close_segment(segment.second);
+        }
+        unmap_index();
+        throw;
+    }
+}
+
+DiskCache::~DiskCache() {
+    // Dirty pages reach the file through the page cache even without this
+    if (index_map_) {
+        ::msync(index_map_, index_size_, MS_ASYNC);
+    }
+    for (auto& segment : segments_) {
+        ::msync(segment.second.data, segment.second.size, MS_ASYNC);
+        close_segment(segment.second);
+    }
+    unmap_index();
+}
+
+std::string DiskCache::segment_path(std::uint32_t id) const {
+    return config_.directory + "/segment-" + std::to_string(id) + ".dat";
+}
+
+void DiskCache::open_index() {
+    std::string path = config_.directory + "/index";
+    bool valid = false;
+    if (std::filesystem::exists(path)) {
+        map_index(path);
+        valid = index_size_ >= sizeof(IndexHeader) &&
+                std::memcmp(header_->magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) == 0 &&
+                header_->version == INDEX_VERSION &&
+                header_->slot_count >= 16 && (header_->slot_count & (header_->slot_count - 1)) == 0 &&
+                index_size_ == sizeof(IndexHeader) + header_->slot_count * sizeof(Slot);
+        if (!valid) {
+            log_warning("Discarding incompatible cache index in " + config_.directory);
+            unmap_index();
+        }
+    }
+
+    if (!valid) {
+        IndexHeader state{};
+        state.slot_count = config_.index_slots;
+        state.first_segment = 1;
+        write_index(path, state, nullptr);
+        map_index(path);
+    }
+
+    // Segments outside this generation are leftovers from an interrupted compaction or a discarded index
+    for (const auto& file : std::filesystem::directory_iterator(config_.directory)) {
+        std::uint32_t id = parse_segment_id(file.path().filename().string());
+        if (id == 0) {
+            continue;
+        }
+        if (id < header_->first_segment || id > header_->active_segment) {
+            remove_segment_file(id);
+        } else {
+            open_segment(id, 0);
+        }
+    }
+}
+
+void DiskCache::write_index(const std::string& path, IndexHeader state, const Slot* slots) {
+    std::memcpy(state.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    state.version = INDEX_VERSION;
+    std::uint64_t size = sizeof(IndexHeader) + state.slot_count * sizeof(Slot);
+
+    // Written beside the live index and renamed over it, so readers see one generation or the other
+    std::string temp_path = path + ".tmp";
+    int fd = ::open(temp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw io_error("Cannot create", temp_path);
+    }
+    bool ok = ::ftruncate(fd, static_cast<off_t>(size)) == 0 &&
+              ::pwrite(fd, &state, sizeof(state), 0) == static_cast<ssize_t>(sizeof(state));
+    if (ok && slots) {
+        std::uint64_t bytes = state.slot_count * sizeof(Slot);
+        const char* data = reinterpret_cast<const char*>(slots);
+        for (std::uint64_t done = 0; ok && done < bytes;) {
+            ssize_t written = ::pwrite(fd, data + done, bytes - done, static_cast<off_t>(sizeof(IndexHeader) + done));
+            ok = written > 0;
+            done += ok ? static_cast<std::uint64_t>(written) : 0;
+        }
+    }
+    ok = ok && ::fdatasync(fd) == 0;
+    ::close(fd);
+    if (!ok || ::rename(temp_path.c_str(), path.c_str()) != 0) {
+        std::runtime_error error = io_error("Cannot write", temp_path);
+        ::unlink(temp_path.c_str());
+        throw error;
+    }
+}
+
+void DiskCache::map_index(const std::string& path) {
+    index_fd_ = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if (index_fd_ < 0) {
+        throw io_error("Cannot open", path);
+    }
+    struct stat info;
+    if (::fstat(index_fd_, &info) != 0) {
+        throw io_error("Cannot stat", path);
+    }
+    index_size_ = static_cast<std::uint64_t>(info.st_size);
+    if (index_size_ < sizeof(IndexHeader)) {
+        return; // rejected by the caller
+    }
+    void* mapping = ::mmap(nullptr, index_size_, PROT_READ | PROT_WRITE, MAP_SHARED, index_fd_, 0);
+    if (mapping == MAP_FAILED) {
+        throw io_error("Cannot map", path);
+    }
+    index_map_ = static_cast<char*>(mapping);
+    header_ = reinterpret_cast<IndexHeader*>(index_map_);
+    slots_ = reinterpret_cast<Slot*>(index_map_ + sizeof(IndexHeader));
+}
+
+void DiskCache::unmap_index() {
+    if (index_map_) {
+        ::munmap(index_map_, index_size_);
+    }
+    if (index_fd_ >= 0) {
+        ::close(index_fd_);
+    }
+    index_fd_ = -1;
+    index_map_ = nullptr;
+    index_size_ = 0;
+    header_ = nullptr;
+    slots_ = nullptr;
+}
+
+DiskCache::Segment& DiskCache::open_segment(std::uint32_t id, std::uint64_t create_size) {
+    std::string path = segment_path(id);
+    auto existing = segments_.find(id);
+    if (existing != segments_.end()) {
+        close_segment(existing->second); // stale mapping from a failed compaction
+    }
+    Segment segment;
+    segment.fd = ::open(path.c_str(), create_size ? O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC : O_RDWR | O_CLOEXEC, 0644);
+    if (segment.fd < 0) {
+        throw io_error("Cannot open", path);
+    }
+    struct stat info;
+    // New segments are sparse; untouched space costs no disk
+    if ((create_size && ::ftruncate(segment.fd, static_cast<off_t>(create_size)) != 0) || ::fstat(segment.fd, &info) != 0) {
+        std::runtime_error error = io_error("Cannot size", path);
+        ::close(segment.fd);
+        throw error;
+    }
+    segment.size = static_cast<std::uint64_t>(info.st_size);
+    if (segment.size > 0) {
+        void* mapping = ::mmap(nullptr, segment.size, PROT_READ | PROT_WRITE, MAP_SHARED, segment.fd, 0);
+        if (mapping == MAP_FAILED) {
+            std::runtime_error error = io_error("Cannot map", path);
+            ::close(segment.fd);
+            throw error;
+        }
+        segment.data = static_cast<char*>(mapping);
+    }
+    return segments_[id] = segment;
+}
+
+void DiskCache::close_segment(Segment& segment) {
+    if (segment.data) {
+        ::munmap(segment.data, segment.size);
+        segment.data = nullptr;
+    }
+    if (segment.fd >= 0) {
+        ::close(segment.fd);
+        segment.fd = -1;
+    }
+}
+
+void DiskCache::remove_segment_file(std::uint32_t id) {
+    auto found = segments_.find(id);
+    if (found != segments_.end()) {
+        close_segment(found->second);
+        segments_.erase(found);
+    }
+    ::unlink(segment_path(id).c_str());
+}
+
+const char* DiskCache::record_at(const Slot& slot) const {
+    auto found = segments_.find(slot.segment);
+    if (found == segments_.end() || slot.length < sizeof(RecordHeader) ||
+        slot.offset > found->second.size || found->second.size - slot.offset < slot.length) {
+        return nullptr;
+    }
+    return found->second.data + slot.offset;
+}
+
+DiskCache::Slot* DiskCache::find_slot(const std::string& key, std::uint64_t hash, Slot** free_slot) {
+    std::uint64_t mask = header_->slot_count - 1;
+    for (std::uint64_t probe = 0, i = hash & mask; probe < header_->slot_count; ++probe, i = (i + 1) & mask) {
+        Slot& slot = slots_[i];
+        if (slot.hash == EMPTY_SLOT || slot.hash == TOMBSTONE) {
+            if (free_slot && !*free_slot) {
+                *free_slot = &slot;
+            }
+            if (slot.hash == EMPTY_SLOT) {
+                return nullptr;
+            }
+            continue;
+        }
+        if (slot.hash != hash) {
+            continue;
+        }
+        const char* record = record_at(slot);
+        RecordHeader header;
+        if (record) {
+            std::memcpy(&header, record, sizeof(header));
+            if (header.key_length == key.size() && sizeof(header) + key.size() <= slot.length &&
+                std::memcmp(record + sizeof(header), key.data(), key.size()) == 0) {
+                return &slot;
+            }
+        }
+    }
+    return nullptr;
+}
+
+char* DiskCache::allocate(std::uint64_t length, Cursor& cursor, Slot& location) {
+    auto active = segments_.find(cursor.segment);
+    if (active == segments_.end() || cursor.offset > active->second.size || active->second.size - cursor.offset < length) {
+        ++cursor.segment;
+        open_segment(cursor.segment, std::max(config_.segment_bytes, length));
+        cursor.offset = 0;
+        active = segments_.find(cursor.segment);
+    }
+    location.segment = cursor.segment;
+    location.offset = cursor.offset;
+    location.length = static_cast<std::uint32_t>(length);
+    cursor.offset += length;
+    return active->second.data + location.offset;
+}
+
+void DiskCache::kill_slot(Slot& slot) {
+    header_->live_bytes -= slot.length;
+    header_->dead_bytes += slot.length;
+    header_->entries -= 1;
+    header_->tombstones += 1;
+    slot.hash = TOMBSTONE;
+}
+
+bool DiskCache::get(const std::string& key, CachedResponse& entry) {
+    std::uint64_t hash = hash_key(key);
+    std::lock_guard<std::mutex> lock(mutex_);
+    Slot* slot = find_slot(key, hash, nullptr);
+    if (!slot) {
+        return false;
+    }
+    if (slot->expires <= now_ms()) {
+        kill_slot(*slot);
+        return false;
+    }
+    const char* record = record_at(*slot);
+    RecordHeader header;
+    std::memcpy(&header, record, sizeof(header));
+    if (sizeof(header) + static_cast<std::uint64_t>(header.key_length) + header.body_length > slot->length) {
+        log_warning("Dropping corrupt cache record for " + key);
+        kill_slot(*slot);
+        return false;
+    }
+    entry.status_code = header.status_code;
+    entry.body.assign(record + sizeof(header) + header.key_length, header.body_length);
+    entry.expires = from_epoch_ms(slot->expires);
+    return true;
+}
+
+void DiskCache::put(const std::string& key, const CachedResponse& entry) {
+    std::uint64_t length = align8(sizeof(RecordHeader) + key.size() + entry.body.size());
+    if (length > std::numeric_limits<std::uint32_t>::max() || length > config_.max_bytes) {
+        return;
+    }
+    std::uint64_t hash = hash_key(key);
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Keep the index at most 3/4 full so probe sequences stay short and always end
+    if ((header_->entries + header_->tombstones + 1) * 4 > header_->slot_count * 3) {
+        compact_locked(config_.max_bytes);
+    }
+
+    Cursor cursor{header_->active_segment, header_->active_offset};
+    Slot location{};
+    char* record = allocate(length, cursor, location);
+    RecordHeader record_header{};
+    record_header.key_length = static_cast<std::uint32_t>(key.size());
+    record_header.body_length = static_cast<std::uint32_t>(entry.body.size());
+    record_header.status_code = entry.status_code;
+    record_header.expires = to_epoch_ms(entry.expires);
+    std::memcpy(record, &record_header, sizeof(record_header));
+    std::memcpy(record + sizeof(record_header), key.data(), key.size());
+    std::memcpy(record + sizeof(record_header) + key.size(), entry.body.data(), entry.body.size());
+    header_->active_segment = cursor.segment;
+    header_->active_offset = cursor.offset;
+
+    // The record is complete before the slot points at it
+    location.hash = hash;
+    location.expires = record_header.expires;
+    Slot* free_slot = nullptr;
+    Slot* slot = find_slot(key, hash, &free_slot);
+    if (slot) {
+        header_->live_bytes -= slot->length;
+        header_->dead_bytes += slot->length;
+    } else {
+        slot = free_slot;
+        if (slot->hash == TOMBSTONE) {
+            header_->tombstones -= 1;
+        }
+        header_->entries += 1;
+    }
+    *slot = location;
+    header_->live_bytes += length;
+
+    if (header_->live_bytes + header_->dead_bytes > config_.max_bytes) {
+        compact_locked(config_.max_bytes / 4 * 3);
+    } else if (header_->dead_bytes > header_->live_bytes && header_->dead_bytes > config_.segment_bytes) {
+        compact_locked(config_.max_bytes);
+    }
+}
+
+void DiskCache::erase(const std::string& key) {
+    std::uint64_t hash = hash_key(key);
+    std::lock_guard<std::mutex> lock(mutex_);
+    Slot* slot = find_slot(key, hash, nullptr);
+    if (slot) {
+        kill_slot(*slot);
+    }
+}
+
+void DiskCache::compact() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    compact_locked(config_.max_bytes);
+}
+
+void DiskCache::compact_locked(std::uint64_t keep_bytes) {
+    std::int64_t now = now_ms();
+    std::vector<Slot> live;
+    live.reserve(header_->entries);
+    for (std::uint64_t i = 0; i < header_->slot_count; ++i) {
+        if (slots_[i].hash > TOMBSTONE && slots_[i].expires > now && record_at(slots_[i])) {
+            live.push_back(slots_[i]);
+        }
+    }
+
+    // Keep the newest entries that fit, then copy them oldest first to preserve age order
+    std::sort(live.begin(), live.end(), [](const Slot& a, const Slot& b) {
+        return a.segment != b.segment ? a.segment > b.segment : a.offset > b.offset;
+    });
+    std::uint64_t kept_bytes = 0;
+    std::size_t kept = 0;
+    while (kept < live.size() && kept_bytes + live[kept].length <= keep_bytes) {
+        kept_bytes += live[kept++].length;
+    }
+    live.resize(kept);
+    std::reverse(live.begin(), live.end());
+
+    IndexHeader state{};
+    state.slot_count = std::max(config_.index_slots, round_up_pow2(live.size() * 2));
+    state.first_segment = header_->active_segment + 1;
+    state.entries = live.size();
+    state.live_bytes = kept_bytes;
+    std::vector<Slot> slots(state.slot_count);
+    std::uint64_t mask = state.slot_count - 1;
+    Cursor cursor{header_->active_segment, std::numeric_limits<std::uint64_t>::max()};
+    for (const Slot& old_slot : live) {
+        Slot moved = old_slot;
+        char* record = allocate(old_slot.length, cursor, moved);
+        std::memcpy(record, record_at(old_slot), old_slot.length);
+        std::uint64_t i = moved.hash & mask;
+        while (slots[i].hash != EMPTY_SLOT) {
+            i = (i + 1) & mask;
+        }
+        slots[i] = moved;
+    }
+    state.active_segment = live.empty() ? header_->active_segment : cursor.segment;
+    state.active_offset = live.empty() ? 0 : cursor.offset;
+
+    // New segments must be durable before the index that references them
+    for (auto& segment : segments_) {
+        if (segment.first >= state.first_segment) {
+            ::msync(segment.second.data, segment.second.size, MS_SYNC);
+        }
+    }
+    std::string path = config_.directory + "/index";
+    write_index(path, state, slots.data());
+    unmap_index();
+    map_index(path);
+
+    std::vector<std::uint32_t> old_segments;
+    for (const auto& segment : segments_) {
+        if (segment.first < state.first_segment) {
+            old_segments.push_back(segment.first);
+        }
+    }
+    for (std::uint32_t id : old_segments) {
+        remove_segment_file(id);
+    }
+}
+
+void DiskCache::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& segment : segments_) {
+        ::msync(segment.second.data, segment.second.size, MS_SYNC);
+    }
+    ::msync(index_map_, index_size_, MS_SYNC);
+}
+
+std::uint64_t DiskCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return header_->entries;
+}
+
+std::uint64_t DiskCache::disk_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return header_->live_bytes + header_->dead_bytes;
+}
@@ -0,0 +1,198 @@
+#include "EventLoop.h"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+uint32_t to_epoll_events(int events) {
+    uint32_t result = 0;
+    if (events & EventLoop::READABLE) result |= EPOLLIN;
+    if (events & EventLoop::WRITABLE) result |= EPOLLOUT;
+    return result;
+}
+
+int from_epoll_events(uint32_t events) {
+    int result = 0;
+    if (events & (EPOLLIN | EPOLLHUP)) result |= EventLoop::READABLE;
+    if (events & EPOLLOUT) result |= EventLoop::WRITABLE;
+    if (events & EPOLLERR) result |= EventLoop::ERROR;
+    return result;
+}
+
+void drain_fd(int fd) {
+    uint64_t value;
+    while (::read(fd, &value, sizeof(value)) == sizeof(value)) {
+    }
+}
+
+} // namespace
+
+EpollEventLoop::EpollEventLoop()
+    : epoll_fd_(-1), event_fd_(-1), timer_fd_(-1), next_timer_id_(1), armed_for_(Clock::time_point::max()) {
+    epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    event_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    timer_fd_ = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (epoll_fd_ < 0 || event_fd_ < 0 || timer_fd_ < 0) {
+        std::string reason = std::strerror(errno);
+        if (epoll_fd_ >= 0) ::close(epoll_fd_);
+        if (event_fd_ >= 0) ::close(event_fd_);
+        if (timer_fd_ >= 0) ::close(timer_fd_);
+        throw std::runtime_error("Failed to create epoll event loop: " + reason);
+    }
+
+    for (int fd : {event_fd_, timer_fd_}) {
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev);
+    }
+}
+
+EpollEventLoop::~EpollEventLoop() {
+    ::close(timer_fd_);
+    ::close(event_fd_);
+    ::close(epoll_fd_);
+}
+
+void EpollEventLoop::watch(int fd, int events, FdCallback callback) {
+    epoll_event ev{};
+    ev.events = to_epoll_events(events);
+    ev.data.fd = fd;
+
+    auto it = watches_.find(fd);
+    if (it == watches_.end()) {
+        if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            throw std::runtime_error("epoll_ctl ADD failed: " + std::string(std::strerror(errno)));
+        }
+        watches_.emplace(fd, std::make_shared<Watch>(Watch{events, std::move(callback)}));
+        return;
+    }
+
+    if (it->second->events != events) {
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev);
+    }
+    // Replace rather than mutate: a dispatch in progress keeps the old callback alive
+    it->second = std::make_shared<Watch>(Watch{events, std::move(callback)});
+}
+
+void EpollEventLoop::unwatch(int fd) {
+    auto it = watches_.find(fd);
+    if (it == watches_.end()) {
+        return;
+    }
+    // May fail if the descriptor is already closed; epoll drops it on close anyway
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    watches_.erase(it);
+}
+
+EventLoop::TimerId EpollEventLoop::add_timer(std::chrono::milliseconds delay, Callback callback) {
+    TimerId id = next_timer_id_++;
+    Clock::time_point deadline = Clock::now() + delay;
+    timers_.emplace(TimerKey(deadline, id), std::move(callback));
+    timer_deadlines_.emplace(id, deadline);
+    if (deadline < armed_for_) {
+        arm_timer_fd();
+    }
+    return id;
+}
+
+void EpollEventLoop::cancel_timer(TimerId id) {
+    auto it = timer_deadlines_.find(id);
+    if (it == timer_deadlines_.end()) {
+        return;
+    }
+    timers_.erase(TimerKey(it->second, id));
+    timer_deadlines_.erase(it);
+}
+
+void EpollEventLoop::post(Callback callback) {
+    {
+        std::lock_guard<std::mutex> lock(posted_mutex_);
+        posted_.push_back(std::move(callback));
+    }
+    uint64_t one = 1;
+    ssize_t written = ::write(event_fd_, &one, sizeof(one));
+    (void)written; // EAGAIN means the counter is already non-zero
+}
+
+void EpollEventLoop::arm_timer_fd() {
+    itimerspec spec{};
+    if (timers_.empty()) {
+        armed_for_ = Clock::time_point::max();
+    } else {
+        armed_for_ = timers_.begin()->first.first;
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(armed_for_.time_since_epoch()).count();
+        if (ns <= 0) {
+            ns = 1; // a zero it_value would disarm the timer
+        }
+        spec.it_value.tv_sec = static_cast<time_t>(ns / 1000000000);
+        spec.it_value.tv_nsec = static_cast<long>(ns % 1000000000);
+    }
+    // steady_clock is CLOCK_MONOTONIC on Linux
+    ::timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &spec, nullptr);
+}
+
+void EpollEventLoop::fire_due_timers() {
+    // Only timers that exist now: a 0ms timer added by a callback waits for the next turn
+    TimerId last_id = next_timer_id_;
+    Clock::time_point now = Clock::now();
+    auto it = timers_.begin();
+    while (it != timers_.end() && it->first.first <= now) {
+        if (it->first.second >= last_id) {
+            ++it;
+            continue;
+        }
+        Callback callback = std::move(it->second);
+        timer_deadlines_.erase(it->first.second);
+        timers_.erase(it);
+        callback();
+        it = timers_.begin();
+    }
+}
+
+void EpollEventLoop::run_posted() {
+    std::vector<Callback> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(posted_mutex_);
+        callbacks.swap(posted_);
+    }
+    for (auto& callback : callbacks) {
+        callback();
+    }
+}
+
+void EpollEventLoop::run_once(int max_wait_ms) {
+    {
+        std::lock_guard<std::mutex> lock(posted_mutex_);
+        if (!posted_.empty()) {
+            max_wait_ms = 0;
+        }
+    }
+
+    epoll_event events[64];
+    int count = ::epoll_wait(epoll_fd_, events, 64, max_wait_ms);
+
+    for (int i = 0; i < count; ++i) {
+        int fd = events[i].data.fd;
+        if (fd == event_fd_ || fd == timer_fd_) {
+            drain_fd(fd);
+            continue;
+        }
+        auto it = watches_.find(fd);
+        if (it == watches_.end()) {
+            continue; // unwatched by an earlier callback in this batch
+        }
+        std::shared_ptr<Watch> watch = it->second;
+        watch->callback(from_epoll_events(events[i].events));
+    }
+
+    fire_due_timers();
+    run_posted();
+    arm_timer_fd();
+}
@@ -0,0 +1,483 @@
+#include "HttpTransport.h"
+#include "HttpUtils.h"
+#include "PerfCounters.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+const char RECORDING_MAGIC[4] = {'H', 'T', 'R', 'C'};
+const std::uint32_t RECORDING_VERSION = 1;
+
+/// Fixed-size part of a record; the six strings follow it
+struct RecordHeader {
+    std::uint32_t method_length;
+    std::uint32_t url_length;
+    std::uint32_t data_length;
+    std::uint32_t body_length;
+    std::uint32_t error_length;
+    std::int32_t code;
+    std::int32_t status_code;
+    std::uint32_t headers_length; ///< Response headers as name\0value\0 pairs
+    std::uint64_t latency_us;
+};
+static_assert(sizeof(RecordHeader) == 40, "RecordHeader must have no padding bytes");
+
+void append_bytes(std::string& buffer, const void* bytes, std::size_t length) {
+    buffer.append(static_cast<const char*>(bytes), length);
+}
+
+/// Copies the status code and phase timings of a finished transfer
+void read_transfer_info(CURL* curl, TransportResult& result) {
+    long http_code = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+    result.status_code = static_cast<int>(http_code);
+
+    curl_off_t value = 0;
+    if (curl_easy_getinfo(curl, CURLINFO_NAMELOOKUP_TIME_T, &value) == CURLE_OK) {
+        result.timings.dns_us = value;
+    }
+    if (curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME_T, &value) == CURLE_OK) {
+        result.timings.connect_us = value;
+    }
+    if (curl_easy_getinfo(curl, CURLINFO_APPCONNECT_TIME_T, &value) == CURLE_OK) {
+        result.timings.tls_us = value;
+    }
+    if (curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &value) == CURLE_OK) {
+        result.timings.first_byte_us = value;
+    }
+    if (curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &value) == CURLE_OK) {
+        result.timings.total_us = value;
+    }
+    read_response_headers(curl, result.headers);
+}
+
+/// Write target of CurlTransport::perform_download
+struct DownloadTarget {
+    CURL* curl;
+    ResponseSink* sink;
+    std::string* error_body; ///< Receives non-2xx bodies
+    std::string error = {};  ///< Why the sink rejected a block
+    std::uint64_t written = 0;
+    bool started = false;
+    bool to_sink = false;
+};
+
+size_t download_write_callback(void* contents, size_t size, size_t nmemb, void* userp) {
+    auto* target = static_cast<DownloadTarget*>(userp);
+    size_t total = size * nmemb;
+    if (!target->started) {
+        // Headers are complete once the first body block arrives
+        target->started = true;
+        long http_code = 0;
+        curl_easy_getinfo(target->curl, CURLINFO_RESPONSE_CODE, &http_code);
+        target->to_sink = http_code >= 200 && http_code < 300;
+        curl_off_t length = -1;
+        curl_easy_getinfo(target->curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length);
+        if (target->to_sink && length > 0) {
+            try {
+                target->sink->reserve(static_cast<std::uint64_t>(length));
+            } catch (const std::exception& e) {
+                target->error = e.what();
+                return 0;
+            }
+        }
+    }
+    if (!target->to_sink) {
+        target->error_body->append(static_cast<char*>(contents), total);
+        return total;
+    }
+    try {
+        target->sink->write(static_cast<const char*>(contents), total);
+    } catch (const std::exception& e) {
+        // Exceptions must not unwind through libcurl; 0 fails with CURLE_WRITE_ERROR
+        target->error = e.what();
+        return 0;
+    }
+    target->written += total;
+    return total;
+}
+
+} // namespace
+
+TransportResult HttpTransport::perform_streaming(const std::string& url,
+                                                 const std::string& method,
+                                                 RequestBodySource& body,
+                                                 const std::vector<std::string>& headers,
+                                                 const RequestOptions& options) {
+    std::string data;
+    if (body.size() > 0) {
+        data.reserve(static_cast<std::size_t>(body.size()));
+    }
+    char buffer[16384];
+    while (std::size_t count = body.read(buffer, sizeof(buffer))) {
+        data.append(buffer, count);
+    }
+    return perform(url, method, data, headers, options);
+}
+
+TransportResult HttpTransport::perform_download(const std::string& url,
+                                                ResponseSink& sink,
+                                                const std::vector<std::string>& headers,
+                                                const RequestOptions& options) {
+    TransportResult result = perform(url, "GET", "", headers, options);
+    if (result.code == CURLE_OK && result.status_code >= 200 && result.status_code < 300) {
+        sink.reserve(result.body.size());
+        sink.write(result.body.data(), result.body.size());
+        result.sink_bytes = result.body.size();
+        result.body.clear();
+    }
+    return result;
+}
+
+CurlTransport::CurlTransport(int timeout_seconds) : timeout_seconds_(timeout_seconds), share_(CurlShare::global()) {
+    curl_ = curl_easy_init();
+    if (!curl_) {
+        throw std::runtime_error("Failed to initialize cURL");
+    }
+    reset_handle();
+}
+
+CurlTransport::~CurlTransport() {
+    if (curl_) {
+        curl_easy_cleanup(curl_);
+    }
+}
+
+void CurlTransport::reset_handle() {
+    // Reset cURL options; the handle keeps its connection cache
+    curl_easy_reset(curl_);
+    setup_common_curl_options(curl_, timeout_seconds_);
+    if (share_) {
+        share_->attach(curl_);
+    }
+}
+
+TransportResult CurlTransport::perform(const std::string& url,
+                                       const std::string& method,
+                                       const std::string& data,
+                                       const std::vector<std::string>& headers,
+                                       const RequestOptions& options) {
+    TransportResult result;
+    struct curl_slist* header_list;
+    {
+        PhaseScope phase(RequestPhase::SETUP);
+        reset_handle();
+        header_list = build_header_list(headers);
+        setup_request_options(curl_, url, method, data, header_list, &result.body);
+        setup_budget_options(curl_, timeout_seconds_, options);
+        setup_socket_options(curl_, options);
+    }
+    {
+        PhaseScope phase(RequestPhase::PERFORM);
+        result.code = curl_easy_perform(curl_);
+    }
+
+    PhaseScope phase(RequestPhase::PARSE);
+    read_transfer_info(curl_, result);
+
+    if (header_list) {
+        curl_slist_free_all(header_list);
+    }
+    if (result.code != CURLE_OK) {
+        result.error_message = curl_easy_strerror(result.code);
+    }
+    return result;
+}
+
+TransportResult CurlTransport::perform_streaming(const std::string& url,
+                                                 const std::string& method,
+                                                 RequestBodySource& body,
+                                                 const std::vector<std::string>& headers,
+                                                 const RequestOptions& options) {
+    TransportResult result;
+    struct curl_slist* header_list;
+    {
+        PhaseScope phase(RequestPhase::SETUP);
+        reset_handle();
+
+        // An empty Expect header skips the 100-continue round trip before the body
+        std::vector<std::string> stream_headers = headers;
+        stream_headers.push_back("Expect:");
+        if (body.size() < 0) {
+            stream_headers.push_back("Transfer-Encoding: chunked");
+        }
+        header_list = build_header_list(stream_headers);
+        setup_streaming_request_options(curl_, url, method, body, header_list, &result.body);
+        setup_budget_options(curl_, timeout_seconds_, options);
+        setup_socket_options(curl_, options);
+    }
+    {
+        PhaseScope phase(RequestPhase::PERFORM);
+        result.code = curl_easy_perform(curl_);
+    }
+
+    PhaseScope phase(RequestPhase::PARSE);
+    read_transfer_info(curl_, result);
+
+    curl_slist_free_all(header_list);
+    if (result.code != CURLE_OK) {
+        result.error_message = curl_easy_strerror(result.code);
+    }
+    return result;
+}
+
+TransportResult CurlTransport::perform_download(const std::string& url,
+                                                ResponseSink& sink,
+                                                const std::vector<std::string>& headers,
+                                                const RequestOptions& options) {
+    TransportResult result;
+    struct curl_slist* header_list;
+    DownloadTarget target{curl_, &sink, &result.body};
+    {
+        PhaseScope phase(RequestPhase::SETUP);
+        reset_handle();
+        header_list = build_header_list(headers);
+        setup_request_options(curl_, url, "GET", "", header_list, &result.body);
+        curl_easy_setopt(curl_, CURLOPT_WRITEFUNCTION, &download_write_callback);
+        curl_easy_setopt(curl_, CURLOPT_WRITEDATA, &target);
+        setup_budget_options(curl_, timeout_seconds_, options);
+        setup_socket_options(curl_, options);
+    }
+    {
+        PhaseScope phase(RequestPhase::PERFORM);
+        result.code = curl_easy_perform(curl_);
+    }
+
+    PhaseScope phase(RequestPhase::PARSE);
+    read_transfer_info(curl_, result);
+    result.sink_bytes = target.written;
+
+    if (header_list) {
+        curl_slist_free_all(header_list);
+    }
+    if (result.code != CURLE_OK) {
+        result.error_message = target.error.empty() ? curl_easy_strerror(result.code) : target.error;
+    }
+    return result;
+}
+
+TransportRecorder::TransportRecorder(const std::string& path) : count_(0) {
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        throw std::runtime_error("Cannot create recording " + path + ": " + std::strerror(errno));
+    }
+    std::fwrite(RECORDING_MAGIC, 1, sizeof(RECORDING_MAGIC), file_);
+    std::fwrite(&RECORDING_VERSION, sizeof(RECORDING_VERSION), 1, file_);
+    std::fflush(file_);
+}
+
+TransportRecorder::~TransportRecorder() {
+    std::fclose(file_);
+}
+
+void TransportRecorder::append(const std::string& method,
+                               const std::string& url,
+                               const std::string& data,
+                               const TransportResult& result,
+                               std::chrono::microseconds latency) {
+    std::string headers;
+    for (const auto& entry : result.headers) {
+        headers += entry.first;
+        headers += '\0';
+        headers += entry.second;
+        headers += '\0';
+    }
+
+    RecordHeader header{};
+    header.method_length = static_cast<std::uint32_t>(method.size());
+    header.url_length = static_cast<std::uint32_t>(url.size());
+    header.data_length = static_cast<std::uint32_t>(data.size());
+    header.body_length = static_cast<std::uint32_t>(result.body.size());
+    header.error_length = static_cast<std::uint32_t>(result.error_message.size());
+    header.code = static_cast<std::int32_t>(result.code);
+    header.status_code = result.status_code;
+    header.headers_length = static_cast<std::uint32_t>(headers.size());
+    header.latency_us = static_cast<std::uint64_t>(std::max<std::int64_t>(0, latency.count()));
+
+    // One fwrite per record keeps records from concurrent clients whole
+    std::string record;
+    record.reserve(sizeof(header) + method.size() + url.size() + data.size() + result.body.size() +
+                   result.error_message.size() + headers.size());
+    append_bytes(record, &header, sizeof(header));
+    record += method;
+    record += url;
+    record += data;
+    record += result.body;
+    record += result.error_message;
+    record += headers;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (std::fwrite(record.data(), 1, record.size(), file_) != record.size() || std::fflush(file_) != 0) {
+        log_error("Failed to write recording: " + std::string(std::strerror(errno)));
+        return;
+    }
+    ++count_;
+}
+
+std::size_t TransportRecorder::count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return count_;
+}
+
+RecordingTransport::RecordingTransport(std::shared_ptr<HttpTransport> inner, std::shared_ptr<TransportRecorder> recorder)
+    : inner_(std::move(inner)), recorder_(std::move(recorder)) {}
+
+TransportResult RecordingTransport::perform(const std::string& url,
+                                            const std::string& method,
+                                            const std::string& data,
+                                            const std::vector<std::string>& headers,
+                                            const RequestOptions& options) {
+    auto start = std::chrono::steady_clock::now();
+    TransportResult result = inner_->perform(url, method, data, headers, options);
+    auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    recorder_->append(method, url, data, result, latency);
+    return result;
+}
+
+ReplayTransport::ReplayTransport(const std::string& path, ReplayTiming timing)
+    : file_(path), timing_(timing), size_(0) {
+    const char* cursor = file_.data();
+    const char* end = cursor + file_.size();
+
+    std::uint32_t version = 0;
+    if (file_.size() < sizeof(RECORDING_MAGIC) + sizeof(version) ||
+        std::memcmp(cursor, RECORDING_MAGIC, sizeof(RECORDING_MAGIC)) != 0) {
+        throw std::runtime_error(path + " is not an HTTP recording");
+    }
+    std::memcpy(&version, cursor + sizeof(RECORDING_MAGIC), sizeof(version));
+    if (version != RECORDING_VERSION) {
+        throw std::runtime_error(path + " has unsupported recording version " + std::to_string(version));
+    }
+    cursor += sizeof(RECORDING_MAGIC) + sizeof(version);
+
+    // Strings stay in the mapping; only the lookup keys are copied
+    while (cursor < end) {
+        RecordHeader header;
+        if (static_cast<std::size_t>(end - cursor) < sizeof(header)) {
+            break;
+        }
+        std::memcpy(&header, cursor, sizeof(header));
+        std::size_t payload = static_cast<std::size_t>(header.method_length) + header.url_length +
+                              header.data_length + header.body_length + header.error_length +
+                              header.headers_length;
+        if (static_cast<std::size_t>(end - cursor) - sizeof(header) < payload) {
+            break;
+        }
+        const char* text = cursor + sizeof(header);
+        std::string_view method(text, header.method_length);
+        text += header.method_length;
+        std::string_view url(text, header.url_length);
+        text += header.url_length;
+        std::string_view data(text, header.data_length);
+        text += header.data_length;
+
+        Exchange exchange;
+        exchange.body = std::string_view(text, header.body_length);
+        text += header.body_length;
+        exchange.error_message = std::string_view(text, header.error_length);
+        text += header.error_length;
+        exchange.headers = std::string_view(text, header.headers_length);
+        exchange.code = static_cast<CURLcode>(header.code);
+        exchange.status_code = header.status_code;
+        exchange.latency = std::chrono::microseconds(header.latency_us);
+
+        entries_[key(method, url, data)].exchanges.push_back(exchange);
+        ++size_;
+        cursor += sizeof(header) + payload;
+    }
+    if (cursor < end) {
+        log_warning(path + " ends with a truncated record; replaying the first " + std::to_string(size_) + " exchanges");
+    }
+}
+
+std::string ReplayTransport::key(std::string_view method, std::string_view url, std::string_view data) {
+    std::string result;
+    result.reserve(method.size() + url.size() + data.size() + 2);
+    result.append(method);
+    result += ' ';
+    result.append(url);
+    result += '\n';
+    result.append(data);
+    return result;
+}
+
+TransportResult ReplayTransport::perform(const std::string& url,
+                                         const std::string& method,
+                                         const std::string& data,
+                                         const std::vector<std::string>& /* headers */,
+                                         const RequestOptions& options) {
+    TransportResult result;
+
+    const Exchange* exchange = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto found = entries_.find(key(method, url, data));
+        if (found != entries_.end()) {
+            Entry& entry = found->second;
+            exchange = &entry.exchanges[entry.next];
+            entry.next = (entry.next + 1) % entry.exchanges.size();
+        }
+    }
+    if (!exchange) {
+        result.code = CURLE_READ_ERROR;
+        result.error_message = "No recorded response for " + method + " " + url;
+        return result;
+    }
+
+    if (timing_ == ReplayTiming::ORIGINAL && exchange->latency.count() > 0) {
+        auto wait = std::chrono::ceil<std::chrono::milliseconds>(exchange->latency);
+        bool cut_by_deadline = options.deadline.is_set() && options.deadline.remaining() < wait;
+        if (cut_by_deadline) {
+            wait = options.deadline.remaining();
+        }
+        if (options.cancellation.wait_for(wait)) {
+            result.code = CURLE_ABORTED_BY_CALLBACK;
+            result.error_message = curl_easy_strerror(result.code);
+            return result;
+        }
+        if (cut_by_deadline) {
+            result.code = CURLE_OPERATION_TIMEDOUT;
+            result.error_message = curl_easy_strerror(result.code);
+            return result;
+        }
+    }
+
+    result.code = exchange->code;
+    result.status_code = exchange->status_code;
+    result.body.assign(exchange->body);
+    result.error_message.assign(exchange->error_message);
+    std::string_view headers = exchange->headers;
+    while (!headers.empty()) {
+        std::size_t name_end = headers.find('\0');
+        std::size_t value_end = headers.find('\0', name_end + 1);
+        if (name_end == std::string_view::npos || value_end == std::string_view::npos) {
+            break;
+        }
+        result.headers.emplace(std::string(headers.substr(0, name_end)),
+                               std::string(headers.substr(name_end + 1, value_end - name_end - 1)));
+        headers.remove_prefix(value_end + 1);
+    }
+    return result;
+}
+
+std::shared_ptr<HttpTransport> make_default_transport(int timeout_seconds) {
+    if (const char* replay_path = std::getenv("HTTP_REPLAY_FILE")) {
+        // Loaded once; every client replays from the same index
+        static std::shared_ptr<ReplayTransport> replay = [replay_path] {
+            const char* timing = std::getenv("HTTP_REPLAY_TIMING");
+            bool original = timing && std::string(timing) == "original";
+            return std::make_shared<ReplayTransport>(replay_path, original ? ReplayTiming::ORIGINAL : ReplayTiming::FULL_SPEED);
+        }();
+        return replay;
+    }
+    auto transport = std::make_shared<CurlTransport>(timeout_seconds);
+    if (const char* record_path = std::getenv("HTTP_RECORD_FILE")) {
+        static std::shared_ptr<TransportRecorder> recorder = std::make_shared<TransportRecorder>(record_path);
+        return std::make_shared<RecordingTransport>(transport, recorder);
+    }
+    return transport;
+}
@@ -1,40 +1,71 @@
 #include "HttpUtils.h"
+#include "Backoff.h"
+#include "RequestBody.h"
 #include <iostream>
 #include <chrono>
 #include <thread>
-#include <random>
 #include <ctime>
+#include <algorithm>
+#include <cctype>
+#include <atomic>
+#include <exception>
+#include <mutex>
 
-// Utility functions
-void log_info(const std::string& message) {
+namespace {
+std::atomic<int> g_log_level(static_cast<int>(LogLevel::INFO));
+
+// Serializes log lines from concurrent clients; the streams may be redirected
+// to buffers that are not safe to write from several threads
+std::mutex g_log_mutex;
+
+bool log_enabled(LogLevel level) {
+    return static_cast<int>(level) >= g_log_level.load(std::memory_order_relaxed);
+}
+
+void write_log(std::ostream& out, const char* level, const std::string& message) {
     auto now = std::chrono::system_clock::now();
     auto time_t = std::chrono::system_clock::to_time_t(now);
-    std::cout << "[" << std::ctime(&time_t) << "] INFO: " << message << std::endl;
+    char timestamp[32]; // ctime_r() needs 26 bytes
+    std::lock_guard<std::mutex> lock(g_log_mutex);
+    out << "[" << ctime_r(&time_t, timestamp) << "] " << level << ": " << message << std::endl;
+}
+} // namespace
+
+void set_log_level(LogLevel level) {
+    g_log_level.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+LogLevel get_log_level() {
+    return static_cast<LogLevel>(g_log_level.load(std::memory_order_relaxed));
+}
+
+// Utility functions
+void log_info(const std::string& message) {
+    if (!log_enabled(LogLevel::INFO)) return;
+    write_log(std::cout, "INFO", message);
 }
 
 void log_error(const std::string& message) {
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    std::cerr << "[" << std::ctime(&time_t) << "] ERROR: " << message << std::endl;
+    if (!log_enabled(LogLevel::ERROR)) return;
+    write_log(std::cerr, "ERROR", message);
 }
 
 void log_warning(const std::string& message) {
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    std::cout << "[" << std::ctime(&time_t) << "] WARNING: " << message << std::endl;
+    if (!log_enabled(LogLevel::WARNING)) return;
+    write_log(std::cout, "WARNING", message);
+}
+
+// Exponential backoff delay with jitter
+int backoff_delay_ms(int attempt) {
+    // Proportional jitter (0.5x to 1.5x) from the thread's generator
+    return Backoff().delay_ms(attempt);
 }
 
 // Exponential backoff with jitter
 void exponential_backoff(int attempt) {
     if (attempt == 0) return;
     
-    int backoff_ms = std::min(INITIAL_BACKOFF_MS * (1 << (attempt - 1)), MAX_BACKOFF_MS);
-    
-    // Add jitter (random factor between 0.5 and 1.5)
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<> dis(0.5, 1.5);
-    backoff_ms = static_cast<int>(backoff_ms * dis(gen));
+    int backoff_ms = backoff_delay_ms(attempt);
     
     log_info("Retrying in " + std::to_string(backoff_ms) + "ms (attempt " + std::to_string(attempt + 1) + ")");
     std::this_thread::sleep_for(std::chrono::milliseconds(backoff_ms));
@@ -61,8 +92,175 @@ bool is_retryable_curl_error(CURLcode code) {
     }
 }
 
+// Classify an attempt as a load signal for the adaptive limit
+AttemptOutcome attempt_outcome(CURLcode code, int status_code) {
+    if (code != CURLE_OK) {
+        // Refused or reset connections say nothing about how loaded the upstream is
+        return code == CURLE_OPERATION_TIMEDOUT ? AttemptOutcome::OVERLOADED : AttemptOutcome::IGNORED;
+    }
+    if (status_code == 429 || status_code == 503) {
+        return AttemptOutcome::OVERLOADED;
+    }
+    return AttemptOutcome::COMPLETED;
+}
+
 // cURL write callback function
 size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
     ((std::string*)userp)->append((char*)contents, size * nmemb);
     return size * nmemb;
-} 
\ No newline at end of file
+}
+
+// Client-wide cURL options shared by the blocking and async clients
+void setup_common_curl_options(CURL* curl, int timeout_seconds) {
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, static_cast<long>(timeout_seconds));
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 10L);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_MAXREDIRS, 3L);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 2L);
+    curl_easy_setopt(curl, CURLOPT_USERAGENT, "C++-API-Client/1.0");
+}
+
+namespace {
+
+int cancellation_progress_callback(void* clientp, curl_off_t, curl_off_t, curl_off_t, curl_off_t) {
+    // Non-zero aborts the transfer with CURLE_ABORTED_BY_CALLBACK
+    return static_cast<const CancellationToken*>(clientp)->is_cancelled() ? 1 : 0;
+}
+
+} // namespace
+
+void setup_budget_options(CURL* curl, int timeout_seconds, const RequestOptions& options) {
+    if (options.deadline.is_set()) {
+        long timeout_ms = static_cast<long>(timeout_seconds) * 1000;
+        long remaining_ms = static_cast<long>(options.deadline.remaining().count());
+        // 0 would mean "no timeout" to cURL
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, std::max(1L, std::min(timeout_ms, remaining_ms)));
+    }
+    if (options.cancellation.can_be_cancelled()) {
+        curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+        curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, &cancellation_progress_callback);
+        curl_easy_setopt(curl, CURLOPT_XFERINFODATA, &options.cancellation);
+    }
+}
+
+void setup_socket_options(CURL* curl, const RequestOptions& options) {
+    if (options.unix_socket.empty()) {
+        return;
+    }
+    if (options.unix_socket[0] == '@') {
+        curl_easy_setopt(curl, CURLOPT_ABSTRACT_UNIX_SOCKET, options.unix_socket.c_str() + 1);
+    } else {
+        curl_easy_setopt(curl, CURLOPT_UNIX_SOCKET_PATH, options.unix_socket.c_str());
+    }
+}
+
+void read_response_headers(CURL* curl, std::map<std::string, std::string>& headers) {
+    headers.clear();
+    // Origin CURLH_HEADER, request -1: server headers of the last response after redirects
+    struct curl_header* header = nullptr;
+    while ((header = curl_easy_nextheader(curl, CURLH_HEADER, -1, header)) != nullptr) {
+        std::string name = header->name;
+        std::transform(name.begin(), name.end(), name.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        auto inserted = headers.emplace(std::move(name), header->value);
+        if (!inserted.second) {
+            inserted.first->second += ", ";
+            inserted.first->second += header->value;
+        }
+    }
+}
+
+struct curl_slist* build_header_list(const std::vector<std::string>& headers) {
+    struct curl_slist* header_list = nullptr;
+    for (const auto& header : headers) {
+        header_list = curl_slist_append(header_list, header.c_str());
+    }
+    return header_list;
+}
+
+void setup_request_options(CURL* curl,
+                           const std::string& url,
+                           const std::string& method,
+                           const std::string& data,
+                           struct curl_slist* header_list,
+                           std::string* body) {
+    // Set URL
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    
+    // Set method
+    if (method == "POST") {
+        curl_easy_setopt(curl, CURLOPT_POST, 1L);
+    } else if (method == "PUT") {
+        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PUT");
+    } else if (method == "DELETE") {
+        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
+    } else if (method == "HEAD") {
+        curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+    }
+    
+    // Set data if provided (an empty POST still needs a body, otherwise cURL reads stdin)
+    if (!data.empty() || method == "POST") {
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data.c_str());
+    }
+    
+    // Set headers
+    if (header_list) {
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, header_list);
+    }
+    
+    // Set callback
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &WriteCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, body);
+}
+
+size_t ReadCallback(char* buffer, size_t size, size_t nitems, void* userp) {
+    auto* source = static_cast<RequestBodySource*>(userp);
+    try {
+        return source->read(buffer, size * nitems);
+    } catch (const std::exception& e) {
+        // Exceptions must not unwind through libcurl
+        log_error("Request body failed: " + std::string(e.what()));
+        return CURL_READFUNC_ABORT;
+    }
+}
+
+void setup_streaming_request_options(CURL* curl,
+                                     const std::string& url,
+                                     const std::string& method,
+                                     RequestBodySource& source,
+                                     struct curl_slist* header_list,
+                                     std::string* body) {
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    
+    // -1 (unknown size) makes cURL rely on the chunked header
+    curl_off_t size = static_cast<curl_off_t>(source.size());
+    if (const char* data = source.contiguous()) {
+        // Sent from the source's own memory (e.g. a file mapping), without the read callback
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, size);
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data);
+        if (method != "POST") {
+            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, method.c_str());
+        }
+    } else {
+        if (method == "POST") {
+            curl_easy_setopt(curl, CURLOPT_POST, 1L);
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, size);
+        } else {
+            curl_easy_setopt(curl, CURLOPT_UPLOAD, 1L);
+            curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE, size);
+            if (method != "PUT") {
+                curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, method.c_str());
+            }
+        }
+        curl_easy_setopt(curl, CURLOPT_READFUNCTION, &ReadCallback);
+        curl_easy_setopt(curl, CURLOPT_READDATA, &source);
+    }
+    
+    if (header_list) {
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, header_list);
+    }
+    
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &WriteCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, body);
+}
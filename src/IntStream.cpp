@@ -0,0 +1,508 @@
+#include "IntStream.h"
+#include "WorkStealingPool.h"
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define INT_STREAM_X86 1
+#endif
+
+namespace {
+
+const std::size_t BLOCK = 64;   ///< Bytes classified per step
+const std::size_t BATCH = 4096; ///< Values parsed, scaled and formatted per round
+
+/// Bit i set if byte i of a 64-byte block is in the class
+struct BlockMasks {
+    std::uint64_t digit;
+    std::uint64_t space;
+};
+
+bool is_space(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+BlockMasks classify_scalar(const char* block) {
+    BlockMasks masks{0, 0};
+    for (std::size_t i = 0; i < BLOCK; ++i) {
+        masks.digit |= static_cast<std::uint64_t>(is_digit(block[i])) << i;
+        masks.space |= static_cast<std::uint64_t>(is_space(block[i])) << i;
+    }
+    return masks;
+}
+
+#ifdef INT_STREAM_X86
+BlockMasks classify_sse2(const char* block) {
+    const __m128i below_zero = _mm_set1_epi8('0' - 1);
+    const __m128i above_nine = _mm_set1_epi8('9' + 1);
+    const __m128i blank = _mm_set1_epi8(' ');
+    const __m128i below_tab = _mm_set1_epi8('\t' - 1);
+    const __m128i above_cr = _mm_set1_epi8('\r' + 1);
+    BlockMasks masks{0, 0};
+    for (std::size_t i = 0; i < BLOCK; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i));
+        // Signed compares: bytes >= 0x80 are negative and fall outside both ranges
+        __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(bytes, below_zero), _mm_cmplt_epi8(bytes, above_nine));
+        __m128i space = _mm_or_si128(_mm_cmpeq_epi8(bytes, blank),
+                                     _mm_and_si128(_mm_cmpgt_epi8(bytes, below_tab), _mm_cmplt_epi8(bytes, above_cr)));
+        masks.digit |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm_movemask_epi8(digit))) << i;
+        masks.space |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm_movemask_epi8(space))) << i;
+    }
+    return masks;
+}
+
+__attribute__((target("avx2"))) BlockMasks classify_avx2(const char* block) {
+    const __m256i below_zero = _mm256_set1_epi8('0' - 1);
+    const __m256i nine = _mm256_set1_epi8('9');
+    const __m256i blank = _mm256_set1_epi8(' ');
+    const __m256i below_tab = _mm256_set1_epi8('\t' - 1);
+    const __m256i cr = _mm256_set1_epi8('\r');
+    BlockMasks masks{0, 0};
+    for (std::size_t i = 0; i < BLOCK; i += 32) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + i));
+        __m256i digit = _mm256_andnot_si256(_mm256_cmpgt_epi8(bytes, nine), _mm256_cmpgt_epi8(bytes, below_zero));
+        __m256i control = _mm256_andnot_si256(_mm256_cmpgt_epi8(bytes, cr), _mm256_cmpgt_epi8(bytes, below_tab));
+        __m256i space = _mm256_or_si256(_mm256_cmpeq_epi8(bytes, blank), control);
+        masks.digit |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(digit))) << i;
+        masks.space |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(space))) << i;
+    }
+    return masks;
+}
+
+__attribute__((target("avx2"))) void scale_avx2(std::int32_t* values, std::size_t count, std::int32_t factor) {
+    const __m256i multiplier = _mm256_set1_epi32(factor);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(values + i), _mm256_mullo_epi32(v, multiplier));
+    }
+    for (; i < count; ++i) {
+        values[i] = static_cast<std::int32_t>(static_cast<std::uint32_t>(values[i]) * static_cast<std::uint32_t>(factor));
+    }
+}
+#endif
+
+using ClassifyFn = BlockMasks (*)(const char*);
+
+ClassifyFn classifier() {
+#ifdef INT_STREAM_X86
+    switch (active_simd_level()) {
+    case SimdLevel::AVX2:
+        return classify_avx2;
+    case SimdLevel::SSE2:
+        return classify_sse2;
+    default:
+        break;
+    }
+#endif
+    return classify_scalar;
+}
+
+/**
+ * @brief Finds runs of a character class over [begin, end) using cached 64-byte block masks
+ *
+ * The final partial block is copied into a NUL-padded buffer, so no load
+ * crosses `end`; NUL is neither a digit nor a space and ends every run.
+ */
+class ClassScanner {
+public:
+    ClassScanner(const char* begin, const char* end)
+        : begin_(begin), end_(end), classify_(classifier()), block_(std::numeric_limits<std::size_t>::max()) {}
+
+    /// First non-space at or after p (end if none)
+    const char* skip_space(const char* p) { return find_clear(p, &BlockMasks::space); }
+
+    /// First non-digit at or after p (end if none)
+    const char* skip_digits(const char* p) { return find_clear(p, &BlockMasks::digit); }
+
+private:
+    const char* find_clear(const char* p, std::uint64_t BlockMasks::*member) {
+        while (p < end_) {
+            std::size_t offset = static_cast<std::size_t>(p - begin_);
+            const BlockMasks& masks = load(offset / BLOCK);
+            std::size_t bit = offset % BLOCK;
+            std::uint64_t clear = ~(masks.*member) >> bit;
+            if (clear != 0) {
+                std::size_t distance = static_cast<std::size_t>(__builtin_ctzll(clear));
+                return distance < static_cast<std::size_t>(end_ - p) ? p + distance : end_;
+            }
+            p += BLOCK - bit;
+        }
+        return end_;
+    }
+
+    const BlockMasks& load(std::size_t block) {
+        if (block != block_) {
+            const char* start = begin_ + block * BLOCK;
+            if (static_cast<std::size_t>(end_ - start) >= BLOCK) {
+                masks_ = classify_(start);
+            } else {
+                char padded[BLOCK] = {};
+                std::memcpy(padded, start, static_cast<std::size_t>(end_ - start));
+                masks_ = classify_(padded);
+            }
+            block_ = block;
+        }
+        return masks_;
+    }
+
+    const char* begin_;
+    const char* end_;
+    ClassifyFn classify_;
+    std::size_t block_;
+    BlockMasks masks_;
+};
+
+/// Converts exactly 8 ASCII digits in one multiply-and-shift sequence (little-endian)
+std::uint64_t parse_eight_digits(const char* p) {
+    std::uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    const std::uint64_t mask = 0x000000FF000000FFULL;
+    const std::uint64_t mul1 = 100 + (1000000ULL << 32);
+    const std::uint64_t mul2 = 1 + (10000ULL << 32);
+    value -= 0x3030303030303030ULL;
+    value = (value * 10) + (value >> 8);
+    return (((value & mask) * mul1) + (((value >> 16) & mask) * mul2)) >> 32;
+#else
+    std::uint64_t result = 0;
+    for (int i = 0; i < 8; ++i) {
+        result = result * 10 + static_cast<std::uint64_t>(p[i] - '0');
+    }
+    return result;
+#endif
+}
+
+const char DIGIT_PAIRS[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+char* format_one(std::int32_t value, char* out) {
+    std::uint32_t magnitude = static_cast<std::uint32_t>(value);
+    if (value < 0) {
+        *out++ = '-';
+        magnitude = 0u - magnitude;
+    }
+    char digits[10];
+    char* p = digits + sizeof(digits);
+    while (magnitude >= 100) {
+        std::uint32_t pair = (magnitude % 100) * 2;
+        magnitude /= 100;
+        *--p = DIGIT_PAIRS[pair + 1];
+        *--p = DIGIT_PAIRS[pair];
+    }
+    if (magnitude >= 10) {
+        *--p = DIGIT_PAIRS[magnitude * 2 + 1];
+        *--p = DIGIT_PAIRS[magnitude * 2];
+    } else {
+        *--p = static_cast<char>('0' + magnitude);
+    }
+    std::size_t length = static_cast<std::size_t>(digits + sizeof(digits) - p);
+    std::memcpy(out, p, length);
+    out += length;
+    *out++ = ' ';
+    return out;
+}
+
+void write_all(int fd, const char* data, std::size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("write failed: " + std::string(std::strerror(errno)));
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+}
+
+/// One chunk's formatted output for ordered reassembly
+struct ChunkOutput {
+    std::vector<char> text;
+    bool invalid = false;
+};
+
+ChunkOutput transform_chunk(const char* begin, const char* end, std::int32_t factor) {
+    ChunkOutput output;
+    std::int32_t values[BATCH];
+    const char* p = begin;
+    for (;;) {
+        IntParseResult parsed = parse_ints(p, end, true, values, BATCH);
+        scale_ints(values, parsed.count, factor);
+        std::size_t used = output.text.size();
+        output.text.resize(used + parsed.count * 12);
+        char* text_end = format_ints(values, parsed.count, output.text.data() + used);
+        output.text.resize(static_cast<std::size_t>(text_end - output.text.data()));
+        p = parsed.next;
+        if (parsed.invalid) {
+            output.invalid = true;
+            return output;
+        }
+        if (parsed.count < BATCH) {
+            return output;
+        }
+    }
+}
+
+} // namespace
+
+OutputBuffer::OutputBuffer(int fd, std::size_t capacity) : fd_(fd), buffer_(capacity), used_(0) {}
+
+OutputBuffer::~OutputBuffer() {
+    try {
+        flush();
+    } catch (...) {
+    }
+}
+
+char* OutputBuffer::reserve(std::size_t n) {
+    if (buffer_.size() - used_ < n) {
+        flush();
+        if (buffer_.size() < n) {
+            buffer_.resize(n);
+        }
+    }
+    return buffer_.data() + used_;
+}
+
+void OutputBuffer::flush() {
+    std::size_t pending = used_;
+    used_ = 0;
+    write_all(fd_, buffer_.data(), pending);
+}
+
+IntParseResult parse_ints(const char* begin, const char* end, bool at_eof, std::int32_t* out, std::size_t capacity) {
+    ClassScanner scanner(begin, end);
+    IntParseResult result{0, begin, false};
+    const char* p = begin;
+
+    while (result.count < capacity) {
+        p = scanner.skip_space(p);
+        if (p == end) {
+            break;
+        }
+        const char* token = p;
+        bool negative = false;
+        if (*p == '-' || *p == '+') {
+            negative = *p == '-';
+            ++p;
+        }
+        const char* digits_end = scanner.skip_digits(p);
+        if (digits_end == end && !at_eof) {
+            p = token; // may continue in the next chunk
+            break;
+        }
+        if (digits_end == p) {
+            result.invalid = true;
+            p = token;
+            break;
+        }
+
+        while (p < digits_end - 1 && *p == '0') {
+            ++p;
+        }
+        std::size_t length = static_cast<std::size_t>(digits_end - p);
+        std::uint64_t magnitude = 0;
+        if (length <= 10) {
+            if (length >= 8) {
+                magnitude = parse_eight_digits(p);
+                p += 8;
+            }
+            for (; p < digits_end; ++p) {
+                magnitude = magnitude * 10 + static_cast<std::uint64_t>(*p - '0');
+            }
+        }
+        std::uint64_t limit = negative ? 2147483648ULL : 2147483647ULL;
+        if (length > 10 || magnitude > limit) {
+            result.invalid = true; // out of range: the stream sets failbit
+            p = token;
+            break;
+        }
+        out[result.count++] = negative ? static_cast<std::int32_t>(0u - static_cast<std::uint32_t>(magnitude))
+                                       : static_cast<std::int32_t>(magnitude);
+        p = digits_end;
+    }
+
+    result.next = p;
+    return result;
+}
+
+void scale_ints(std::int32_t* values, std::size_t count, std::int32_t factor) {
+#ifdef INT_STREAM_X86
+    if (active_simd_level() == SimdLevel::AVX2) {
+        scale_avx2(values, count, factor);
+        return;
+    }
+#endif
+    // Unsigned arithmetic wraps like the hardware multiply (signed overflow is undefined)
+    for (std::size_t i = 0; i < count; ++i) {
+        values[i] = static_cast<std::int32_t>(static_cast<std::uint32_t>(values[i]) * static_cast<std::uint32_t>(factor));
+    }
+}
+
+char* format_ints(const std::int32_t* values, std::size_t count, char* out) {
+    for (std::size_t i = 0; i < count; ++i) {
+        out = format_one(values[i], out);
+    }
+    return out;
+}
+
+bool transform_int_buffer(const char* data,
+                          std::size_t size,
+                          bool at_eof,
+                          std::int32_t factor,
+                          OutputBuffer& out,
+                          std::size_t& consumed) {
+    std::int32_t values[BATCH];
+    const char* p = data;
+    const char* end = data + size;
+
+    for (;;) {
+        IntParseResult parsed = parse_ints(p, end, at_eof, values, BATCH);
+        scale_ints(values, parsed.count, factor);
+        out.commit(format_ints(values, parsed.count, out.reserve(parsed.count * 12)));
+        p = parsed.next;
+        if (parsed.invalid) {
+            consumed = static_cast<std::size_t>(p - data);
+            return false;
+        }
+        if (parsed.count < BATCH) {
+            consumed = static_cast<std::size_t>(p - data);
+            return true;
+        }
+    }
+}
+
+bool transform_int_stream(int in_fd, int out_fd, std::int32_t factor) {
+    OutputBuffer out(out_fd);
+    std::size_t consumed = 0;
+
+    struct stat info;
+    if (::fstat(in_fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        MappedFile file(in_fd);
+        bool complete = transform_int_buffer(file.data(), file.size(), true, factor, out, consumed);
+        out.flush();
+        return complete;
+    }
+
+    // Pipes and terminals: large blocks, carrying a partial token to the next read
+    std::vector<char> buffer(1 << 20);
+    std::size_t filled = 0;
+    for (;;) {
+        if (filled == buffer.size()) {
+            buffer.resize(buffer.size() * 2); // one token longer than the buffer
+        }
+        ssize_t bytes = ::read(in_fd, buffer.data() + filled, buffer.size() - filled);
+        if (bytes < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("read failed: " + std::string(std::strerror(errno)));
+        }
+        bool at_eof = bytes == 0;
+        filled += static_cast<std::size_t>(bytes);
+
+        if (!transform_int_buffer(buffer.data(), filled, at_eof, factor, out, consumed)) {
+            out.flush();
+            return false;
+        }
+        if (at_eof) {
+            out.flush();
+            return true;
+        }
+        std::memmove(buffer.data(), buffer.data() + consumed, filled - consumed);
+        filled -= consumed;
+    }
+}
+
+bool transform_int_buffer_parallel(const char* data,
+                                   std::size_t size,
+                                   std::int32_t factor,
+                                   int out_fd,
+                                   WorkStealingPool& pool,
+                                   std::size_t chunk_size) {
+    const char* end = data + size;
+    const char* next_chunk = data;
+    std::size_t next_index = 0;
+    std::size_t window = std::max<std::size_t>(pool.size(), 1) * 3;
+    // Chunks after the first invalid token are skipped rather than transformed
+    std::atomic<std::size_t> first_invalid(std::numeric_limits<std::size_t>::max());
+    std::deque<std::future<ChunkOutput>> pending;
+    bool complete = true;
+
+    auto submit_next = [&] {
+        const char* begin = next_chunk;
+        const char* split = end;
+        if (static_cast<std::size_t>(end - begin) > chunk_size) {
+            // A token never contains whitespace, so a chunk may end at any space
+            split = begin + chunk_size;
+            while (split < end && !is_space(*split)) {
+                ++split;
+            }
+        }
+        std::size_t index = next_index++;
+        next_chunk = split;
+        pending.push_back(pool.submit([begin, split, factor, index, &first_invalid] {
+            if (index > first_invalid.load(std::memory_order_relaxed)) {
+                return ChunkOutput();
+            }
+            ChunkOutput output = transform_chunk(begin, split, factor);
+            if (output.invalid) {
+                std::size_t current = first_invalid.load(std::memory_order_relaxed);
+                while (index < current && !first_invalid.compare_exchange_weak(current, index)) {
+                }
+            }
+            return output;
+        }));
+    };
+
+    try {
+        while (next_chunk < end || !pending.empty()) {
+            while (next_chunk < end && pending.size() < window && complete) {
+                submit_next();
+            }
+            if (pending.empty()) {
+                break;
+            }
+            ChunkOutput output = pending.front().get();
+            pending.pop_front();
+            if (complete) {
+                write_all(out_fd, output.text.data(), output.text.size());
+                complete = !output.invalid;
+            }
+        }
+    } catch (...) {
+        // Jobs reference first_invalid on this stack: let them finish first
+        for (std::future<ChunkOutput>& job : pending) {
+            job.wait();
+        }
+        throw;
+    }
+    return complete;
+}
+
+bool transform_int_stream_parallel(int in_fd, int out_fd, std::int32_t factor, WorkStealingPool& pool) {
+    struct stat info;
+    if (::fstat(in_fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        MappedFile file(in_fd);
+        return transform_int_buffer_parallel(file.data(), file.size(), factor, out_fd, pool);
+    }
+    return transform_int_stream(in_fd, out_fd, factor);
+}
@@ -0,0 +1,600 @@
+#include "JsonOnDemand.h"
+#include <charconv>
+#include <cstring>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define JSON_ON_DEMAND_X86 1
+#endif
+
+namespace {
+
+const std::size_t BLOCK = 64; ///< Bytes classified per step
+
+/// Bit i set if byte i of a 64-byte block is in the class
+struct BlockMasks {
+    std::uint64_t quote;
+    std::uint64_t backslash;
+    std::uint64_t op;    ///< { } [ ] : ,
+    std::uint64_t space; ///< JSON whitespace: space, tab, LF, CR
+};
+
+bool is_op(char c) {
+    return c == '{' || c == '}' || c == '[' || c == ']' || c == ':' || c == ',';
+}
+
+bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+BlockMasks classify_scalar(const char* block) {
+    BlockMasks masks{0, 0, 0, 0};
+    for (std::size_t i = 0; i < BLOCK; ++i) {
+        masks.quote |= static_cast<std::uint64_t>(block[i] == '"') << i;
+        masks.backslash |= static_cast<std::uint64_t>(block[i] == '\\') << i;
+        masks.op |= static_cast<std::uint64_t>(is_op(block[i])) << i;
+        masks.space |= static_cast<std::uint64_t>(is_space(block[i])) << i;
+    }
+    return masks;
+}
+
+#ifdef JSON_ON_DEMAND_X86
+// '[' | 0x20 == '{' and ']' | 0x20 == '}', so one OR folds the brackets into
+// two compares; no other byte maps onto either.
+BlockMasks classify_sse2(const char* block) {
+    const __m128i case_bit = _mm_set1_epi8(0x20);
+    BlockMasks masks{0, 0, 0, 0};
+    for (std::size_t i = 0; i < BLOCK; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i));
+        __m128i folded = _mm_or_si128(bytes, case_bit);
+        __m128i quote = _mm_cmpeq_epi8(bytes, _mm_set1_epi8('"'));
+        __m128i backslash = _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\\'));
+        __m128i op = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(folded, _mm_set1_epi8('{')),
+                                               _mm_cmpeq_epi8(folded, _mm_set1_epi8('}'))),
+                                  _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(':')),
+                                               _mm_cmpeq_epi8(bytes, _mm_set1_epi8(','))));
+        __m128i space = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(' ')),
+                                                  _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\t'))),
+                                     _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n')),
+                                                  _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\r'))));
+        masks.quote |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm_movemask_epi8(quote))) << i;
+        masks.backslash |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm_movemask_epi8(backslash))) << i;
+        masks.op |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm_movemask_epi8(op))) << i;
+        masks.space |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm_movemask_epi8(space))) << i;
+    }
+    return masks;
+}
+
+__attribute__((target("avx2"))) BlockMasks classify_avx2(const char* block) {
+    const __m256i case_bit = _mm256_set1_epi8(0x20);
+    BlockMasks masks{0, 0, 0, 0};
+    for (std::size_t i = 0; i < BLOCK; i += 32) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + i));
+        __m256i folded = _mm256_or_si256(bytes, case_bit);
+        __m256i quote = _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('"'));
+        __m256i backslash = _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\\'));
+        __m256i op = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(folded, _mm256_set1_epi8('{')),
+                                                     _mm256_cmpeq_epi8(folded, _mm256_set1_epi8('}'))),
+                                     _mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(':')),
+                                                     _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(','))));
+        __m256i space = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' ')),
+                                                        _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\t'))),
+                                        _mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\n')),
+                                                        _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\r'))));
+        masks.quote |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(quote))) << i;
+        masks.backslash |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(backslash))) << i;
+        masks.op |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(op))) << i;
+        masks.space |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(space))) << i;
+    }
+    return masks;
+}
+#endif
+
+using ClassifyFn = BlockMasks (*)(const char*);
+
+ClassifyFn classifier() {
+#ifdef JSON_ON_DEMAND_X86
+    switch (active_simd_level()) {
+    case SimdLevel::AVX2:
+        return classify_avx2;
+    case SimdLevel::SSE2:
+        return classify_sse2;
+    default:
+        break;
+    }
+#endif
+    return classify_scalar;
+}
+
+/**
+ * @brief Characters escaped by a backslash, i.e. preceded by an odd-length backslash run
+ * @param carry In: 1 if the previous block ended with an unfinished escape; out: the same for this block
+ *
+ * Adding each odd-aligned run start to the backslash mask carries through
+ * the run and lands one past its end; comparing where it lands with where
+ * it started tells odd-length runs from even ones for all runs at once.
+ */
+std::uint64_t escaped_mask(std::uint64_t backslash, std::uint64_t& carry) {
+    const std::uint64_t even_bits = 0x5555555555555555ULL;
+    backslash &= ~carry;
+    std::uint64_t follows_escape = (backslash << 1) | carry;
+    std::uint64_t odd_starts = backslash & ~even_bits & ~follows_escape;
+    std::uint64_t even_ends;
+    carry = __builtin_add_overflow(odd_starts, backslash, &even_ends) ? 1 : 0;
+    std::uint64_t invert = even_ends << 1;
+    return (even_bits ^ invert) & follows_escape;
+}
+
+/// Bit i set if an odd number of bits at or below i are set
+std::uint64_t prefix_xor(std::uint64_t bits) {
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+std::string offset_text(std::size_t offset) {
+    return " at offset " + std::to_string(offset);
+}
+
+/// Checks the JSON number grammar: -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+bool valid_number(std::string_view text) {
+    std::size_t i = 0;
+    auto digits = [&]() {
+        std::size_t start = i;
+        while (i < text.size() && text[i] >= '0' && text[i] <= '9') {
+            ++i;
+        }
+        return i - start;
+    };
+    if (i < text.size() && text[i] == '-') {
+        ++i;
+    }
+    if (i < text.size() && text[i] == '0') {
+        ++i;
+    } else if (digits() == 0) {
+        return false;
+    }
+    if (i < text.size() && text[i] == '.') {
+        ++i;
+        if (digits() == 0) {
+            return false;
+        }
+    }
+    if (i < text.size() && (text[i] == 'e' || text[i] == 'E')) {
+        ++i;
+        if (i < text.size() && (text[i] == '+' || text[i] == '-')) {
+            ++i;
+        }
+        if (digits() == 0) {
+            return false;
+        }
+    }
+    return i == text.size();
+}
+
+unsigned hex4(std::string_view text, std::size_t at) {
+    if (at + 4 > text.size()) {
+        throw JsonError("Truncated \\u escape");
+    }
+    unsigned value = 0;
+    for (std::size_t i = at; i < at + 4; ++i) {
+        char c = text[i];
+        value <<= 4;
+        if (c >= '0' && c <= '9') {
+            value |= static_cast<unsigned>(c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            value |= static_cast<unsigned>(c - 'a' + 10);
+        } else if (c >= 'A' && c <= 'F') {
+            value |= static_cast<unsigned>(c - 'A' + 10);
+        } else {
+            throw JsonError("Invalid \\u escape");
+        }
+    }
+    return value;
+}
+
+void append_utf8(std::string& out, unsigned code_point) {
+    if (code_point < 0x80) {
+        out.push_back(static_cast<char>(code_point));
+    } else if (code_point < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    } else if (code_point < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+}
+
+/// Decodes the text between a string's quotes
+std::string unescape(std::string_view body) {
+    std::size_t backslash = body.find('\\');
+    if (backslash == std::string_view::npos) {
+        return std::string(body);
+    }
+    std::string out(body.substr(0, backslash));
+    out.reserve(body.size());
+    for (std::size_t i = backslash; i < body.size(); ++i) {
+        char c = body[i];
+        if (c != '\\') {
+            out.push_back(c);
+            continue;
+        }
+        if (++i == body.size()) {
+            throw JsonError("Truncated escape");
+        }
+        switch (body[i]) {
+        case '"': out.push_back('"'); break;
+        case '\\': out.push_back('\\'); break;
+        case '/': out.push_back('/'); break;
+        case 'b': out.push_back('\b'); break;
+        case 'f': out.push_back('\f'); break;
+        case 'n': out.push_back('\n'); break;
+        case 'r': out.push_back('\r'); break;
+        case 't': out.push_back('\t'); break;
+        case 'u': {
+            unsigned code_point = hex4(body, i + 1);
+            i += 4;
+            if (code_point >= 0xD800 && code_point < 0xDC00) {
+                if (i + 2 >= body.size() || body[i + 1] != '\\' || body[i + 2] != 'u') {
+                    throw JsonError("Unpaired surrogate in \\u escape");
+                }
+                unsigned low = hex4(body, i + 3);
+                if (low < 0xDC00 || low >= 0xE000) {
+                    throw JsonError("Unpaired surrogate in \\u escape");
+                }
+                code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+                i += 6;
+            } else if (code_point >= 0xDC00 && code_point < 0xE000) {
+                throw JsonError("Unpaired surrogate in \\u escape");
+            }
+            append_utf8(out, code_point);
+            break;
+        }
+        default:
+            throw JsonError(std::string("Invalid escape '\\") + body[i] + "'");
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+JsonDocument::JsonDocument(std::string_view text) {
+    parse(text);
+}
+
+void JsonDocument::parse(std::string_view text) {
+    if (text.size() >= std::numeric_limits<std::uint32_t>::max()) {
+        throw JsonError("JSON document over 4 GiB");
+    }
+    text_ = text;
+    try {
+        index_structurals();
+        match_brackets();
+    } catch (...) {
+        positions_.clear();
+        throw;
+    }
+}
+
+void JsonDocument::index_structurals() {
+    ClassifyFn classify = classifier();
+    const std::size_t size = text_.size();
+    // At most one structural character per byte
+    positions_.resize(size);
+    std::uint32_t* out = positions_.data();
+    std::size_t count = 0;
+
+    std::uint64_t escape_carry = 0;
+    std::uint64_t in_string_carry = 0; ///< All ones if the previous block ended inside a string
+    std::uint64_t scalar_carry = 0;    ///< 1 if the previous block ended inside a number or literal
+    char tail[BLOCK];
+
+    for (std::size_t base = 0; base < size; base += BLOCK) {
+        const char* block = text_.data() + base;
+        if (size - base < BLOCK) {
+            // Pad the last block with whitespace, which ends any number or literal
+            std::memset(tail, ' ', BLOCK);
+            std::memcpy(tail, block, size - base);
+            block = tail;
+        }
+        BlockMasks masks = classify(block);
+
+        std::uint64_t quote = masks.quote & ~escaped_mask(masks.backslash, escape_carry);
+        // Opening quotes and string contents; closing quotes are clear
+        std::uint64_t in_string = prefix_xor(quote) ^ in_string_carry;
+        in_string_carry = static_cast<std::uint64_t>(static_cast<std::int64_t>(in_string) >> 63);
+
+        std::uint64_t scalar = ~(masks.op | masks.space | quote | in_string);
+        std::uint64_t scalar_start = scalar & ~((scalar << 1) | scalar_carry);
+        scalar_carry = scalar >> 63;
+
+        std::uint64_t structural = (masks.op & ~in_string) | scalar_start | quote;
+        while (structural != 0) {
+            out[count++] = static_cast<std::uint32_t>(base + static_cast<std::size_t>(__builtin_ctzll(structural)));
+            structural &= structural - 1;
+        }
+    }
+
+    if (in_string_carry != 0) {
+        throw JsonError("Unterminated string" + offset_text(count > 0 ? positions_[count - 1] : 0));
+    }
+    positions_.resize(count);
+}
+
+void JsonDocument::match_brackets() {
+    const std::uint32_t count = static_cast<std::uint32_t>(positions_.size());
+    if (count == 0) {
+        throw JsonError("Empty JSON document");
+    }
+    jumps_.resize(count);
+    stack_.clear();
+    for (std::uint32_t i = 0; i < count; ++i) {
+        char c = text_[positions_[i]];
+        if (c == '{' || c == '[') {
+            stack_.push_back(i);
+        } else if (c == '}' || c == ']') {
+            char open = c == '}' ? '{' : '[';
+            if (stack_.empty() || text_[positions_[stack_.back()]] != open) {
+                throw JsonError(std::string("Unexpected '") + c + "'" + offset_text(positions_[i]));
+            }
+            jumps_[stack_.back()] = i;
+            jumps_[i] = stack_.back();
+            stack_.pop_back();
+        }
+    }
+    if (!stack_.empty()) {
+        throw JsonError(std::string("Unclosed '") + text_[positions_[stack_.back()]] + "'" +
+                        offset_text(positions_[stack_.back()]));
+    }
+    if (skip(0) != count) {
+        throw JsonError("Trailing content" + offset_text(positions_[skip(0)]));
+    }
+}
+
+JsonValue JsonDocument::root() const {
+    if (positions_.empty()) {
+        throw JsonError("No JSON document parsed");
+    }
+    return JsonValue(this, 0);
+}
+
+char JsonDocument::at(std::uint32_t index) const {
+    return index < positions_.size() ? text_[positions_[index]] : '\0';
+}
+
+std::uint32_t JsonDocument::skip(std::uint32_t index) const {
+    switch (at(index)) {
+    case '{':
+    case '[':
+        return partner(index) + 1;
+    case '"':
+        return index + 2; // the closing quote is the next structural
+    default:
+        return index + 1;
+    }
+}
+
+std::string_view JsonDocument::string_body(std::uint32_t index) const {
+    std::uint32_t start = positions_[index] + 1;
+    return text_.substr(start, positions_[index + 1] - start);
+}
+
+JsonType JsonValue::type() const {
+    if (document_ == nullptr) {
+        throw JsonError("Empty JSON value");
+    }
+    char c = document_->at(index_);
+    switch (c) {
+    case '{':
+        return JsonType::OBJECT;
+    case '[':
+        return JsonType::ARRAY;
+    case '"':
+        return JsonType::STRING;
+    case 't':
+    case 'f':
+        return JsonType::BOOLEAN;
+    case 'n':
+        return JsonType::NUL;
+    default:
+        if (c == '-' || (c >= '0' && c <= '9')) {
+            return JsonType::NUMBER;
+        }
+        if (c == '\0') {
+            throw JsonError("Missing JSON value");
+        }
+        throw JsonError(std::string("Unexpected '") + c + "'" + offset_text(document_->positions_[index_]));
+    }
+}
+
+bool JsonValue::is_null() const {
+    if (type() != JsonType::NUL) {
+        return false;
+    }
+    if (raw() != "null") {
+        throw JsonError("Invalid literal '" + std::string(raw()) + "'");
+    }
+    return true;
+}
+
+std::string JsonValue::get_string() const {
+    if (type() != JsonType::STRING) {
+        throw JsonError("Expected a string, got '" + std::string(raw()) + "'");
+    }
+    return unescape(document_->string_body(index_));
+}
+
+std::string_view JsonValue::raw() const {
+    JsonType kind = type();
+    const std::string_view& text = document_->text_;
+    const auto& positions = document_->positions_;
+    std::uint32_t start = positions[index_];
+    std::uint32_t end;
+    if (kind == JsonType::OBJECT || kind == JsonType::ARRAY) {
+        end = positions[document_->partner(index_)] + 1;
+    } else if (kind == JsonType::STRING) {
+        end = positions[index_ + 1] + 1;
+    } else {
+        // A number or literal runs to the next structural, less whitespace
+        end = index_ + 1 < positions.size() ? positions[index_ + 1] : static_cast<std::uint32_t>(text.size());
+        while (end > start && is_space(text[end - 1])) {
+            --end;
+        }
+    }
+    return text.substr(start, end - start);
+}
+
+std::int64_t JsonValue::get_int64() const {
+    std::string_view text = type() == JsonType::NUMBER ? raw() : std::string_view();
+    if (!valid_number(text)) {
+        throw JsonError("Expected a number, got '" + std::string(raw()) + "'");
+    }
+    std::int64_t value = 0;
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (result.ec == std::errc::result_out_of_range) {
+        throw JsonError("Integer out of range: " + std::string(text));
+    }
+    if (result.ptr != text.data() + text.size()) {
+        throw JsonError("Expected an integer, got " + std::string(text));
+    }
+    return value;
+}
+
+double JsonValue::get_double() const {
+    std::string_view text = type() == JsonType::NUMBER ? raw() : std::string_view();
+    if (!valid_number(text)) {
+        throw JsonError("Expected a number, got '" + std::string(raw()) + "'");
+    }
+    double value = 0;
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (result.ec != std::errc()) {
+        throw JsonError("Number out of range: " + std::string(text));
+    }
+    return value;
+}
+
+bool JsonValue::get_bool() const {
+    std::string_view text = raw();
+    if (text == "true") {
+        return true;
+    }
+    if (text == "false") {
+        return false;
+    }
+    throw JsonError("Expected a boolean, got '" + std::string(text) + "'");
+}
+
+JsonValue JsonValue::operator[](std::string_view key) const {
+    JsonValue value;
+    if (!find(key, value)) {
+        throw JsonError("Missing key '" + std::string(key) + "'");
+    }
+    return value;
+}
+
+bool JsonValue::find(std::string_view key, JsonValue& value) const {
+    for (const JsonField& field : fields()) {
+        std::string_view raw_key = field.raw_key();
+        bool match = raw_key.find('\\') == std::string_view::npos ? raw_key == key : field.key() == key;
+        if (match) {
+            value = field.value();
+            return true;
+        }
+    }
+    return false;
+}
+
+JsonArray JsonValue::elements() const {
+    if (type() != JsonType::ARRAY) {
+        throw JsonError("Expected an array, got '" + std::string(raw()) + "'");
+    }
+    return JsonArray(document_, index_, document_->partner(index_));
+}
+
+JsonObject JsonValue::fields() const {
+    if (type() != JsonType::OBJECT) {
+        throw JsonError("Expected an object, got '" + std::string(raw()) + "'");
+    }
+    return JsonObject(document_, index_, document_->partner(index_));
+}
+
+std::size_t JsonValue::size() const {
+    std::size_t count = 0;
+    if (type() == JsonType::ARRAY) {
+        for (auto it = elements().begin(), end = elements().end(); it != end; ++it) {
+            ++count;
+        }
+    } else {
+        for (auto it = fields().begin(), end = fields().end(); it != end; ++it) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+std::string JsonField::key() const {
+    return unescape(raw_key_);
+}
+
+JsonArray::iterator JsonArray::begin() const {
+    return iterator(document_, open_ + 1, close_);
+}
+
+JsonArray::iterator& JsonArray::iterator::operator++() {
+    std::uint32_t next = document_->skip(index_);
+    if (next == close_) {
+        index_ = close_;
+    } else if (document_->at(next) == ',' && next + 1 != close_) {
+        index_ = next + 1;
+    } else {
+        throw JsonError("Expected ',' or ']'" + offset_text(document_->positions_[next]));
+    }
+    return *this;
+}
+
+JsonObject::iterator::iterator(const JsonDocument* document, std::uint32_t index, std::uint32_t close)
+    : document_(document), index_(index), close_(close) {
+    if (index_ != close_) {
+        load();
+    }
+}
+
+void JsonObject::iterator::load() {
+    if (document_->at(index_) != '"') {
+        throw JsonError("Expected a string key" + offset_text(document_->positions_[index_]));
+    }
+    if (document_->at(index_ + 2) != ':' || index_ + 3 == close_) {
+        throw JsonError("Expected ':' and a value after key" + offset_text(document_->positions_[index_]));
+    }
+    field_.raw_key_ = document_->string_body(index_);
+    field_.value_ = JsonValue(document_, index_ + 3);
+}
+
+JsonObject::iterator JsonObject::begin() const {
+    return iterator(document_, open_ + 1, close_);
+}
+
+JsonObject::iterator& JsonObject::iterator::operator++() {
+    std::uint32_t next = document_->skip(index_ + 3);
+    if (next == close_) {
+        index_ = close_;
+    } else if (document_->at(next) == ',' && next + 1 != close_) {
+        index_ = next + 1;
+        load();
+    } else {
+        throw JsonError("Expected ',' or '}'" + offset_text(document_->positions_[next]));
+    }
+    return *this;
+}
@@ -0,0 +1,281 @@
+#include "LoadGenerator.h"
+#include "AsyncHttpClient.h"
+#include "HttpClient.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const std::size_t EXACT_BUCKETS = 128;  ///< Values below this are stored exactly
+const std::size_t SUB_BUCKETS = 64;     ///< Buckets per power of two above that
+const std::size_t BUCKET_COUNT = EXACT_BUCKETS + (64 - 7) * SUB_BUCKETS;
+
+std::string error_key(const HttpResponse& response) {
+    if (!response.error_message.empty()) {
+        return response.error_message;
+    }
+    return "HTTP " + std::to_string(response.status_code);
+}
+
+void record_result(LoadReport& report, const HttpResponse& response, Clock::duration latency) {
+    report.latency.record(std::chrono::duration_cast<std::chrono::microseconds>(latency));
+    if (response.success) {
+        ++report.successes;
+    } else {
+        ++report.failures;
+        ++report.errors[error_key(response)];
+    }
+}
+
+Task<void> timed_request(AsyncHttpClient& client,
+                         const LoadConfig& config,
+                         const std::string& url,
+                         Clock::time_point intended,
+                         LoadReport& report) {
+    HttpResponse response = co_await client.request(url, config.method, config.data, config.headers);
+    record_result(report, response, Clock::now() - intended);
+}
+
+Task<void> open_loop_driver(AsyncHttpClient& client,
+                            const LoadConfig& config,
+                            Clock::time_point start,
+                            LoadReport& report) {
+    std::chrono::duration<double> interval(1.0 / config.rate);
+    Clock::time_point end = start + config.duration;
+
+    for (std::uint64_t i = 0;; ++i) {
+        Clock::time_point intended = start + std::chrono::duration_cast<Clock::duration>(interval * i);
+        if (intended >= end) {
+            break;
+        }
+        Clock::time_point now = Clock::now();
+        if (intended > now) {
+            co_await client.sleep_for(std::chrono::ceil<std::chrono::milliseconds>(intended - now));
+        }
+        // Requests already due (timer granularity, a slow loop) are sent back to back
+        const std::string& url = config.urls[i % config.urls.size()];
+        client.spawn(timed_request(client, config, url, intended, report));
+    }
+}
+
+} // namespace
+
+LatencyHistogram::LatencyHistogram()
+    : buckets_(BUCKET_COUNT, 0),
+      count_(0),
+      min_(std::numeric_limits<std::uint64_t>::max()),
+      max_(0),
+      sum_(0) {}
+
+std::size_t LatencyHistogram::bucket_index(std::uint64_t value) {
+    if (value < EXACT_BUCKETS) {
+        return static_cast<std::size_t>(value);
+    }
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - 6;
+    std::uint64_t top = value >> shift; // in [64, 128)
+    return EXACT_BUCKETS + static_cast<std::size_t>(msb - 7) * SUB_BUCKETS + static_cast<std::size_t>(top - 64);
+}
+
+std::uint64_t LatencyHistogram::bucket_upper_bound(std::size_t index) {
+    if (index < EXACT_BUCKETS) {
+        return index;
+    }
+    std::size_t offset = index - EXACT_BUCKETS;
+    int shift = static_cast<int>(offset / SUB_BUCKETS) + 1;
+    std::uint64_t top = SUB_BUCKETS + offset % SUB_BUCKETS;
+    return ((top + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(std::chrono::microseconds latency) {
+    std::uint64_t value = latency.count() > 0 ? static_cast<std::uint64_t>(latency.count()) : 0;
+    ++buckets_[bucket_index(value)];
+    ++count_;
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+    sum_ += value;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (std::size_t i = 0; i < buckets_.size(); ++i) {
+        buckets_[i] += other.buckets_[i];
+    }
+    count_ += other.count_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+    sum_ += other.sum_;
+}
+
+std::chrono::microseconds LatencyHistogram::percentile(double p) const {
+    if (count_ == 0) {
+        return std::chrono::microseconds(0);
+    }
+    p = std::clamp(p, 0.0, 100.0);
+    auto rank = static_cast<std::uint64_t>(std::ceil(p / 100.0 * static_cast<double>(count_)));
+    rank = std::clamp<std::uint64_t>(rank, 1, count_);
+
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < buckets_.size(); ++i) {
+        seen += buckets_[i];
+        if (seen >= rank) {
+            return std::chrono::microseconds(std::min(bucket_upper_bound(i), max_));
+        }
+    }
+    return std::chrono::microseconds(max_);
+}
+
+std::chrono::microseconds LatencyHistogram::min() const {
+    return std::chrono::microseconds(count_ ? min_ : 0);
+}
+
+std::chrono::microseconds LatencyHistogram::mean() const {
+    return std::chrono::microseconds(count_ ? static_cast<std::int64_t>(sum_ / count_) : 0);
+}
+
+void LoadReport::merge(const LoadReport& other) {
+    latency.merge(other.latency);
+    successes += other.successes;
+    failures += other.failures;
+    for (const auto& entry : other.errors) {
+        errors[entry.first] += entry.second;
+    }
+    allocations.merge(other.allocations);
+}
+
+double LoadReport::throughput() const {
+    if (elapsed.count() <= 0) {
+        return 0.0;
+    }
+    return static_cast<double>(successes + failures) / elapsed.count();
+}
+
+LoadReport run_open_loop(const LoadConfig& config) {
+    LoadReport report;
+    AsyncHttpClient client(config.timeout_seconds);
+    client.set_max_retries(config.max_retries);
+
+    Clock::time_point start = Clock::now();
+    client.sync_wait(open_loop_driver(client, config, start, report));
+    client.run(); // requests still in flight when the schedule ends
+    report.elapsed = Clock::now() - start;
+    return report;
+}
+
+LoadReport run_closed_loop(const LoadConfig& config) {
+    LoadReport report;
+    std::mutex report_mutex;
+    Clock::time_point start = Clock::now();
+    Clock::time_point end = start + config.duration;
+
+    // One index or output file shared by all workers
+    std::shared_ptr<ReplayTransport> replay;
+    std::shared_ptr<TransportRecorder> recorder;
+    if (!config.replay_path.empty()) {
+        replay = std::make_shared<ReplayTransport>(config.replay_path, config.replay_timing);
+    } else if (!config.record_path.empty()) {
+        recorder = std::make_shared<TransportRecorder>(config.record_path);
+    }
+
+    std::vector<std::thread> workers;
+    for (int worker = 0; worker < config.concurrency; ++worker) {
+        workers.emplace_back([&, worker] {
+            LoadReport local;
+            HttpClient client(config.timeout_seconds);
+            client.set_max_retries(config.max_retries);
+            if (replay) {
+                client.set_transport(replay);
+            } else if (recorder) {
+                client.set_transport(std::make_shared<RecordingTransport>(
+                    std::make_shared<CurlTransport>(config.timeout_seconds), recorder));
+            }
+
+            // Stagger start URLs so workers do not move through the list in lockstep
+            for (std::size_t i = static_cast<std::size_t>(worker); Clock::now() < end; ++i) {
+                const std::string& url = config.urls[i % config.urls.size()];
+                Clock::time_point sent = Clock::now();
+                HttpResponse response;
+                {
+                    AllocationScope allocations(local.allocations);
+                    response = client.make_request(url, config.method, config.data, config.headers);
+                }
+                record_result(local, response, Clock::now() - sent);
+            }
+
+            std::lock_guard<std::mutex> lock(report_mutex);
+            report.merge(local);
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    report.elapsed = Clock::now() - start;
+    return report;
+}
+
+LoadReport run_load(const LoadConfig& config) {
+    if (config.urls.empty()) {
+        throw std::invalid_argument("At least one URL is required");
+    }
+    if (config.mode == LoadMode::OPEN_LOOP) {
+        if (!(config.rate > 0)) {
+            throw std::invalid_argument("Open-loop rate must be positive");
+        }
+        if (!config.record_path.empty() || !config.replay_path.empty()) {
+            throw std::invalid_argument("Recording and replay require closed-loop mode");
+        }
+        return run_open_loop(config);
+    }
+    if (config.concurrency <= 0) {
+        throw std::invalid_argument("Closed-loop concurrency must be positive");
+    }
+    return run_closed_loop(config);
+}
+
+void print_report(const LoadConfig& config, const LoadReport& report, std::ostream& out) {
+    auto ms = [](std::chrono::microseconds value) { return static_cast<double>(value.count()) / 1000.0; };
+    std::ios::fmtflags flags = out.flags();
+    out << std::fixed << std::setprecision(2);
+
+    if (config.mode == LoadMode::OPEN_LOOP) {
+        out << "Mode:        open loop, " << config.rate << " req/s offered\n";
+    } else {
+        out << "Mode:        closed loop, " << config.concurrency << " workers\n";
+    }
+    out << "Elapsed:     " << report.elapsed.count() << " s\n";
+    out << "Requests:    " << report.latency.count() << " (" << report.successes << " ok, "
+        << report.failures << " failed)\n";
+    out << "Throughput:  " << report.throughput() << " req/s\n";
+    out << "Latency ms:  min " << ms(report.latency.min())
+        << "  mean " << ms(report.latency.mean())
+        << "  p50 " << ms(report.latency.percentile(50))
+        << "  p90 " << ms(report.latency.percentile(90))
+        << "  p99 " << ms(report.latency.percentile(99))
+        << "  p99.9 " << ms(report.latency.percentile(99.9))
+        << "  max " << ms(report.latency.max()) << "\n";
+    for (const auto& entry : report.errors) {
+        out << "Error:       " << entry.first << " x" << entry.second << "\n";
+    }
+    if (AllocationTracker::installed() && report.allocations.requests > 0) {
+        const AllocationProfile& allocations = report.allocations;
+        double requests = static_cast<double>(allocations.requests);
+        auto per_request = [&](const char* name, const AllocationStats& stats) {
+            out << "  " << std::left << std::setw(9) << name << std::right << std::setw(10)
+                << stats.allocations / requests << " allocs  " << std::setw(12) << stats.bytes / requests
+                << " bytes\n";
+        };
+        out << "Allocations: per request, " << allocations.total.allocations / requests << " allocs  "
+            << allocations.total.bytes / requests << " bytes\n";
+        for (std::size_t i = 0; i < REQUEST_PHASE_COUNT; ++i) {
+            per_request(request_phase_name(static_cast<RequestPhase>(i)), allocations.phases[i]);
+        }
+        per_request("other", allocations.unphased());
+    }
+    out.flags(flags);
+}
@@ -0,0 +1,49 @@
+#include "MappedFile.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+MappedFile::MappedFile(const std::string& path) : data_(nullptr), size_(0) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + path + ": " + std::strerror(errno));
+    }
+    try {
+        map(fd, path);
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    ::close(fd); // the mapping stays valid
+}
+
+MappedFile::MappedFile(int fd) : data_(nullptr), size_(0) {
+    map(fd, "descriptor " + std::to_string(fd));
+}
+
+void MappedFile::map(int fd, const std::string& name) {
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        throw std::runtime_error("Cannot stat " + name + ": " + std::strerror(errno));
+    }
+    size_ = static_cast<std::size_t>(info.st_size);
+    if (size_ == 0) {
+        return; // mmap rejects empty mappings
+    }
+    void* mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Cannot map " + name + ": " + std::strerror(errno));
+    }
+    ::madvise(mapping, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const char*>(mapping);
+}
+
+MappedFile::~MappedFile() {
+    if (data_) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+}
@@ -0,0 +1,240 @@
+#include "Metrics.h"
+#include "HttpUtils.h"
+#include "PerfCounters.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+struct MetricInfo {
+    const char* name;
+    const char* help;
+};
+
+/// Prometheus names in Metric order
+const MetricInfo METRIC_INFO[METRIC_COUNT] = {
+    {"http_client_requests_total", "Requests started"},
+    {"http_client_successes_total", "Requests that ended with a 2xx response"},
+    {"http_client_failures_total", "Requests that gave up"},
+    {"http_client_attempts_total", "Transfers performed, including retries"},
+    {"http_client_retries_total", "Attempts after the first"},
+    {"http_client_transport_errors_total", "Attempts that failed below HTTP"},
+    {"http_client_cache_hits_total", "GET requests answered from the response cache"},
+    {"http_client_sent_bytes_total", "Request body bytes sent"},
+    {"http_client_received_bytes_total", "Response body bytes received"},
+    {"http_client_backoff_seconds_total", "Time spent sleeping between attempts"},
+};
+
+/// Longest request head the metrics server reads
+const std::size_t MAX_REQUEST_BYTES = 8192;
+
+void send_all(int fd, const std::string& data) {
+    std::size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t written = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (written <= 0) {
+            return; // the scraper went away
+        }
+        sent += static_cast<std::size_t>(written);
+    }
+}
+
+} // namespace
+
+HttpMetrics& HttpMetrics::instance() {
+    static HttpMetrics metrics;
+    return metrics;
+}
+
+HttpMetrics::ShardHandle::ShardHandle() {
+    HttpMetrics& metrics = instance();
+    std::lock_guard<std::mutex> lock(metrics.mutex_);
+    metrics.shards_.push_back(std::make_unique<Shard>());
+    shard = metrics.shards_.back().get();
+}
+
+HttpMetrics::ShardHandle::~ShardHandle() {
+    HttpMetrics& metrics = instance();
+    std::lock_guard<std::mutex> lock(metrics.mutex_);
+    for (std::size_t i = 0; i < METRIC_COUNT; ++i) {
+        metrics.retired_.counters[i] += shard->counters[i].load(std::memory_order_relaxed);
+    }
+    for (int i = 0; i < STATUS_COUNT; ++i) {
+        if (std::uint64_t count = shard->responses[i].load(std::memory_order_relaxed)) {
+            metrics.retired_.responses[MIN_STATUS + i] += count;
+        }
+    }
+    auto it = std::find_if(metrics.shards_.begin(), metrics.shards_.end(),
+                           [this](const std::unique_ptr<Shard>& entry) { return entry.get() == shard; });
+    metrics.shards_.erase(it);
+}
+
+HttpMetrics::Shard& HttpMetrics::local_shard() {
+    thread_local ShardHandle handle;
+    return *handle.shard;
+}
+
+void HttpMetrics::add(Metric metric, std::uint64_t amount) {
+    increment(local_shard().counters[static_cast<std::size_t>(metric)], amount);
+}
+
+void HttpMetrics::add_response(int status_code) {
+    if (status_code >= MIN_STATUS && status_code < MIN_STATUS + STATUS_COUNT) {
+        increment(local_shard().responses[status_code - MIN_STATUS], 1);
+    }
+}
+
+MetricsSnapshot HttpMetrics::snapshot() {
+    HttpMetrics& metrics = instance();
+    std::lock_guard<std::mutex> lock(metrics.mutex_);
+    MetricsSnapshot result = metrics.retired_;
+    for (const auto& shard : metrics.shards_) {
+        for (std::size_t i = 0; i < METRIC_COUNT; ++i) {
+            result.counters[i] += shard->counters[i].load(std::memory_order_relaxed);
+        }
+        for (int i = 0; i < STATUS_COUNT; ++i) {
+            if (std::uint64_t count = shard->responses[i].load(std::memory_order_relaxed)) {
+                result.responses[MIN_STATUS + i] += count;
+            }
+        }
+    }
+    return result;
+}
+
+void HttpMetrics::write_prometheus(std::ostream& out) {
+    MetricsSnapshot totals = snapshot();
+    for (std::size_t i = 0; i < METRIC_COUNT; ++i) {
+        const MetricInfo& info = METRIC_INFO[i];
+        out << "# HELP " << info.name << " " << info.help << "\n"
+            << "# TYPE " << info.name << " counter\n"
+            << info.name << " ";
+        if (static_cast<Metric>(i) == Metric::BACKOFF_MICROSECONDS) {
+            std::ios::fmtflags flags = out.flags();
+            out << std::fixed << std::setprecision(6) << static_cast<double>(totals.counters[i]) / 1e6;
+            out.flags(flags);
+        } else {
+            out << totals.counters[i];
+        }
+        out << "\n";
+    }
+    out << "# HELP http_client_responses_total HTTP responses by status code\n"
+        << "# TYPE http_client_responses_total counter\n";
+    for (const auto& response : totals.responses) {
+        out << "http_client_responses_total{code=\"" << response.first << "\"} " << response.second << "\n";
+    }
+}
+
+std::string HttpMetrics::prometheus() {
+    std::ostringstream out;
+    write_prometheus(out);
+    return out.str();
+}
+
+MetricsServer::MetricsServer(std::uint16_t port) : listen_fd_(-1), wake_fd_(-1), port_(0) {
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        throw std::runtime_error("Cannot create metrics socket: " + std::string(std::strerror(errno)));
+    }
+    int enable = 1;
+    ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    socklen_t length = sizeof(addr);
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listen_fd_, 16) != 0 ||
+        ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &length) != 0) {
+        std::string error = std::strerror(errno);
+        ::close(listen_fd_);
+        throw std::runtime_error("Cannot listen for metrics on port " + std::to_string(port) + ": " + error);
+    }
+    port_ = ntohs(addr.sin_port);
+
+    wake_fd_ = ::eventfd(0, EFD_CLOEXEC);
+    if (wake_fd_ < 0) {
+        ::close(listen_fd_);
+        throw std::runtime_error("Cannot create metrics eventfd: " + std::string(std::strerror(errno)));
+    }
+    thread_ = std::thread([this] { serve(); });
+}
+
+MetricsServer::~MetricsServer() {
+    std::uint64_t one = 1;
+    ssize_t written = ::write(wake_fd_, &one, sizeof(one));
+    (void)written; // an eventfd write only fails on counter overflow
+    thread_.join();
+    ::close(wake_fd_);
+    ::close(listen_fd_);
+}
+
+std::string MetricsServer::url() const {
+    return "http://127.0.0.1:" + std::to_string(port_) + "/metrics";
+}
+
+void MetricsServer::serve() {
+    while (true) {
+        pollfd fds[2] = {{listen_fd_, POLLIN, 0}, {wake_fd_, POLLIN, 0}};
+        if (::poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            log_error("Metrics server poll failed: " + std::string(std::strerror(errno)));
+            return;
+        }
+        if (fds[1].revents) {
+            return;
+        }
+        int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd >= 0) {
+            respond(fd);
+            ::close(fd);
+        }
+    }
+}
+
+void MetricsServer::respond(int fd) {
+    // A stalled client must not block the server for long
+    timeval timeout{1, 0};
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < MAX_REQUEST_BYTES) {
+        ssize_t received = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            return;
+        }
+        request.append(buffer, static_cast<std::size_t>(received));
+    }
+
+    auto requested = [&request](const std::string& path) {
+        return request.compare(0, path.size(), path) == 0 && request.size() > path.size() &&
+               (request[path.size()] == ' ' || request[path.size()] == '?');
+    };
+    std::string status = "200 OK";
+    std::string body;
+    if (requested("GET /metrics")) {
+        body = HttpMetrics::prometheus();
+    } else if (requested("GET /profile")) {
+        body = PhaseProfiler::enabled() ? PhaseProfiler::report() : "Phase profiling is disabled\n";
+    } else {
+        status = "404 Not Found";
+        body = "Only GET /metrics and GET /profile are served\n";
+    }
+    send_all(fd, "HTTP/1.1 " + status + "\r\n"
+                 "Content-Type: text/plain; version=0.0.4\r\n"
+                 "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                 "Connection: close\r\n\r\n" + body);
+}
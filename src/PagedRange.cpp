@@ -0,0 +1,281 @@
+#include "PagedRange.h"
+#include "JsonOnDemand.h"
+#include <algorithm>
+#include <cctype>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+/// Percent-encodes everything but RFC 3986 unreserved characters
+std::string encode_query_value(const std::string& value) {
+    static const char* hex = "0123456789ABCDEF";
+    std::string encoded;
+    encoded.reserve(value.size());
+    for (unsigned char c : value) {
+        if (std::isalnum(c) || c == '-' || c == '.' || c == '_' || c == '~') {
+            encoded += static_cast<char>(c);
+        } else {
+            encoded += '%';
+            encoded += hex[c >> 4];
+            encoded += hex[c & 0xF];
+        }
+    }
+    return encoded;
+}
+
+/// Appends name=value to the query of a URL (value already encoded)
+std::string with_query(const std::string& url, const std::string& name, const std::string& value) {
+    std::size_t fragment = url.find('#');
+    std::string base = url.substr(0, fragment);
+    char separator = base.find('?') == std::string::npos ? '?' : '&';
+    if (!base.empty() && (base.back() == '?' || base.back() == '&')) {
+        base.pop_back();
+    }
+    return base + separator + name + "=" + value;
+}
+
+/// Resolves a URI reference (absolute, "//host/..", "/path", "?query" or relative path) against a URL
+std::string resolve_reference(const std::string& target, const std::string& base) {
+    std::size_t scheme_end = base.find("://");
+    if (target.find("://") != std::string::npos || scheme_end == std::string::npos) {
+        return target;
+    }
+    if (target.compare(0, 2, "//") == 0) {
+        return base.substr(0, scheme_end + 1) + target;
+    }
+    std::size_t authority_end = base.find_first_of("/?#", scheme_end + 3);
+    std::string origin = base.substr(0, authority_end);
+    if (!target.empty() && target[0] == '/') {
+        return origin + target;
+    }
+    std::string path = authority_end == std::string::npos ? std::string("/") : base.substr(authority_end);
+    path = path.substr(0, path.find_first_of("?#"));
+    if (!target.empty() && target[0] == '?') {
+        return origin + path + target;
+    }
+    std::size_t last_slash = path.rfind('/');
+    return origin + (last_slash == std::string::npos ? std::string("/") : path.substr(0, last_slash + 1)) + target;
+}
+
+std::string trim(const std::string& text) {
+    std::size_t first = text.find_first_not_of(" \t");
+    if (first == std::string::npos) {
+        return std::string();
+    }
+    return text.substr(first, text.find_last_not_of(" \t") - first + 1);
+}
+
+} // namespace
+
+PagedRange::iterator::iterator(PagedRange* range) : range_(range) {
+    ++*this;
+}
+
+PagedRange::iterator& PagedRange::iterator::operator++() {
+    if (range_ && !range_->next(page_)) {
+        range_ = nullptr;
+    }
+    return *this;
+}
+
+PagedRange::PagedRange(PageConfig config)
+    : config_(std::move(config)), end_(std::numeric_limits<std::size_t>::max()) {
+    if (config_.url.empty()) {
+        throw std::invalid_argument("PagedRange needs a URL");
+    }
+    if (config_.prefetch < 1) {
+        throw std::invalid_argument("PagedRange prefetch must be positive");
+    }
+    if (config_.style == PageStyle::OFFSET &&
+        (config_.page_size == 0 || config_.offset_param.empty() || config_.limit_param.empty())) {
+        throw std::invalid_argument("PagedRange offset paging needs a page size and both parameters");
+    }
+    if (config_.style == PageStyle::CURSOR && (config_.cursor_param.empty() || config_.cursor_field.empty())) {
+        throw std::invalid_argument("PagedRange cursor paging needs a cursor parameter and field");
+    }
+    options_.cancellation = cancel_.token();
+}
+
+PagedRange::~PagedRange() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cancel_.cancel();
+    space_cv_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+void PagedRange::start() {
+    started_ = true;
+    if (config_.style == PageStyle::OFFSET) {
+        for (int i = 0; i < config_.prefetch; ++i) {
+            workers_.emplace_back([this] { offset_worker(); });
+        }
+    } else {
+        workers_.emplace_back([this] { sequential_worker(); });
+    }
+}
+
+bool PagedRange::next(Page& page) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!started_) {
+        start();
+    }
+    ready_cv_.wait(lock, [this] { return consumed_ >= end_ || ready_.count(consumed_) > 0; });
+    if (consumed_ >= end_) {
+        return false;
+    }
+    auto it = ready_.find(consumed_);
+    page = std::move(it->second);
+    ready_.erase(it);
+    ++consumed_;
+    space_cv_.notify_all();
+    return true;
+}
+
+void PagedRange::offset_worker() {
+    HttpClient client(config_.timeout_seconds);
+    client.set_max_retries(config_.max_retries);
+    std::size_t window = static_cast<std::size_t>(config_.prefetch);
+    for (;;) {
+        std::size_t index;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            space_cv_.wait(lock, [&] {
+                return stopping_ || next_fetch_ >= end_ || next_fetch_ < consumed_ + window;
+            });
+            if (stopping_ || next_fetch_ >= end_) {
+                return;
+            }
+            index = next_fetch_++;
+        }
+        std::string url = with_query(config_.url, config_.offset_param, std::to_string(index * config_.page_size));
+        url = with_query(url, config_.limit_param, std::to_string(config_.page_size));
+        Page page = fetch(client, index, url, nullptr);
+        bool last = !page.response.success || page.items < config_.page_size;
+        publish(std::move(page), last);
+    }
+}
+
+void PagedRange::sequential_worker() {
+    HttpClient client(config_.timeout_seconds);
+    client.set_max_retries(config_.max_retries);
+    std::size_t window = static_cast<std::size_t>(config_.prefetch);
+    std::string url = config_.url;
+    for (std::size_t index = 0;; ++index) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            space_cv_.wait(lock, [&] { return stopping_ || index < consumed_ + window; });
+            if (stopping_) {
+                return;
+            }
+        }
+        std::string next_url;
+        Page page = fetch(client, index, url, &next_url);
+        bool last = !page.response.success || next_url.empty();
+        publish(std::move(page), last);
+        if (last) {
+            return;
+        }
+        url = std::move(next_url);
+    }
+}
+
+Page PagedRange::fetch(HttpClient& client, std::size_t index, const std::string& url, std::string* next_url) {
+    Page page;
+    page.index = index;
+    page.url = url;
+    page.response = client.make_request(url, "GET", "", config_.headers, options_);
+    if (!page.response.success) {
+        return page;
+    }
+
+    try {
+        JsonDocument document(page.response.body);
+        JsonValue root = document.root();
+        JsonValue items = config_.items_field.empty() ? root : root[config_.items_field];
+        if (items.type() != JsonType::ARRAY) {
+            throw JsonError("items are not an array");
+        }
+        page.items = items.size();
+
+        JsonValue cursor;
+        if (next_url && config_.style == PageStyle::CURSOR && root.type() == JsonType::OBJECT &&
+            root.find(config_.cursor_field, cursor) && !cursor.is_null()) {
+            std::string value = cursor.type() == JsonType::STRING ? cursor.get_string() : std::string(cursor.raw());
+            if (!value.empty()) {
+                *next_url = with_query(config_.url, config_.cursor_param, encode_query_value(value));
+            }
+        }
+    } catch (const JsonError& e) {
+        page.items = 0;
+        page.response.success = false;
+        page.response.error_message = std::string("Unexpected page body: ") + e.what();
+        log_error(page.response.error_message + " (" + url + ")");
+        return page;
+    }
+
+    if (next_url && config_.style == PageStyle::LINK) {
+        auto link = page.response.headers.find("link");
+        if (link != page.response.headers.end()) {
+            *next_url = next_link(link->second, url);
+        }
+    }
+    return page;
+}
+
+void PagedRange::publish(Page page, bool last) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // OFFSET pages requested before a short page arrived lie past the end
+    if (page.index >= end_) {
+        return;
+    }
+    if (last) {
+        end_ = page.index + 1;
+        ready_.erase(ready_.upper_bound(page.index), ready_.end());
+    }
+    ready_.emplace(page.index, std::move(page));
+    ready_cv_.notify_all();
+    space_cv_.notify_all();
+}
+
+std::string PagedRange::next_link(const std::string& link_header, const std::string& request_url) {
+    // <url>; rel="next", <url>; rel="last"; a URL may itself contain ',' or ';'
+    std::size_t open = 0;
+    while ((open = link_header.find('<', open)) != std::string::npos) {
+        std::size_t close = link_header.find('>', open);
+        if (close == std::string::npos) {
+            break;
+        }
+        std::size_t params_end = link_header.find('<', close);
+        std::string params = link_header.substr(
+            close + 1, params_end == std::string::npos ? std::string::npos : params_end - close - 1);
+        std::transform(params.begin(), params.end(), params.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+        std::size_t rel = params.find("rel=");
+        if (rel != std::string::npos) {
+            std::size_t value_start = rel + 4;
+            std::size_t value_end;
+            if (value_start < params.size() && params[value_start] == '"') {
+                ++value_start;
+                value_end = params.find('"', value_start);
+            } else {
+                value_end = params.find_first_of(";, ", value_start);
+            }
+            // rel may list several space-separated relation types
+            std::string value = " " + params.substr(value_start, value_end == std::string::npos
+                                                                     ? std::string::npos
+                                                                     : value_end - value_start) + " ";
+            if (value.find(" next ") != std::string::npos) {
+                return resolve_reference(trim(link_header.substr(open + 1, close - open - 1)), request_url);
+            }
+        }
+        open = close;
+    }
+    return std::string();
+}
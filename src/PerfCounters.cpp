@@ -0,0 +1,239 @@
+#include "PerfCounters.h"
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+struct EventSpec {
+    std::uint32_t type;
+    std::uint64_t config;
+};
+
+const std::array<EventSpec, PERF_EVENT_COUNT> EVENT_SPECS = {{
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+}};
+
+int open_event(const EventSpec& spec, int group_fd, bool user_only) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = spec.type;
+    attr.config = spec.config;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.exclude_kernel = user_only ? 1 : 0;
+    attr.exclude_hv = 1;
+    // This thread on any CPU
+    return static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, PERF_FLAG_FD_CLOEXEC));
+}
+
+/// Average per call, or "n/a" for events that were not counted
+std::string per_call(std::uint64_t total, std::uint64_t calls, bool available) {
+    if (!available) {
+        return "n/a";
+    }
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(0) << (calls ? static_cast<double>(total) / calls : 0.0);
+    return out.str();
+}
+
+} // namespace
+
+const char* perf_event_name(PerfEvent event) {
+    switch (event) {
+    case PerfEvent::CYCLES:
+        return "cycles";
+    case PerfEvent::INSTRUCTIONS:
+        return "instructions";
+    case PerfEvent::CACHE_MISSES:
+        return "cache-misses";
+    case PerfEvent::CONTEXT_SWITCHES:
+        return "context-switches";
+    default:
+        return "unknown";
+    }
+}
+
+PerfCounters::PerfCounters() : leader_fd_(-1), opened_(0), user_only_(false), error_(0) {
+    fds_.fill(-1);
+    slots_.fill(-1);
+    for (std::size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+        int fd = open_event(EVENT_SPECS[i], leader_fd_, user_only_);
+        // Unprivileged processes may only count user mode (perf_event_paranoid >= 2)
+        if (fd < 0 && (errno == EACCES || errno == EPERM) && !user_only_ && leader_fd_ < 0) {
+            user_only_ = true;
+            fd = open_event(EVENT_SPECS[i], leader_fd_, user_only_);
+        }
+        if (fd < 0) {
+            error_ = errno;
+            continue;
+        }
+        if (leader_fd_ < 0) {
+            leader_fd_ = fd;
+        }
+        fds_[i] = fd;
+        slots_[i] = static_cast<int>(opened_++);
+    }
+}
+
+PerfCounters::~PerfCounters() {
+    for (int fd : fds_) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+}
+
+PerfSample PerfCounters::read() const {
+    PerfSample sample;
+    if (leader_fd_ < 0) {
+        return sample;
+    }
+    // nr, time_enabled, time_running, then one value per opened event
+    std::array<std::uint64_t, 3 + PERF_EVENT_COUNT> buffer{};
+    ssize_t length = ::read(leader_fd_, buffer.data(), sizeof(buffer));
+    if (length < static_cast<ssize_t>(3 * sizeof(std::uint64_t))) {
+        return sample;
+    }
+    std::uint64_t enabled = buffer[1];
+    std::uint64_t running = buffer[2];
+    double scale = running > 0 && running < enabled ? static_cast<double>(enabled) / running : 1.0;
+    for (std::size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+        if (slots_[i] >= 0 && static_cast<std::uint64_t>(slots_[i]) < buffer[0]) {
+            sample.values[i] = static_cast<std::uint64_t>(static_cast<double>(buffer[3 + slots_[i]]) * scale);
+        }
+    }
+    return sample;
+}
+
+PerfCounters& PerfCounters::thread_instance() {
+    thread_local PerfCounters counters;
+    return counters;
+}
+
+const char* request_phase_name(RequestPhase phase) {
+    switch (phase) {
+    case RequestPhase::SETUP:
+        return "setup";
+    case RequestPhase::PERFORM:
+        return "perform";
+    case RequestPhase::PARSE:
+        return "parse";
+    case RequestPhase::LOGGING:
+        return "logging";
+    default:
+        return "unknown";
+    }
+}
+
+std::array<PhaseProfiler::Totals, REQUEST_PHASE_COUNT>& PhaseProfiler::totals() {
+    static std::array<Totals, REQUEST_PHASE_COUNT> totals;
+    return totals;
+}
+
+void PhaseProfiler::add(RequestPhase phase, std::chrono::nanoseconds wall, const PerfSample& counters) {
+    Totals& phase_totals = totals()[static_cast<std::size_t>(phase)];
+    phase_totals.calls.fetch_add(1, std::memory_order_relaxed);
+    phase_totals.wall_ns.fetch_add(static_cast<std::uint64_t>(wall.count()), std::memory_order_relaxed);
+    for (std::size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+        if (counters.values[i]) {
+            phase_totals.counters[i].fetch_add(counters.values[i], std::memory_order_relaxed);
+        }
+    }
+}
+
+PhaseProfile PhaseProfiler::snapshot() {
+    PhaseProfile profile;
+    for (std::size_t p = 0; p < REQUEST_PHASE_COUNT; ++p) {
+        const Totals& phase_totals = totals()[p];
+        PhaseStats& stats = profile.phases[p];
+        stats.calls = phase_totals.calls.load(std::memory_order_relaxed);
+        stats.wall_ns = phase_totals.wall_ns.load(std::memory_order_relaxed);
+        for (std::size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+            stats.counters.values[i] = phase_totals.counters[i].load(std::memory_order_relaxed);
+        }
+    }
+    const PerfCounters& counters = PerfCounters::thread_instance();
+    for (std::size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+        profile.available[i] = counters.available(static_cast<PerfEvent>(i));
+    }
+    return profile;
+}
+
+void PhaseProfiler::reset() {
+    for (Totals& phase_totals : totals()) {
+        phase_totals.calls.store(0, std::memory_order_relaxed);
+        phase_totals.wall_ns.store(0, std::memory_order_relaxed);
+        for (auto& counter : phase_totals.counters) {
+            counter.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+void PhaseProfiler::write_report(std::ostream& out) {
+    PhaseProfile profile = snapshot();
+    bool available_cycles = profile.available[static_cast<std::size_t>(PerfEvent::CYCLES)];
+    bool available_instructions = profile.available[static_cast<std::size_t>(PerfEvent::INSTRUCTIONS)];
+
+    out << "Per-call averages by request phase";
+    if (PerfCounters::thread_instance().user_only()) {
+        out << " (user mode only)";
+    }
+    out << "\n" << std::left << std::setw(10) << "phase" << std::right << std::setw(10) << "calls" << std::setw(12)
+        << "wall-us";
+    for (std::size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+        out << std::setw(18) << perf_event_name(static_cast<PerfEvent>(i));
+    }
+    out << std::setw(7) << "IPC" << "\n";
+
+    for (std::size_t p = 0; p < REQUEST_PHASE_COUNT; ++p) {
+        const PhaseStats& stats = profile.phases[p];
+        out << std::left << std::setw(10) << request_phase_name(static_cast<RequestPhase>(p)) << std::right
+            << std::setw(10) << stats.calls << std::setw(12) << std::fixed << std::setprecision(1)
+            << (stats.calls ? static_cast<double>(stats.wall_ns) / stats.calls / 1000 : 0.0);
+        for (std::size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+            out << std::setw(18) << per_call(stats.counters.values[i], stats.calls, profile.available[i]);
+        }
+        std::uint64_t cycles = stats.counters[PerfEvent::CYCLES];
+        if (available_cycles && available_instructions && cycles > 0) {
+            out << std::setw(7) << std::setprecision(2)
+                << static_cast<double>(stats.counters[PerfEvent::INSTRUCTIONS]) / cycles;
+        } else {
+            out << std::setw(7) << "n/a";
+        }
+        out << "\n";
+    }
+    const PerfCounters& counters = PerfCounters::thread_instance();
+    if (!counters.any_available()) {
+        out << "perf_event_open unavailable (" << std::strerror(counters.error()) << "); wall time only\n";
+    }
+}
+
+std::string PhaseProfiler::report() {
+    std::ostringstream out;
+    write_report(out);
+    return out.str();
+}
+
+void PhaseScope::start() {
+    begin_ = PerfCounters::thread_instance().read();
+    started_ = std::chrono::steady_clock::now();
+}
+
+void PhaseScope::stop() {
+    auto elapsed = std::chrono::steady_clock::now() - started_;
+    PerfSample end = PerfCounters::thread_instance().read();
+    PerfSample delta;
+    for (std::size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+        // Scaling of multiplexed counts can make a later estimate smaller
+        delta.values[i] = end.values[i] > begin_.values[i] ? end.values[i] - begin_.values[i] : 0;
+    }
+    PhaseProfiler::add(phase_, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed), delta);
+}
@@ -0,0 +1,236 @@
+#include "ReplicaSet.h"
+#include "HttpUtils.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+ReplicaSet::Lease::Lease(Lease&& other) noexcept : set_(other.set_), index_(other.index_) {
+    other.set_ = nullptr;
+}
+
+ReplicaSet::Lease& ReplicaSet::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        if (set_) {
+            set_->release(index_, std::chrono::microseconds(0), false, false);
+        }
+        set_ = other.set_;
+        index_ = other.index_;
+        other.set_ = nullptr;
+    }
+    return *this;
+}
+
+ReplicaSet::Lease::~Lease() {
+    if (set_) {
+        set_->release(index_, std::chrono::microseconds(0), false, false);
+    }
+}
+
+const std::string& ReplicaSet::Lease::endpoint() const {
+    return set_->replicas_[index_].endpoint;
+}
+
+void ReplicaSet::Lease::complete(std::chrono::microseconds latency, bool failed) {
+    if (set_) {
+        set_->release(index_, latency, failed, true);
+        set_ = nullptr;
+    }
+}
+
+ReplicaSet::ReplicaSet(std::vector<std::string> endpoints, ReplicaConfig config)
+    : config_(config), random_(std::random_device{}()) {
+    if (endpoints.empty()) {
+        throw std::invalid_argument("ReplicaSet needs at least one endpoint");
+    }
+    if (config_.decay.count() <= 0 || config_.consecutive_failures < 1 || config_.base_ejection.count() < 0 ||
+        config_.max_ejection < config_.base_ejection || config_.max_ejected_fraction < 0 ||
+        config_.max_ejected_fraction > 1) {
+        throw std::invalid_argument("Invalid ReplicaConfig");
+    }
+    Clock::time_point now = Clock::now();
+    for (std::string& endpoint : endpoints) {
+        if (endpoint.find("://") == std::string::npos) {
+            throw std::invalid_argument("Replica endpoint needs a scheme: " + endpoint);
+        }
+        while (endpoint.size() > 1 && endpoint.back() == '/') {
+            endpoint.pop_back();
+        }
+        Replica replica;
+        replica.endpoint = std::move(endpoint);
+        replica.latency_us = static_cast<double>(
+            std::chrono::duration_cast<std::chrono::microseconds>(config_.initial_latency).count());
+        replica.updated = now;
+        replicas_.push_back(std::move(replica));
+    }
+    candidates_.reserve(replicas_.size());
+}
+
+double ReplicaSet::cost(const Replica& replica, Clock::time_point now) const {
+    // An idle replica's estimate fades, so one that was slow once is eventually retried
+    double idle = std::chrono::duration<double>(now - replica.updated).count();
+    double latency = replica.latency_us * std::exp(-idle / std::chrono::duration<double>(config_.decay).count());
+    return std::max(latency, 1.0) * static_cast<double>(replica.in_flight + 1);
+}
+
+ReplicaSet::Lease ReplicaSet::acquire() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Clock::time_point now = Clock::now();
+    candidates_.clear();
+    for (std::size_t i = 0; i < replicas_.size(); ++i) {
+        if (replicas_[i].ejected_until <= now) {
+            candidates_.push_back(i);
+        }
+    }
+    if (candidates_.empty()) {
+        // Only reachable when every remaining replica was ejected before the others came back
+        for (std::size_t i = 0; i < replicas_.size(); ++i) {
+            candidates_.push_back(i);
+        }
+    }
+
+    std::size_t chosen = candidates_[0];
+    if (candidates_.size() > 1) {
+        // Two distinct candidates, uniformly
+        std::size_t first = std::uniform_int_distribution<std::size_t>(0, candidates_.size() - 1)(random_);
+        std::size_t second = std::uniform_int_distribution<std::size_t>(0, candidates_.size() - 2)(random_);
+        if (second >= first) {
+            ++second;
+        }
+        chosen = cost(replicas_[candidates_[second]], now) < cost(replicas_[candidates_[first]], now)
+                     ? candidates_[second] : candidates_[first];
+    }
+    ++replicas_[chosen].in_flight;
+    return Lease(this, chosen);
+}
+
+void ReplicaSet::release(std::size_t index, std::chrono::microseconds latency, bool failed, bool record) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Replica& replica = replicas_[index];
+    --replica.in_flight;
+    if (!record) {
+        return;
+    }
+
+    Clock::time_point now = Clock::now();
+    double sample = static_cast<double>(latency.count());
+    if (failed) {
+        // Failures are often fast (refused connections); never let them look cheap
+        sample = std::max(sample, static_cast<double>(
+            std::chrono::duration_cast<std::chrono::microseconds>(config_.failure_penalty).count()));
+    }
+    if (sample > replica.latency_us) {
+        replica.latency_us = sample;
+    } else {
+        double elapsed = std::chrono::duration<double, std::micro>(now - replica.updated).count();
+        double decay = std::chrono::duration<double, std::micro>(config_.decay).count();
+        double weight = std::exp(-elapsed / decay);
+        replica.latency_us = replica.latency_us * weight + sample * (1 - weight);
+    }
+    replica.updated = now;
+    ++replica.requests;
+
+    if (!failed) {
+        replica.failure_streak = 0;
+        return;
+    }
+    ++replica.failures;
+    if (++replica.failure_streak < config_.consecutive_failures || replica.ejected_until > now) {
+        return;
+    }
+
+    std::size_t ejected = static_cast<std::size_t>(
+        std::count_if(replicas_.begin(), replicas_.end(), [now](const Replica& r) { return r.ejected_until > now; }));
+    std::size_t limit = static_cast<std::size_t>(config_.max_ejected_fraction * static_cast<double>(replicas_.size()));
+    if (ejected + 1 > limit) {
+        return;
+    }
+    // A replica that stayed healthy longer than the longest ejection starts over at the base time
+    if (now - replica.ejected_until > config_.max_ejection) {
+        replica.ejections = 0;
+    }
+    auto duration = config_.base_ejection * (1LL << std::min(replica.ejections, 20));
+    duration = std::min<decltype(duration)>(duration, config_.max_ejection);
+    replica.ejected_until = now + duration;
+    ++replica.ejections;
+    replica.failure_streak = 0;
+    log_warning("Ejecting replica " + replica.endpoint + " for " + std::to_string(duration.count()) + "ms after " +
+                std::to_string(config_.consecutive_failures) + " consecutive failures");
+}
+
+std::vector<ReplicaStats> ReplicaSet::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Clock::time_point now = Clock::now();
+    std::vector<ReplicaStats> result;
+    result.reserve(replicas_.size());
+    for (const Replica& replica : replicas_) {
+        ReplicaStats entry;
+        entry.endpoint = replica.endpoint;
+        entry.latency_ms = replica.latency_us / 1000.0;
+        entry.in_flight = replica.in_flight;
+        entry.requests = replica.requests;
+        entry.failures = replica.failures;
+        entry.ejected = replica.ejected_until > now;
+        result.push_back(entry);
+    }
+    return result;
+}
+
+std::string ReplicaSet::resolve(const std::string& url, const std::string& endpoint) {
+    if (url.empty() || url[0] == '/') {
+        return endpoint + url;
+    }
+    std::size_t scheme_end = url.find("://");
+    if (scheme_end == std::string::npos) {
+        return endpoint + "/" + url;
+    }
+    std::size_t authority_end = url.find_first_of("/?#", scheme_end + 3);
+    return endpoint + (authority_end == std::string::npos ? std::string() : url.substr(authority_end));
+}
+
+BalancedTransport::BalancedTransport(std::shared_ptr<HttpTransport> inner, std::shared_ptr<ReplicaSet> replicas)
+    : inner_(std::move(inner)), replicas_(std::move(replicas)) {}
+
+template <typename Perform>
+TransportResult BalancedTransport::balanced(const std::string& url, const RequestOptions& options, Perform perform) {
+    ReplicaSet::Lease lease = replicas_->acquire();
+    auto start = std::chrono::steady_clock::now();
+    TransportResult result = perform(ReplicaSet::resolve(url, lease.endpoint()));
+    auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+    // A transfer cut short by the caller's deadline or cancellation says nothing about the replica
+    if (request_budget_error(options) == nullptr) {
+        bool failed = result.code != CURLE_OK ? is_retryable_curl_error(result.code)
+                                              : is_retryable_error(result.status_code);
+        lease.complete(latency, failed);
+    }
+    return result;
+}
+
+TransportResult BalancedTransport::perform(const std::string& url,
+                                           const std::string& method,
+                                           const std::string& data,
+                                           const std::vector<std::string>& headers,
+                                           const RequestOptions& options) {
+    return balanced(url, options, [&](const std::string& target) {
+        return inner_->perform(target, method, data, headers, options);
+    });
+}
+
+TransportResult BalancedTransport::perform_streaming(const std::string& url,
+                                                     const std::string& method,
+                                                     RequestBodySource& body,
+                                                     const std::vector<std::string>& headers,
+                                                     const RequestOptions& options) {
+    return balanced(url, options, [&](const std::string& target) {
+        return inner_->perform_streaming(target, method, body, headers, options);
+    });
+}
+
+TransportResult BalancedTransport::perform_download(const std::string& url,
+                                                    ResponseSink& sink,
+                                                    const std::vector<std::string>& headers,
+                                                    const RequestOptions& options) {
+    return balanced(url, options, [&](const std::string& target) {
+        return inner_->perform_download(target, sink, headers, options);
+    });
+}
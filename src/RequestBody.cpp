@@ -0,0 +1,49 @@
+#include "RequestBody.h"
+#include <algorithm>
+#include <cstring>
+
+std::size_t BufferBodySource::read(char* buffer, std::size_t capacity) {
+    std::size_t count = std::min(capacity, data_.size() - offset_);
+    std::memcpy(buffer, data_.data() + offset_, count);
+    offset_ += count;
+    return count;
+}
+
+bool BufferBodySource::rewind() {
+    offset_ = 0;
+    return true;
+}
+
+FileBodySource::FileBodySource(const std::string& path) : file_(path), offset_(0) {}
+
+std::size_t FileBodySource::read(char* buffer, std::size_t capacity) {
+    std::size_t count = std::min(capacity, file_.size() - offset_);
+    if (count > 0) {
+        std::memcpy(buffer, file_.data() + offset_, count);
+    }
+    offset_ += count;
+    return count;
+}
+
+bool FileBodySource::rewind() {
+    offset_ = 0;
+    return true;
+}
+
+std::size_t GeneratorBodySource::read(char* buffer, std::size_t capacity) {
+    if (finished_) {
+        return 0;
+    }
+    std::size_t count = generator_(buffer, capacity);
+    finished_ = count == 0;
+    return std::min(count, capacity);
+}
+
+bool GeneratorBodySource::rewind() {
+    if (!restart_) {
+        return false;
+    }
+    restart_();
+    finished_ = false;
+    return true;
+}
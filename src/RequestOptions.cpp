@@ -0,0 +1,112 @@
+#include "RequestOptions.h"
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace detail {
+
+struct CancellationState {
+    std::atomic<bool> cancelled{false};
+    std::mutex mutex;
+    std::condition_variable cancelled_cv;
+    std::condition_variable callback_done;      ///< Signalled after each callback cancel() runs
+    std::map<CancellationToken::SubscriptionId, std::function<void()>> callbacks;
+    CancellationToken::SubscriptionId next_id = 1;
+    CancellationToken::SubscriptionId running = 0; ///< Callback cancel() is running (0: none)
+    std::thread::id cancelling_thread;
+};
+
+} // namespace detail
+
+std::chrono::milliseconds Deadline::remaining() const {
+    if (!is_set()) {
+        return std::chrono::milliseconds::max();
+    }
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(at_ - Clock::now());
+    return left.count() > 0 ? left : std::chrono::milliseconds(0);
+}
+
+bool CancellationToken::is_cancelled() const {
+    return state_ && state_->cancelled.load(std::memory_order_acquire);
+}
+
+bool CancellationToken::wait_for(std::chrono::milliseconds duration) const {
+    if (!state_) {
+        std::this_thread::sleep_for(duration);
+        return false;
+    }
+    std::unique_lock<std::mutex> lock(state_->mutex);
+    return state_->cancelled_cv.wait_for(lock, duration, [this] {
+        return state_->cancelled.load(std::memory_order_acquire);
+    });
+}
+
+CancellationToken::SubscriptionId CancellationToken::subscribe(std::function<void()> callback) const {
+    if (!state_) {
+        return 0;
+    }
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        if (!state_->cancelled.load(std::memory_order_acquire)) {
+            SubscriptionId id = state_->next_id++;
+            state_->callbacks.emplace(id, std::move(callback));
+            return id;
+        }
+    }
+    callback();
+    return 0;
+}
+
+void CancellationToken::unsubscribe(SubscriptionId id) const {
+    if (!state_ || id == 0) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(state_->mutex);
+    state_->callbacks.erase(id);
+    // Once this returns the callback must not be running, so its captures may
+    // be destroyed; a callback unsubscribing itself does not wait
+    if (state_->running == id && state_->cancelling_thread != std::this_thread::get_id()) {
+        state_->callback_done.wait(lock, [this, id] { return state_->running != id; });
+    }
+}
+
+CancellationSource::CancellationSource() : state_(std::make_shared<detail::CancellationState>()) {}
+
+void CancellationSource::cancel() {
+    std::unique_lock<std::mutex> lock(state_->mutex);
+    if (state_->cancelled.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+    state_->cancelled_cv.notify_all();
+    state_->cancelling_thread = std::this_thread::get_id();
+
+    // Callbacks are taken one at a time, so one unsubscribed meanwhile never runs
+    while (!state_->callbacks.empty()) {
+        auto first = state_->callbacks.begin();
+        CancellationToken::SubscriptionId id = first->first;
+        std::function<void()> callback = std::move(first->second);
+        state_->callbacks.erase(first);
+        state_->running = id;
+        lock.unlock();
+        callback();
+        lock.lock();
+        state_->running = 0;
+        state_->callback_done.notify_all();
+    }
+}
+
+bool CancellationSource::is_cancelled() const {
+    return state_->cancelled.load(std::memory_order_acquire);
+}
+
+const char* request_budget_error(const RequestOptions& options) {
+    if (options.cancellation.is_cancelled()) {
+        return "Request cancelled";
+    }
+    if (options.deadline.expired()) {
+        return "Deadline exceeded";
+    }
+    return nullptr;
+}
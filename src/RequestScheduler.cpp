@@ -0,0 +1,288 @@
+#include "RequestScheduler.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <condition_variable>
+#include <limits>
+#include <memory>
+
+AdaptiveLimit::AdaptiveLimit(std::size_t initial, std::size_t min, std::size_t max)
+    : limit_(static_cast<double>(initial)),
+      min_(static_cast<double>(std::max<std::size_t>(min, 1))),
+      max_(static_cast<double>(std::max(max, std::max<std::size_t>(min, 1)))),
+      min_rtt_us_(0),
+      samples_(0) {
+    clamp();
+}
+
+void AdaptiveLimit::clamp() {
+    limit_ = std::min(std::max(limit_, min_), max_);
+}
+
+void AdaptiveLimit::on_sample(std::chrono::microseconds rtt, std::size_t in_flight) {
+    std::int64_t rtt_us = std::max<std::int64_t>(rtt.count(), 1);
+    // Periodically forget the baseline so a lasting change in it is learned again
+    if (++samples_ > 30 * static_cast<std::uint64_t>(limit_)) {
+        min_rtt_us_ = 0;
+        samples_ = 1;
+    }
+    if (min_rtt_us_ == 0 || rtt_us < min_rtt_us_) {
+        min_rtt_us_ = rtt_us;
+    }
+    if (static_cast<double>(in_flight) * 2 < limit_) {
+        return;
+    }
+
+    double step = std::max(1.0, std::log10(limit_));
+    double queue = limit_ * (1.0 - static_cast<double>(min_rtt_us_) / static_cast<double>(rtt_us));
+    if (queue <= step) {
+        limit_ += 6 * step; // latency at the baseline: grow quickly
+    } else if (queue < 3 * step) {
+        limit_ += step;
+    } else if (queue > 6 * step) {
+        limit_ -= step;
+    }
+    clamp();
+}
+
+void AdaptiveLimit::on_overload() {
+    limit_ *= 0.9;
+    clamp();
+}
+
+RequestScheduler::RequestScheduler(SchedulerConfig config)
+    : config_(config), in_flight_(0), virtual_time_(0.0), next_ticket_(1) {
+    config_.max_in_flight = std::max<std::size_t>(config_.max_in_flight, 1);
+    config_.max_per_host = std::max<std::size_t>(config_.max_per_host, 1);
+    config_.reserved_interactive = std::min(config_.reserved_interactive, config_.max_in_flight - 1);
+    for (unsigned& weight : config_.weights) {
+        weight = std::max(weight, 1u);
+    }
+    config_.min_per_host = std::min(std::max<std::size_t>(config_.min_per_host, 1), config_.max_per_host);
+    config_.initial_per_host = std::min(std::max(config_.initial_per_host, config_.min_per_host), config_.max_per_host);
+}
+
+std::size_t RequestScheduler::limit_for(const std::string& host) const {
+    if (!config_.adaptive_per_host) {
+        return config_.max_per_host;
+    }
+    auto it = host_limits_.find(host);
+    return it == host_limits_.end() ? config_.initial_per_host : it->second.limit();
+}
+
+bool RequestScheduler::has_capacity(const std::string& host, int priority) const {
+    std::size_t limit = config_.max_in_flight;
+    if (priority != static_cast<int>(RequestPriority::Interactive)) {
+        limit -= config_.reserved_interactive;
+    }
+    if (in_flight_ >= limit) {
+        return false;
+    }
+    auto it = host_in_flight_.find(host);
+    return it == host_in_flight_.end() || it->second < limit_for(host);
+}
+
+void RequestScheduler::admit(const std::string& host) {
+    ++in_flight_;
+    ++host_in_flight_[host];
+    if (config_.adaptive_per_host && host_limits_.find(host) == host_limits_.end()) {
+        host_limits_.emplace(host, AdaptiveLimit(config_.initial_per_host, config_.min_per_host, config_.max_per_host));
+    }
+}
+
+void RequestScheduler::dequeued(const std::string& host) {
+    auto it = host_queued_.find(host);
+    if (--it->second == 0) {
+        host_queued_.erase(it);
+    }
+}
+
+RequestScheduler::Ticket RequestScheduler::enqueue(const std::string& host, RequestPriority priority, Grant grant) {
+    int klass = static_cast<int>(priority);
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    Flow& flow = flows_[FlowKey(host, klass)];
+    bool direct = flow.entries.empty() && has_capacity(host, klass);
+    if (!direct && config_.max_queued_per_host > 0) {
+        auto queued = host_queued_.find(host);
+        if (queued != host_queued_.end() && queued->second >= config_.max_queued_per_host) {
+            return REJECTED; // shed before the flow is charged for it
+        }
+    }
+    double finish = std::max(virtual_time_, flow.last_finish) + 1.0 / config_.weights[klass];
+    flow.last_finish = finish;
+
+    // Nothing queued is eligible between calls, so a free slot can be taken directly
+    if (direct) {
+        virtual_time_ = finish;
+        admit(host);
+        return 0;
+    }
+
+    Ticket ticket = next_ticket_++;
+    flow.entries.push_back(Entry{ticket, finish, std::move(grant)});
+    queued_.emplace(ticket, FlowKey(host, klass));
+    ++host_queued_[host];
+    return ticket;
+}
+
+bool RequestScheduler::withdraw(Ticket ticket) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = queued_.find(ticket);
+    if (it == queued_.end()) {
+        return false;
+    }
+    std::deque<Entry>& entries = flows_[it->second].entries;
+    entries.erase(std::find_if(entries.begin(), entries.end(),
+                               [ticket](const Entry& entry) { return entry.ticket == ticket; }));
+    dequeued(it->second.first);
+    queued_.erase(it);
+    return true;
+}
+
+std::vector<RequestScheduler::Grant> RequestScheduler::admit_queued() {
+    std::vector<Grant> grants;
+    for (;;) {
+        // Smallest finish time among flow heads that may be admitted now
+        auto best = flows_.end();
+        double best_finish = std::numeric_limits<double>::infinity();
+        for (auto it = flows_.begin(); it != flows_.end();) {
+            Flow& flow = it->second;
+            if (flow.entries.empty()) {
+                // An idle flow's history no longer matters once virtual time has passed it
+                if (flow.last_finish <= virtual_time_) {
+                    it = flows_.erase(it);
+                    continue;
+                }
+            } else if (flow.entries.front().finish < best_finish &&
+                       has_capacity(it->first.first, it->first.second)) {
+                best = it;
+                best_finish = flow.entries.front().finish;
+            }
+            ++it;
+        }
+        if (best == flows_.end()) {
+            return grants;
+        }
+
+        Entry entry = std::move(best->second.entries.front());
+        best->second.entries.pop_front();
+        queued_.erase(entry.ticket);
+        dequeued(best->first.first);
+        virtual_time_ = std::max(virtual_time_, entry.finish);
+        admit(best->first.first);
+        grants.push_back(std::move(entry.grant));
+    }
+}
+
+void RequestScheduler::release(const std::string& host, AttemptOutcome outcome, std::chrono::microseconds rtt) {
+    std::vector<Grant> grants;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = host_in_flight_.find(host);
+        if (it == host_in_flight_.end()) {
+            return;
+        }
+        if (outcome != AttemptOutcome::IGNORED) {
+            auto limit = host_limits_.find(host);
+            if (limit != host_limits_.end()) {
+                if (outcome == AttemptOutcome::OVERLOADED) {
+                    limit->second.on_overload();
+                } else {
+                    limit->second.on_sample(rtt, it->second);
+                }
+            }
+        }
+        if (--it->second == 0) {
+            host_in_flight_.erase(it);
+        }
+        --in_flight_;
+        grants = admit_queued();
+    }
+    for (Grant& grant : grants) {
+        grant();
+    }
+}
+
+RequestScheduler::Permit RequestScheduler::acquire(const std::string& host, const RequestOptions& options) {
+    struct Waiter {
+        std::mutex mutex;
+        std::condition_variable ready;
+        bool granted = false;
+    };
+    auto waiter = std::make_shared<Waiter>();
+
+    Ticket ticket = enqueue(host, options.priority, [waiter] {
+        std::lock_guard<std::mutex> lock(waiter->mutex);
+        waiter->granted = true;
+        waiter->ready.notify_all();
+    });
+    if (ticket == 0) {
+        return Permit(this, host);
+    }
+    if (ticket == REJECTED) {
+        return Permit();
+    }
+
+    CancellationToken::SubscriptionId subscription = options.cancellation.subscribe([waiter] {
+        std::lock_guard<std::mutex> lock(waiter->mutex);
+        waiter->ready.notify_all();
+    });
+    bool granted;
+    {
+        std::unique_lock<std::mutex> lock(waiter->mutex);
+        auto admitted_or_cancelled = [&] { return waiter->granted || options.cancellation.is_cancelled(); };
+        if (options.deadline.is_set()) {
+            waiter->ready.wait_until(lock, options.deadline.time_point(), admitted_or_cancelled);
+        } else {
+            waiter->ready.wait(lock, admitted_or_cancelled);
+        }
+        granted = waiter->granted;
+    }
+    options.cancellation.unsubscribe(subscription);
+
+    if (!granted && withdraw(ticket)) {
+        return Permit();
+    }
+    // Admitted, possibly while giving up: wait for the grant so the slot is not lost
+    std::unique_lock<std::mutex> lock(waiter->mutex);
+    waiter->ready.wait(lock, [&] { return waiter->granted; });
+    return Permit(this, host);
+}
+
+std::string RequestScheduler::host_key(const std::string& url) {
+    std::size_t start = 0;
+    std::size_t scheme_end = url.find("://");
+    if (scheme_end != std::string::npos) {
+        start = scheme_end + 3;
+    }
+    std::size_t end = url.find_first_of("/?#", start);
+    if (end == std::string::npos) {
+        end = url.size();
+    }
+    // Drop any userinfo so credentials do not split a host into several flows
+    std::size_t host_start = start;
+    std::size_t at = url.find('@', start);
+    if (at != std::string::npos && at < end) {
+        host_start = at + 1;
+    }
+    std::string key = url.substr(0, start) + url.substr(host_start, end - host_start);
+    std::transform(key.begin(), key.end(), key.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return key;
+}
+
+std::size_t RequestScheduler::in_flight() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return in_flight_;
+}
+
+std::size_t RequestScheduler::queued() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queued_.size();
+}
+
+std::size_t RequestScheduler::host_limit(const std::string& host) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return limit_for(host);
+}
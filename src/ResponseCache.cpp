@@ -0,0 +1,92 @@
+#include "ResponseCache.h"
+
+namespace {
+
+std::size_t entry_bytes(const std::string& key, const CachedResponse& entry) {
+    return key.size() + entry.body.size();
+}
+
+} // namespace
+
+MemoryCache::MemoryCache(std::size_t max_bytes) : max_bytes_(max_bytes), bytes_(0) {}
+
+bool MemoryCache::get(const std::string& key, CachedResponse& entry) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = index_.find(key);
+    if (found == index_.end()) {
+        return false;
+    }
+    if (found->second->second.expired()) {
+        remove(found->second);
+        return false;
+    }
+    items_.splice(items_.begin(), items_, found->second);
+    entry = found->second->second;
+    return true;
+}
+
+void MemoryCache::put(const std::string& key, const CachedResponse& entry) {
+    std::size_t size = entry_bytes(key, entry);
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = index_.find(key);
+    if (found != index_.end()) {
+        remove(found->second);
+    }
+    if (size > max_bytes_) {
+        return; // would evict everything else and still not fit
+    }
+    while (bytes_ + size > max_bytes_ && !items_.empty()) {
+        remove(std::prev(items_.end()));
+    }
+    items_.emplace_front(key, entry);
+    index_[key] = items_.begin();
+    bytes_ += size;
+}
+
+void MemoryCache::erase(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = index_.find(key);
+    if (found != index_.end()) {
+        remove(found->second);
+    }
+}
+
+std::size_t MemoryCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return items_.size();
+}
+
+std::size_t MemoryCache::bytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bytes_;
+}
+
+void MemoryCache::remove(std::list<Item>::iterator item) {
+    bytes_ -= entry_bytes(item->first, item->second);
+    index_.erase(item->first);
+    items_.erase(item);
+}
+
+TieredCache::TieredCache(std::shared_ptr<ResponseCache> front, std::shared_ptr<ResponseCache> back)
+    : front_(std::move(front)), back_(std::move(back)) {}
+
+bool TieredCache::get(const std::string& key, CachedResponse& entry) {
+    if (front_->get(key, entry)) {
+        return true;
+    }
+    if (!back_->get(key, entry)) {
+        return false;
+    }
+    front_->put(key, entry);
+    return true;
+}
+
+void TieredCache::put(const std::string& key, const CachedResponse& entry) {
+    back_->put(key, entry);
+    front_->put(key, entry);
+}
+
+void TieredCache::erase(const std::string& key) {
+    front_->erase(key);
+    back_->erase(key);
+}
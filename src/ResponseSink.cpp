@@ -0,0 +1,78 @@
+#include "ResponseSink.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+/// Smallest mapping made when the body size is unknown
+const std::size_t MIN_GROWTH_BYTES = 1 << 20;
+
+} // namespace
+
+MappedFileSink::MappedFileSink(const std::string& path)
+    : path_(path), data_(nullptr), capacity_(0), size_(0) {
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        throw std::runtime_error("Cannot create " + path + ": " + std::strerror(errno));
+    }
+}
+
+MappedFileSink::~MappedFileSink() {
+    // Trims growth slack if finish() was never reached
+    unmap();
+    int trimmed = ::ftruncate(fd_, static_cast<off_t>(size_));
+    (void)trimmed; // a destructor cannot report it; the file just keeps its slack
+    ::close(fd_);
+}
+
+void MappedFileSink::reset() {
+    size_ = 0;
+}
+
+void MappedFileSink::reserve(std::uint64_t size) {
+    if (size > capacity_) {
+        remap(static_cast<std::size_t>(size));
+    }
+}
+
+void MappedFileSink::write(const char* data, std::size_t size) {
+    if (size_ + size > capacity_) {
+        remap(std::max({size_ + size, capacity_ * 2, MIN_GROWTH_BYTES}));
+    }
+    std::memcpy(data_ + size_, data, size);
+    size_ += size;
+}
+
+void MappedFileSink::finish() {
+    unmap();
+    if (::ftruncate(fd_, static_cast<off_t>(size_)) != 0) {
+        throw std::runtime_error("Cannot truncate " + path_ + ": " + std::strerror(errno));
+    }
+}
+
+void MappedFileSink::remap(std::size_t capacity) {
+    unmap();
+    if (::ftruncate(fd_, static_cast<off_t>(capacity)) != 0) {
+        throw std::runtime_error("Cannot resize " + path_ + ": " + std::strerror(errno));
+    }
+    void* mapping = ::mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Cannot map " + path_ + ": " + std::strerror(errno));
+    }
+    ::madvise(mapping, capacity, MADV_SEQUENTIAL);
+    data_ = static_cast<char*>(mapping);
+    capacity_ = capacity;
+}
+
+void MappedFileSink::unmap() {
+    if (data_) {
+        ::munmap(data_, capacity_);
+        data_ = nullptr;
+    }
+    capacity_ = 0;
+}
@@ -0,0 +1,35 @@
+#include "SimdLevel.h"
+#include <algorithm>
+#include <atomic>
+
+namespace {
+
+SimdLevel detect() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::AVX2;
+    }
+    return SimdLevel::SSE2;
+#else
+    return SimdLevel::SCALAR;
+#endif
+}
+
+const SimdLevel g_detected = detect();
+std::atomic<int> g_active(static_cast<int>(g_detected));
+
+} // namespace
+
+SimdLevel detected_simd_level() {
+    return g_detected;
+}
+
+SimdLevel active_simd_level() {
+    return static_cast<SimdLevel>(g_active.load(std::memory_order_relaxed));
+}
+
+void set_simd_level(SimdLevel level) {
+    int clamped = std::min(static_cast<int>(level), static_cast<int>(g_detected));
+    g_active.store(clamped, std::memory_order_relaxed);
+}
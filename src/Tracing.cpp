@@ -0,0 +1,395 @@
+#include "Tracing.h"
+#include "HttpUtils.h"
+#include <strings.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <stdexcept>
+
+namespace {
+
+const char HEX_DIGITS[] = "0123456789abcdef";
+
+std::mt19937_64& thread_rng() {
+    thread_local std::mt19937_64 rng(std::random_device{}() ^
+                                     std::hash<std::thread::id>()(std::this_thread::get_id()));
+    return rng;
+}
+
+void append_hex(std::string& out, const std::uint8_t* bytes, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        out.push_back(HEX_DIGITS[bytes[i] >> 4]);
+        out.push_back(HEX_DIGITS[bytes[i] & 0xf]);
+    }
+}
+
+void append_hex(std::string& out, std::uint64_t value) {
+    for (int shift = 60; shift >= 0; shift -= 4) {
+        out.push_back(HEX_DIGITS[(value >> shift) & 0xf]);
+    }
+}
+
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1; // the spec only allows lower case
+}
+
+bool parse_hex(const char* text, std::size_t digits, std::uint8_t* bytes) {
+    for (std::size_t i = 0; i < digits; i += 2) {
+        int high = hex_value(text[i]);
+        int low = hex_value(text[i + 1]);
+        if (high < 0 || low < 0) {
+            return false;
+        }
+        bytes[i / 2] = static_cast<std::uint8_t>(high << 4 | low);
+    }
+    return true;
+}
+
+void append_json_string(std::string& out, const char* text) {
+    out.push_back('"');
+    for (const char* c = text; *c; ++c) {
+        unsigned char ch = static_cast<unsigned char>(*c);
+        if (ch == '"' || ch == '\\') {
+            out.push_back('\\');
+            out.push_back(*c);
+        } else if (ch < 0x20) {
+            out += "\\u00";
+            out.push_back(HEX_DIGITS[ch >> 4]);
+            out.push_back(HEX_DIGITS[ch & 0xf]);
+        } else {
+            out.push_back(*c);
+        }
+    }
+    out.push_back('"');
+}
+
+void append_tag(std::string& out, bool& first, const char* name, const std::string& value) {
+    out += first ? "" : ",";
+    first = false;
+    append_json_string(out, name);
+    out.push_back(':');
+    append_json_string(out, value.c_str());
+}
+
+void copy_truncated(char* destination, std::size_t capacity, const std::string& source) {
+    std::size_t length = std::min(capacity - 1, source.size());
+    std::memcpy(destination, source.data(), length);
+    destination[length] = '\0';
+}
+
+bool is_traceparent_header(const std::string& header) {
+    return header.size() >= 12 && strncasecmp(header.c_str(), "traceparent:", 12) == 0;
+}
+
+} // namespace
+
+bool TraceContext::valid() const {
+    return span_id != 0 && std::any_of(trace_id.begin(), trace_id.end(), [](std::uint8_t b) { return b != 0; });
+}
+
+std::string TraceContext::traceparent() const {
+    std::string value = "00-";
+    value.reserve(55);
+    append_hex(value, trace_id.data(), trace_id.size());
+    value.push_back('-');
+    append_hex(value, span_id);
+    value += sampled ? "-01" : "-00";
+    return value;
+}
+
+bool TraceContext::parse(const std::string& value, TraceContext& context) {
+    // version "-" trace-id "-" parent-id "-" flags
+    if (value.size() < 55 || value[2] != '-' || value[35] != '-' || value[52] != '-') {
+        return false;
+    }
+    std::uint8_t version = 0;
+    std::uint8_t span[8];
+    std::uint8_t flags = 0;
+    TraceContext parsed;
+    if (!parse_hex(value.data(), 2, &version) || version == 0xff ||
+        !parse_hex(value.data() + 3, 32, parsed.trace_id.data()) ||
+        !parse_hex(value.data() + 36, 16, span) ||
+        !parse_hex(value.data() + 53, 2, &flags)) {
+        return false;
+    }
+    for (std::uint8_t byte : span) {
+        parsed.span_id = parsed.span_id << 8 | byte;
+    }
+    parsed.sampled = flags & 0x01;
+    if (!parsed.valid()) {
+        return false;
+    }
+    context = parsed;
+    return true;
+}
+
+Tracer::Tracer(TracerConfig config)
+    : config_(std::move(config)), enqueue_pos_(0), dequeue_pos_(0), exported_(0), dropped_(0),
+      file_(nullptr), stopping_(false) {
+    if (!(config_.sample_rate >= 0.0 && config_.sample_rate <= 1.0)) {
+        throw std::invalid_argument("Trace sample rate must be between 0 and 1");
+    }
+    if (config_.buffer_spans == 0) {
+        throw std::invalid_argument("Trace buffer must hold at least one span");
+    }
+    double threshold = config_.sample_rate * 18446744073709551616.0; // rate * 2^64
+    sample_threshold_ = threshold >= 18446744073709551615.0 ? UINT64_MAX : static_cast<std::uint64_t>(threshold);
+
+    std::size_t capacity = 1;
+    while (capacity < config_.buffer_spans) {
+        capacity <<= 1;
+    }
+    cells_.reset(new Cell[capacity]);
+    for (std::size_t i = 0; i < capacity; ++i) {
+        cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    mask_ = capacity - 1;
+
+    file_ = std::fopen(config_.path.c_str(), "a");
+    if (!file_) {
+        throw std::runtime_error("Cannot open trace file " + config_.path + ": " + std::strerror(errno));
+    }
+    exporter_ = std::thread([this] { export_loop(); });
+}
+
+Tracer::~Tracer() {
+    {
+        std::lock_guard<std::mutex> lock(stop_mutex_);
+        stopping_ = true;
+    }
+    stop_cv_.notify_all();
+    exporter_.join();
+    flush();
+    std::fclose(file_);
+}
+
+std::uint64_t Tracer::random_id() {
+    std::uint64_t id;
+    do {
+        id = thread_rng()();
+    } while (id == 0);
+    return id;
+}
+
+TraceContext Tracer::start(const TraceContext* parent) {
+    TraceContext context;
+    if (parent) {
+        context.trace_id = parent->trace_id;
+        context.sampled = parent->sampled;
+    } else {
+        std::uint64_t high = random_id();
+        std::uint64_t low = random_id();
+        std::memcpy(context.trace_id.data(), &high, sizeof(high));
+        std::memcpy(context.trace_id.data() + 8, &low, sizeof(low));
+        context.sampled = sample_threshold_ == UINT64_MAX || thread_rng()() < sample_threshold_;
+    }
+    context.span_id = random_id();
+    return context;
+}
+
+bool Tracer::record(const SpanRecord& span) {
+    std::size_t position = enqueue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+        Cell& cell = cells_[position & mask_];
+        std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+        if (difference == 0) {
+            if (enqueue_pos_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                cell.span = span;
+                cell.sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (difference < 0) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false; // full
+        } else {
+            position = enqueue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool Tracer::pop(SpanRecord& span) {
+    std::size_t position = dequeue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+        Cell& cell = cells_[position & mask_];
+        std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+        if (difference == 0) {
+            if (dequeue_pos_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                span = cell.span;
+                cell.sequence.store(position + mask_ + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (difference < 0) {
+            return false; // empty
+        } else {
+            position = dequeue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void Tracer::flush() {
+    std::lock_guard<std::mutex> lock(export_mutex_);
+    SpanRecord span;
+    bool wrote = false;
+    while (pop(span)) {
+        write_span(span);
+        wrote = true;
+    }
+    if (wrote) {
+        std::fflush(file_);
+    }
+}
+
+void Tracer::write_span(const SpanRecord& span) {
+    std::string& out = line_;
+    out.clear();
+    out += "{\"traceId\":\"";
+    append_hex(out, span.trace_id.data(), span.trace_id.size());
+    out += "\",\"id\":\"";
+    append_hex(out, span.span_id);
+    out += "\"";
+    if (span.parent_id != 0) {
+        out += ",\"parentId\":\"";
+        append_hex(out, span.parent_id);
+        out += "\"";
+    }
+    out += ",\"name\":";
+    append_json_string(out, span.name);
+    out += ",\"kind\":\"CLIENT\",\"timestamp\":" + std::to_string(span.start_us) +
+           ",\"duration\":" + std::to_string(std::max<std::int64_t>(span.duration_us, 1)) +
+           ",\"localEndpoint\":{\"serviceName\":";
+    append_json_string(out, config_.service_name.c_str());
+    out += "},\"tags\":{";
+
+    bool first = true;
+    append_tag(out, first, "http.method", span.method);
+    append_tag(out, first, "http.url", span.url);
+    if (span.status_code != 0) {
+        append_tag(out, first, "http.status_code", std::to_string(span.status_code));
+    }
+    if (span.attempt != 0) {
+        append_tag(out, first, "attempt", std::to_string(span.attempt));
+    }
+    if (span.curl_code != 0) {
+        append_tag(out, first, "error", curl_easy_strerror(static_cast<CURLcode>(span.curl_code)));
+    }
+    // Phase durations from cURL's cumulative times
+    const TransferTimings& t = span.timings;
+    if (t.dns_us >= 0) {
+        append_tag(out, first, "dns_us", std::to_string(t.dns_us));
+    }
+    if (t.connect_us >= 0 && t.dns_us >= 0) {
+        append_tag(out, first, "connect_us", std::to_string(std::max<std::int64_t>(t.connect_us - t.dns_us, 0)));
+    }
+    if (t.tls_us > 0 && t.connect_us >= 0) {
+        append_tag(out, first, "tls_us", std::to_string(std::max<std::int64_t>(t.tls_us - t.connect_us, 0)));
+    }
+    if (t.first_byte_us >= 0) {
+        append_tag(out, first, "ttfb_us", std::to_string(t.first_byte_us));
+    }
+    out += "}}\n";
+
+    if (std::fwrite(out.data(), 1, out.size(), file_) == out.size()) {
+        exported_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Tracer::export_loop() {
+    std::unique_lock<std::mutex> lock(stop_mutex_);
+    while (!stopping_) {
+        stop_cv_.wait_for(lock, config_.flush_interval, [this] { return stopping_; });
+        lock.unlock();
+        flush();
+        lock.lock();
+    }
+}
+
+RequestTrace::RequestTrace(Tracer& tracer, const std::string& method, const std::string& url,
+                           const std::vector<std::string>& headers)
+    : tracer_(&tracer), start_(SteadyClock::now()) {
+    TraceContext parent;
+    bool has_parent = false;
+    for (const std::string& header : headers) {
+        if (is_traceparent_header(header)) {
+            std::size_t value = header.find_first_not_of(" \t", 12);
+            has_parent = value != std::string::npos && TraceContext::parse(header.substr(value), parent);
+            break;
+        }
+    }
+    context_ = tracer.start(has_parent ? &parent : nullptr);
+    parent_id_ = has_parent ? parent.span_id : 0;
+    if (context_.sampled) {
+        start_epoch_us_ = std::chrono::duration_cast<std::chrono::microseconds>(
+                              std::chrono::system_clock::now().time_since_epoch()).count();
+        method_ = method;
+        url_ = url;
+    }
+}
+
+std::vector<std::string> RequestTrace::start_attempt(const std::vector<std::string>& headers) {
+    attempt_span_ = Tracer::random_id();
+    attempt_start_ = SteadyClock::now();
+
+    std::vector<std::string> traced;
+    traced.reserve(headers.size() + 1);
+    for (const std::string& header : headers) {
+        if (!is_traceparent_header(header)) {
+            traced.push_back(header);
+        }
+    }
+    TraceContext attempt = context_;
+    attempt.span_id = attempt_span_;
+    traced.push_back("traceparent: " + attempt.traceparent());
+    return traced;
+}
+
+void RequestTrace::end_attempt(int attempt, const TransportResult& result) {
+    if (!tracer_ || !context_.sampled) {
+        return;
+    }
+    SpanRecord span = make_span("http.attempt", attempt_span_, context_.span_id, attempt_start_, SteadyClock::now());
+    span.status_code = result.status_code;
+    span.attempt = attempt;
+    span.curl_code = static_cast<int>(result.code);
+    span.timings = result.timings;
+    tracer_->record(span);
+}
+
+void RequestTrace::record_backoff(SteadyClock::time_point start, SteadyClock::time_point end) {
+    if (!tracer_ || !context_.sampled) {
+        return;
+    }
+    tracer_->record(make_span("http.backoff", Tracer::random_id(), context_.span_id, start, end));
+}
+
+void RequestTrace::finish(int status_code) {
+    if (!tracer_ || !context_.sampled) {
+        return;
+    }
+    SpanRecord span = make_span("http.request", context_.span_id, parent_id_, start_, SteadyClock::now());
+    span.status_code = status_code;
+    tracer_->record(span);
+}
+
+SpanRecord RequestTrace::make_span(const char* name, std::uint64_t span_id, std::uint64_t parent_id,
+                                   SteadyClock::time_point start, SteadyClock::time_point end) const {
+    SpanRecord span;
+    span.trace_id = context_.trace_id;
+    span.span_id = span_id;
+    span.parent_id = parent_id;
+    span.name = name;
+    span.start_us = start_epoch_us_ + std::chrono::duration_cast<std::chrono::microseconds>(start - start_).count();
+    span.duration_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    copy_truncated(span.method, sizeof(span.method), method_);
+    copy_truncated(span.url, sizeof(span.url), url_);
+    return span;
+}
@@ -0,0 +1,123 @@
+#include "WorkStealingPool.h"
+#include "HttpUtils.h"
+#include <algorithm>
+#include <exception>
+#include <string>
+
+namespace {
+
+// Identifies the pool and worker index of the current thread, if any
+struct WorkerIdentity {
+    const WorkStealingPool* pool = nullptr;
+    std::size_t index = 0;
+};
+
+thread_local WorkerIdentity current_worker;
+
+} // namespace
+
+WorkStealingPool::WorkStealingPool(std::size_t threads)
+    : steals_(0), pending_(0), sleepers_(0), stopping_(false) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (std::size_t i = 0; i < threads; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    for (std::size_t i = 0; i < threads; ++i) {
+        threads_.emplace_back([this, i] { worker_loop(i); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::post(Job job) {
+    Worker& target = current_worker.pool == this ? *workers_[current_worker.index] : injector_;
+    // Count first so a worker that pops the job right away never sees pending_ underflow
+    pending_.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(target.mutex);
+        target.jobs.push_back(std::move(job));
+    }
+    if (sleepers_.load() > 0) {
+        // A worker between its pending_ check and wait() holds sleep_mutex_;
+        // passing through the lock ensures the notify cannot slip in between.
+        { std::lock_guard<std::mutex> lock(sleep_mutex_); }
+        wake_.notify_one();
+    }
+}
+
+bool WorkStealingPool::try_pop_local(std::size_t index, Job& job) {
+    Worker& worker = *workers_[index];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.jobs.empty()) {
+        return false;
+    }
+    job = std::move(worker.jobs.back());
+    worker.jobs.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::try_pop_injected(Job& job) {
+    std::lock_guard<std::mutex> lock(injector_.mutex);
+    if (injector_.jobs.empty()) {
+        return false;
+    }
+    job = std::move(injector_.jobs.front());
+    injector_.jobs.pop_front();
+    return true;
+}
+
+bool WorkStealingPool::try_steal(std::size_t index, Job& job) {
+    for (std::size_t offset = 1; offset < workers_.size(); ++offset) {
+        Worker& victim = *workers_[(index + offset) % workers_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.jobs.empty()) {
+            job = std::move(victim.jobs.front());
+            victim.jobs.pop_front();
+            steals_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::worker_loop(std::size_t index) {
+    current_worker.pool = this;
+    current_worker.index = index;
+
+    for (;;) {
+        Job job;
+        if (try_pop_local(index, job) || try_pop_injected(job) || try_steal(index, job)) {
+            pending_.fetch_sub(1);
+            try {
+                job();
+            } catch (const std::exception& e) {
+                log_error("Work-stealing pool job failed: " + std::string(e.what()));
+            } catch (...) {
+                log_error("Work-stealing pool job failed: unknown exception");
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        if (stopping_ && pending_.load() == 0) {
+            return;
+        }
+        // Announce the park before re-checking pending_ so post() either sees a
+        // sleeper or this check sees its job. A job may be counted but not yet
+        // visible in a deque; the loop re-scans then.
+        sleepers_.fetch_add(1);
+        wake_.wait(lock, [this] { return stopping_ || pending_.load() > 0; });
+        sleepers_.fetch_sub(1);
+    }
+}
@@ -0,0 +1,82 @@
+#include "Backoff.h"
+#include "BackoffSimulator.h"
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+void print_usage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "Simulates clients retrying against a failing server, once per jitter strategy\n"
+              << "  --clients N       Clients making one request each (default 1000)\n"
+              << "  --spread MS       First attempts spread over MS milliseconds (default 1000)\n"
+              << "  --outage MS       Server fails everything for MS milliseconds (default 5000)\n"
+              << "  --capacity N      Attempts served per second after the outage (default 2000)\n"
+              << "  --window MS       Capacity accounting window (default 100)\n"
+              << "  --retries N       Retries before a client gives up (default 10)\n"
+              << "  --initial MS      Backoff base delay (default " << INITIAL_BACKOFF_MS << ")\n"
+              << "  --max MS          Backoff cap (default " << MAX_BACKOFF_MS << ")\n"
+              << "  --strategy NAME   Only proportional, full, equal or decorrelated\n"
+              << "  --seed N          Random seed (default 1)\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    RetryStormConfig config;
+    std::vector<JitterStrategy> strategies = {JitterStrategy::PROPORTIONAL, JitterStrategy::FULL,
+                                              JitterStrategy::EQUAL, JitterStrategy::DECORRELATED};
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) {
+                    throw std::invalid_argument("Missing value for " + arg);
+                }
+                return argv[++i];
+            };
+
+            if (arg == "--clients") {
+                config.clients = std::stoi(value());
+            } else if (arg == "--spread") {
+                config.arrival_spread_ms = std::stoi(value());
+            } else if (arg == "--outage") {
+                config.outage_ms = std::stoi(value());
+            } else if (arg == "--capacity") {
+                config.capacity_per_second = std::stoi(value());
+            } else if (arg == "--window") {
+                config.window_ms = std::stoi(value());
+            } else if (arg == "--retries") {
+                config.max_retries = std::stoi(value());
+            } else if (arg == "--initial") {
+                config.backoff.initial_ms = std::stoi(value());
+            } else if (arg == "--max") {
+                config.backoff.max_ms = std::stoi(value());
+            } else if (arg == "--strategy") {
+                strategies = {parse_jitter_strategy(value())};
+            } else if (arg == "--seed") {
+                config.seed = std::stoull(value());
+            } else if (arg == "--help" || arg == "-h") {
+                print_usage(argv[0]);
+                return 0;
+            } else {
+                throw std::invalid_argument("Unknown option: " + arg);
+            }
+        }
+
+        std::vector<RetryStormReport> reports;
+        for (JitterStrategy strategy : strategies) {
+            config.backoff.strategy = strategy;
+            reports.push_back(simulate_retry_storm(config));
+        }
+        print_retry_storm_reports(config, reports, std::cout);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        print_usage(argv[0]);
+        return 1;
+    }
+    return 0;
+}
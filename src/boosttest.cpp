@@ -2,9 +2,96 @@
 #include<iostream>
 #include <iterator>
 #include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string>
+#include <thread>
+#include "IntStream.h"
+#include "WorkStealingPool.h"
 
-int main()
+// --fast [FILE]: same output, via the bulk SIMD parser and a single output buffer
+// --parallel [--threads N] [FILE]: as --fast, with mapped input split across a work-stealing pool
+int run_fast(const char* path, std::size_t threads)
 {
+    int fd = STDIN_FILENO;
+    if (path) {
+        fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            std::cerr << "Cannot open " << path << ": " << std::strerror(errno) << std::endl;
+            return 1;
+        }
+    }
+
+    int status = 0;
+    try {
+        if (threads > 0) {
+            WorkStealingPool pool(threads);
+            transform_int_stream_parallel(fd, STDOUT_FILENO, 3, pool);
+        } else {
+            transform_int_stream(fd, STDOUT_FILENO, 3);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        status = 1;
+    }
+    if (path) {
+        ::close(fd);
+    }
+    return status;
+}
+
+// Upper bound for --threads; far beyond any useful split of one input file
+const std::size_t kMaxThreads = 256;
+
+int usage()
+{
+    std::cerr << "Usage: boosttest [--fast [FILE] | --parallel [--threads N] [FILE]]\n"
+              << "  N must be an integer from 1 to " << kMaxThreads << std::endl;
+    return 2;
+}
+
+// Parses a --threads value; returns 0 when it is not a number in [1, kMaxThreads]
+std::size_t parse_threads(const char* text)
+{
+    if (!std::isdigit(static_cast<unsigned char>(text[0]))) {
+        return 0;
+    }
+    try {
+        std::size_t consumed = 0;
+        unsigned long value = std::stoul(text, &consumed);
+        if (text[consumed] != '\0' || value > kMaxThreads) {
+            return 0;
+        }
+        return value;
+    } catch (const std::exception&) {
+        return 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc > 1 && (std::strcmp(argv[1], "--fast") == 0 || std::strcmp(argv[1], "--parallel") == 0)) {
+        std::size_t threads = 0;
+        int next = 2;
+        if (std::strcmp(argv[1], "--parallel") == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+            if (argc > 2 && std::strcmp(argv[2], "--threads") == 0) {
+                if (argc < 4) {
+                    return usage();
+                }
+                threads = parse_threads(argv[3]);
+                if (threads == 0) {
+                    return usage();
+                }
+                next = 4;
+            }
+        }
+        return run_fast(argc > next ? argv[next] : nullptr, threads);
+    }
+
     using namespace boost::lambda;
     typedef std::istream_iterator<int> in;
 
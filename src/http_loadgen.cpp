@@ -0,0 +1,153 @@
+#include "AllocationTracker.h"
+#include "HttpUtils.h"
+#include "LoadGenerator.h"
+#include "Metrics.h"
+#include "PerfCounters.h"
+#include <curl/curl.h>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+void print_usage(const char* program) {
+    std::cerr << "Usage: " << program << " [options] URL [URL...]\n"
+              << "  --rate N          Open loop: start N requests per second\n"
+              << "  --concurrency N   Closed loop: N workers back to back (default 8)\n"
+              << "  --duration S      Seconds to generate load (default 10)\n"
+              << "  --method M        HTTP method (default GET)\n"
+              << "  --data BODY       Request body\n"
+              << "  --header H        Request header \"Name: value\" (repeatable)\n"
+              << "  --urls FILE       Read target URLs from FILE, one per line\n"
+              << "  --timeout S       Per-request timeout in seconds (default 10)\n"
+              << "  --retries N       Client retries per request (default 0)\n"
+              << "  --record FILE     Closed loop: save every exchange to FILE\n"
+              << "  --replay FILE     Closed loop: answer from a recording instead of the network\n"
+              << "  --replay-timing T fast (default) or original recorded latencies\n"
+              << "  --metrics-port P  Closed loop: serve client counters at 127.0.0.1:P/metrics\n"
+              << "  --profile         Closed loop: report CPU counters per request phase (also at /profile)\n"
+              << "  --verbose         Keep the client's per-request logging\n";
+}
+
+void read_url_file(const std::string& path, std::vector<std::string>& urls) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Cannot open URL file: " + path);
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line[0] != '#') {
+            urls.push_back(line);
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    LoadConfig config;
+    bool verbose = false;
+    int metrics_port = -1;
+    bool profile = false;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) {
+                    throw std::invalid_argument("Missing value for " + arg);
+                }
+                return argv[++i];
+            };
+
+            if (arg == "--rate") {
+                config.mode = LoadMode::OPEN_LOOP;
+                config.rate = std::stod(value());
+            } else if (arg == "--concurrency") {
+                config.mode = LoadMode::CLOSED_LOOP;
+                config.concurrency = std::stoi(value());
+            } else if (arg == "--duration") {
+                config.duration = std::chrono::milliseconds(static_cast<long long>(std::stod(value()) * 1000));
+            } else if (arg == "--method") {
+                config.method = value();
+            } else if (arg == "--data") {
+                config.data = value();
+            } else if (arg == "--header") {
+                config.headers.push_back(value());
+            } else if (arg == "--urls") {
+                read_url_file(value(), config.urls);
+            } else if (arg == "--timeout") {
+                config.timeout_seconds = std::stoi(value());
+            } else if (arg == "--retries") {
+                config.max_retries = std::stoi(value());
+            } else if (arg == "--record") {
+                config.record_path = value();
+            } else if (arg == "--replay") {
+                config.replay_path = value();
+            } else if (arg == "--replay-timing") {
+                std::string timing = value();
+                if (timing != "fast" && timing != "original") {
+                    throw std::invalid_argument("--replay-timing must be fast or original");
+                }
+                config.replay_timing = timing == "original" ? ReplayTiming::ORIGINAL : ReplayTiming::FULL_SPEED;
+            } else if (arg == "--metrics-port") {
+                metrics_port = std::stoi(value());
+                if (metrics_port < 0 || metrics_port > 65535) {
+                    throw std::invalid_argument("--metrics-port must be between 0 and 65535");
+                }
+            } else if (arg == "--profile") {
+                profile = true;
+            } else if (arg == "--verbose") {
+                verbose = true;
+            } else if (arg == "--help" || arg == "-h") {
+                print_usage(argv[0]);
+                return 0;
+            } else if (!arg.empty() && arg[0] == '-') {
+                throw std::invalid_argument("Unknown option: " + arg);
+            } else {
+                config.urls.push_back(arg);
+            }
+        }
+        if (config.urls.empty()) {
+            throw std::invalid_argument("At least one URL is required");
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    CURLcode init_result = AllocationTracker::init_curl(CURL_GLOBAL_DEFAULT);
+    if (init_result != CURLE_OK) {
+        log_error("Failed to initialize cURL: " + std::string(curl_easy_strerror(init_result)));
+        return 1;
+    }
+    // Per-request logging would dominate the measurement; failures are counted in the report
+    if (!verbose) {
+        set_log_level(LogLevel::SILENT);
+    }
+
+    int status = 0;
+    try {
+        std::unique_ptr<MetricsServer> metrics_server;
+        if (metrics_port >= 0) {
+            metrics_server = std::make_unique<MetricsServer>(static_cast<std::uint16_t>(metrics_port));
+            std::cerr << "Serving metrics at " << metrics_server->url() << "\n";
+        }
+        PhaseProfiler::enable(profile);
+        LoadReport report = run_load(config);
+        print_report(config, report, std::cout);
+        if (profile) {
+            std::cout << "\n";
+            PhaseProfiler::write_report(std::cout);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Load test failed: " << e.what() << "\n";
+        status = 1;
+    }
+
+    curl_global_cleanup();
+    return status;
+}
@@ -1,9 +1,16 @@
+#include <chrono>
 #include <iostream>
 #include <curl/curl.h>
+#include <sstream>
 #include <string>
 #include <nlohmann/json.hpp>
 #include "HttpClient.h"
 #include "HttpUtils.h"
+#include "AsyncHttpClient.h"
+#include "BulkUpload.h"
+#include "CurlShare.h"
+#include "JsonOnDemand.h"
+#include "PagedRange.h"
 
 using json = nlohmann::json;
 
@@ -11,6 +18,47 @@ using json = nlohmann::json;
 const char* BASE_URL = "https://jsonplaceholder.typicode.com";
 const char* POSTS_ENDPOINT = "/posts";
 
+// Parser used for response bodies (--json-backend)
+enum class JsonBackend {
+    NLOHMANN,
+    ON_DEMAND
+};
+
+JsonBackend g_json_backend = JsonBackend::NLOHMANN;
+
+// Formats the fields printed for a response. The on-demand backend reads
+// only these fields from a structural index instead of building a tree.
+std::string describe_response(const std::string& method, const std::string& body) {
+    std::ostringstream out;
+    out << method << " Response Parsed:" << std::endl;
+    if (g_json_backend == JsonBackend::ON_DEMAND) {
+        JsonDocument document(body);
+        JsonValue root = document.root();
+        if (method == "DELETE") {
+            out << "  Response: " << root.raw() << std::endl;
+            return out.str();
+        }
+        const std::pair<const char*, const char*> fields[] = {
+            {"ID", "id"}, {"Title", "title"}, {"Body", "body"}, {"User ID", "userId"}};
+        for (const auto& field : fields) {
+            JsonValue value;
+            out << "  " << field.first << ": " << (root.find(field.second, value) ? value.raw() : "null") << std::endl;
+        }
+        return out.str();
+    }
+
+    json json_response = json::parse(body);
+    if (method == "DELETE") {
+        out << "  Response: " << json_response.dump(2) << std::endl;
+    } else {
+        out << "  ID: " << json_response["id"] << std::endl;
+        out << "  Title: " << json_response["title"] << std::endl;
+        out << "  Body: " << json_response["body"] << std::endl;
+        out << "  User ID: " << json_response["userId"] << std::endl;
+    }
+    return out.str();
+}
+
 // API functions using the separated HttpClient class
 
 void perform_get() {
@@ -22,16 +70,8 @@ void perform_get() {
         
         if (response.success) {
             try {
-                // Parse JSON response
-                json json_response = json::parse(response.body);
-                
-                std::cout << "GET Response Parsed:" << std::endl;
-                std::cout << "  ID: " << json_response["id"] << std::endl;
-                std::cout << "  Title: " << json_response["title"] << std::endl;
-                std::cout << "  Body: " << json_response["body"] << std::endl;
-                std::cout << "  User ID: " << json_response["userId"] << std::endl;
-                std::cout << std::endl;
-            } catch (const json::parse_error& e) {
+                std::cout << describe_response("GET", response.body) << std::endl;
+            } catch (const std::exception& e) {
                 log_error("Error parsing JSON: " + std::string(e.what()));
                 std::cout << "Raw response: " << response.body << std::endl;
             }
@@ -64,16 +104,8 @@ void perform_post() {
         
         if (response.success) {
             try {
-                // Parse JSON response
-                json json_response = json::parse(response.body);
-                
-                std::cout << "POST Response Parsed:" << std::endl;
-                std::cout << "  ID: " << json_response["id"] << std::endl;
-                std::cout << "  Title: " << json_response["title"] << std::endl;
-                std::cout << "  Body: " << json_response["body"] << std::endl;
-                std::cout << "  User ID: " << json_response["userId"] << std::endl;
-                std::cout << std::endl;
-            } catch (const json::parse_error& e) {
+                std::cout << describe_response("POST", response.body) << std::endl;
+            } catch (const std::exception& e) {
                 log_error("Error parsing JSON: " + std::string(e.what()));
                 std::cout << "Raw response: " << response.body << std::endl;
             }
@@ -107,16 +139,8 @@ void perform_put() {
         
         if (response.success) {
             try {
-                // Parse JSON response
-                json json_response = json::parse(response.body);
-                
-                std::cout << "PUT Response Parsed:" << std::endl;
-                std::cout << "  ID: " << json_response["id"] << std::endl;
-                std::cout << "  Title: " << json_response["title"] << std::endl;
-                std::cout << "  Body: " << json_response["body"] << std::endl;
-                std::cout << "  User ID: " << json_response["userId"] << std::endl;
-                std::cout << std::endl;
-            } catch (const json::parse_error& e) {
+                std::cout << describe_response("PUT", response.body) << std::endl;
+            } catch (const std::exception& e) {
                 log_error("Error parsing JSON: " + std::string(e.what()));
                 std::cout << "Raw response: " << response.body << std::endl;
             }
@@ -137,13 +161,8 @@ void perform_delete() {
         
         if (response.success) {
             try {
-                // Parse JSON response
-                json json_response = json::parse(response.body);
-                
-                std::cout << "DELETE Response Parsed:" << std::endl;
-                std::cout << "  Response: " << json_response.dump(2) << std::endl;
-                std::cout << std::endl;
-            } catch (const json::parse_error& e) {
+                std::cout << describe_response("DELETE", response.body) << std::endl;
+            } catch (const std::exception& e) {
                 log_error("Error parsing JSON: " + std::string(e.what()));
                 std::cout << "Raw response: " << response.body << std::endl;
             }
@@ -155,6 +174,164 @@ void perform_delete() {
     }
 }
 
+// Coroutine variant: all four operations are in flight at once on one thread,
+// while the code still reads top to bottom. JSON parsing runs on a
+// work-stealing pool so a large body never stalls the I/O thread.
+
+Task<void> report_async(AsyncHttpClient& client, WorkStealingPool& pool,
+                        std::string method, Task<HttpResponse> call) {
+    HttpResponse response = co_await call;
+    if (!response.success) {
+        log_error(method + " request failed: " + response.error_message);
+        co_return;
+    }
+    try {
+        std::string text = co_await client.offload(pool, [&method, &response] {
+            return describe_response(method, response.body);
+        });
+        std::cout << text << std::endl;
+    } catch (const std::exception& e) {
+        log_error("Error parsing JSON: " + std::string(e.what()));
+        std::cout << "Raw response: " << response.body << std::endl;
+    }
+}
+
+Task<void> perform_all_async(AsyncHttpClient& client, WorkStealingPool& pool) {
+    std::string posts_url = std::string(BASE_URL) + POSTS_ENDPOINT;
+    std::vector<std::string> headers = {"Content-Type: application/json; charset=UTF-8"};
+
+    json post_data = {{"title", "foo"}, {"body", "bar"}, {"userId", 1}};
+    json put_data = {{"id", 1}, {"title", "foo"}, {"body", "bar"}, {"userId", 1}};
+
+    std::vector<Task<void>> operations;
+    operations.push_back(report_async(client, pool, "GET", client.get(posts_url + "/1")));
+    operations.push_back(report_async(client, pool, "POST", client.post(posts_url, post_data.dump(), headers)));
+    operations.push_back(report_async(client, pool, "PUT", client.put(posts_url + "/1", put_data.dump(), headers)));
+    operations.push_back(report_async(client, pool, "DELETE", client.request(posts_url + "/1", "DELETE")));
+
+    co_await when_all(std::move(operations));
+}
+
+// Opens connections to the API host before the first real call, so its
+// DNS lookup and TCP/TLS handshakes happen in parallel at startup
+void warm_up(AsyncHttpClient& client, std::size_t connections) {
+    auto start = std::chrono::steady_clock::now();
+    std::size_t warmed = client.sync_wait(client.warmup({BASE_URL}, connections));
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    log_info("Warmed " + std::to_string(warmed) + " of " + std::to_string(connections) + " connections to " +
+             BASE_URL + " in " + std::to_string(elapsed.count()) + "ms");
+}
+
+// Bulk mode: upload every record of a JSON-lines file, batched or one POST each
+int perform_bulk(int argc, char *argv[]) {
+    BulkConfig config;
+    config.url = std::string(BASE_URL) + POSTS_ENDPOINT;
+    std::string path;
+    
+    try {
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) {
+                    throw std::invalid_argument("Missing value for " + arg);
+                }
+                return argv[++i];
+            };
+            
+            if (arg == "--url") {
+                config.url = value();
+            } else if (arg == "--per-record") {
+                config.mode = BulkMode::PER_RECORD;
+            } else if (arg == "--batch-records") {
+                config.batch_records = std::stoul(value());
+            } else if (arg == "--batch-bytes") {
+                config.batch_bytes = std::stoul(value());
+            } else if (arg == "--concurrency") {
+                config.concurrency = std::stoi(value());
+            } else if (!arg.empty() && arg[0] == '-') {
+                throw std::invalid_argument("Unknown option: " + arg);
+            } else {
+                path = arg;
+            }
+        }
+        if (path.empty()) {
+            throw std::invalid_argument("--bulk needs a file");
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n"
+                  << "Usage: " << argv[0] << " --bulk FILE [--url URL] [--per-record]"
+                  << " [--batch-records N] [--batch-bytes N] [--concurrency N]\n";
+        return 1;
+    }
+    
+    // Per-request logging would drown out the summary for millions of records
+    set_log_level(LogLevel::WARNING);
+    try {
+        WorkStealingPool pool;
+        BulkReport report = run_bulk_upload_file(path, config, pool);
+        print_bulk_report(report, std::cout);
+        return report.failed_requests == 0 ? 0 : 1;
+    } catch (const std::exception& e) {
+        log_error("Bulk upload failed: " + std::string(e.what()));
+        return 1;
+    }
+}
+
+// List mode: read the whole /posts collection page by page, prefetching ahead
+int perform_list(int argc, char *argv[]) {
+    PageConfig config;
+    config.url = std::string(BASE_URL) + POSTS_ENDPOINT;
+    
+    try {
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) {
+                    throw std::invalid_argument("Missing value for " + arg);
+                }
+                return argv[++i];
+            };
+            
+            if (arg == "--url") {
+                config.url = value();
+            } else if (arg == "--page-size") {
+                config.page_size = std::stoul(value());
+            } else if (arg == "--prefetch") {
+                config.prefetch = std::stoi(value());
+            } else {
+                throw std::invalid_argument("Unknown option: " + arg);
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n"
+                  << "Usage: " << argv[0] << " --list [--url URL] [--page-size N] [--prefetch N]\n";
+        return 1;
+    }
+    
+    try {
+        auto start = std::chrono::steady_clock::now();
+        std::size_t pages = 0;
+        std::size_t items = 0;
+        for (const Page& page : PagedRange(config)) {
+            if (!page.response.success) {
+                log_error("Listing stopped at page " + std::to_string(page.index) + ": " +
+                          page.response.error_message);
+                return 1;
+            }
+            ++pages;
+            items += page.items;
+            std::cout << "Page " << page.index << ": " << page.items << " items" << std::endl;
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        log_info("Listed " + std::to_string(items) + " items in " + std::to_string(pages) + " pages in " +
+                 std::to_string(elapsed.count()) + "ms");
+        return 0;
+    } catch (const std::exception& e) {
+        log_error("Listing failed: " + std::string(e.what()));
+        return 1;
+    }
+}
+
 int main(int argc, char *argv[]) {
     try {
         log_info("Starting Sample API Integration with Best Practices");
@@ -168,6 +345,68 @@ int main(int argc, char *argv[]) {
         
         log_info("cURL initialized successfully");
         
+        if (argc > 1 && std::string(argv[1]) == "--bulk") {
+            int status = perform_bulk(argc, argv);
+            curl_global_cleanup();
+            return status;
+        }
+        
+        if (argc > 1 && std::string(argv[1]) == "--list") {
+            int status = perform_list(argc, argv);
+            curl_global_cleanup();
+            return status;
+        }
+        
+        bool use_async = false;
+        std::size_t warm_connections = 0;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--async") {
+                use_async = true;
+            } else if (arg == "--warmup" && i + 1 < argc) {
+                warm_connections = std::stoul(argv[++i]);
+            } else if (arg == "--json-backend" && i + 1 < argc && std::string(argv[i + 1]) == "nlohmann") {
+                g_json_backend = JsonBackend::NLOHMANN;
+                ++i;
+            } else if (arg == "--json-backend" && i + 1 < argc && std::string(argv[i + 1]) == "ondemand") {
+                g_json_backend = JsonBackend::ON_DEMAND;
+                ++i;
+            } else {
+                std::cerr << "Usage: " << argv[0] << " [--async] [--warmup N] [--json-backend nlohmann|ondemand]\n"
+                          << "       " << argv[0] << " --bulk FILE [options]\n"
+                          << "       " << argv[0] << " --list [options]\n";
+                curl_global_cleanup();
+                return 1;
+            }
+        }
+        
+        // Every client below resolves names and resumes TLS sessions through one cache
+        CurlShare::set_global(std::make_shared<CurlShare>());
+        
+        if (use_async) {
+            try {
+                WorkStealingPool pool;
+                AsyncHttpClient client;
+                if (warm_connections > 0) {
+                    warm_up(client, warm_connections);
+                }
+                client.sync_wait(perform_all_async(client, pool));
+            } catch (const std::exception& e) {
+                log_error("Async operations failed: " + std::string(e.what()));
+            }
+            log_info("All API operations completed");
+            CurlShare::set_global(nullptr);
+            curl_global_cleanup();
+            return 0;
+        }
+        
+        // The warm-up client's connections close with it, but the lookups and
+        // TLS sessions it cached stay in the shared cache
+        if (warm_connections > 0) {
+            AsyncHttpClient warmer;
+            warm_up(warmer, warm_connections);
+        }
+        
         // Perform API operations with proper error handling
         try {
             perform_get();
@@ -201,6 +440,7 @@ int main(int argc, char *argv[]) {
     }
     
     // Cleanup
+    CurlShare::set_global(nullptr);
     curl_global_cleanup();
     log_info("cURL cleanup completed");
     
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "AllocationTracker.h"
+#include "LoadGenerator.h"
+#include "PerfCounters.h"
+#include <sstream>
+#include <thread>
+
+class AllocationTrackerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // Redirect cout/cerr to capture log output
+        old_cout = std::cout.rdbuf();
+        old_cerr = std::cerr.rdbuf();
+        std::cout.rdbuf(cout_buffer.rdbuf());
+        std::cerr.rdbuf(cerr_buffer.rdbuf());
+    }
+
+    void TearDown() override {
+        // Restore cout/cerr
+        std::cout.rdbuf(old_cout);
+        std::cerr.rdbuf(old_cerr);
+    }
+
+    std::stringstream cout_buffer;
+    std::stringstream cerr_buffer;
+    std::streambuf* old_cout;
+    std::streambuf* old_cerr;
+};
+
+// Test allocations go to the open scope and to the phase marked at the time
+TEST_F(AllocationTrackerTest, AttributesToScopeAndPhase) {
+    // The tests link the default allocator, so the hook is driven directly
+    EXPECT_FALSE(AllocationTracker::installed());
+
+    AllocationProfile profile;
+    AllocationTracker::record_allocation(1000); // no scope: not counted
+    {
+        AllocationScope scope(profile);
+        AllocationTracker::record_allocation(10);
+        {
+            PhaseScope phase(RequestPhase::SETUP);
+            AllocationTracker::record_allocation(20);
+            AllocationTracker::record_allocation(30);
+            {
+                PhaseScope inner(RequestPhase::LOGGING);
+                AllocationTracker::record_allocation(40);
+            }
+            AllocationTracker::record_free();
+        }
+        EXPECT_EQ(PhaseScope::current(), RequestPhase::COUNT);
+        AllocationTracker::record_free();
+    }
+    AllocationTracker::record_allocation(1000);
+
+    EXPECT_EQ(profile.requests, 1u);
+    EXPECT_EQ(profile.total.allocations, 4u);
+    EXPECT_EQ(profile.total.bytes, 100u);
+    EXPECT_EQ(profile.total.frees, 2u);
+    EXPECT_EQ(profile[RequestPhase::SETUP].allocations, 2u);
+    EXPECT_EQ(profile[RequestPhase::SETUP].bytes, 50u);
+    EXPECT_EQ(profile[RequestPhase::SETUP].frees, 1u);
+    EXPECT_EQ(profile[RequestPhase::LOGGING].bytes, 40u);
+    EXPECT_EQ(profile[RequestPhase::PERFORM].allocations, 0u);
+    AllocationStats other = profile.unphased();
+    EXPECT_EQ(other.allocations, 1u);
+    EXPECT_EQ(other.bytes, 10u);
+    EXPECT_EQ(other.frees, 1u);
+}
+
+// Test scopes nest and stay private to their thread
+TEST_F(AllocationTrackerTest, ScopesNestPerThread) {
+    AllocationProfile outer;
+    AllocationProfile inner;
+    {
+        AllocationScope outer_scope(outer);
+        AllocationTracker::record_allocation(1);
+        {
+            AllocationScope inner_scope(inner);
+            AllocationTracker::record_allocation(2);
+            std::thread([] { AllocationTracker::record_allocation(1000); }).join();
+        }
+        AllocationTracker::record_allocation(4);
+    }
+    EXPECT_EQ(outer.total.bytes, 5u);
+    EXPECT_EQ(inner.total.bytes, 2u);
+
+    outer.merge(inner);
+    EXPECT_EQ(outer.requests, 2u);
+    EXPECT_EQ(outer.total.allocations, 3u);
+    EXPECT_EQ(outer.total.bytes, 7u);
+}
+
+// Test the load report only shows allocations when they were counted
+TEST_F(AllocationTrackerTest, LoadReportOmitsUncountedAllocations) {
+    LoadConfig config;
+    LoadReport report;
+    report.allocations.requests = 3;
+    report.allocations.total.allocations = 30;
+    std::ostringstream out;
+    print_report(config, report, out);
+    EXPECT_THAT(out.str(), ::testing::HasSubstr("Latency ms:"));
+    EXPECT_THAT(out.str(), ::testing::Not(::testing::HasSubstr("Allocations:")));
+}
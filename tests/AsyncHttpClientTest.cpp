@@ -0,0 +1,348 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "AsyncHttpClient.h"
+#include "LocalHttpServer.h"
+#include <curl/curl.h>
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+class AsyncHttpClientTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // Initialize cURL globally for tests
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+
+        // Redirect cout/cerr to capture log output
+        old_cout = std::cout.rdbuf();
+        old_cerr = std::cerr.rdbuf();
+        std::cout.rdbuf(cout_buffer.rdbuf());
+        std::cerr.rdbuf(cerr_buffer.rdbuf());
+    }
+
+    void TearDown() override {
+        // Restore cout/cerr
+        std::cout.rdbuf(old_cout);
+        std::cerr.rdbuf(old_cerr);
+
+        // Cleanup cURL
+        curl_global_cleanup();
+    }
+
+    std::stringstream cout_buffer;
+    std::stringstream cerr_buffer;
+    std::streambuf* old_cout;
+    std::streambuf* old_cerr;
+};
+
+// Test a single awaited GET
+TEST_F(AsyncHttpClientTest, GetReturnsBody) {
+    LocalHttpServer server([](const LocalHttpServer::Request& request) {
+        LocalHttpServer::Response response;
+        response.body = "hello " + request.target;
+        return response;
+    });
+    AsyncHttpClient client(5);
+
+    HttpResponse response = client.sync_wait(client.get(server.url("/posts/1")));
+
+    EXPECT_TRUE(response.success);
+    EXPECT_EQ(response.status_code, 200);
+    EXPECT_EQ(response.body, "hello /posts/1");
+    EXPECT_TRUE(response.error_message.empty());
+}
+
+// Test method and body are sent
+TEST_F(AsyncHttpClientTest, PostAndPutSendBody) {
+    LocalHttpServer server([](const LocalHttpServer::Request& request) {
+        LocalHttpServer::Response response;
+        response.status = request.method == "POST" ? 201 : 200;
+        response.body = request.method + ":" + request.body;
+        return response;
+    });
+    AsyncHttpClient client(5);
+
+    HttpResponse posted = client.sync_wait(client.post(server.url("/posts"), "{\"a\":1}"));
+    HttpResponse put = client.sync_wait(client.put(server.url("/posts/1"), "{\"b\":2}"));
+    HttpResponse deleted = client.sync_wait(client.request(server.url("/posts/1"), "DELETE"));
+
+    EXPECT_EQ(posted.status_code, 201);
+    EXPECT_EQ(posted.body, "POST:{\"a\":1}");
+    EXPECT_EQ(put.body, "PUT:{\"b\":2}");
+    EXPECT_EQ(deleted.body, "DELETE:");
+}
+
+// Test that awaited requests in when_all run concurrently
+TEST_F(AsyncHttpClientTest, WhenAllFansOutConcurrently) {
+    LocalHttpServer server([](const LocalHttpServer::Request& request) {
+        LocalHttpServer::Response response;
+        response.body = request.target;
+        response.delay_ms = 300;
+        return response;
+    });
+    AsyncHttpClient client(5);
+
+    auto flow = [&]() -> Task<std::vector<HttpResponse>> {
+        std::vector<Task<HttpResponse>> calls;
+        for (int i = 0; i < 8; ++i) {
+            calls.push_back(client.get(server.url("/item/" + std::to_string(i))));
+        }
+        co_return co_await when_all(std::move(calls));
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<HttpResponse> responses = client.sync_wait(flow());
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+
+    ASSERT_EQ(responses.size(), 8u);
+    for (int i = 0; i < 8; ++i) {
+        EXPECT_TRUE(responses[i].success);
+        EXPECT_EQ(responses[i].body, "/item/" + std::to_string(i));
+    }
+    // Eight serial requests would take at least 2400ms
+    EXPECT_LT(elapsed.count(), 1500);
+}
+
+// Test that destroying a when_all mid-flight tears down its children
+TEST_F(AsyncHttpClientTest, WhenAllDestroyedMidFlightReleasesChildren) {
+    struct Gate {
+        std::coroutine_handle<> waiter;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) noexcept { waiter = handle; }
+        void await_resume() const noexcept {}
+    };
+    struct Tracked {
+        int* alive;
+        explicit Tracked(int* counter) : alive(counter) { ++*alive; }
+        ~Tracked() { --*alive; }
+    };
+
+    Gate gate;
+    int alive = 0;
+    auto pending = [&]() -> Task<int> {
+        Tracked tracked(&alive);
+        co_await gate;
+        co_return 1;
+    };
+    auto ready = []() -> Task<int> { co_return 2; };
+
+    {
+        std::vector<Task<int>> tasks;
+        tasks.push_back(pending());
+        tasks.push_back(ready());
+        Task<std::vector<int>> all = when_all(std::move(tasks));
+        all.start();
+        EXPECT_FALSE(all.done());
+        EXPECT_EQ(alive, 1);
+    }
+    // The suspended child and the task it awaited are gone with the parent
+    EXPECT_EQ(alive, 0);
+}
+
+// Test retryable status codes are retried and eventually succeed
+TEST_F(AsyncHttpClientTest, RetriesServerErrorThenSucceeds) {
+    std::atomic<int> calls{0};
+    LocalHttpServer server([&](const LocalHttpServer::Request&) {
+        LocalHttpServer::Response response;
+        response.status = calls++ == 0 ? 503 : 200;
+        response.body = "ok";
+        return response;
+    });
+    AsyncHttpClient client(5);
+
+    HttpResponse response = client.sync_wait(client.get(server.url()));
+
+    EXPECT_TRUE(response.success);
+    EXPECT_EQ(response.body, "ok");
+    EXPECT_EQ(server.request_count(), 2);
+    EXPECT_THAT(cout_buffer.str(), ::testing::HasSubstr("HTTP 503"));
+}
+
+// Test non-retryable status codes fail without retrying
+TEST_F(AsyncHttpClientTest, NotFoundIsNotRetried) {
+    LocalHttpServer server([](const LocalHttpServer::Request&) {
+        LocalHttpServer::Response response;
+        response.status = 404;
+        return response;
+    });
+    AsyncHttpClient client(5);
+
+    HttpResponse response = client.sync_wait(client.get(server.url("/missing")));
+
+    EXPECT_FALSE(response.success);
+    EXPECT_EQ(response.status_code, 404);
+    EXPECT_EQ(response.error_message, "HTTP 404");
+    EXPECT_EQ(server.request_count(), 1);
+}
+
+// Test connection failures surface as an error response
+TEST_F(AsyncHttpClientTest, ConnectionRefusedReturnsError) {
+    int port = 0;
+    {
+        LocalHttpServer server([](const LocalHttpServer::Request&) { return LocalHttpServer::Response(); });
+        port = server.port();
+    }
+    AsyncHttpClient client(2);
+    client.set_max_retries(0);
+
+    HttpResponse response = client.sync_wait(
+        client.get("http://127.0.0.1:" + std::to_string(port) + "/"));
+
+    EXPECT_FALSE(response.success);
+    EXPECT_FALSE(response.error_message.empty());
+}
+
+// Test sleep_for suspends without blocking other work
+TEST_F(AsyncHttpClientTest, SleepForDelaysCoroutine) {
+    AsyncHttpClient client;
+
+    auto flow = [&]() -> Task<void> {
+        co_await client.sleep_for(std::chrono::milliseconds(100));
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    client.sync_wait(flow());
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+
+    EXPECT_GE(elapsed.count(), 100);
+    EXPECT_LT(elapsed.count(), 1000);
+}
+
+// Test spawned tasks are driven to completion by run()
+TEST_F(AsyncHttpClientTest, SpawnedTasksRunToCompletion) {
+    LocalHttpServer server([](const LocalHttpServer::Request&) {
+        LocalHttpServer::Response response;
+        response.body = "x";
+        return response;
+    });
+    AsyncHttpClient client(5);
+    int completed = 0;
+
+    auto flow = [&](int n) -> Task<void> {
+        for (int i = 0; i < n; ++i) {
+            HttpResponse response = co_await client.get(server.url());
+            if (response.success) {
+                ++completed;
+            }
+        }
+    };
+    for (int i = 0; i < 10; ++i) {
+        client.spawn(flow(3));
+    }
+    client.run();
+
+    EXPECT_EQ(completed, 30);
+    EXPECT_EQ(client.in_flight(), 0);
+}
+
+// Test offload runs work on the pool and resumes on the event-loop thread
+TEST_F(AsyncHttpClientTest, OffloadResumesOnLoopThread) {
+    WorkStealingPool pool(2);
+    AsyncHttpClient client;
+    std::thread::id loop_thread = std::this_thread::get_id();
+    std::thread::id worker_thread;
+    std::thread::id resumed_thread;
+
+    auto flow = [&]() -> Task<int> {
+        int value = co_await client.offload(pool, [&] {
+            worker_thread = std::this_thread::get_id();
+            return 21 * 2;
+        });
+        resumed_thread = std::this_thread::get_id();
+        co_return value;
+    };
+
+    EXPECT_EQ(client.sync_wait(flow()), 42);
+    EXPECT_NE(worker_thread, loop_thread);
+    EXPECT_EQ(resumed_thread, loop_thread);
+}
+
+// Test exceptions thrown by offloaded work are rethrown at co_await
+TEST_F(AsyncHttpClientTest, OffloadPropagatesException) {
+    WorkStealingPool pool(1);
+    AsyncHttpClient client;
+
+    auto flow = [&]() -> Task<void> {
+        co_await client.offload(pool, []() { throw std::runtime_error("parse failed"); });
+    };
+
+    EXPECT_THROW(client.sync_wait(flow()), std::runtime_error);
+}
+
+// Test destroying the client mid-offload neither touches the freed frame nor resumes it
+TEST_F(AsyncHttpClientTest, DestroyedMidOffloadDropsResume) {
+    WorkStealingPool pool(1);
+    std::atomic<bool> job_finished{false};
+    bool resumed = false;
+    {
+        AsyncHttpClient client;
+        auto flow = [&]() -> Task<void> {
+            co_await client.offload(pool, [&] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(200));
+                job_finished = true;
+                return 1;
+            });
+            resumed = true;
+        };
+        client.spawn(flow());
+        client.run_once(0);
+    }
+
+    EXPECT_TRUE(job_finished.load());
+    EXPECT_FALSE(resumed);
+}
+
+// Test warmup opens connections in parallel and later requests reuse them
+TEST_F(AsyncHttpClientTest, WarmupOpensConnectionsInParallel) {
+    LocalHttpServer server([](const LocalHttpServer::Request& request) {
+        LocalHttpServer::Response response;
+        if (request.method == "HEAD") {
+            response.delay_ms = 100;
+        } else {
+            response.body = "ok";
+        }
+        return response;
+    });
+    AsyncHttpClient client;
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(client.sync_wait(client.warmup({server.url("/")}, 6)), 6u);
+    // Six probes one after another would take 600ms
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(450));
+    EXPECT_EQ(server.connection_count(), 6);
+
+    std::vector<Task<HttpResponse>> calls;
+    for (int i = 0; i < 6; ++i) {
+        calls.push_back(client.get(server.url("/item")));
+    }
+    for (const HttpResponse& response : client.sync_wait(when_all(std::move(calls)))) {
+        EXPECT_TRUE(response.success);
+    }
+    EXPECT_EQ(server.connection_count(), 6);
+
+    // A host that cannot be reached is reported, not thrown
+    EXPECT_EQ(client.sync_wait(client.warmup({"http://127.0.0.1:1"}, 2)), 0u);
+    EXPECT_THAT(cerr_buffer.str() + cout_buffer.str(), ::testing::HasSubstr("Warmup of http://127.0.0.1:1 failed"));
+}
+
+// Test keep_warm refreshes idle connections without opening new ones or blocking run()
+TEST_F(AsyncHttpClientTest, KeepWarmRefreshesIdleConnections) {
+    LocalHttpServer server([](const LocalHttpServer::Request&) { return LocalHttpServer::Response(); });
+    AsyncHttpClient client;
+    client.keep_warm({server.url("")}, 2, std::chrono::milliseconds(50));
+
+    auto idle = [&]() -> Task<void> { co_await client.sleep_for(std::chrono::milliseconds(230)); };
+    client.sync_wait(idle());
+    client.run(); // the timer alone is not pending work
+    client.stop_keep_warm();
+
+    EXPECT_EQ(server.connection_count(), 2);
+    EXPECT_GE(server.request_count(), 6);
+    int requests = server.request_count();
+    client.sync_wait(idle());
+    EXPECT_EQ(server.request_count(), requests);
+}
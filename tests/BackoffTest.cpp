@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "Backoff.h"
+#include "BackoffSimulator.h"
+#include "HttpClient.h"
+#include <algorithm>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+class BackoffTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // Redirect cout/cerr to capture log output
+        old_cout = std::cout.rdbuf();
+        old_cerr = std::cerr.rdbuf();
+        std::cout.rdbuf(cout_buffer.rdbuf());
+        std::cerr.rdbuf(cerr_buffer.rdbuf());
+    }
+
+    void TearDown() override {
+        // Restore cout/cerr
+        std::cout.rdbuf(old_cout);
+        std::cerr.rdbuf(old_cerr);
+    }
+
+    // Small storm that finishes in milliseconds
+    static RetryStormConfig small_storm(JitterStrategy strategy) {
+        RetryStormConfig config;
+        config.clients = 300;
+        config.outage_ms = 3000;
+        config.capacity_per_second = 1000;
+        config.backoff.strategy = strategy;
+        config.seed = 7;
+        return config;
+    }
+
+    std::stringstream cout_buffer;
+    std::stringstream cerr_buffer;
+    std::streambuf* old_cout;
+    std::streambuf* old_cerr;
+};
+
+// Test the generator is reproducible per seed, in range, and distinct per thread
+TEST_F(BackoffTest, FastRandomIsSeededAndUniform) {
+    FastRandom a(42);
+    FastRandom b(42);
+    double sum = 0;
+    for (int i = 0; i < 10000; ++i) {
+        double value = a.uniform();
+        EXPECT_EQ(value, b.uniform());
+        ASSERT_GE(value, 0.0);
+        ASSERT_LT(value, 1.0);
+        sum += value;
+    }
+    EXPECT_NEAR(sum / 10000, 0.5, 0.02);
+
+    std::uint64_t main_value = FastRandom::thread_instance().next();
+    std::uint64_t other_value = 0;
+    std::thread([&other_value] { other_value = FastRandom::thread_instance().next(); }).join();
+    EXPECT_NE(main_value, other_value);
+}
+
+// Test each strategy stays within its bounds, and the first retry is immediate
+TEST_F(BackoffTest, StrategiesStayWithinBounds) {
+    FastRandom random(1);
+    BackoffConfig config;
+    config.initial_ms = 100;
+    config.max_ms = 1000;
+
+    for (int attempt = 1; attempt <= 8; ++attempt) {
+        double base = std::min(100.0 * (1 << (attempt - 1)), 1000.0);
+        for (int i = 0; i < 200; ++i) {
+            config.strategy = JitterStrategy::PROPORTIONAL;
+            int delay = Backoff(config, &random).delay_ms(attempt);
+            ASSERT_GE(delay, static_cast<int>(base * 0.5));
+            ASSERT_LE(delay, static_cast<int>(base * 1.5));
+
+            config.strategy = JitterStrategy::FULL;
+            delay = Backoff(config, &random).delay_ms(attempt);
+            ASSERT_GE(delay, 0);
+            ASSERT_LT(delay, static_cast<int>(base));
+
+            config.strategy = JitterStrategy::EQUAL;
+            delay = Backoff(config, &random).delay_ms(attempt);
+            ASSERT_GE(delay, static_cast<int>(base / 2));
+            ASSERT_LE(delay, static_cast<int>(base));
+        }
+    }
+
+    // Decorrelated delays grow from the previous one and are capped
+    config.strategy = JitterStrategy::DECORRELATED;
+    Backoff decorrelated(config, &random);
+    for (int round = 0; round < 50; ++round) {
+        EXPECT_EQ(decorrelated.delay_ms(0), 0);
+        int previous = config.initial_ms;
+        for (int attempt = 1; attempt <= 10; ++attempt) {
+            int delay = decorrelated.delay_ms(attempt);
+            ASSERT_GE(delay, config.initial_ms);
+            ASSERT_LE(delay, std::min(config.max_ms, 3 * previous));
+            previous = delay;
+        }
+    }
+
+    EXPECT_EQ(backoff_delay_ms(0), 0);
+    int delay = backoff_delay_ms(1);
+    EXPECT_GE(delay, INITIAL_BACKOFF_MS / 2);
+    EXPECT_LE(delay, INITIAL_BACKOFF_MS * 3 / 2);
+
+    config.initial_ms = 0;
+    EXPECT_THROW(Backoff{config}, std::invalid_argument);
+    config.initial_ms = 2000;
+    EXPECT_THROW(Backoff{config}, std::invalid_argument);
+    EXPECT_EQ(parse_jitter_strategy("decorrelated"), JitterStrategy::DECORRELATED);
+    EXPECT_THROW(parse_jitter_strategy("none"), std::invalid_argument);
+}
+
+// Test HttpClient uses the configured strategy for its retries
+TEST_F(BackoffTest, ClientUsesConfiguredStrategy) {
+    HttpClient client(5);
+    BackoffConfig config;
+    config.strategy = JitterStrategy::FULL;
+    config.initial_ms = 10;
+    config.max_ms = 20;
+    client.backoff_policy().backoff = Backoff(config);
+    std::set<int> delays;
+    for (int i = 0; i < 100; ++i) {
+        int delay = client.backoff_policy().delay_ms(3);
+        EXPECT_LT(delay, 20);
+        delays.insert(delay);
+    }
+    EXPECT_GT(delays.size(), 5u);
+}
+
+// Test every client is accounted for and a run depends only on its seed
+TEST_F(BackoffTest, SimulationIsDeterministic) {
+    for (JitterStrategy strategy : {JitterStrategy::PROPORTIONAL, JitterStrategy::FULL, JitterStrategy::EQUAL,
+                                    JitterStrategy::DECORRELATED}) {
+        RetryStormConfig config = small_storm(strategy);
+        RetryStormReport first = simulate_retry_storm(config);
+        RetryStormReport second = simulate_retry_storm(config);
+        EXPECT_EQ(first.strategy, strategy);
+        EXPECT_EQ(first.succeeded + first.gave_up, config.clients) << jitter_strategy_name(strategy);
+        EXPECT_GT(first.attempts, static_cast<std::uint64_t>(config.clients));
+        EXPECT_EQ(first.attempts, second.attempts);
+        EXPECT_EQ(first.recovery_ms, second.recovery_ms);
+        EXPECT_GT(first.peak_window_attempts, 0u);
+    }
+
+    // Without an outage and with spare capacity, nobody retries
+    RetryStormConfig calm = small_storm(JitterStrategy::FULL);
+    calm.outage_ms = 0;
+    calm.capacity_per_second = 100000;
+    RetryStormReport report = simulate_retry_storm(calm);
+    EXPECT_EQ(report.attempts, static_cast<std::uint64_t>(calm.clients));
+    EXPECT_EQ(report.succeeded, calm.clients);
+    EXPECT_EQ(report.rejected, 0u);
+
+    calm.clients = 0;
+    EXPECT_THROW(simulate_retry_storm(calm), std::invalid_argument);
+}
+
+// Test the report table lists every strategy
+TEST_F(BackoffTest, PrintsReportTable) {
+    RetryStormConfig config = small_storm(JitterStrategy::EQUAL);
+    std::vector<RetryStormReport> reports = {simulate_retry_storm(config)};
+    config.backoff.strategy = JitterStrategy::DECORRELATED;
+    reports.push_back(simulate_retry_storm(config));
+
+    std::ostringstream out;
+    print_retry_storm_reports(config, reports, out);
+    EXPECT_THAT(out.str(), ::testing::HasSubstr("300 clients, 3000ms outage"));
+    EXPECT_THAT(out.str(), ::testing::HasSubstr("recovery-ms"));
+    EXPECT_THAT(out.str(), ::testing::HasSubstr("equal"));
+    EXPECT_THAT(out.str(), ::testing::HasSubstr("decorrelated"));
+}
@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "BulkUpload.h"
+#include "LocalHttpServer.h"
+#include "WorkStealingPool.h"
+#include <curl/curl.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+class BulkUploadTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // Initialize cURL globally for tests
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+
+        // Redirect cout/cerr to capture log output
+        old_cout = std::cout.rdbuf();
+        old_cerr = std::cerr.rdbuf();
+        std::cout.rdbuf(cout_buffer.rdbuf());
+        std::cerr.rdbuf(cerr_buffer.rdbuf());
+    }
+
+    void TearDown() override {
+        // Restore cout/cerr
+        std::cout.rdbuf(old_cout);
+        std::cerr.rdbuf(old_cerr);
+
+        // Cleanup cURL
+        curl_global_cleanup();
+    }
+
+    static std::string records(int count) {
+        std::string text;
+        for (int i = 0; i < count; ++i) {
+            text += "{\"id\": " + std::to_string(i) + ", \"title\": \"record " + std::to_string(i) + "\"}\n";
+        }
+        return text;
+    }
+
+    std::stringstream cout_buffer;
+    std::stringstream cerr_buffer;
+    std::streambuf* old_cout;
+    std::streambuf* old_cerr;
+};
+
+// Test records are packed into NDJSON batches within the record limit
+TEST_F(BulkUploadTest, SendsNdjsonBatches) {
+    std::mutex mutex;
+    std::size_t received_lines = 0;
+    std::string content_type;
+    std::size_t chunked_requests = 0;
+    LocalHttpServer server([&](const LocalHttpServer::Request& request) {
+        std::lock_guard<std::mutex> lock(mutex);
+        received_lines += static_cast<std::size_t>(std::count(request.body.begin(), request.body.end(), '\n'));
+        content_type = request.headers.at("content-type");
+        auto encoding = request.headers.find("transfer-encoding");
+        if (encoding != request.headers.end() && encoding->second == "chunked") {
+            ++chunked_requests;
+        }
+        return LocalHttpServer::Response();
+    });
+    WorkStealingPool pool(2);
+    BulkConfig config;
+    config.url = server.url("/bulk");
+    config.batch_records = 100;
+    config.concurrency = 3;
+
+    std::string input = records(1050);
+    BulkReport report = run_bulk_upload(input.data(), input.size(), config, pool);
+
+    EXPECT_EQ(report.records, 1050u);
+    EXPECT_EQ(report.requests, 11u);
+    EXPECT_EQ(report.failed_requests, 0u);
+    EXPECT_EQ(report.bytes, input.size());
+    EXPECT_EQ(received_lines, 1050u);
+    EXPECT_EQ(content_type, "application/x-ndjson");
+    // Batches are streamed, not sent as complete bodies
+    EXPECT_EQ(chunked_requests, 11u);
+}
+
+// Test per-record mode sends one POST per record with bounded concurrency
+TEST_F(BulkUploadTest, PerRecordRespectsConcurrency) {
+    std::atomic<int> in_flight{0};
+    std::atomic<int> peak{0};
+    LocalHttpServer server([&](const LocalHttpServer::Request&) {
+        int now = ++in_flight;
+        int seen = peak.load();
+        while (now > seen && !peak.compare_exchange_weak(seen, now)) {
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        --in_flight;
+        return LocalHttpServer::Response();
+    });
+    WorkStealingPool pool(2);
+    BulkConfig config;
+    config.url = server.url("/posts");
+    config.mode = BulkMode::PER_RECORD;
+    config.concurrency = 2;
+
+    std::string input = records(20);
+    BulkReport report = run_bulk_upload(input.data(), input.size(), config, pool);
+
+    EXPECT_EQ(report.records, 20u);
+    EXPECT_EQ(report.requests, 20u);
+    EXPECT_EQ(server.request_count(), 20);
+    EXPECT_LE(peak.load(), 2);
+}
+
+// Test invalid and blank lines are skipped and reported by line number
+TEST_F(BulkUploadTest, SkipsInvalidLines) {
+    LocalHttpServer server([](const LocalHttpServer::Request&) {
+        return LocalHttpServer::Response();
+    });
+    WorkStealingPool pool(2);
+    BulkConfig config;
+    config.url = server.url("/bulk");
+
+    std::string input = "{\"a\":1}\r\n\n   \n{\"b\":\n[1,2]\n{\"c\":3}";
+    BulkReport report = run_bulk_upload(input.data(), input.size(), config, pool);
+
+    EXPECT_EQ(report.records, 3u);
+    EXPECT_EQ(report.invalid_records, 1u);
+    EXPECT_EQ(report.first_invalid_line, 4u);
+    EXPECT_EQ(report.requests, 1u);
+
+    std::ostringstream out;
+    print_bulk_report(report, out);
+    EXPECT_THAT(out.str(), ::testing::HasSubstr("1 invalid (first at line 4)"));
+}
+
+// Test failed requests count their records and errors
+TEST_F(BulkUploadTest, CountsFailedBatches) {
+    LocalHttpServer server([](const LocalHttpServer::Request&) {
+        LocalHttpServer::Response response;
+        response.status = 400;
+        return response;
+    });
+    WorkStealingPool pool(2);
+    BulkConfig config;
+    config.url = server.url("/bulk");
+    config.batch_records = 5;
+    config.max_retries = 0;
+
+    std::string input = records(12);
+    BulkReport report = run_bulk_upload(input.data(), input.size(), config, pool);
+
+    EXPECT_EQ(report.failed_requests, 3u);
+    EXPECT_EQ(report.failed_records, 12u);
+    EXPECT_EQ(report.errors.size(), 1u);
+
+    config.concurrency = 0;
+    EXPECT_THROW(run_bulk_upload(input.data(), input.size(), config, pool), std::invalid_argument);
+}
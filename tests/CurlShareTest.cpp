@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "AsyncHttpClient.h"
+#include "CurlShare.h"
+#include "HttpClient.h"
+#include "HttpUtils.h"
+#include "LocalHttpServer.h"
+#include <curl/curl.h>
+#include <atomic>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+class CurlShareTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // Initialize cURL globally for tests
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+
+        // Redirect cout/cerr to capture log output
+        old_cout = std::cout.rdbuf();
+        old_cerr = std::cerr.rdbuf();
+        std::cout.rdbuf(cout_buffer.rdbuf());
+        std::cerr.rdbuf(cerr_buffer.rdbuf());
+    }
+
+    void TearDown() override {
+        CurlShare::set_global(nullptr);
+
+        // Restore cout/cerr
+        std::cout.rdbuf(old_cout);
+        std::cerr.rdbuf(old_cerr);
+
+        // Cleanup cURL
+        curl_global_cleanup();
+    }
+
+    // Puts name -> 127.0.0.1 into the share's DNS cache through a handle of its own
+    static void seed_dns(const CurlShare& share, const std::string& name, const LocalHttpServer& server) {
+        std::string port = std::to_string(server.port());
+        std::string body;
+        CURL* curl = curl_easy_init();
+        share.attach(curl);
+        struct curl_slist* resolve = curl_slist_append(nullptr, (name + ":" + port + ":127.0.0.1").c_str());
+        curl_easy_setopt(curl, CURLOPT_RESOLVE, resolve);
+        curl_easy_setopt(curl, CURLOPT_URL, ("http://" + name + ":" + port + "/seed").c_str());
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &WriteCallback);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &body);
+        ASSERT_EQ(curl_easy_perform(curl), CURLE_OK);
+        curl_easy_cleanup(curl);
+        curl_slist_free_all(resolve);
+    }
+
+    std::stringstream cout_buffer;
+    std::stringstream cerr_buffer;
+    std::streambuf* old_cout;
+    std::streambuf* old_cerr;
+};
+
+// Test clients created after set_global() resolve names through the shared cache
+TEST_F(CurlShareTest, ClientsShareDnsCache) {
+    LocalHttpServer server([](const LocalHttpServer::Request& request) {
+        LocalHttpServer::Response response;
+        response.body = request.target;
+        return response;
+    });
+    auto share = std::make_shared<CurlShare>();
+    seed_dns(*share, "warm.test", server);
+    std::string url = "http://warm.test:" + std::to_string(server.port()) + "/shared";
+
+    // Without the share the name does not resolve
+    HttpClient isolated(5);
+    isolated.set_max_retries(0);
+    EXPECT_FALSE(isolated.make_request(url).success);
+
+    CurlShare::set_global(share);
+    HttpClient client(5);
+    HttpResponse response = client.make_request(url);
+    EXPECT_TRUE(response.success);
+    EXPECT_EQ(response.body, "/shared");
+
+    AsyncHttpClient async_client(5);
+    HttpResponse async_response = async_client.sync_wait(async_client.get(url));
+    EXPECT_TRUE(async_response.success);
+    EXPECT_EQ(async_response.body, "/shared");
+
+    // Clients keep the share they joined
+    CurlShare::set_global(nullptr);
+    EXPECT_TRUE(client.make_request(url).success);
+}
+
+// Test clients on many threads use one share at once
+TEST_F(CurlShareTest, ThreadsUseShareConcurrently) {
+    LocalHttpServer server([](const LocalHttpServer::Request&) { return LocalHttpServer::Response(); });
+    auto share = std::make_shared<CurlShare>();
+    seed_dns(*share, "threads.test", server);
+    CurlShare::set_global(share);
+    std::string url = "http://threads.test:" + std::to_string(server.port()) + "/";
+
+    std::atomic<int> successes{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 10; ++i) {
+                // A new client per call, as sampleapi does, so every lookup goes to the share
+                HttpClient client(5);
+                if (client.make_request(url).success) {
+                    ++successes;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(successes.load(), 40);
+}
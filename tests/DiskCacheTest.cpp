@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "DiskCache.h"
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+class DiskCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // Redirect cout/cerr to capture log output
+        old_cout = std::cout.rdbuf();
+        old_cerr = std::cerr.rdbuf();
+        std::cout.rdbuf(cout_buffer.rdbuf());
+        std::cerr.rdbuf(cerr_buffer.rdbuf());
+
+        char path[] = "/tmp/disk_cache_testXXXXXX";
+        ASSERT_NE(::mkdtemp(path), nullptr);
+        config.directory = path;
+        config.segment_bytes = 4096;
+        config.index_slots = 16;
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(config.directory);
+
+        // Restore cout/cerr
+        std::cout.rdbuf(old_cout);
+        std::cerr.rdbuf(old_cerr);
+    }
+
+    static CachedResponse entry(const std::string& body, int status = 200) {
+        CachedResponse result;
+        result.status_code = status;
+        result.body = body;
+        return result;
+    }
+
+    std::size_t segment_files() const {
+        std::size_t count = 0;
+        for (const auto& file : std::filesystem::directory_iterator(config.directory)) {
+            count += file.path().filename().string().rfind("segment-", 0) == 0;
+        }
+        return count;
+    }
+
+    DiskCacheConfig config;
+    std::stringstream cout_buffer;
+    std::stringstream cerr_buffer;
+    std::streambuf* old_cout;
+    std::streambuf* old_cerr;
+};
+
+// Test entries written by one instance are served by the next (warm restart)
+TEST_F(DiskCacheTest, SurvivesReopen) {
+    {
+        DiskCache cache(config);
+        cache.put("https://api.example.com/a", entry("alpha"));
+        cache.put("https://api.example.com/b", entry("", 204));
+    }
+
+    DiskCache reopened(config);
+    CachedResponse found;
+    ASSERT_TRUE(reopened.get("https://api.example.com/a", found));
+    EXPECT_EQ(found.body, "alpha");
+    EXPECT_EQ(found.status_code, 200);
+    ASSERT_TRUE(reopened.get("https://api.example.com/b", found));
+    EXPECT_EQ(found.status_code, 204);
+    EXPECT_TRUE(found.body.empty());
+    EXPECT_FALSE(reopened.get("https://api.example.com/c", found));
+    EXPECT_EQ(reopened.size(), 2u);
+}
+
+// Test overwrites, erases and expiry
+TEST_F(DiskCacheTest, OverwriteEraseAndExpiry) {
+    DiskCache cache(config);
+    cache.put("k", entry("first"));
+    cache.put("k", entry("second"));
+    CachedResponse found;
+    ASSERT_TRUE(cache.get("k", found));
+    EXPECT_EQ(found.body, "second");
+    EXPECT_EQ(cache.size(), 1u);
+
+    cache.erase("k");
+    EXPECT_FALSE(cache.get("k", found));
+    EXPECT_EQ(cache.size(), 0u);
+
+    CachedResponse stale = entry("stale");
+    stale.expires = std::chrono::system_clock::now() - std::chrono::milliseconds(1);
+    cache.put("old", stale);
+    EXPECT_FALSE(cache.get("old", found));
+
+    CachedResponse fresh = entry("fresh");
+    fresh.expires = std::chrono::system_clock::now() + std::chrono::hours(1);
+    cache.put("new", fresh);
+    ASSERT_TRUE(cache.get("new", found));
+    EXPECT_LE(found.expires - fresh.expires, std::chrono::milliseconds(1));
+}
+
+// Test the index grows past its initial size and compaction reclaims dead records
+TEST_F(DiskCacheTest, GrowsAndCompacts) {
+    DiskCache cache(config);
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 200; ++i) {
+            cache.put("key" + std::to_string(i), entry("value " + std::to_string(round * 1000 + i)));
+        }
+    }
+    EXPECT_EQ(cache.size(), 200u);
+
+    cache.compact();
+    std::uint64_t live = cache.disk_bytes();
+    for (int i = 0; i < 200; ++i) {
+        CachedResponse found;
+        ASSERT_TRUE(cache.get("key" + std::to_string(i), found)) << i;
+        EXPECT_EQ(found.body, "value " + std::to_string(2000 + i));
+    }
+    for (int i = 0; i < 100; ++i) {
+        cache.erase("key" + std::to_string(i));
+    }
+    cache.compact();
+    EXPECT_EQ(cache.size(), 100u);
+    EXPECT_LT(cache.disk_bytes(), live);
+    EXPECT_LE(segment_files(), (cache.disk_bytes() + config.segment_bytes - 1) / config.segment_bytes);
+}
+
+// Test the oldest entries are dropped to stay within max_bytes
+TEST_F(DiskCacheTest, EvictsOldestBeyondMaxBytes) {
+    config.max_bytes = 16 * 1024;
+    DiskCache cache(config);
+    std::string body(900, 'x');
+    for (int i = 0; i < 100; ++i) {
+        cache.put("key" + std::to_string(i), entry(body));
+    }
+    EXPECT_LE(cache.disk_bytes(), config.max_bytes);
+
+    CachedResponse found;
+    EXPECT_TRUE(cache.get("key99", found));
+    EXPECT_FALSE(cache.get("key0", found));
+
+    cache.put("too big", entry(std::string(config.max_bytes, 'y')));
+    EXPECT_FALSE(cache.get("too big", found));
+}
+
+// Test an unreadable index is discarded with its segments instead of failing
+TEST_F(DiskCacheTest, DiscardsCorruptIndex) {
+    {
+        DiskCache cache(config);
+        cache.put("k", entry("v"));
+    }
+    std::ofstream(config.directory + "/index", std::ios::trunc) << "garbage";
+
+    DiskCache cache(config);
+    CachedResponse found;
+    EXPECT_FALSE(cache.get("k", found));
+    EXPECT_EQ(segment_files(), 0u);
+    cache.put("k", entry("again"));
+    ASSERT_TRUE(cache.get("k", found));
+    EXPECT_EQ(found.body, "again");
+}
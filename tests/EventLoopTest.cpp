@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include "EventLoop.h"
+#include "AsyncHttpClient.h"
+#include "LocalHttpServer.h"
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <chrono>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+class EventLoopTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+        old_cout = std::cout.rdbuf();
+        std::cout.rdbuf(cout_buffer.rdbuf());
+    }
+
+    void TearDown() override {
+        std::cout.rdbuf(old_cout);
+        curl_global_cleanup();
+    }
+
+    std::stringstream cout_buffer;
+    std::streambuf* old_cout;
+};
+
+// Test timers fire in deadline order
+TEST_F(EventLoopTest, TimersFireInOrder) {
+    EpollEventLoop loop;
+    std::vector<int> fired;
+
+    loop.add_timer(std::chrono::milliseconds(30), [&] { fired.push_back(2); });
+    loop.add_timer(std::chrono::milliseconds(10), [&] { fired.push_back(1); });
+    loop.add_timer(std::chrono::milliseconds(50), [&] { fired.push_back(3); });
+
+    auto start = std::chrono::steady_clock::now();
+    while (fired.size() < 3 && std::chrono::steady_clock::now() - start < std::chrono::seconds(2)) {
+        loop.run_once(100);
+    }
+
+    EXPECT_EQ(fired, (std::vector<int>{1, 2, 3}));
+}
+
+// Test cancelled timers never fire
+TEST_F(EventLoopTest, CancelledTimerDoesNotFire) {
+    EpollEventLoop loop;
+    bool fired = false;
+
+    auto id = loop.add_timer(std::chrono::milliseconds(10), [&] { fired = true; });
+    loop.cancel_timer(id);
+    loop.run_once(50);
+
+    EXPECT_FALSE(fired);
+}
+
+// Test post() from another thread wakes a blocked run_once
+TEST_F(EventLoopTest, PostWakesLoopFromOtherThread) {
+    EpollEventLoop loop;
+    bool ran = false;
+
+    std::thread poster([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        loop.post([&] { ran = true; });
+    });
+    auto start = std::chrono::steady_clock::now();
+    loop.run_once(5000);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    poster.join();
+    if (!ran) {
+        loop.run_once(0); // woken by the eventfd before the callback was queued
+    }
+
+    EXPECT_TRUE(ran);
+    EXPECT_LT(elapsed, std::chrono::seconds(2));
+}
+
+// Test readiness callbacks for a watched descriptor
+TEST_F(EventLoopTest, WatchReportsReadable) {
+    EpollEventLoop loop;
+    int fds[2];
+    ASSERT_EQ(::pipe(fds), 0);
+    int seen = 0;
+
+    loop.watch(fds[0], EventLoop::READABLE, [&](int events) { seen = events; });
+    ASSERT_EQ(::write(fds[1], "x", 1), 1);
+    loop.run_once(100);
+    EXPECT_TRUE(seen & EventLoop::READABLE);
+
+    loop.unwatch(fds[0]);
+    EXPECT_EQ(loop.watched_count(), 0u);
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+// Test the loop can be nested in an external epoll instance, timers included
+TEST_F(EventLoopTest, NestsInExternalEpoll) {
+    EpollEventLoop loop;
+    int outer = ::epoll_create1(0);
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = loop.fd();
+    ASSERT_EQ(::epoll_ctl(outer, EPOLL_CTL_ADD, loop.fd(), &ev), 0);
+
+    bool fired = false;
+    loop.add_timer(std::chrono::milliseconds(20), [&] { fired = true; });
+
+    epoll_event out;
+    int ready = ::epoll_wait(outer, &out, 1, 2000);
+    ASSERT_EQ(ready, 1);
+    loop.run_once(0);
+    EXPECT_TRUE(fired);
+    ::close(outer);
+}
+
+// Test an AsyncHttpClient driven entirely by an external epoll loop
+TEST_F(EventLoopTest, ClientOnExternallyDrivenLoop) {
+    LocalHttpServer server([](const LocalHttpServer::Request& request) {
+        LocalHttpServer::Response response;
+        response.body = request.target;
+        return response;
+    });
+    EpollEventLoop loop;
+    AsyncHttpClient client(loop, 5);
+
+    int outer = ::epoll_create1(0);
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = loop.fd();
+    ASSERT_EQ(::epoll_ctl(outer, EPOLL_CTL_ADD, loop.fd(), &ev), 0);
+
+    HttpResponse result;
+    auto flow = [&]() -> Task<void> {
+        result = co_await client.get(server.url("/external"));
+    };
+    Task<void> task = flow();
+    task.start();
+
+    // The service's own loop: wait on its epoll set, then let the client run
+    auto start = std::chrono::steady_clock::now();
+    while (!task.done() && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+        epoll_event out;
+        ::epoll_wait(outer, &out, 1, 100);
+        loop.run_once(0);
+    }
+
+    EXPECT_TRUE(task.done());
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(result.body, "/external");
+    ::close(outer);
+}
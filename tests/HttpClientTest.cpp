@@ -1,9 +1,15 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include "HttpClient.h"
+#include "HttpClientImpl.h"
 #include "HttpUtils.h"
+#include "LocalHttpServer.h"
+#include "Metrics.h"
 #include <curl/curl.h>
+#include <atomic>
+#include <chrono>
 #include <stdexcept>
+#include <type_traits>
 
 class HttpClientTest : public ::testing::Test {
 protected:
@@ -248,4 +254,51 @@ TEST_F(HttpClientTest, AssignmentOperatorDeleted) {
     HttpClient client2;
     // This should not compile, but we can test that the assignment operator is deleted
     EXPECT_FALSE(std::is_copy_assignable<HttpClient>::value);
-} 
\ No newline at end of file
+}
+
+// Test the trusted client makes a single attempt without logging or metrics
+TEST_F(HttpClientTest, TrustedClientSkipsRetriesLogsAndMetrics) {
+    static_assert(std::is_empty_v<NoRetryPolicy> && std::is_empty_v<NoBackoffPolicy>);
+
+    LocalHttpServer server([](const LocalHttpServer::Request&) {
+        LocalHttpServer::Response response;
+        response.status = 503;
+        return response;
+    });
+    MetricsSnapshot before = HttpMetrics::snapshot();
+
+    TrustedHttpClient client(5);
+    HttpResponse response = client.make_request(server.url("/unavailable"));
+    EXPECT_FALSE(response.success);
+    EXPECT_EQ(response.status_code, 503);
+    EXPECT_EQ(response.error_message, "HTTP error: 503");
+    EXPECT_EQ(server.request_count(), 1u);
+    EXPECT_EQ(cout_buffer.str() + cerr_buffer.str(), "");
+    EXPECT_EQ(HttpMetrics::snapshot()[Metric::ATTEMPTS], before[Metric::ATTEMPTS]);
+
+    LocalHttpServer healthy([](const LocalHttpServer::Request&) { return LocalHttpServer::Response(); });
+    EXPECT_TRUE(client.make_request(healthy.url("/")).success);
+}
+
+// Test other policy combinations instantiate from HttpClientImpl.h
+TEST_F(HttpClientTest, MixedPoliciesRetryWithoutBackoff) {
+    using QuietRetryingClient = BasicHttpClient<DefaultRetryPolicy, NoBackoffPolicy, NullLogPolicy, MetricsSinkPolicy>;
+    std::atomic<int> calls{0};
+    LocalHttpServer server([&calls](const LocalHttpServer::Request&) {
+        LocalHttpServer::Response response;
+        response.status = ++calls < 3 ? 503 : 200;
+        return response;
+    });
+    MetricsSnapshot before = HttpMetrics::snapshot();
+
+    QuietRetryingClient client(5);
+    client.set_max_retries(2);
+    auto start = std::chrono::steady_clock::now();
+    HttpResponse response = client.make_request(server.url("/flaky"));
+    EXPECT_TRUE(response.success);
+    EXPECT_EQ(calls.load(), 3);
+    // ExponentialBackoffPolicy would wait at least 500ms before the first retry
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(400));
+    EXPECT_EQ(cout_buffer.str() + cerr_buffer.str(), "");
+    EXPECT_EQ(HttpMetrics::snapshot()[Metric::ATTEMPTS] - before[Metric::ATTEMPTS], 3u);
+}
@@ -0,0 +1,270 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "AsyncHttpClient.h"
+#include "HttpClient.h"
+#include "HttpTransport.h"
+#include "LoadGenerator.h"
+#include "LocalHttpServer.h"
+#include <curl/curl.h>
+#include <unistd.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+class HttpTransportTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // Initialize cURL globally for tests
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+
+        // Redirect cout/cerr to capture log output
+        old_cout = std::cout.rdbuf();
+        old_cerr = std::cerr.rdbuf();
+        std::cout.rdbuf(cout_buffer.rdbuf());
+        std::cerr.rdbuf(cerr_buffer.rdbuf());
+
+        char path[] = "/tmp/http_transport_testXXXXXX";
+        int fd = ::mkstemp(path);
+        ASSERT_GE(fd, 0);
+        ::close(fd);
+        recording_path = path;
+    }
+
+    void TearDown() override {
+        ::unlink(recording_path.c_str());
+
+        // Restore cout/cerr
+        std::cout.rdbuf(old_cout);
+        std::cerr.rdbuf(old_cerr);
+
+        // Cleanup cURL
+        curl_global_cleanup();
+    }
+
+    std::stringstream cout_buffer;
+    std::stringstream cerr_buffer;
+    std::streambuf* old_cout;
+    std::streambuf* old_cerr;
+    std::string recording_path;
+};
+
+// Test responses recorded from a live server are replayed without it
+TEST_F(HttpTransportTest, RecordThenReplayOffline) {
+    std::string get_url;
+    std::string post_url;
+    {
+        LocalHttpServer server([](const LocalHttpServer::Request& request) {
+            LocalHttpServer::Response response;
+            response.body = request.method + " " + request.target + " " + request.body;
+            response.status = request.target == "/missing" ? 404 : 200;
+            return response;
+        });
+        get_url = server.url("/items");
+        post_url = server.url("/missing");
+
+        auto recorder = std::make_shared<TransportRecorder>(recording_path);
+        HttpClient client(std::make_shared<RecordingTransport>(std::make_shared<CurlTransport>(5), recorder), 5);
+        client.set_max_retries(0);
+        EXPECT_TRUE(client.make_request(get_url).success);
+        EXPECT_FALSE(client.make_request(post_url, "POST", "{\"a\":1}").success);
+        EXPECT_EQ(recorder->count(), 2u);
+    }
+
+    auto replay = std::make_shared<ReplayTransport>(recording_path);
+    EXPECT_EQ(replay->size(), 2u);
+    HttpClient client(replay, 5);
+    client.set_max_retries(0);
+
+    HttpResponse found = client.make_request(get_url);
+    EXPECT_TRUE(found.success);
+    EXPECT_EQ(found.status_code, 200);
+    EXPECT_EQ(found.body, "GET /items ");
+
+    HttpResponse missing = client.make_request(post_url, "POST", "{\"a\":1}");
+    EXPECT_FALSE(missing.success);
+    EXPECT_EQ(missing.status_code, 404);
+    EXPECT_EQ(missing.body, "POST /missing {\"a\":1}");
+}
+
+// Test repeated requests replay the recorded sequence in order, including retries
+TEST_F(HttpTransportTest, ReplaysRetrySequenceInOrder) {
+    std::string url;
+    {
+        int calls = 0;
+        LocalHttpServer server([&calls](const LocalHttpServer::Request&) {
+            LocalHttpServer::Response response;
+            response.status = ++calls == 1 ? 503 : 200;
+            response.body = "call " + std::to_string(calls);
+            return response;
+        });
+        url = server.url("/flaky");
+
+        auto recorder = std::make_shared<TransportRecorder>(recording_path);
+        HttpClient client(std::make_shared<RecordingTransport>(std::make_shared<CurlTransport>(5), recorder), 5);
+        EXPECT_TRUE(client.make_request(url).success);
+        EXPECT_EQ(recorder->count(), 2u);
+    }
+
+    ReplayTransport replay(recording_path);
+    TransportResult first = replay.perform(url, "GET", "", {}, RequestOptions());
+    TransportResult second = replay.perform(url, "GET", "", {}, RequestOptions());
+    TransportResult wrapped = replay.perform(url, "GET", "", {}, RequestOptions());
+    EXPECT_EQ(first.status_code, 503);
+    EXPECT_EQ(second.status_code, 200);
+    EXPECT_EQ(second.body, "call 2");
+    EXPECT_EQ(wrapped.status_code, 503);
+}
+
+// Test response headers survive recording, e.g. pagination links
+TEST_F(HttpTransportTest, ReplaysResponseHeaders) {
+    std::string url;
+    {
+        LocalHttpServer server([](const LocalHttpServer::Request&) {
+            LocalHttpServer::Response response;
+            response.body = "[]";
+            response.headers.push_back("Link: <http://example.invalid/items?page=2>; rel=\"next\"");
+            return response;
+        });
+        url = server.url("/items");
+
+        auto recorder = std::make_shared<TransportRecorder>(recording_path);
+        RecordingTransport recording(std::make_shared<CurlTransport>(5), recorder);
+        recording.perform(url, "GET", "", {}, RequestOptions());
+    }
+
+    ReplayTransport replay(recording_path);
+    TransportResult result = replay.perform(url, "GET", "", {}, RequestOptions());
+    ASSERT_EQ(result.headers.count("link"), 1u);
+    EXPECT_EQ(result.headers["link"], "<http://example.invalid/items?page=2>; rel=\"next\"");
+}
+
+// Test unmatched requests fail with a descriptive error
+TEST_F(HttpTransportTest, UnrecordedRequestFails) {
+    { TransportRecorder recorder(recording_path); }
+    auto replay = std::make_shared<ReplayTransport>(recording_path);
+    HttpClient client(replay, 5);
+    client.set_max_retries(0);
+
+    HttpResponse response = client.make_request("http://example.invalid/none");
+    EXPECT_FALSE(response.success);
+    EXPECT_THAT(response.error_message, ::testing::HasSubstr("No recorded response for GET http://example.invalid/none"));
+}
+
+// Test original timing reproduces latency and still honours the deadline
+TEST_F(HttpTransportTest, OriginalTimingKeepsLatency) {
+    {
+        TransportRecorder recorder(recording_path);
+        TransportResult result;
+        result.status_code = 200;
+        result.body = "slow";
+        recorder.append("GET", "http://recorded/slow", "", result, std::chrono::milliseconds(80));
+    }
+
+    ReplayTransport fast(recording_path);
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(fast.perform("http://recorded/slow", "GET", "", {}, RequestOptions()).body, "slow");
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(40));
+
+    ReplayTransport paced(recording_path, ReplayTiming::ORIGINAL);
+    start = std::chrono::steady_clock::now();
+    EXPECT_EQ(paced.perform("http://recorded/slow", "GET", "", {}, RequestOptions()).body, "slow");
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(80));
+
+    RequestOptions options;
+    options.deadline = Deadline::after(std::chrono::milliseconds(20));
+    TransportResult timed_out = paced.perform("http://recorded/slow", "GET", "", {}, options);
+    EXPECT_EQ(timed_out.code, CURLE_OPERATION_TIMEDOUT);
+}
+
+// Test truncated and foreign files are handled
+TEST_F(HttpTransportTest, RejectsInvalidRecordings) {
+    {
+        TransportRecorder recorder(recording_path);
+        TransportResult result;
+        result.status_code = 200;
+        recorder.append("GET", "http://recorded/a", "", result, std::chrono::microseconds(0));
+        recorder.append("GET", "http://recorded/b", "", result, std::chrono::microseconds(0));
+    }
+    std::filesystem::resize_file(recording_path, std::filesystem::file_size(recording_path) - 3);
+    EXPECT_EQ(ReplayTransport(recording_path).size(), 1u);
+
+    std::ofstream(recording_path) << "not a recording";
+    EXPECT_THROW(ReplayTransport{recording_path}, std::runtime_error);
+    EXPECT_THROW(ReplayTransport("/nonexistent/recording"), std::runtime_error);
+}
+
+// Test the load generator can record a run and replay it with no server
+TEST_F(HttpTransportTest, LoadGeneratorReplay) {
+    LoadConfig config;
+    config.concurrency = 2;
+    config.duration = std::chrono::milliseconds(100);
+    {
+        LocalHttpServer server([](const LocalHttpServer::Request&) {
+            return LocalHttpServer::Response();
+        });
+        config.urls = {server.url("/a")};
+        config.record_path = recording_path;
+        LoadReport recorded = run_load(config);
+        EXPECT_GT(recorded.successes, 0u);
+        EXPECT_EQ(recorded.failures, 0u);
+    }
+
+    config.record_path.clear();
+    config.replay_path = recording_path;
+    LoadReport replayed = run_load(config);
+    EXPECT_GT(replayed.successes, 0u);
+    EXPECT_EQ(replayed.failures, 0u);
+
+    config.mode = LoadMode::OPEN_LOOP;
+    EXPECT_THROW(run_load(config), std::invalid_argument);
+}
+
+// Test requests reach a server on a Unix domain socket per request and per host
+TEST_F(HttpTransportTest, RoutesOverUnixSocket) {
+    auto handler = [](const LocalHttpServer::Request& request) {
+        LocalHttpServer::Response response;
+        response.body = request.headers.at("host") + request.target;
+        return response;
+    };
+    std::string socket_path = recording_path + ".sock";
+    LocalHttpServer file_server(handler, socket_path);
+    std::string abstract_name = "@http_transport_test_" + std::to_string(::getpid());
+    LocalHttpServer abstract_server(handler, abstract_name);
+    LocalHttpServer tcp_server(handler);
+
+    HttpClient client(5);
+    client.set_max_retries(0);
+    RequestOptions options;
+    options.unix_socket = socket_path;
+    HttpResponse response = client.make_request("http://sidecar/posts/1", "GET", "", {}, options);
+    EXPECT_TRUE(response.success) << response.error_message;
+    EXPECT_EQ(response.body, "sidecar/posts/1");
+
+    // Per-host mapping; other hosts still use TCP
+    client.set_unix_socket("http://mesh:15001", abstract_name);
+    response = client.make_request("http://mesh:15001/posts?page=2");
+    EXPECT_TRUE(response.success) << response.error_message;
+    EXPECT_EQ(response.body, "mesh:15001/posts?page=2");
+    EXPECT_TRUE(client.make_request(tcp_server.url("/tcp")).success);
+    EXPECT_EQ(abstract_server.request_count(), 1);
+    EXPECT_EQ(tcp_server.request_count(), 1);
+
+    // The request's own socket wins over the mapping
+    response = client.make_request("http://mesh:15001/override", "GET", "", {}, options);
+    EXPECT_EQ(response.body, "mesh:15001/override");
+    EXPECT_EQ(file_server.request_count(), 2);
+
+    AsyncHttpClient async_client(5);
+    async_client.set_unix_socket("http://mesh:15001", abstract_name);
+    HttpResponse async_response = async_client.sync_wait(async_client.get("http://mesh:15001/async"));
+    EXPECT_TRUE(async_response.success) << async_response.error_message;
+    EXPECT_EQ(async_response.body, "mesh:15001/async");
+
+    // A missing socket fails like a refused connection
+    client.set_unix_socket("http://mesh:15001", socket_path + ".missing");
+    response = client.make_request("http://mesh:15001/gone");
+    EXPECT_FALSE(response.success);
+    EXPECT_EQ(response.status_code, 0);
+}
@@ -56,6 +56,19 @@ TEST_F(HttpUtilsTest, LogWarningTest) {
     EXPECT_THAT(output, ::testing::HasSubstr("WARNING:"));
 }
 
+// Test log level filtering
+TEST_F(HttpUtilsTest, LogLevelFiltersMessages) {
+    set_log_level(LogLevel::ERROR);
+    log_info("hidden info");
+    log_warning("hidden warning");
+    log_error("shown error");
+    set_log_level(LogLevel::INFO);
+    
+    EXPECT_EQ(get_log_level(), LogLevel::INFO);
+    EXPECT_THAT(cout_buffer.str(), ::testing::Not(::testing::HasSubstr("hidden")));
+    EXPECT_THAT(cerr_buffer.str(), ::testing::HasSubstr("ERROR: shown error"));
+}
+
 // Test exponential backoff
 TEST_F(HttpUtilsTest, ExponentialBackoffTest) {
     auto start = std::chrono::high_resolution_clock::now();
@@ -0,0 +1,217 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "IntStream.h"
+#include "WorkStealingPool.h"
+#include <unistd.h>
+#include <cstdio>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+
+class IntStreamTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        set_simd_level(detected_simd_level());
+    }
+
+    // Output of the original boosttest pipeline
+    static std::string reference(const std::string& input) {
+        std::istringstream in(input);
+        std::ostringstream out;
+        for (std::istream_iterator<int> it(in), end; it != end; ++it) {
+            out << static_cast<std::int32_t>(static_cast<std::uint32_t>(*it) * 3u) << " ";
+        }
+        return out.str();
+    }
+
+    static std::string read_all(FILE* file) {
+        std::string text;
+        std::rewind(file);
+        char chunk[4096];
+        std::size_t bytes;
+        while ((bytes = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+            text.append(chunk, bytes);
+        }
+        return text;
+    }
+
+    // Runs transform_int_buffer over the whole input, writing to a temporary file
+    static std::string transform(const std::string& input) {
+        FILE* file = std::tmpfile();
+        {
+            OutputBuffer out(fileno(file), 256);
+            std::size_t consumed = 0;
+            transform_int_buffer(input.data(), input.size(), true, 3, out, consumed);
+        }
+        std::string text = read_all(file);
+        std::fclose(file);
+        return text;
+    }
+
+    static std::vector<SimdLevel> levels() {
+        std::vector<SimdLevel> result;
+        for (int level = 0; level <= static_cast<int>(detected_simd_level()); ++level) {
+            result.push_back(static_cast<SimdLevel>(level));
+        }
+        return result;
+    }
+};
+
+// Test token rules match std::istream_iterator<int>
+TEST_F(IntStreamTest, MatchesIstreamSemantics) {
+    const char* inputs[] = {
+        "1 2 3",
+        "  \t\n-7\r\n+8\v\f9  ",
+        "12-3+4",
+        "0000000000042 -0",
+        "2147483647 -2147483648 715827883",
+        "5 2147483648 6",
+        "5 -2147483649 6",
+        "12abc 7",
+        "0x10",
+        "4 - 5",
+        "+-5",
+        "99999999999999999999 1",
+        "",
+        "-",
+    };
+    for (SimdLevel level : levels()) {
+        set_simd_level(level);
+        for (const char* input : inputs) {
+            EXPECT_EQ(transform(input), reference(input)) << "input: \"" << input << "\" level " << static_cast<int>(level);
+        }
+    }
+}
+
+// Test random inputs longer than a block agree across all code paths
+TEST_F(IntStreamTest, RandomInputsMatchReference) {
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<std::int64_t> value(-3000000000LL, 3000000000LL);
+    std::uniform_int_distribution<int> small(0, 7);
+    const char* separators[] = {" ", "\n", "\t", "  ", "\r\n", " \f "};
+
+    for (int round = 0; round < 20; ++round) {
+        std::string input;
+        for (int i = 0; i < 2000; ++i) {
+            int kind = small(rng);
+            if (kind == 0) {
+                input += std::string(static_cast<std::size_t>(small(rng)), '0');
+            }
+            input += std::to_string(kind == 1 ? value(rng) % 1000 : value(rng) / 2);
+            input += separators[small(rng) % 6];
+        }
+        if (round % 4 == 3) {
+            input += "oops 1 2 3"; // stops early
+        }
+        std::string expected = reference(input);
+        for (SimdLevel level : levels()) {
+            set_simd_level(level);
+            ASSERT_EQ(transform(input), expected) << "round " << round << " level " << static_cast<int>(level);
+        }
+    }
+}
+
+// Test a token touching the end of a chunk is left for the next one
+TEST_F(IntStreamTest, IncompleteTokenIsCarried) {
+    std::string chunk = "10 20 -3";
+    std::int32_t values[8];
+
+    IntParseResult partial = parse_ints(chunk.data(), chunk.data() + chunk.size(), false, values, 8);
+    EXPECT_EQ(partial.count, 2u);
+    EXPECT_FALSE(partial.invalid);
+    EXPECT_EQ(std::string(partial.next), "-3");
+
+    IntParseResult final_chunk = parse_ints(chunk.data(), chunk.data() + chunk.size(), true, values, 8);
+    EXPECT_EQ(final_chunk.count, 3u);
+    EXPECT_EQ(values[2], -3);
+
+    IntParseResult capped = parse_ints(chunk.data(), chunk.data() + chunk.size(), true, values, 1);
+    EXPECT_EQ(capped.count, 1u);
+    EXPECT_EQ(values[0], 10);
+}
+
+// Test scaling wraps like 32-bit hardware multiplication
+TEST_F(IntStreamTest, ScaleWrapsAndFormats) {
+    for (SimdLevel level : levels()) {
+        set_simd_level(level);
+        std::vector<std::int32_t> values = {0, 1, -1, 715827882, 715827883, -2147483647 - 1, 7, 8, 9, 10, 11};
+        scale_ints(values.data(), values.size(), 3);
+        char text[12 * 11];
+        std::string formatted(text, format_ints(values.data(), values.size(), text));
+        EXPECT_EQ(formatted, "0 3 -3 2147483646 -2147483647 -2147483648 21 24 27 30 33 ");
+    }
+}
+
+// Test the streaming path (pipe) and the mapped path (file) produce the same output
+TEST_F(IntStreamTest, PipeAndMappedFileAgree) {
+    std::string input;
+    for (int i = 0; i < 300000; ++i) {
+        input += std::to_string(i * 7919 % 100003 - 50000) + (i % 10 ? " " : "\n");
+    }
+    std::string expected = reference(input);
+
+    FILE* source = std::tmpfile();
+    std::fwrite(input.data(), 1, input.size(), source);
+    std::fflush(source);
+    std::rewind(source);
+    FILE* mapped_out = std::tmpfile();
+    EXPECT_TRUE(transform_int_stream(fileno(source), fileno(mapped_out), 3));
+    EXPECT_EQ(read_all(mapped_out), expected);
+
+    int pipe_fds[2];
+    ASSERT_EQ(::pipe(pipe_fds), 0);
+    std::thread writer([&] {
+        // Small writes so tokens straddle read boundaries
+        for (std::size_t offset = 0; offset < input.size(); offset += 4093) {
+            std::size_t length = std::min<std::size_t>(4093, input.size() - offset);
+            ssize_t written = ::write(pipe_fds[1], input.data() + offset, length);
+            (void)written;
+        }
+        ::close(pipe_fds[1]);
+    });
+    FILE* piped_out = std::tmpfile();
+    EXPECT_TRUE(transform_int_stream(pipe_fds[0], fileno(piped_out), 3));
+    writer.join();
+    ::close(pipe_fds[0]);
+    EXPECT_EQ(read_all(piped_out), expected);
+
+    std::fclose(source);
+    std::fclose(mapped_out);
+    std::fclose(piped_out);
+}
+
+// Test parallel chunks are reassembled in input order and stop at the first invalid token
+TEST_F(IntStreamTest, ParallelMatchesSequential) {
+    std::string input;
+    for (int i = 0; i < 50000; ++i) {
+        input += std::to_string(i * 31 - 700000) + (i % 7 ? " " : "\n");
+    }
+    std::string with_error = input + "bad " + input;
+    WorkStealingPool pool(4);
+
+    for (const std::string* text : {&input, &with_error}) {
+        FILE* out = std::tmpfile();
+        bool complete = transform_int_buffer_parallel(text->data(), text->size(), 3, fileno(out), pool, 1000);
+        EXPECT_EQ(complete, text == &input);
+        EXPECT_EQ(read_all(out), reference(*text));
+        std::fclose(out);
+    }
+}
+
+// Test MappedFile exposes file contents and rejects missing files
+TEST_F(IntStreamTest, MappedFileReadsContents) {
+    char path[] = "/tmp/int_stream_testXXXXXX";
+    int fd = ::mkstemp(path);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(::write(fd, "1 2 3", 5), 5);
+    ::close(fd);
+
+    {
+        MappedFile file(path);
+        EXPECT_EQ(std::string(file.data(), file.size()), "1 2 3");
+    }
+    ::unlink(path);
+    EXPECT_THROW(MappedFile("/nonexistent/int_stream"), std::runtime_error);
+}
@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "JsonOnDemand.h"
+#include <nlohmann/json.hpp>
+#include <random>
+#include <string>
+#include <vector>
+
+class JsonOnDemandTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        set_simd_level(detected_simd_level());
+    }
+
+    // Every level this CPU supports, so each classifier is checked
+    static std::vector<SimdLevel> levels() {
+        std::vector<SimdLevel> result;
+        for (int level = 0; level <= static_cast<int>(detected_simd_level()); ++level) {
+            result.push_back(static_cast<SimdLevel>(level));
+        }
+        return result;
+    }
+
+    // Checks an on-demand value against the nlohmann tree of the same text
+    static void expect_same(const JsonValue& value, const nlohmann::json& expected) {
+        switch (expected.type()) {
+        case nlohmann::json::value_t::object: {
+            ASSERT_EQ(value.type(), JsonType::OBJECT);
+            std::size_t count = 0;
+            for (const JsonField& field : value.fields()) {
+                ASSERT_TRUE(expected.contains(field.key())) << field.key();
+                expect_same(field.value(), expected.at(field.key()));
+                ++count;
+            }
+            EXPECT_EQ(count, expected.size());
+            break;
+        }
+        case nlohmann::json::value_t::array: {
+            ASSERT_EQ(value.type(), JsonType::ARRAY);
+            std::size_t i = 0;
+            for (JsonValue element : value.elements()) {
+                ASSERT_LT(i, expected.size());
+                expect_same(element, expected[i++]);
+            }
+            EXPECT_EQ(i, expected.size());
+            break;
+        }
+        case nlohmann::json::value_t::string:
+            EXPECT_EQ(value.get_string(), expected.get<std::string>());
+            break;
+        case nlohmann::json::value_t::number_integer:
+        case nlohmann::json::value_t::number_unsigned:
+            EXPECT_EQ(value.get_int64(), expected.get<std::int64_t>());
+            break;
+        case nlohmann::json::value_t::number_float:
+            EXPECT_DOUBLE_EQ(value.get_double(), expected.get<double>());
+            break;
+        case nlohmann::json::value_t::boolean:
+            EXPECT_EQ(value.get_bool(), expected.get<bool>());
+            break;
+        default:
+            EXPECT_TRUE(value.is_null());
+            break;
+        }
+    }
+};
+
+// Test field access, escapes and raw text with every classifier
+TEST_F(JsonOnDemandTest, ReadsFieldsAtEverySimdLevel) {
+    const std::string text =
+        " {\"id\": 101, \"title\" : \"a \\\"quoted\\\" \\\\ title\\n\", \"score\":-2.5e1,\n"
+        "  \"tags\": [\"x\", {\"deep\": [true, false, null]}, []], \"empty\": {},\n"
+        "  \"snow\\u0041\": \"\\u00e9\\u2603\\ud83d\\ude00\", \"braces\": \"{[,:]}\", \"last\": 0} ";
+    for (SimdLevel level : levels()) {
+        set_simd_level(level);
+        JsonDocument document(text);
+        JsonValue root = document.root();
+
+        EXPECT_EQ(root["id"].get_int64(), 101);
+        EXPECT_EQ(root["title"].get_string(), "a \"quoted\" \\ title\n");
+        EXPECT_EQ(root["title"].raw(), "\"a \\\"quoted\\\" \\\\ title\\n\"");
+        EXPECT_DOUBLE_EQ(root["score"].get_double(), -25.0);
+        EXPECT_THROW(root["score"].get_int64(), JsonError);
+        EXPECT_EQ(root["tags"].size(), 3u);
+        EXPECT_EQ(root["tags"].raw(), "[\"x\", {\"deep\": [true, false, null]}, []]");
+        EXPECT_EQ(root["empty"].size(), 0u);
+        EXPECT_EQ(root["snowA"].get_string(), "\xc3\xa9\xe2\x98\x83\xf0\x9f\x98\x80");
+        EXPECT_EQ(root["braces"].get_string(), "{[,:]}");
+        EXPECT_EQ(root["last"].get_int64(), 0);
+
+        std::vector<JsonValue> tags(root["tags"].elements().begin(), root["tags"].elements().end());
+        ASSERT_EQ(tags.size(), 3u);
+        JsonValue deep = tags[1]["deep"];
+        std::vector<JsonType> types;
+        for (JsonValue element : deep.elements()) {
+            types.push_back(element.type());
+        }
+        EXPECT_THAT(types, ::testing::ElementsAre(JsonType::BOOLEAN, JsonType::BOOLEAN, JsonType::NUL));
+
+        JsonValue missing;
+        EXPECT_FALSE(root.find("userId", missing));
+        EXPECT_THROW(root["userId"], JsonError);
+        EXPECT_THROW(root["id"].get_string(), JsonError);
+        EXPECT_THROW(root["title"].elements(), JsonError);
+    }
+}
+
+// Test backslash runs of every length, ending at every offset of a block
+TEST_F(JsonOnDemandTest, HandlesBackslashRunsAcrossBlocks) {
+    for (SimdLevel level : levels()) {
+        set_simd_level(level);
+        for (std::size_t padding = 0; padding < 64; padding += 7) {
+            for (std::size_t run = 0; run < 70; ++run) {
+                // run backslashes then a quote: even runs end the string, odd runs escape the quote
+                std::string value(padding, 'p');
+                value += std::string(run, '\\');
+                value += "\"q";
+                std::string text = nlohmann::json::array({value, "after\\", 7}).dump();
+                JsonDocument document(text);
+                std::vector<JsonValue> elements(document.root().elements().begin(),
+                                                document.root().elements().end());
+                ASSERT_EQ(elements.size(), 3u) << text;
+                EXPECT_EQ(elements[0].get_string(), value);
+                EXPECT_EQ(elements[1].get_string(), "after\\");
+                EXPECT_EQ(elements[2].get_int64(), 7);
+            }
+        }
+    }
+}
+
+// Test a megabyte-sized list response matches nlohmann value for value
+TEST_F(JsonOnDemandTest, MatchesNlohmannOnLargeList) {
+    std::mt19937 random(42);
+    const std::vector<std::string> pieces = {"a", "b", "xyz", " ", "\"", "\\", "/", "{", "}", "[", "]",
+                                             ":", ",", "\t", "\n", "\x01", "\xc3\xa9", "\xe2\x98\x83"};
+    auto random_string = [&]() {
+        std::string result;
+        for (std::size_t i = random() % 40; i > 0; --i) {
+            result += pieces[random() % pieces.size()];
+        }
+        return result;
+    };
+
+    nlohmann::json list = nlohmann::json::array();
+    for (int i = 0; i < 6000; ++i) {
+        list.push_back({{"id", i},
+                        {"userId", static_cast<std::int64_t>(random()) - 2147483648LL},
+                        {"title", random_string()},
+                        {"body", random_string() + random_string()},
+                        {"ratio", static_cast<double>(random()) / 7.0},
+                        {"done", random() % 2 == 0},
+                        {"owner", nullptr},
+                        {"tags", {random_string(), random_string()}}});
+    }
+    std::string compact = list.dump();
+    std::string pretty = list.dump(2);
+    ASSERT_GT(compact.size(), 1024u * 1024);
+
+    for (SimdLevel level : levels()) {
+        set_simd_level(level);
+        JsonDocument document;
+        document.parse(compact);
+        expect_same(document.root(), list);
+        document.parse(pretty);
+        expect_same(document.root(), list);
+    }
+}
+
+// Test structural errors fail parse() and value errors fail on access
+TEST_F(JsonOnDemandTest, RejectsMalformedJson) {
+    for (const char* text : {"", "   ", "{\"a\": \"open", "[1, 2", "[1, 2}}", "{\"a\": 1}]", "1 2", "{} {}"}) {
+        JsonDocument document;
+        EXPECT_THROW(document.parse(text), JsonError) << text;
+        EXPECT_THROW(document.root(), JsonError) << text;
+    }
+
+    auto elements_of = [](const JsonDocument& document) {
+        std::size_t count = 0;
+        for (JsonValue element : document.root().elements()) {
+            element.type();
+            ++count;
+        }
+        return count;
+    };
+    EXPECT_THROW(elements_of(JsonDocument("[1, ]")), JsonError);
+    EXPECT_THROW(elements_of(JsonDocument("[1 2]")), JsonError);
+    EXPECT_THROW(elements_of(JsonDocument("[, 1]")), JsonError);
+    EXPECT_EQ(elements_of(JsonDocument("[1, [2, 3], {\"a\": [4]}]")), 3u);
+
+    EXPECT_THROW(JsonDocument("{\"a\" 1}").root().size(), JsonError);
+    EXPECT_THROW(JsonDocument("{\"a\": }").root().size(), JsonError);
+    EXPECT_THROW(JsonDocument("{1: 2}").root().size(), JsonError);
+    EXPECT_THROW(JsonDocument("01").root().get_int64(), JsonError);
+    EXPECT_THROW(JsonDocument("1.").root().get_double(), JsonError);
+    EXPECT_THROW(JsonDocument("99999999999999999999").root().get_int64(), JsonError);
+    EXPECT_THROW(JsonDocument("tru").root().get_bool(), JsonError);
+    EXPECT_THROW(JsonDocument("nul").root().is_null(), JsonError);
+    EXPECT_THROW(JsonDocument("\"\\x\"").root().get_string(), JsonError);
+    EXPECT_THROW(JsonDocument("\"\\ud83d\"").root().get_string(), JsonError);
+    EXPECT_THROW(JsonDocument("@").root().type(), JsonError);
+    EXPECT_THROW(JsonValue().type(), JsonError);
+}
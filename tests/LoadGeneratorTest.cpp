@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "LoadGenerator.h"
+#include "LocalHttpServer.h"
+#include <curl/curl.h>
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+
+class LoadGeneratorTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // Initialize cURL globally for tests
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+
+        // Redirect cout/cerr to capture log output
+        old_cout = std::cout.rdbuf();
+        old_cerr = std::cerr.rdbuf();
+        std::cout.rdbuf(cout_buffer.rdbuf());
+        std::cerr.rdbuf(cerr_buffer.rdbuf());
+    }
+
+    void TearDown() override {
+        // Restore cout/cerr
+        std::cout.rdbuf(old_cout);
+        std::cerr.rdbuf(old_cerr);
+
+        // Cleanup cURL
+        curl_global_cleanup();
+    }
+
+    std::stringstream cout_buffer;
+    std::stringstream cerr_buffer;
+    std::streambuf* old_cout;
+    std::streambuf* old_cerr;
+};
+
+using std::chrono::microseconds;
+
+// Test small values are exact and percentiles follow rank order
+TEST_F(LoadGeneratorTest, HistogramPercentiles) {
+    LatencyHistogram histogram;
+    for (int i = 1; i <= 100; ++i) {
+        histogram.record(microseconds(i));
+    }
+
+    EXPECT_EQ(histogram.count(), 100u);
+    EXPECT_EQ(histogram.min(), microseconds(1));
+    EXPECT_EQ(histogram.max(), microseconds(100));
+    EXPECT_EQ(histogram.percentile(50), microseconds(50));
+    EXPECT_EQ(histogram.percentile(99), microseconds(99));
+    EXPECT_EQ(histogram.percentile(100), microseconds(100));
+    EXPECT_EQ(histogram.mean(), microseconds(50));
+}
+
+// Test large values stay within the bucket error bound and merge adds samples
+TEST_F(LoadGeneratorTest, HistogramLargeValuesAndMerge) {
+    LatencyHistogram first;
+    LatencyHistogram second;
+    first.record(microseconds(1000));
+    second.record(microseconds(2500000));
+    second.record(microseconds(-5));
+
+    first.merge(second);
+
+    EXPECT_EQ(first.count(), 3u);
+    EXPECT_EQ(first.min(), microseconds(0));
+    EXPECT_EQ(first.max(), microseconds(2500000));
+    auto median = first.percentile(50).count();
+    EXPECT_GE(median, 1000);
+    EXPECT_LE(median, 1016);
+    EXPECT_EQ(first.percentile(100), microseconds(2500000));
+    EXPECT_EQ(LatencyHistogram().percentile(99), microseconds(0));
+}
+
+// Test closed loop keeps every worker busy for the duration
+TEST_F(LoadGeneratorTest, ClosedLoopCountsResponses) {
+    LocalHttpServer server([](const LocalHttpServer::Request&) {
+        LocalHttpServer::Response response;
+        response.delay_ms = 10;
+        return response;
+    });
+    LoadConfig config;
+    config.urls = {server.url("/a"), server.url("/b")};
+    config.concurrency = 2;
+    config.duration = std::chrono::milliseconds(300);
+
+    LoadReport report = run_load(config);
+
+    EXPECT_GT(report.successes, 10u);
+    EXPECT_EQ(report.failures, 0u);
+    EXPECT_EQ(report.latency.count(), report.successes);
+    EXPECT_GE(report.latency.percentile(50), microseconds(10000));
+    EXPECT_EQ(server.request_count(), report.successes);
+    EXPECT_EQ(report.allocations.requests, report.successes);
+}
+
+// Test open loop offers the configured rate and measures from the intended send time
+TEST_F(LoadGeneratorTest, OpenLoopKeepsSchedule) {
+    LocalHttpServer server([](const LocalHttpServer::Request&) {
+        LocalHttpServer::Response response;
+        response.delay_ms = 50;
+        return response;
+    });
+    LoadConfig config;
+    config.urls = {server.url("/")};
+    config.mode = LoadMode::OPEN_LOOP;
+    config.rate = 200;
+    config.duration = std::chrono::milliseconds(500);
+
+    auto start = std::chrono::steady_clock::now();
+    LoadReport report = run_load(config);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    // Slow responses do not throttle the arrival rate
+    EXPECT_EQ(report.successes, 100u);
+    EXPECT_LT(elapsed, std::chrono::milliseconds(1500));
+    EXPECT_GE(report.latency.percentile(50), microseconds(50000));
+}
+
+// Test failures are grouped by error message and printed
+TEST_F(LoadGeneratorTest, ReportsErrors) {
+    LocalHttpServer server([](const LocalHttpServer::Request&) {
+        LocalHttpServer::Response response;
+        response.status = 503;
+        return response;
+    });
+    LoadConfig config;
+    config.urls = {server.url("/")};
+    config.mode = LoadMode::OPEN_LOOP;
+    config.rate = 100;
+    config.duration = std::chrono::milliseconds(100);
+
+    LoadReport report = run_load(config);
+    std::ostringstream out;
+    print_report(config, report, out);
+
+    EXPECT_EQ(report.successes, 0u);
+    EXPECT_EQ(report.failures, 10u);
+    EXPECT_EQ(report.errors["HTTP 503"], 10u);
+    EXPECT_THAT(out.str(), ::testing::HasSubstr("open loop, 100.00 req/s"));
+    EXPECT_THAT(out.str(), ::testing::HasSubstr("HTTP 503 x10"));
+    EXPECT_THAT(out.str(), ::testing::HasSubstr("p99"));
+}
+
+// Test invalid configurations are rejected
+TEST_F(LoadGeneratorTest, RejectsInvalidConfig) {
+    LoadConfig config;
+    EXPECT_THROW(run_load(config), std::invalid_argument);
+
+    config.urls = {"http://127.0.0.1:1/"};
+    config.concurrency = 0;
+    EXPECT_THROW(run_load(config), std::invalid_argument);
+}
@@ -0,0 +1,324 @@
+#ifndef LOCAL_HTTP_SERVER_H
+#define LOCAL_HTTP_SERVER_H
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstddef>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Minimal HTTP/1.1 server on 127.0.0.1 for offline, deterministic tests
+ *
+ * Each connection is served on its own thread with keep-alive; the handler
+ * may be called concurrently. Supports Content-Length and chunked request bodies.
+ */
+class LocalHttpServer {
+public:
+    struct Request {
+        std::string method;
+        std::string target;                         ///< Path and query, e.g. "/posts?page=2"
+        std::map<std::string, std::string> headers; ///< Lower-cased header names
+        std::string body;
+    };
+
+    struct Response {
+        int status = 200;
+        std::string body;
+        std::vector<std::string> headers; ///< Extra "Name: value" headers
+        int delay_ms = 0;                 ///< Delay before the response is written
+    };
+
+    using Handler = std::function<Response(const Request&)>;
+
+    explicit LocalHttpServer(Handler handler) : handler_(std::move(handler)) {
+        listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (listen_fd_ < 0) {
+            throw std::runtime_error("LocalHttpServer: socket() failed");
+        }
+        int enable = 1;
+        ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+            ::listen(listen_fd_, 512) != 0) {
+            ::close(listen_fd_);
+            throw std::runtime_error("LocalHttpServer: bind/listen failed");
+        }
+        socklen_t len = sizeof(addr);
+        ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len);
+        port_ = ntohs(addr.sin_port);
+
+        accept_thread_ = std::thread([this] { accept_loop(); });
+    }
+
+    /**
+     * @brief Listens on a Unix domain socket instead (path, or "@name" for the abstract namespace)
+     */
+    LocalHttpServer(Handler handler, const std::string& unix_socket)
+        : handler_(std::move(handler)), unix_socket_(unix_socket) {
+        sockaddr_un addr{};
+        if (unix_socket.empty() || unix_socket.size() >= sizeof(addr.sun_path)) {
+            throw std::runtime_error("LocalHttpServer: bad socket path");
+        }
+        listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_fd_ < 0) {
+            throw std::runtime_error("LocalHttpServer: socket() failed");
+        }
+        addr.sun_family = AF_UNIX;
+        std::copy(unix_socket.begin(), unix_socket.end(), addr.sun_path);
+        socklen_t len = sizeof(addr);
+        if (unix_socket[0] == '@') {
+            addr.sun_path[0] = '\0'; // abstract: the name is exactly the bytes after the NUL
+            len = static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + unix_socket.size());
+        } else {
+            ::unlink(unix_socket.c_str());
+        }
+        if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), len) != 0 || ::listen(listen_fd_, 512) != 0) {
+            ::close(listen_fd_);
+            throw std::runtime_error("LocalHttpServer: bind/listen failed");
+        }
+        accept_thread_ = std::thread([this] { accept_loop(); });
+    }
+
+    ~LocalHttpServer() {
+        stopping_ = true;
+        accept_thread_.join();
+        std::vector<std::thread> workers;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            workers.swap(workers_);
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        ::close(listen_fd_);
+        if (!unix_socket_.empty() && unix_socket_[0] != '@') {
+            ::unlink(unix_socket_.c_str());
+        }
+    }
+
+    int port() const { return port_; }
+
+    std::string url(const std::string& path = "/") const {
+        return "http://127.0.0.1:" + std::to_string(port_) + path;
+    }
+
+    int request_count() const { return request_count_.load(); }
+
+    int connection_count() const { return connection_count_.load(); }
+
+    LocalHttpServer(const LocalHttpServer&) = delete;
+    LocalHttpServer& operator=(const LocalHttpServer&) = delete;
+
+private:
+    Handler handler_;
+    std::string unix_socket_;
+    int listen_fd_ = -1;
+    int port_ = 0;
+    std::atomic<bool> stopping_{false};
+    std::atomic<int> request_count_{0};
+    std::atomic<int> connection_count_{0};
+    std::thread accept_thread_;
+    std::mutex mutex_;
+    std::vector<std::thread> workers_;
+
+    bool wait_readable(int fd) {
+        while (!stopping_) {
+            pollfd pfd{fd, POLLIN, 0};
+            int ready = ::poll(&pfd, 1, 50);
+            if (ready > 0) {
+                return true;
+            }
+            if (ready < 0) {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    void accept_loop() {
+        while (wait_readable(listen_fd_)) {
+            int fd = ::accept(listen_fd_, nullptr, nullptr);
+            if (fd < 0) {
+                continue;
+            }
+            ++connection_count_;
+            std::lock_guard<std::mutex> lock(mutex_);
+            workers_.emplace_back([this, fd] {
+                serve_connection(fd);
+                ::close(fd);
+            });
+        }
+    }
+
+    // Reads until `buffer` holds at least `size` bytes
+    bool fill(int fd, std::string& buffer, size_t size) {
+        char chunk[16384];
+        while (buffer.size() < size) {
+            if (!wait_readable(fd)) {
+                return false;
+            }
+            ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+            if (n <= 0) {
+                return false;
+            }
+            buffer.append(chunk, static_cast<size_t>(n));
+        }
+        return true;
+    }
+
+    // Reads until `delimiter` appears at or after `from`; returns its offset
+    bool fill_until(int fd, std::string& buffer, const std::string& delimiter, size_t from, size_t& at) {
+        while ((at = buffer.find(delimiter, from)) == std::string::npos) {
+            if (!fill(fd, buffer, buffer.size() + 1)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool read_request(int fd, std::string& buffer, Request& request) {
+        size_t header_end = 0;
+        if (!fill_until(fd, buffer, "\r\n\r\n", 0, header_end)) {
+            return false;
+        }
+        std::string head = buffer.substr(0, header_end);
+        buffer.erase(0, header_end + 4);
+
+        size_t line_end = head.find("\r\n");
+        std::string request_line = head.substr(0, line_end);
+        size_t sp1 = request_line.find(' ');
+        size_t sp2 = request_line.find(' ', sp1 + 1);
+        request.method = request_line.substr(0, sp1);
+        request.target = request_line.substr(sp1 + 1, sp2 - sp1 - 1);
+
+        size_t pos = (line_end == std::string::npos) ? head.size() : line_end + 2;
+        while (pos < head.size()) {
+            size_t next = head.find("\r\n", pos);
+            if (next == std::string::npos) {
+                next = head.size();
+            }
+            std::string line = head.substr(pos, next - pos);
+            size_t colon = line.find(':');
+            if (colon != std::string::npos) {
+                std::string name = line.substr(0, colon);
+                std::transform(name.begin(), name.end(), name.begin(),
+                               [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+                size_t value_start = line.find_first_not_of(' ', colon + 1);
+                request.headers[name] = value_start == std::string::npos ? "" : line.substr(value_start);
+            }
+            pos = next + 2;
+        }
+
+        auto te = request.headers.find("transfer-encoding");
+        if (te != request.headers.end() && te->second.find("chunked") != std::string::npos) {
+            for (;;) {
+                size_t size_end = 0;
+                if (!fill_until(fd, buffer, "\r\n", 0, size_end)) {
+                    return false;
+                }
+                size_t chunk_size = std::strtoul(buffer.substr(0, size_end).c_str(), nullptr, 16);
+                buffer.erase(0, size_end + 2);
+                if (!fill(fd, buffer, chunk_size + 2)) {
+                    return false;
+                }
+                request.body.append(buffer, 0, chunk_size);
+                buffer.erase(0, chunk_size + 2);
+                if (chunk_size == 0) {
+                    return true;
+                }
+            }
+        }
+
+        auto cl = request.headers.find("content-length");
+        size_t length = cl == request.headers.end() ? 0 : std::strtoul(cl->second.c_str(), nullptr, 10);
+        auto expect = request.headers.find("expect");
+        if (expect != request.headers.end() && length > 0) {
+            send_all(fd, "HTTP/1.1 100 Continue\r\n\r\n");
+        }
+        if (!fill(fd, buffer, length)) {
+            return false;
+        }
+        request.body = buffer.substr(0, length);
+        buffer.erase(0, length);
+        return true;
+    }
+
+    static const char* reason(int status) {
+        switch (status) {
+            case 200: return "OK";
+            case 201: return "Created";
+            case 204: return "No Content";
+            case 404: return "Not Found";
+            case 429: return "Too Many Requests";
+            case 500: return "Internal Server Error";
+            case 503: return "Service Unavailable";
+            default: return "Status";
+        }
+    }
+
+    static bool send_all(int fd, const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) {
+                return false;
+            }
+            sent += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    void serve_connection(int fd) {
+        std::string buffer;
+        for (;;) {
+            Request request;
+            if (!read_request(fd, buffer, request)) {
+                return;
+            }
+            ++request_count_;
+            Response response = handler_(request);
+            if (response.delay_ms > 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(response.delay_ms));
+            }
+
+            std::string out = "HTTP/1.1 " + std::to_string(response.status) + " " + reason(response.status) + "\r\n";
+            out += "Content-Length: " + std::to_string(response.body.size()) + "\r\n";
+            for (const auto& header : response.headers) {
+                out += header + "\r\n";
+            }
+            out += "\r\n";
+            if (request.method != "HEAD") {
+                out += response.body;
+            }
+            if (!send_all(fd, out)) {
+                return;
+            }
+            auto connection = request.headers.find("connection");
+            if (connection != request.headers.end() && connection->second == "close") {
+                return;
+            }
+        }
+    }
+};
+
+#endif // LOCAL_HTTP_SERVER_H
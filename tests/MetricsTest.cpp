@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "HttpClient.h"
+#include "LocalHttpServer.h"
+#include "Metrics.h"
+#include <curl/curl.h>
+#include <atomic>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+class MetricsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // Initialize cURL globally for tests
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+
+        // Redirect cout/cerr to capture log output
+        old_cout = std::cout.rdbuf();
+        old_cerr = std::cerr.rdbuf();
+        std::cout.rdbuf(cout_buffer.rdbuf());
+        std::cerr.rdbuf(cerr_buffer.rdbuf());
+    }
+
+    void TearDown() override {
+        // Restore cout/cerr
+        std::cout.rdbuf(old_cout);
+        std::cerr.rdbuf(old_cerr);
+
+        // Cleanup cURL
+        curl_global_cleanup();
+    }
+
+    /// Change of a counter since an earlier snapshot (other tests share the counters)
+    static std::uint64_t delta(const MetricsSnapshot& before, Metric metric) {
+        return HttpMetrics::snapshot()[metric] - before[metric];
+    }
+
+    std::stringstream cout_buffer;
+    std::stringstream cerr_buffer;
+    std::streambuf* old_cout;
+    std::streambuf* old_cerr;
+};
+
+// Test counts from many threads add up, including threads that have exited
+TEST_F(MetricsTest, SumsThreadShards) {
+    MetricsSnapshot before = HttpMetrics::snapshot();
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i) {
+        threads.emplace_back([] {
+            for (int j = 0; j < 10000; ++j) {
+                HttpMetrics::add(Metric::BYTES_SENT, 3);
+            }
+            HttpMetrics::add_response(299);
+            HttpMetrics::add_response(42); // out of range, ignored
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    MetricsSnapshot after = HttpMetrics::snapshot();
+    EXPECT_EQ(after[Metric::BYTES_SENT] - before[Metric::BYTES_SENT], 240000u);
+    EXPECT_EQ(after.responses[299] - before.responses[299], 8u);
+    EXPECT_EQ(after.responses.count(42), 0u);
+}
+
+// Test HttpClient counts attempts, retries, statuses and bytes
+TEST_F(MetricsTest, CountsClientRequests) {
+    std::atomic<int> calls{0};
+    LocalHttpServer server([&](const LocalHttpServer::Request&) {
+        LocalHttpServer::Response response;
+        response.status = calls++ == 0 ? 503 : 200;
+        response.body = "done";
+        return response;
+    });
+    HttpClient client(5);
+    client.set_max_retries(1);
+
+    MetricsSnapshot before = HttpMetrics::snapshot();
+    HttpResponse response = client.make_request(server.url("/count"), "POST", "12345");
+    ASSERT_TRUE(response.success);
+
+    EXPECT_EQ(delta(before, Metric::REQUESTS), 1u);
+    EXPECT_EQ(delta(before, Metric::SUCCESSES), 1u);
+    EXPECT_EQ(delta(before, Metric::FAILURES), 0u);
+    EXPECT_EQ(delta(before, Metric::ATTEMPTS), 2u);
+    EXPECT_EQ(delta(before, Metric::RETRIES), 1u);
+    EXPECT_EQ(delta(before, Metric::BYTES_SENT), 10u);
+    EXPECT_EQ(delta(before, Metric::BYTES_RECEIVED), 8u);
+    MetricsSnapshot after = HttpMetrics::snapshot();
+    EXPECT_EQ(after.responses[503] - before.responses[503], 1u);
+    EXPECT_EQ(after.responses[200] - before.responses[200], 1u);
+
+    client.set_max_retries(0);
+    before = HttpMetrics::snapshot();
+    client.make_request("http://127.0.0.1:1/refused");
+    EXPECT_EQ(delta(before, Metric::FAILURES), 1u);
+    EXPECT_EQ(delta(before, Metric::TRANSPORT_ERRORS), 1u);
+}
+
+// Test the text export and the loopback endpoint
+TEST_F(MetricsTest, ServesPrometheusText) {
+    HttpMetrics::add_response(201);
+    std::string text = HttpMetrics::prometheus();
+    EXPECT_THAT(text, ::testing::HasSubstr("# TYPE http_client_requests_total counter\n"));
+    EXPECT_THAT(text, ::testing::HasSubstr("http_client_responses_total{code=\"201\"} "));
+    EXPECT_THAT(text, ::testing::ContainsRegex("http_client_backoff_seconds_total [0-9]+\\.[0-9]{6}\n"));
+
+    MetricsServer server;
+    EXPECT_GT(server.port(), 0);
+    HttpClient client(5);
+    client.set_max_retries(0);
+    HttpResponse response = client.make_request(server.url());
+    ASSERT_TRUE(response.success);
+    EXPECT_THAT(response.body, ::testing::HasSubstr("http_client_attempts_total "));
+
+    response = client.make_request("http://127.0.0.1:" + std::to_string(server.port()) + "/other");
+    EXPECT_EQ(response.status_code, 404);
+}
@@ -0,0 +1,279 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "LocalHttpServer.h"
+#include "PagedRange.h"
+#include <curl/curl.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+class PagedRangeTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // Initialize cURL globally for tests
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+
+        // Redirect cout/cerr to capture log output
+        old_cout = std::cout.rdbuf();
+        old_cerr = std::cerr.rdbuf();
+        std::cout.rdbuf(cout_buffer.rdbuf());
+        std::cerr.rdbuf(cerr_buffer.rdbuf());
+    }
+
+    void TearDown() override {
+        // Restore cout/cerr
+        std::cout.rdbuf(old_cout);
+        std::cerr.rdbuf(old_cerr);
+
+        // Cleanup cURL
+        curl_global_cleanup();
+    }
+
+    // Value of a query parameter in a request target, or "" if absent
+    static std::string query_value(const std::string& target, const std::string& name) {
+        std::size_t query = target.find('?');
+        while (query != std::string::npos) {
+            std::size_t start = query + 1;
+            std::size_t end = target.find('&', start);
+            std::string pair = target.substr(start, end == std::string::npos ? std::string::npos : end - start);
+            if (pair.compare(0, name.size() + 1, name + "=") == 0) {
+                return pair.substr(name.size() + 1);
+            }
+            query = end;
+        }
+        return "";
+    }
+
+    // JSON array of the integers [first, last)
+    static std::string json_range(int first, int last) {
+        std::string body = "[";
+        for (int i = first; i < last; ++i) {
+            body += (i > first ? "," : "") + std::to_string(i);
+        }
+        return body + "]";
+    }
+
+    std::stringstream cout_buffer;
+    std::stringstream cerr_buffer;
+    std::streambuf* old_cout;
+    std::streambuf* old_cerr;
+};
+
+// Test next links are found among other relations and resolved against the request
+TEST_F(PagedRangeTest, ParsesLinkHeader) {
+    const std::string request = "https://api.example.com/repos/issues?page=1";
+    EXPECT_EQ(PagedRange::next_link("<https://api.example.com/repos/issues?page=2>; rel=\"next\", "
+                                    "<https://api.example.com/repos/issues?page=9>; rel=\"last\"", request),
+              "https://api.example.com/repos/issues?page=2");
+    EXPECT_EQ(PagedRange::next_link("<?page=1>; rel=\"prev\", </repos/issues?page=3&a=1,2>; REL=\"Next\"", request),
+              "https://api.example.com/repos/issues?page=3&a=1,2");
+    EXPECT_EQ(PagedRange::next_link("<issues?page=2>; rel=\"next last\"", request),
+              "https://api.example.com/repos/issues?page=2");
+    EXPECT_EQ(PagedRange::next_link("<?page=4>;rel=next", request), "https://api.example.com/repos/issues?page=4");
+    EXPECT_EQ(PagedRange::next_link("<https://api.example.com/x>; rel=\"last\"", request), "");
+    EXPECT_EQ(PagedRange::next_link("", request), "");
+
+    PageConfig config;
+    EXPECT_THROW(PagedRange{config}, std::invalid_argument);
+    config.url = "http://127.0.0.1/";
+    config.prefetch = 0;
+    EXPECT_THROW(PagedRange{config}, std::invalid_argument);
+}
+
+// Test offset pages arrive in order, concurrently, and stop at the short page
+TEST_F(PagedRangeTest, PrefetchesOffsetPages) {
+    const int total = 47;
+    std::atomic<int> in_flight{0};
+    std::atomic<int> peak{0};
+    LocalHttpServer server([&](const LocalHttpServer::Request& request) {
+        int now = ++in_flight;
+        int previous = peak.load();
+        while (now > previous && !peak.compare_exchange_weak(previous, now)) {
+        }
+        int start = std::stoi(query_value(request.target, "_start"));
+        int limit = std::stoi(query_value(request.target, "_limit"));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        --in_flight;
+        LocalHttpServer::Response response;
+        response.body = json_range(std::min(start, total), std::min(start + limit, total));
+        return response;
+    });
+
+    PageConfig config;
+    config.url = server.url("/posts?sort=id");
+    config.page_size = 10;
+    config.prefetch = 4;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::size_t> indexes;
+    std::string items;
+    for (const Page& page : PagedRange(config)) {
+        ASSERT_TRUE(page.response.success) << page.response.error_message;
+        indexes.push_back(page.index);
+        items += page.response.body;
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_THAT(indexes, ::testing::ElementsAre(0, 1, 2, 3, 4));
+    EXPECT_EQ(items, json_range(0, 10) + json_range(10, 20) + json_range(20, 30) + json_range(30, 40) +
+                     json_range(40, 47));
+    // Five pages one after another would take 500ms
+    EXPECT_LT(elapsed, std::chrono::milliseconds(400));
+    EXPECT_LE(peak.load(), 4);
+    EXPECT_GT(peak.load(), 1);
+}
+
+// Test cursor pages follow the cursor from each body, percent-encoded
+TEST_F(PagedRangeTest, FollowsCursor) {
+    std::vector<std::string> cursors;
+    std::mutex mutex;
+    LocalHttpServer server([&](const LocalHttpServer::Request& request) {
+        std::string cursor = query_value(request.target, "after");
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            cursors.push_back(cursor);
+        }
+        LocalHttpServer::Response response;
+        if (cursor.empty()) {
+            response.body = R"({"data": [1, 2], "meta": {}, "next": "a b/3"})";
+        } else if (cursor == "a%20b%2F3") {
+            response.body = R"({"data": [3, 4], "next": 5})";
+        } else {
+            response.body = R"({"data": [5], "next": null})";
+        }
+        return response;
+    });
+
+    PageConfig config;
+    config.url = server.url("/events");
+    config.style = PageStyle::CURSOR;
+    config.items_field = "data";
+    config.cursor_param = "after";
+    config.cursor_field = "next";
+
+    PagedRange range(config);
+    Page page;
+    std::vector<std::size_t> items;
+    while (range.next(page)) {
+        ASSERT_TRUE(page.response.success) << page.response.error_message;
+        items.push_back(page.items);
+    }
+    EXPECT_THAT(items, ::testing::ElementsAre(2, 2, 1));
+    EXPECT_THAT(cursors, ::testing::ElementsAre("", "a%20b%2F3", "5"));
+    EXPECT_FALSE(range.next(page));
+}
+
+// Test Link-header pages follow relative next links and are read ahead of the caller
+TEST_F(PagedRangeTest, FollowsLinkHeader) {
+    std::atomic<int> requests{0};
+    LocalHttpServer server([&](const LocalHttpServer::Request& request) {
+        ++requests;
+        std::string page = query_value(request.target, "page");
+        int number = page.empty() ? 1 : std::stoi(page);
+        LocalHttpServer::Response response;
+        response.body = json_range(number * 10, number * 10 + 3);
+        if (number < 3) {
+            response.headers.push_back("Link: </issues?page=" + std::to_string(number + 1) +
+                                       ">; rel=\"next\", </issues?page=3>; rel=\"last\"");
+        }
+        return response;
+    });
+
+    PageConfig config;
+    config.url = server.url("/issues");
+    config.style = PageStyle::LINK;
+    config.prefetch = 2;
+
+    PagedRange range(config);
+    Page page;
+    ASSERT_TRUE(range.next(page));
+    EXPECT_EQ(page.response.body, json_range(10, 13));
+    EXPECT_THAT(page.response.headers["link"], ::testing::HasSubstr("rel=\"next\""));
+    // While the caller holds page 0, pages 1 and 2 are fetched
+    for (int i = 0; i < 100 && requests.load() < 3; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(requests.load(), 3);
+
+    ASSERT_TRUE(range.next(page));
+    EXPECT_EQ(page.url, server.url("/issues?page=2"));
+    ASSERT_TRUE(range.next(page));
+    EXPECT_EQ(page.response.body, json_range(30, 33));
+    EXPECT_FALSE(range.next(page));
+}
+
+// Test a failed page is handed out and ends the listing
+TEST_F(PagedRangeTest, FailedPageEndsListing) {
+    LocalHttpServer server([](const LocalHttpServer::Request& request) {
+        int start = std::stoi(query_value(request.target, "offset"));
+        LocalHttpServer::Response response;
+        if (start == 4) {
+            response.status = 500;
+        } else if (start == 8) {
+            response.body = "not json";
+        } else {
+            response.body = json_range(start, start + 4);
+        }
+        return response;
+    });
+
+    PageConfig config;
+    config.url = server.url("/items");
+    config.offset_param = "offset";
+    config.limit_param = "limit";
+    config.page_size = 4;
+    config.max_retries = 0;
+
+    std::vector<bool> results;
+    for (const Page& page : PagedRange(config)) {
+        results.push_back(page.response.success);
+    }
+    EXPECT_THAT(results, ::testing::ElementsAre(true, false));
+
+    // A body that is not a JSON array also ends the listing
+    std::vector<std::string> errors;
+    LocalHttpServer bad_body([](const LocalHttpServer::Request&) {
+        LocalHttpServer::Response response;
+        response.body = R"({"items": 1})";
+        return response;
+    });
+    config.url = bad_body.url("/items");
+    for (const Page& page : PagedRange(config)) {
+        errors.push_back(page.response.error_message);
+    }
+    ASSERT_EQ(errors.size(), 1u);
+    EXPECT_THAT(errors[0], ::testing::HasSubstr("Unexpected page body"));
+}
+
+// Test leaving a listing early cancels the pages still being fetched
+TEST_F(PagedRangeTest, EarlyExitCancelsPrefetch) {
+    std::atomic<int> requests{0};
+    LocalHttpServer server([&](const LocalHttpServer::Request& request) {
+        ++requests;
+        int start = std::stoi(query_value(request.target, "_start"));
+        LocalHttpServer::Response response;
+        response.body = json_range(start, start + 5);
+        response.delay_ms = start == 0 ? 0 : 3000;
+        return response;
+    });
+
+    PageConfig config;
+    config.url = server.url("/endless");
+    config.page_size = 5;
+    config.prefetch = 3;
+
+    auto start = std::chrono::steady_clock::now();
+    {
+        PagedRange range(config);
+        Page page;
+        ASSERT_TRUE(range.next(page));
+        EXPECT_EQ(page.items, 5u);
+    }
+    // The progress callback notices the cancellation within about a second
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(2500));
+    // Nothing beyond the prefetch window was requested
+    EXPECT_LE(requests.load(), 4);
+}
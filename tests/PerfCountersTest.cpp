@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "HttpClient.h"
+#include "LocalHttpServer.h"
+#include "Metrics.h"
+#include "PerfCounters.h"
+#include <curl/curl.h>
+#include <chrono>
+#include <sstream>
+#include <thread>
+
+class PerfCountersTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // Initialize cURL globally for tests
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+
+        // Redirect cout/cerr to capture log output
+        old_cout = std::cout.rdbuf();
+        old_cerr = std::cerr.rdbuf();
+        std::cout.rdbuf(cout_buffer.rdbuf());
+        std::cerr.rdbuf(cerr_buffer.rdbuf());
+
+        PhaseProfiler::reset();
+    }
+
+    void TearDown() override {
+        PhaseProfiler::enable(false);
+        PhaseProfiler::reset();
+
+        // Restore cout/cerr
+        std::cout.rdbuf(old_cout);
+        std::cerr.rdbuf(old_cerr);
+
+        // Cleanup cURL
+        curl_global_cleanup();
+    }
+
+    std::stringstream cout_buffer;
+    std::stringstream cerr_buffer;
+    std::streambuf* old_cout;
+    std::streambuf* old_cerr;
+};
+
+// Test counters only move forward and unavailable events read as zero
+TEST_F(PerfCountersTest, CountersAreMonotonicOrAbsent) {
+    PerfCounters counters;
+    PerfSample before = counters.read();
+    volatile std::uint64_t sum = 0;
+    for (int i = 0; i < 1000000; ++i) {
+        sum = sum + static_cast<std::uint64_t>(i);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    PerfSample after = counters.read();
+
+    for (std::size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+        PerfEvent event = static_cast<PerfEvent>(i);
+        if (!counters.available(event)) {
+            EXPECT_EQ(after[event], 0u) << perf_event_name(event);
+            continue;
+        }
+        EXPECT_GE(after[event], before[event]) << perf_event_name(event);
+    }
+    if (counters.available(PerfEvent::INSTRUCTIONS)) {
+        EXPECT_GT(after[PerfEvent::INSTRUCTIONS] - before[PerfEvent::INSTRUCTIONS], 1000000u);
+    }
+    // Sleeping switches the thread out, which is only visible when kernel mode is counted
+    if (counters.available(PerfEvent::CONTEXT_SWITCHES) && !counters.user_only()) {
+        EXPECT_GT(after[PerfEvent::CONTEXT_SWITCHES], before[PerfEvent::CONTEXT_SWITCHES]);
+    }
+    if (!counters.any_available()) {
+        EXPECT_NE(counters.error(), 0);
+    }
+}
+
+// Test nothing is recorded until profiling is enabled, then every phase of a request is
+TEST_F(PerfCountersTest, RecordsRequestPhasesWhenEnabled) {
+    LocalHttpServer server([](const LocalHttpServer::Request&) {
+        LocalHttpServer::Response response;
+        response.body = "{\"ok\":true}";
+        return response;
+    });
+    HttpClient client(5);
+    client.set_max_retries(0);
+
+    ASSERT_TRUE(client.make_request(server.url()).success);
+    PhaseProfile profile = PhaseProfiler::snapshot();
+    for (const PhaseStats& stats : profile.phases) {
+        EXPECT_EQ(stats.calls, 0u);
+    }
+
+    PhaseProfiler::enable();
+    ASSERT_TRUE(client.make_request(server.url()).success);
+    ASSERT_TRUE(client.make_request(server.url(), "POST", "{}").success);
+    PhaseProfiler::enable(false);
+
+    profile = PhaseProfiler::snapshot();
+    EXPECT_EQ(profile[RequestPhase::SETUP].calls, 2u);
+    EXPECT_EQ(profile[RequestPhase::PERFORM].calls, 2u);
+    EXPECT_EQ(profile[RequestPhase::PARSE].calls, 2u);
+    EXPECT_GE(profile[RequestPhase::LOGGING].calls, 4u); // "Making ..." and "Request successful ..."
+    for (const PhaseStats& stats : profile.phases) {
+        EXPECT_GT(stats.wall_ns, 0u);
+    }
+    // The round trip dominates option setup
+    EXPECT_GT(profile[RequestPhase::PERFORM].wall_ns, profile[RequestPhase::SETUP].wall_ns);
+    if (profile.available[static_cast<std::size_t>(PerfEvent::INSTRUCTIONS)]) {
+        EXPECT_GT(profile[RequestPhase::PERFORM].counters[PerfEvent::INSTRUCTIONS], 0u);
+    }
+
+    PhaseProfiler::reset();
+    EXPECT_EQ(PhaseProfiler::snapshot()[RequestPhase::PERFORM].calls, 0u);
+}
+
+// Test the report lists every phase and marks events that could not be counted
+TEST_F(PerfCountersTest, ReportsPerPhaseAverages) {
+    PhaseProfiler::enable();
+    {
+        PhaseScope scope(RequestPhase::PARSE);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    PhaseProfiler::enable(false);
+    {
+        PhaseScope ignored(RequestPhase::PARSE);
+    }
+
+    std::string report = PhaseProfiler::report();
+    EXPECT_THAT(report, ::testing::HasSubstr("context-switches"));
+    EXPECT_THAT(report, ::testing::ContainsRegex("\nsetup +0 "));
+    EXPECT_THAT(report, ::testing::ContainsRegex("\nparse +1 +[0-9]+\\.[0-9] "));
+    EXPECT_THAT(report, ::testing::HasSubstr("\nlogging "));
+    const PerfCounters& counters = PerfCounters::thread_instance();
+    if (!counters.available(PerfEvent::CYCLES)) {
+        EXPECT_THAT(report, ::testing::HasSubstr("n/a"));
+    }
+    if (!counters.any_available()) {
+        EXPECT_THAT(report, ::testing::HasSubstr("wall time only"));
+    }
+    EXPECT_GE(PhaseProfiler::snapshot()[RequestPhase::PARSE].wall_ns, 2000000u);
+}
+
+// Test the metrics server dumps the report on demand
+TEST_F(PerfCountersTest, MetricsServerServesProfile) {
+    MetricsServer server;
+    HttpClient client(5);
+    client.set_max_retries(0);
+    std::string url = "http://127.0.0.1:" + std::to_string(server.port()) + "/profile";
+
+    HttpResponse response = client.make_request(url);
+    ASSERT_TRUE(response.success);
+    EXPECT_THAT(response.body, ::testing::HasSubstr("disabled"));
+
+    PhaseProfiler::enable();
+    response = client.make_request(url);
+    ASSERT_TRUE(response.success);
+    EXPECT_THAT(response.body, ::testing::HasSubstr("Per-call averages by request phase"));
+    EXPECT_THAT(response.body, ::testing::HasSubstr("perform"));
+}
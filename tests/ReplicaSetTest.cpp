@@ -0,0 +1,195 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "HttpClient.h"
+#include "LocalHttpServer.h"
+#include "ReplicaSet.h"
+#include <curl/curl.h>
+#include <atomic>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+class ReplicaSetTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // Initialize cURL globally for tests
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+
+        // Redirect cout/cerr to capture log output
+        old_cout = std::cout.rdbuf();
+        old_cerr = std::cerr.rdbuf();
+        std::cout.rdbuf(cout_buffer.rdbuf());
+        std::cerr.rdbuf(cerr_buffer.rdbuf());
+    }
+
+    void TearDown() override {
+        // Restore cout/cerr
+        std::cout.rdbuf(old_cout);
+        std::cerr.rdbuf(old_cerr);
+
+        // Cleanup cURL
+        curl_global_cleanup();
+    }
+
+    // Base URL of a LocalHttpServer
+    static std::string endpoint(const LocalHttpServer& server) {
+        return server.url("");
+    }
+
+    std::stringstream cout_buffer;
+    std::stringstream cerr_buffer;
+    std::streambuf* old_cout;
+    std::streambuf* old_cerr;
+};
+
+// Test URLs are pointed at endpoints and bad configurations are rejected
+TEST_F(ReplicaSetTest, ResolvesUrlsAndValidates) {
+    EXPECT_EQ(ReplicaSet::resolve("/posts/1?x=2", "http://10.0.0.1:80"), "http://10.0.0.1:80/posts/1?x=2");
+    EXPECT_EQ(ReplicaSet::resolve("https://api.example.com/posts", "http://10.0.0.1"), "http://10.0.0.1/posts");
+    EXPECT_EQ(ReplicaSet::resolve("https://api.example.com", "http://10.0.0.1"), "http://10.0.0.1");
+
+    ReplicaSet replicas({"http://a:1/", "http://b:2"});
+    EXPECT_EQ(replicas.stats()[0].endpoint, "http://a:1");
+
+    EXPECT_THROW(ReplicaSet({}), std::invalid_argument);
+    EXPECT_THROW(ReplicaSet({"a:1"}), std::invalid_argument);
+    ReplicaConfig config;
+    config.max_ejected_fraction = 2;
+    EXPECT_THROW(ReplicaSet({"http://a:1"}, config), std::invalid_argument);
+}
+
+// Test power-of-two-choices favours the faster replica and counts in-flight attempts
+TEST_F(ReplicaSetTest, PrefersFasterReplica) {
+    ReplicaSet replicas({"http://fast", "http://slow"});
+    int slow_picks = 0;
+    for (int i = 0; i < 200; ++i) {
+        ReplicaSet::Lease lease = replicas.acquire();
+        bool slow = lease.endpoint() == "http://slow";
+        slow_picks += slow ? 1 : 0;
+        lease.complete(std::chrono::microseconds(slow ? 50000 : 1000), false);
+    }
+    // The slow replica is only taken while its EWMA has not caught up
+    EXPECT_LT(slow_picks, 10);
+
+    // Outstanding attempts raise the cost of the fast replica until the slow one wins
+    std::vector<ReplicaSet::Lease> held;
+    for (int i = 0; i < 60; ++i) {
+        held.push_back(replicas.acquire());
+    }
+    std::vector<ReplicaStats> stats = replicas.stats();
+    EXPECT_EQ(stats[0].in_flight + stats[1].in_flight, 60u);
+    EXPECT_GT(stats[1].in_flight, 0u);
+    held.clear();
+    stats = replicas.stats();
+    EXPECT_EQ(stats[0].in_flight + stats[1].in_flight, 0u);
+}
+
+// Test requests through HttpClient spread across healthy replicas
+TEST_F(ReplicaSetTest, SpreadsClientRequests) {
+    std::vector<std::unique_ptr<LocalHttpServer>> servers;
+    std::vector<std::atomic<int>> hits(3);
+    std::vector<std::string> endpoints;
+    for (int i = 0; i < 3; ++i) {
+        servers.push_back(std::make_unique<LocalHttpServer>([&hits, i](const LocalHttpServer::Request& request) {
+            ++hits[i];
+            LocalHttpServer::Response response;
+            response.body = request.target;
+            return response;
+        }));
+        endpoints.push_back(endpoint(*servers.back()));
+    }
+
+    ReplicaConfig config;
+    config.decay = std::chrono::milliseconds(20);
+    auto replicas = std::make_shared<ReplicaSet>(endpoints, config);
+    std::vector<std::thread> threads;
+    std::atomic<int> successes{0};
+    for (int t = 0; t < 3; ++t) {
+        threads.emplace_back([&replicas, &successes] {
+            HttpClient client(5);
+            client.set_max_retries(0);
+            client.set_replicas(replicas);
+            for (int i = 0; i < 30; ++i) {
+                HttpResponse response = client.make_request("/item?n=" + std::to_string(i));
+                if (response.success && response.body == "/item?n=" + std::to_string(i)) {
+                    ++successes;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(successes.load(), 90);
+    // New replicas are tried first, and idle ones are probed again as their estimate fades
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_GT(hits[i].load(), 0) << endpoints[i];
+    }
+    std::uint64_t completed = 0;
+    for (const ReplicaStats& replica : replicas->stats()) {
+        completed += replica.requests;
+        EXPECT_EQ(replica.in_flight, 0u);
+    }
+    EXPECT_EQ(completed, 90u);
+}
+
+// Test a retry after a failure moves to the healthy replica
+TEST_F(ReplicaSetTest, RetriesAvoidFailingReplica) {
+    std::atomic<int> healthy_hits{0};
+    std::atomic<int> failing_hits{0};
+    LocalHttpServer healthy([&](const LocalHttpServer::Request&) {
+        ++healthy_hits;
+        return LocalHttpServer::Response();
+    });
+    LocalHttpServer failing([&](const LocalHttpServer::Request&) {
+        ++failing_hits;
+        LocalHttpServer::Response response;
+        response.status = 503;
+        return response;
+    });
+
+    auto replicas = std::make_shared<ReplicaSet>(std::vector<std::string>{endpoint(failing), endpoint(healthy)});
+    HttpClient client(5);
+    client.set_max_retries(1);
+    client.set_replicas(replicas);
+    for (int i = 0; i < 20; ++i) {
+        EXPECT_TRUE(client.make_request("/ok").success);
+    }
+    EXPECT_EQ(healthy_hits.load(), 20);
+    // The failure penalty keeps the failing replica out after its first 503
+    EXPECT_LE(failing_hits.load(), 1);
+    EXPECT_EQ(replicas->stats()[0].failures, static_cast<std::uint64_t>(failing_hits.load()));
+}
+
+// Test consecutive failures eject a replica, within the ejection limit
+TEST_F(ReplicaSetTest, EjectsAfterConsecutiveFailures) {
+    ReplicaConfig config;
+    config.consecutive_failures = 3;
+    config.failure_penalty = std::chrono::milliseconds(0); // keep failing replicas in the rotation
+    ReplicaSet replicas({"http://good", "http://bad1", "http://bad2"}, config);
+
+    for (int i = 0; i < 300; ++i) {
+        ReplicaSet::Lease lease = replicas.acquire();
+        lease.complete(std::chrono::microseconds(1000), lease.endpoint() != "http://good");
+    }
+    std::vector<ReplicaStats> stats = replicas.stats();
+    EXPECT_FALSE(stats[0].ejected);
+    EXPECT_EQ(stats[0].failures, 0u);
+    // Only one of three replicas may be out at a time (max_ejected_fraction 0.5)
+    EXPECT_EQ(static_cast<int>(stats[1].ejected) + static_cast<int>(stats[2].ejected), 1);
+    EXPECT_THAT(cerr_buffer.str() + cout_buffer.str(), ::testing::HasSubstr("Ejecting replica"));
+
+    // An ejected replica is never picked
+    std::size_t ejected = stats[1].ejected ? 1 : 2;
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_NE(replicas.acquire().index(), ejected);
+    }
+
+    // A lone replica is never ejected
+    ReplicaSet single({"http://only"}, config);
+    for (int i = 0; i < 10; ++i) {
+        single.acquire().complete(std::chrono::microseconds(1000), true);
+    }
+    EXPECT_FALSE(single.stats()[0].ejected);
+}
@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include "HttpClient.h"
+#include "LocalHttpServer.h"
+#include "RequestBody.h"
+#include <curl/curl.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <unistd.h>
+
+class RequestBodyTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // Initialize cURL globally for tests
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+
+        // Redirect cout/cerr to capture log output
+        old_cout = std::cout.rdbuf();
+        old_cerr = std::cerr.rdbuf();
+        std::cout.rdbuf(cout_buffer.rdbuf());
+        std::cerr.rdbuf(cerr_buffer.rdbuf());
+
+        path = "/tmp/request_body_test_" + std::to_string(::getpid()) + ".bin";
+    }
+
+    void TearDown() override {
+        std::remove(path.c_str());
+
+        // Restore cout/cerr
+        std::cout.rdbuf(old_cout);
+        std::cerr.rdbuf(old_cerr);
+
+        // Cleanup cURL
+        curl_global_cleanup();
+    }
+
+    /// Generator writing count bytes of a repeating pattern
+    static GeneratorBodySource::Generator pattern(std::size_t count, std::size_t& sent) {
+        return [count, &sent](char* buffer, std::size_t capacity) {
+            std::size_t n = std::min(capacity, count - sent);
+            for (std::size_t i = 0; i < n; ++i) {
+                buffer[i] = static_cast<char>('a' + (sent + i) % 26);
+            }
+            sent += n;
+            return n;
+        };
+    }
+
+    std::stringstream cout_buffer;
+    std::stringstream cerr_buffer;
+    std::streambuf* old_cout;
+    std::streambuf* old_cerr;
+    std::string path;
+};
+
+// Test sources read in pieces and rewind to the start
+TEST_F(RequestBodyTest, SourcesReadAndRewind) {
+    BufferBodySource buffer("hello world");
+    char out[8];
+    EXPECT_EQ(buffer.size(), 11);
+    EXPECT_EQ(buffer.read(out, sizeof(out)), 8u);
+    EXPECT_EQ(buffer.read(out, sizeof(out)), 3u);
+    EXPECT_EQ(buffer.read(out, sizeof(out)), 0u);
+    EXPECT_TRUE(buffer.rewind());
+    EXPECT_EQ(buffer.read(out, 5), 5u);
+    EXPECT_EQ(std::string(out, 5), "hello");
+
+    std::size_t sent = 0;
+    GeneratorBodySource once(pattern(10, sent));
+    EXPECT_EQ(once.size(), -1);
+    EXPECT_EQ(once.read(out, sizeof(out)), 8u);
+    EXPECT_EQ(once.read(out, sizeof(out)), 2u);
+    EXPECT_EQ(once.read(out, sizeof(out)), 0u);
+    EXPECT_EQ(once.read(out, sizeof(out)), 0u);
+    EXPECT_FALSE(once.rewind());
+
+    EXPECT_THROW(FileBodySource("/nonexistent/body.bin"), std::runtime_error);
+}
+
+// Test a file body is uploaded with its length and arrives intact
+TEST_F(RequestBodyTest, UploadsFile) {
+    std::string content(300000, '\0');
+    for (std::size_t i = 0; i < content.size(); ++i) {
+        content[i] = static_cast<char>(i % 251);
+    }
+    std::ofstream(path, std::ios::binary).write(content.data(), static_cast<std::streamsize>(content.size()));
+
+    std::mutex mutex;
+    LocalHttpServer::Request received;
+    LocalHttpServer server([&](const LocalHttpServer::Request& request) {
+        std::lock_guard<std::mutex> lock(mutex);
+        received = request;
+        return LocalHttpServer::Response();
+    });
+
+    HttpClient client(5);
+    FileBodySource body(path);
+    HttpResponse response = client.make_request(server.url("/upload"), "PUT", body);
+
+    EXPECT_TRUE(response.success);
+    EXPECT_EQ(received.method, "PUT");
+    EXPECT_EQ(received.headers["content-length"], std::to_string(content.size()));
+    EXPECT_TRUE(received.body == content);
+}
+
+// Test a generated body of unknown size is sent with chunked encoding
+TEST_F(RequestBodyTest, StreamsGeneratedBodyChunked) {
+    std::mutex mutex;
+    LocalHttpServer::Request received;
+    LocalHttpServer server([&](const LocalHttpServer::Request& request) {
+        std::lock_guard<std::mutex> lock(mutex);
+        received = request;
+        return LocalHttpServer::Response();
+    });
+
+    const std::size_t total = 1 << 20;
+    std::size_t sent = 0;
+    GeneratorBodySource body(pattern(total, sent));
+    HttpClient client(5);
+    HttpResponse response = client.make_request(server.url("/stream"), "POST", body, {"Content-Type: text/plain"});
+
+    EXPECT_TRUE(response.success);
+    EXPECT_EQ(received.method, "POST");
+    EXPECT_EQ(received.headers["transfer-encoding"], "chunked");
+    EXPECT_EQ(received.headers.count("content-length"), 0u);
+    ASSERT_EQ(received.body.size(), total);
+    EXPECT_EQ(received.body[0], 'a');
+    EXPECT_EQ(received.body[total - 1], static_cast<char>('a' + (total - 1) % 26));
+}
+
+// Test retries rewind the body, and a body that cannot rewind is not retried
+TEST_F(RequestBodyTest, RetriesOnlyRewindableBodies) {
+    std::mutex mutex;
+    std::vector<std::string> bodies;
+    LocalHttpServer server([&](const LocalHttpServer::Request& request) {
+        std::lock_guard<std::mutex> lock(mutex);
+        bodies.push_back(request.body);
+        LocalHttpServer::Response response;
+        response.status = 503;
+        return response;
+    });
+
+    HttpClient client(5);
+    client.set_max_retries(1);
+
+    BufferBodySource buffer("payload");
+    HttpResponse response = client.make_request(server.url("/retry"), "POST", buffer);
+    EXPECT_FALSE(response.success);
+    ASSERT_EQ(bodies.size(), 2u);
+    EXPECT_EQ(bodies[1], "payload");
+
+    std::size_t sent = 0;
+    GeneratorBodySource once(pattern(100, sent));
+    response = client.make_request(server.url("/retry"), "POST", once);
+    EXPECT_FALSE(response.success);
+    EXPECT_EQ(bodies.size(), 3u);
+    EXPECT_EQ(response.error_message, "Request body cannot be replayed for a retry");
+}
@@ -0,0 +1,248 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "AsyncHttpClient.h"
+#include "HttpClient.h"
+#include "LocalHttpServer.h"
+#include "RequestOptions.h"
+#include <curl/curl.h>
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <thread>
+
+class RequestOptionsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // Initialize cURL globally for tests
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+
+        // Redirect cout/cerr to capture log output
+        old_cout = std::cout.rdbuf();
+        old_cerr = std::cerr.rdbuf();
+        std::cout.rdbuf(cout_buffer.rdbuf());
+        std::cerr.rdbuf(cerr_buffer.rdbuf());
+    }
+
+    void TearDown() override {
+        // Restore cout/cerr
+        std::cout.rdbuf(old_cout);
+        std::cerr.rdbuf(old_cerr);
+
+        // Cleanup cURL
+        curl_global_cleanup();
+    }
+
+    static long elapsed_ms(std::chrono::steady_clock::time_point start) {
+        return static_cast<long>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count());
+    }
+
+    std::stringstream cout_buffer;
+    std::stringstream cerr_buffer;
+    std::streambuf* old_cout;
+    std::streambuf* old_cerr;
+};
+
+// Test Deadline and CancellationSource basics
+TEST_F(RequestOptionsTest, DeadlineAndCancellationBasics) {
+    Deadline unbounded;
+    EXPECT_FALSE(unbounded.is_set());
+    EXPECT_FALSE(unbounded.expired());
+    EXPECT_EQ(unbounded.remaining(), std::chrono::milliseconds::max());
+
+    Deadline past = Deadline::after(std::chrono::milliseconds(-1));
+    EXPECT_TRUE(past.expired());
+    EXPECT_EQ(past.remaining(), std::chrono::milliseconds(0));
+
+    CancellationToken never;
+    EXPECT_FALSE(never.can_be_cancelled());
+    EXPECT_EQ(never.subscribe([] {}), 0u);
+
+    CancellationSource source;
+    CancellationToken token = source.token();
+    int calls = 0;
+    token.subscribe([&calls] { ++calls; });
+    CancellationToken::SubscriptionId removed = token.subscribe([&calls] { calls += 100; });
+    token.unsubscribe(removed);
+
+    source.cancel();
+    source.cancel();
+    EXPECT_TRUE(token.is_cancelled());
+    EXPECT_EQ(calls, 1);
+    EXPECT_TRUE(token.wait_for(std::chrono::milliseconds(1000)));
+
+    // Late subscribers run immediately
+    token.subscribe([&calls] { ++calls; });
+    EXPECT_EQ(calls, 2);
+}
+
+// Test unsubscribe waits for a callback already running on the cancelling thread
+TEST_F(RequestOptionsTest, UnsubscribeWaitsForRunningCallback) {
+    CancellationSource source;
+    CancellationToken token = source.token();
+    std::atomic<bool> started{false};
+    std::atomic<bool> finished{false};
+    CancellationToken::SubscriptionId id = token.subscribe([&] {
+        started = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        finished = true;
+    });
+
+    std::thread canceller([&source] { source.cancel(); });
+    while (!started) {
+        std::this_thread::yield();
+    }
+    token.unsubscribe(id);
+    EXPECT_TRUE(finished.load());
+    canceller.join();
+}
+
+// Test an already-expired deadline fails without touching the network
+TEST_F(RequestOptionsTest, ExpiredDeadlineSkipsRequest) {
+    LocalHttpServer server([](const LocalHttpServer::Request&) {
+        return LocalHttpServer::Response();
+    });
+    HttpClient client(5);
+    RequestOptions options;
+    options.deadline = Deadline::after(std::chrono::milliseconds(0));
+
+    HttpResponse response = client.make_request(server.url("/"), "GET", "", {}, options);
+
+    EXPECT_FALSE(response.success);
+    EXPECT_EQ(response.error_message, "Deadline exceeded");
+    EXPECT_EQ(server.request_count(), 0u);
+}
+
+// Test a deadline caps a slow transfer well below the client timeout
+TEST_F(RequestOptionsTest, DeadlineAbortsSlowTransfer) {
+    LocalHttpServer server([](const LocalHttpServer::Request&) {
+        LocalHttpServer::Response response;
+        response.delay_ms = 1500;
+        return response;
+    });
+    HttpClient client(30);
+    RequestOptions options;
+    options.deadline = Deadline::after(std::chrono::milliseconds(200));
+
+    auto start = std::chrono::steady_clock::now();
+    HttpResponse response = client.make_request(server.url("/slow"), "GET", "", {}, options);
+
+    EXPECT_FALSE(response.success);
+    EXPECT_EQ(response.error_message, "Deadline exceeded");
+    EXPECT_LT(elapsed_ms(start), 1000);
+}
+
+// Test cancelling from another thread aborts the blocking call
+TEST_F(RequestOptionsTest, CancelAbortsBlockingRequest) {
+    LocalHttpServer server([](const LocalHttpServer::Request&) {
+        LocalHttpServer::Response response;
+        response.delay_ms = 3000;
+        return response;
+    });
+    HttpClient client(30);
+    CancellationSource source;
+    RequestOptions options;
+    options.cancellation = source.token();
+
+    std::thread canceller([&source] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        source.cancel();
+    });
+    auto start = std::chrono::steady_clock::now();
+    HttpResponse response = client.make_request(server.url("/slow"), "GET", "", {}, options);
+    canceller.join();
+
+    EXPECT_FALSE(response.success);
+    EXPECT_EQ(response.error_message, "Request cancelled");
+    // The progress callback fires at least once a second while idle
+    EXPECT_LT(elapsed_ms(start), 2500);
+}
+
+// Test retries stop when the next backoff would overrun the deadline
+TEST_F(RequestOptionsTest, DeadlineStopsRetryBackoff) {
+    LocalHttpServer server([](const LocalHttpServer::Request&) {
+        LocalHttpServer::Response response;
+        response.status = 503;
+        return response;
+    });
+    HttpClient client(5);
+    RequestOptions options;
+    options.deadline = Deadline::after(std::chrono::milliseconds(300));
+
+    auto start = std::chrono::steady_clock::now();
+    HttpResponse response = client.make_request(server.url("/"), "GET", "", {}, options);
+
+    // First retry is immediate; the second backoff (>= 500ms) does not fit
+    EXPECT_FALSE(response.success);
+    EXPECT_EQ(response.error_message, "Deadline exceeded");
+    EXPECT_EQ(server.request_count(), 2u);
+    EXPECT_LT(elapsed_ms(start), 300);
+}
+
+// Test cancelling an async request removes it from the loop promptly
+TEST_F(RequestOptionsTest, AsyncCancelAbortsTransfer) {
+    LocalHttpServer server([](const LocalHttpServer::Request&) {
+        LocalHttpServer::Response response;
+        response.delay_ms = 1500;
+        return response;
+    });
+    AsyncHttpClient client(30);
+    CancellationSource source;
+    RequestOptions options;
+    options.cancellation = source.token();
+
+    std::thread canceller([&source] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        source.cancel();
+    });
+    auto start = std::chrono::steady_clock::now();
+    HttpResponse response = client.sync_wait(client.get(server.url("/slow"), {}, options));
+    canceller.join();
+
+    EXPECT_FALSE(response.success);
+    EXPECT_EQ(response.error_message, "Request cancelled");
+    EXPECT_LT(elapsed_ms(start), 1000);
+    EXPECT_EQ(client.in_flight(), 0u);
+}
+
+// Test an async deadline bounds the transfer and its siblings are unaffected
+TEST_F(RequestOptionsTest, AsyncDeadlineIsPerRequest) {
+    LocalHttpServer server([](const LocalHttpServer::Request& request) {
+        LocalHttpServer::Response response;
+        response.delay_ms = request.target == "/slow" ? 1500 : 0;
+        response.body = request.target;
+        return response;
+    });
+    AsyncHttpClient client(30);
+    RequestOptions options;
+    options.deadline = Deadline::after(std::chrono::milliseconds(200));
+
+    std::vector<Task<HttpResponse>> tasks;
+    tasks.push_back(client.get(server.url("/slow"), {}, options));
+    tasks.push_back(client.get(server.url("/fast")));
+    std::vector<HttpResponse> responses = client.sync_wait(when_all(std::move(tasks)));
+
+    EXPECT_EQ(responses[0].error_message, "Deadline exceeded");
+    EXPECT_TRUE(responses[1].success);
+    EXPECT_EQ(responses[1].body, "/fast");
+}
+
+// Test a cancelled sleep wakes early and reports it
+TEST_F(RequestOptionsTest, AsyncSleepWakesOnCancel) {
+    AsyncHttpClient client(5);
+    CancellationSource source;
+
+    auto sleeper = [&client, &source]() -> Task<bool> {
+        co_return co_await client.sleep_for(std::chrono::milliseconds(5000), source.token());
+    };
+    std::thread canceller([&source] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        source.cancel();
+    });
+    auto start = std::chrono::steady_clock::now();
+    bool cancelled = client.sync_wait(sleeper());
+    canceller.join();
+
+    EXPECT_TRUE(cancelled);
+    EXPECT_LT(elapsed_ms(start), 1000);
+}
@@ -0,0 +1,313 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "AsyncHttpClient.h"
+#include "HttpClient.h"
+#include "LocalHttpServer.h"
+#include "RequestScheduler.h"
+#include <curl/curl.h>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+class RequestSchedulerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // Initialize cURL globally for tests
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+
+        // Redirect cout/cerr to capture log output
+        old_cout = std::cout.rdbuf();
+        old_cerr = std::cerr.rdbuf();
+        std::cout.rdbuf(cout_buffer.rdbuf());
+        std::cerr.rdbuf(cerr_buffer.rdbuf());
+    }
+
+    void TearDown() override {
+        // Restore cout/cerr
+        std::cout.rdbuf(old_cout);
+        std::cerr.rdbuf(old_cerr);
+
+        // Cleanup cURL
+        curl_global_cleanup();
+    }
+
+    static SchedulerConfig single_slot() {
+        SchedulerConfig config;
+        config.max_in_flight = 1;
+        config.reserved_interactive = 0;
+        return config;
+    }
+
+    std::stringstream cout_buffer;
+    std::stringstream cerr_buffer;
+    std::streambuf* old_cout;
+    std::streambuf* old_cerr;
+};
+
+// Test scheduling keys ignore path, query, userinfo and case
+TEST_F(RequestSchedulerTest, HostKeyIsSchemeHostPort) {
+    EXPECT_EQ(RequestScheduler::host_key("https://API.example.com/posts/1?x=1"), "https://api.example.com");
+    EXPECT_EQ(RequestScheduler::host_key("http://user:pw@127.0.0.1:8080/a"), "http://127.0.0.1:8080");
+    EXPECT_EQ(RequestScheduler::host_key("http://host?q"), "http://host");
+    EXPECT_EQ(RequestScheduler::host_key("example.com/path"), "example.com");
+}
+
+// Test slots are granted immediately up to the limits, then on release
+TEST_F(RequestSchedulerTest, QueuesBeyondLimitAndGrantsOnRelease) {
+    SchedulerConfig config;
+    config.max_in_flight = 2;
+    config.reserved_interactive = 0;
+    RequestScheduler scheduler(config);
+    int granted = 0;
+
+    EXPECT_EQ(scheduler.enqueue("h", RequestPriority::Normal, [&] { ++granted; }), 0u);
+    EXPECT_EQ(scheduler.enqueue("h", RequestPriority::Normal, [&] { ++granted; }), 0u);
+    EXPECT_NE(scheduler.enqueue("h", RequestPriority::Normal, [&] { ++granted; }), 0u);
+    EXPECT_EQ(scheduler.in_flight(), 2u);
+    EXPECT_EQ(scheduler.queued(), 1u);
+    EXPECT_EQ(granted, 0);
+
+    scheduler.release("h");
+    EXPECT_EQ(granted, 1);
+    EXPECT_EQ(scheduler.in_flight(), 2u);
+    EXPECT_EQ(scheduler.queued(), 0u);
+}
+
+// Test one host at its cap does not block another host
+TEST_F(RequestSchedulerTest, PerHostLimitDoesNotBlockOtherHosts) {
+    SchedulerConfig config;
+    config.max_per_host = 2;
+    RequestScheduler scheduler(config);
+
+    EXPECT_EQ(scheduler.enqueue("a", RequestPriority::Bulk, [] {}), 0u);
+    EXPECT_EQ(scheduler.enqueue("a", RequestPriority::Bulk, [] {}), 0u);
+    EXPECT_NE(scheduler.enqueue("a", RequestPriority::Bulk, [] {}), 0u);
+    EXPECT_EQ(scheduler.enqueue("b", RequestPriority::Bulk, [] {}), 0u);
+}
+
+// Test reserved slots admit interactive requests while bulk work saturates the rest
+TEST_F(RequestSchedulerTest, ReservedSlotsBypassBulkBacklog) {
+    SchedulerConfig config;
+    config.max_in_flight = 3;
+    config.reserved_interactive = 1;
+    RequestScheduler scheduler(config);
+
+    EXPECT_EQ(scheduler.enqueue("a", RequestPriority::Bulk, [] {}), 0u);
+    EXPECT_EQ(scheduler.enqueue("b", RequestPriority::Bulk, [] {}), 0u);
+    EXPECT_NE(scheduler.enqueue("c", RequestPriority::Bulk, [] {}), 0u);
+    EXPECT_EQ(scheduler.enqueue("d", RequestPriority::Interactive, [] {}), 0u);
+}
+
+// Test freed slots are shared by class weight without starving bulk
+TEST_F(RequestSchedulerTest, WeightsShareSlotsBetweenClasses) {
+    RequestScheduler scheduler(single_slot());
+    std::vector<RequestPriority> order;
+    ASSERT_EQ(scheduler.enqueue("h", RequestPriority::Bulk, [] {}), 0u);
+    for (int i = 0; i < 20; ++i) {
+        scheduler.enqueue("h", RequestPriority::Bulk, [&] { order.push_back(RequestPriority::Bulk); });
+    }
+    for (int i = 0; i < 20; ++i) {
+        scheduler.enqueue("h", RequestPriority::Interactive, [&] { order.push_back(RequestPriority::Interactive); });
+    }
+
+    for (int i = 0; i < 17; ++i) {
+        scheduler.release("h");
+    }
+
+    ASSERT_EQ(order.size(), 17u);
+    long interactive = std::count(order.begin(), order.end(), RequestPriority::Interactive);
+    EXPECT_GE(interactive, 15);
+    EXPECT_GE(17 - interactive, 1);
+    EXPECT_EQ(order.front(), RequestPriority::Interactive);
+}
+
+// Test hosts within a class are served round-robin rather than FIFO
+TEST_F(RequestSchedulerTest, HostsShareFairlyWithinClass) {
+    RequestScheduler scheduler(single_slot());
+    std::vector<std::string> order;
+    ASSERT_EQ(scheduler.enqueue("a", RequestPriority::Normal, [] {}), 0u);
+    for (int i = 0; i < 10; ++i) {
+        scheduler.enqueue("a", RequestPriority::Normal, [&] { order.push_back("a"); });
+    }
+    scheduler.enqueue("b", RequestPriority::Normal, [&] { order.push_back("b"); });
+
+    scheduler.release("a");
+    scheduler.release("a");
+    scheduler.release("a");
+
+    EXPECT_THAT(order, ::testing::Contains("b"));
+}
+
+// Test withdrawn requests are never granted
+TEST_F(RequestSchedulerTest, WithdrawRemovesQueuedRequest) {
+    RequestScheduler scheduler(single_slot());
+    bool granted = false;
+    ASSERT_EQ(scheduler.enqueue("h", RequestPriority::Normal, [] {}), 0u);
+    RequestScheduler::Ticket ticket = scheduler.enqueue("h", RequestPriority::Normal, [&] { granted = true; });
+
+    EXPECT_TRUE(scheduler.withdraw(ticket));
+    EXPECT_FALSE(scheduler.withdraw(ticket));
+    scheduler.release("h");
+
+    EXPECT_FALSE(granted);
+    EXPECT_EQ(scheduler.in_flight(), 0u);
+}
+
+// Test blocking acquire gives up at the deadline and permits release on destruction
+TEST_F(RequestSchedulerTest, AcquireHonoursDeadline) {
+    RequestScheduler scheduler(single_slot());
+    RequestOptions options;
+    {
+        RequestScheduler::Permit held = scheduler.acquire("h", options);
+        ASSERT_TRUE(held);
+
+        options.deadline = Deadline::after(std::chrono::milliseconds(50));
+        auto start = std::chrono::steady_clock::now();
+        RequestScheduler::Permit denied = scheduler.acquire("h", options);
+        EXPECT_FALSE(denied);
+        EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(1000));
+        EXPECT_EQ(scheduler.queued(), 0u);
+    }
+    EXPECT_EQ(scheduler.in_flight(), 0u);
+}
+
+// Test an interactive request overtakes queued bulk requests on the async client
+TEST_F(RequestSchedulerTest, AsyncInteractiveOvertakesBulk) {
+    std::mutex mutex;
+    std::vector<std::string> served;
+    LocalHttpServer server([&](const LocalHttpServer::Request& request) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            served.push_back(request.target);
+        }
+        LocalHttpServer::Response response;
+        response.delay_ms = 30;
+        return response;
+    });
+    auto scheduler = std::make_shared<RequestScheduler>(single_slot());
+    AsyncHttpClient client(5);
+    client.set_scheduler(scheduler);
+
+    RequestOptions bulk;
+    bulk.priority = RequestPriority::Bulk;
+    RequestOptions interactive;
+    interactive.priority = RequestPriority::Interactive;
+    std::vector<Task<HttpResponse>> tasks;
+    for (int i = 0; i < 4; ++i) {
+        tasks.push_back(client.get(server.url("/bulk"), {}, bulk));
+    }
+    tasks.push_back(client.get(server.url("/interactive"), {}, interactive));
+    std::vector<HttpResponse> responses = client.sync_wait(when_all(std::move(tasks)));
+
+    for (const HttpResponse& response : responses) {
+        EXPECT_TRUE(response.success);
+    }
+    ASSERT_EQ(served.size(), 5u);
+    EXPECT_EQ(served[1], "/interactive");
+    EXPECT_EQ(scheduler->in_flight(), 0u);
+}
+
+// Test the Vegas limit grows at the no-load latency and backs off as latency or overload rises
+TEST_F(RequestSchedulerTest, AdaptiveLimitFollowsLatency) {
+    AdaptiveLimit limit(4, 2, 100);
+    // Idle callers do not raise the limit
+    limit.on_sample(std::chrono::microseconds(1000), 1);
+    EXPECT_EQ(limit.limit(), 4u);
+    EXPECT_EQ(limit.min_rtt(), std::chrono::microseconds(1000));
+
+    for (int i = 0; i < 10; ++i) {
+        limit.on_sample(std::chrono::microseconds(1000), limit.limit());
+    }
+    std::size_t grown = limit.limit();
+    EXPECT_GT(grown, 30u);
+
+    // Three times the no-load latency means most requests are queued upstream
+    for (int i = 0; i < 10; ++i) {
+        limit.on_sample(std::chrono::microseconds(3000), limit.limit());
+    }
+    std::size_t queued = limit.limit();
+    EXPECT_LT(queued, grown);
+    EXPECT_EQ(limit.min_rtt(), std::chrono::microseconds(1000));
+
+    limit.on_overload();
+    EXPECT_LT(limit.limit(), queued);
+    for (int i = 0; i < 100; ++i) {
+        limit.on_overload();
+    }
+    EXPECT_EQ(limit.limit(), 2u);
+    for (int i = 0; i < 100; ++i) {
+        limit.on_sample(std::chrono::microseconds(1000), limit.limit());
+    }
+    EXPECT_EQ(limit.limit(), 100u);
+}
+
+// Test an adaptive per-host limit admits queued requests as it grows and shrinks on overload
+TEST_F(RequestSchedulerTest, AdaptivePerHostLimit) {
+    SchedulerConfig config;
+    config.adaptive_per_host = true;
+    config.initial_per_host = 2;
+    config.max_per_host = 50;
+    RequestScheduler scheduler(config);
+    EXPECT_EQ(scheduler.host_limit("h"), 2u);
+
+    bool granted = false;
+    ASSERT_EQ(scheduler.enqueue("h", RequestPriority::Normal, [] {}), 0u);
+    ASSERT_EQ(scheduler.enqueue("h", RequestPriority::Normal, [] {}), 0u);
+    ASSERT_NE(scheduler.enqueue("h", RequestPriority::Normal, [&] { granted = true; }), 0u);
+
+    // A fast response at full use raises the limit, which admits the queued request
+    scheduler.release("h", AttemptOutcome::COMPLETED, std::chrono::microseconds(1000));
+    EXPECT_TRUE(granted);
+    EXPECT_EQ(scheduler.host_limit("h"), 8u);
+
+    scheduler.release("h", AttemptOutcome::OVERLOADED, std::chrono::microseconds(0));
+    EXPECT_EQ(scheduler.host_limit("h"), 7u);
+    scheduler.release("h", AttemptOutcome::IGNORED, std::chrono::microseconds(0));
+    EXPECT_EQ(scheduler.host_limit("h"), 7u);
+    EXPECT_EQ(scheduler.in_flight(), 0u);
+    EXPECT_EQ(scheduler.host_limit("other"), 2u);
+}
+
+// Test requests beyond a host's queue bound are shed at once by both clients
+TEST_F(RequestSchedulerTest, ShedsBeyondQueueLimit) {
+    LocalHttpServer server([](const LocalHttpServer::Request&) { return LocalHttpServer::Response(); });
+    std::string host = RequestScheduler::host_key(server.url("/"));
+    SchedulerConfig config = single_slot();
+    config.max_queued_per_host = 1;
+    auto scheduler = std::make_shared<RequestScheduler>(config);
+
+    RequestScheduler::Permit held = scheduler->acquire(host, RequestOptions());
+    ASSERT_TRUE(held);
+    RequestScheduler::Ticket ticket = scheduler->enqueue(host, RequestPriority::Normal, [] {});
+    ASSERT_NE(ticket, 0u);
+    ASSERT_NE(ticket, RequestScheduler::REJECTED);
+    EXPECT_EQ(scheduler->enqueue(host, RequestPriority::Interactive, [] {}), RequestScheduler::REJECTED);
+    // Other hosts keep their own queue
+    RequestScheduler::Ticket other = scheduler->enqueue("http://other", RequestPriority::Normal, [] {});
+    EXPECT_NE(other, RequestScheduler::REJECTED);
+    EXPECT_TRUE(scheduler->withdraw(other));
+
+    HttpClient client(5);
+    client.set_scheduler(scheduler);
+    auto start = std::chrono::steady_clock::now();
+    HttpResponse response = client.make_request(server.url("/shed"));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(1000));
+    EXPECT_FALSE(response.success);
+    EXPECT_THAT(response.error_message, ::testing::HasSubstr("Request shed"));
+
+    AsyncHttpClient async_client(5);
+    async_client.set_scheduler(scheduler);
+    HttpResponse async_response = async_client.sync_wait(async_client.get(server.url("/shed")));
+    EXPECT_FALSE(async_response.success);
+    EXPECT_THAT(async_response.error_message, ::testing::HasSubstr("Request shed"));
+
+    // Once the queue drains, requests are accepted again
+    EXPECT_TRUE(scheduler->withdraw(ticket));
+    held.release();
+    EXPECT_TRUE(client.make_request(server.url("/ok")).success);
+    EXPECT_EQ(scheduler->in_flight(), 0u);
+    EXPECT_EQ(scheduler->queued(), 0u);
+}
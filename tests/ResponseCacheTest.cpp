@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "HttpClient.h"
+#include "LocalHttpServer.h"
+#include "ResponseCache.h"
+#include <curl/curl.h>
+#include <chrono>
+#include <sstream>
+#include <thread>
+
+class ResponseCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // Initialize cURL globally for tests
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+
+        // Redirect cout/cerr to capture log output
+        old_cout = std::cout.rdbuf();
+        old_cerr = std::cerr.rdbuf();
+        std::cout.rdbuf(cout_buffer.rdbuf());
+        std::cerr.rdbuf(cerr_buffer.rdbuf());
+    }
+
+    void TearDown() override {
+        // Restore cout/cerr
+        std::cout.rdbuf(old_cout);
+        std::cerr.rdbuf(old_cerr);
+
+        // Cleanup cURL
+        curl_global_cleanup();
+    }
+
+    static CachedResponse entry(const std::string& body) {
+        CachedResponse result;
+        result.status_code = 200;
+        result.body = body;
+        return result;
+    }
+
+    std::stringstream cout_buffer;
+    std::stringstream cerr_buffer;
+    std::streambuf* old_cout;
+    std::streambuf* old_cerr;
+};
+
+// Test the least recently used entry is evicted first
+TEST_F(ResponseCacheTest, MemoryCacheEvictsLeastRecentlyUsed) {
+    MemoryCache cache(30);
+    cache.put("a", entry("0123456789")); // 11 bytes with the key
+    cache.put("b", entry("0123456789"));
+
+    CachedResponse found;
+    EXPECT_TRUE(cache.get("a", found)); // "b" is now least recently used
+    cache.put("c", entry("0123456789"));
+
+    EXPECT_TRUE(cache.get("a", found));
+    EXPECT_FALSE(cache.get("b", found));
+    EXPECT_TRUE(cache.get("c", found));
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_EQ(cache.bytes(), 22u);
+
+    cache.put("huge", entry(std::string(100, 'x')));
+    EXPECT_FALSE(cache.get("huge", found));
+    EXPECT_EQ(cache.size(), 2u);
+}
+
+// Test expired entries are not returned
+TEST_F(ResponseCacheTest, MemoryCacheHonoursExpiry) {
+    MemoryCache cache;
+    CachedResponse stale = entry("old");
+    stale.expires = std::chrono::system_clock::now() - std::chrono::seconds(1);
+    cache.put("k", stale);
+
+    CachedResponse found;
+    EXPECT_FALSE(cache.get("k", found));
+    EXPECT_EQ(cache.size(), 0u);
+}
+
+// Test back-tier hits are promoted and writes reach both tiers
+TEST_F(ResponseCacheTest, TieredCachePromotesHits) {
+    auto front = std::make_shared<MemoryCache>();
+    auto back = std::make_shared<MemoryCache>();
+    TieredCache tiered(front, back);
+
+    back->put("k", entry("from back"));
+    CachedResponse found;
+    EXPECT_TRUE(tiered.get("k", found));
+    EXPECT_EQ(found.body, "from back");
+    EXPECT_EQ(front->size(), 1u);
+
+    tiered.put("n", entry("new"));
+    EXPECT_TRUE(back->get("n", found));
+    tiered.erase("n");
+    EXPECT_FALSE(front->get("n", found));
+    EXPECT_FALSE(back->get("n", found));
+}
+
+// Test HttpClient answers repeated GETs from the cache but not other methods
+TEST_F(ResponseCacheTest, HttpClientServesGetFromCache) {
+    LocalHttpServer server([](const LocalHttpServer::Request& request) {
+        LocalHttpServer::Response response;
+        response.body = request.method + " " + request.target;
+        return response;
+    });
+    HttpClient client(5);
+    auto cache = std::make_shared<MemoryCache>();
+    client.set_cache(cache, std::chrono::seconds(60));
+
+    HttpResponse first = client.make_request(server.url("/item"));
+    HttpResponse second = client.make_request(server.url("/item"));
+    EXPECT_TRUE(second.success);
+    EXPECT_EQ(second.status_code, 200);
+    EXPECT_EQ(second.body, first.body);
+    EXPECT_EQ(server.request_count(), 1);
+
+    client.make_request(server.url("/item"), "POST", "x");
+    client.make_request(server.url("/item"), "POST", "x");
+    EXPECT_EQ(server.request_count(), 3);
+    EXPECT_EQ(cache->size(), 1u);
+}
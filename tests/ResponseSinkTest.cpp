@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include "HttpClient.h"
+#include "LocalHttpServer.h"
+#include "MappedFile.h"
+#include "ResponseSink.h"
+#include <curl/curl.h>
+#include <cstdio>
+#include <sstream>
+#include <unistd.h>
+
+class ResponseSinkTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // Initialize cURL globally for tests
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+
+        // Redirect cout/cerr to capture log output
+        old_cout = std::cout.rdbuf();
+        old_cerr = std::cerr.rdbuf();
+        std::cout.rdbuf(cout_buffer.rdbuf());
+        std::cerr.rdbuf(cerr_buffer.rdbuf());
+
+        path = "/tmp/response_sink_test_" + std::to_string(::getpid()) + ".bin";
+    }
+
+    void TearDown() override {
+        std::remove(path.c_str());
+
+        // Restore cout/cerr
+        std::cout.rdbuf(old_cout);
+        std::cerr.rdbuf(old_cerr);
+
+        // Cleanup cURL
+        curl_global_cleanup();
+    }
+
+    std::string file_contents() const {
+        MappedFile file(path);
+        return std::string(file.data() ? file.data() : "", file.size());
+    }
+
+    std::stringstream cout_buffer;
+    std::stringstream cerr_buffer;
+    std::streambuf* old_cout;
+    std::streambuf* old_cerr;
+    std::string path;
+};
+
+// Test the sink grows past its first mapping, and reset and finish trim the file
+TEST_F(ResponseSinkTest, GrowsAndTrims) {
+    std::string block(700000, 'x');
+    {
+        MappedFileSink sink(path);
+        sink.write("stale", 5);
+        sink.reset();
+        sink.write(block.data(), block.size());
+        sink.write(block.data(), block.size());
+        sink.write("end", 3);
+        EXPECT_EQ(sink.size(), 2 * block.size() + 3);
+        sink.finish();
+        EXPECT_EQ(file_contents(), block + block + "end");
+    }
+    {
+        // An unfinished sink still leaves only the bytes written
+        MappedFileSink sink(path);
+        sink.reserve(1 << 20);
+        sink.write("partial", 7);
+    }
+    EXPECT_EQ(file_contents(), "partial");
+
+    EXPECT_THROW(MappedFileSink("/nonexistent/dir/file.bin"), std::runtime_error);
+}
+
+// Test a download is written to the mapped file and not to the response body
+TEST_F(ResponseSinkTest, DownloadsToFile) {
+    std::string content(3 << 20, '\0');
+    for (std::size_t i = 0; i < content.size(); ++i) {
+        content[i] = static_cast<char>(i * 7 % 256);
+    }
+    LocalHttpServer server([&](const LocalHttpServer::Request&) {
+        LocalHttpServer::Response response;
+        response.body = content;
+        return response;
+    });
+
+    HttpClient client(5);
+    HttpResponse response;
+    {
+        MappedFileSink sink(path);
+        response = client.download(server.url("/artifact"), sink);
+        EXPECT_EQ(sink.size(), content.size());
+    }
+
+    EXPECT_TRUE(response.success);
+    EXPECT_EQ(response.status_code, 200);
+    EXPECT_TRUE(response.body.empty());
+    EXPECT_TRUE(file_contents() == content);
+}
+
+// Test an error body is reported in the response and leaves the file empty
+TEST_F(ResponseSinkTest, ErrorBodyStaysInResponse) {
+    LocalHttpServer server([](const LocalHttpServer::Request&) {
+        LocalHttpServer::Response response;
+        response.status = 404;
+        response.body = "no such artifact";
+        return response;
+    });
+
+    HttpClient client(5);
+    client.set_max_retries(0);
+    HttpResponse response;
+    {
+        MappedFileSink sink(path);
+        response = client.download(server.url("/missing"), sink);
+        EXPECT_EQ(sink.size(), 0u);
+    }
+
+    EXPECT_FALSE(response.success);
+    EXPECT_EQ(response.status_code, 404);
+    EXPECT_EQ(response.body, "no such artifact");
+    EXPECT_EQ(file_contents(), "");
+}
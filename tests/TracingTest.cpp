@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "HttpClient.h"
+#include "LocalHttpServer.h"
+#include "Tracing.h"
+#include <curl/curl.h>
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <unistd.h>
+
+class TracingTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // Initialize cURL globally for tests
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+
+        // Redirect cout/cerr to capture log output
+        old_cout = std::cout.rdbuf();
+        old_cerr = std::cerr.rdbuf();
+        std::cout.rdbuf(cout_buffer.rdbuf());
+        std::cerr.rdbuf(cerr_buffer.rdbuf());
+
+        path = "/tmp/tracing_test_" + std::to_string(::getpid()) + ".ndjson";
+        std::remove(path.c_str());
+    }
+
+    void TearDown() override {
+        std::remove(path.c_str());
+
+        // Restore cout/cerr
+        std::cout.rdbuf(old_cout);
+        std::cerr.rdbuf(old_cerr);
+
+        // Cleanup cURL
+        curl_global_cleanup();
+    }
+
+    TracerConfig config(double sample_rate) const {
+        TracerConfig result;
+        result.path = path;
+        result.sample_rate = sample_rate;
+        result.flush_interval = std::chrono::milliseconds(60000);
+        return result;
+    }
+
+    std::vector<std::string> span_lines() const {
+        std::vector<std::string> lines;
+        std::ifstream in(path);
+        for (std::string line; std::getline(in, line);) {
+            lines.push_back(line);
+        }
+        return lines;
+    }
+
+    std::stringstream cout_buffer;
+    std::stringstream cerr_buffer;
+    std::streambuf* old_cout;
+    std::streambuf* old_cerr;
+    std::string path;
+};
+
+// Test traceparent values round-trip and malformed ones are rejected
+TEST_F(TracingTest, ParsesTraceparent) {
+    TraceContext context;
+    ASSERT_TRUE(TraceContext::parse("00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01", context));
+    EXPECT_TRUE(context.sampled);
+    EXPECT_EQ(context.span_id, 0x00f067aa0ba902b7u);
+    EXPECT_EQ(context.traceparent(), "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01");
+
+    EXPECT_FALSE(TraceContext::parse("00-00000000000000000000000000000000-00f067aa0ba902b7-01", context));
+    EXPECT_FALSE(TraceContext::parse("00-4BF92F3577B34DA6A3CE929D0E0E4736-00f067aa0ba902b7-01", context));
+    EXPECT_FALSE(TraceContext::parse("ff-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01", context));
+    EXPECT_FALSE(TraceContext::parse("garbage", context));
+
+    EXPECT_THROW(Tracer(config(1.5)), std::invalid_argument);
+}
+
+// Test a sampled request exports a root span and one span per attempt, linked by IDs
+TEST_F(TracingTest, ExportsAttemptSpans) {
+    std::atomic<int> calls{0};
+    std::mutex mutex;
+    std::vector<std::string> traceparents;
+    LocalHttpServer server([&](const LocalHttpServer::Request& request) {
+        std::lock_guard<std::mutex> lock(mutex);
+        traceparents.push_back(request.headers.at("traceparent"));
+        LocalHttpServer::Response response;
+        response.status = calls++ == 0 ? 503 : 200;
+        return response;
+    });
+
+    auto tracer = std::make_shared<Tracer>(config(1.0));
+    HttpClient client(5);
+    client.set_max_retries(1);
+    client.set_tracer(tracer);
+    ASSERT_TRUE(client.make_request(server.url("/traced")).success);
+    tracer->flush();
+
+    ASSERT_EQ(traceparents.size(), 2u);
+    TraceContext first;
+    TraceContext second;
+    ASSERT_TRUE(TraceContext::parse(traceparents[0], first));
+    ASSERT_TRUE(TraceContext::parse(traceparents[1], second));
+    EXPECT_TRUE(first.sampled);
+    EXPECT_EQ(first.trace_id, second.trace_id);
+    EXPECT_NE(first.span_id, second.span_id);
+
+    std::vector<std::string> lines = span_lines();
+    ASSERT_EQ(lines.size(), 3u);
+    std::string trace_id = traceparents[0].substr(3, 32);
+    for (const std::string& line : lines) {
+        EXPECT_TRUE(nlohmann::json::accept(line)) << line;
+        EXPECT_THAT(line, ::testing::HasSubstr("\"traceId\":\"" + trace_id + "\""));
+    }
+    EXPECT_THAT(lines[0], ::testing::HasSubstr("\"name\":\"http.attempt\""));
+    EXPECT_THAT(lines[0], ::testing::HasSubstr("\"http.status_code\":\"503\""));
+    EXPECT_THAT(lines[0], ::testing::HasSubstr("\"ttfb_us\":"));
+    EXPECT_THAT(lines[0], ::testing::HasSubstr("\"id\":\"" + traceparents[0].substr(36, 16) + "\""));
+    EXPECT_THAT(lines[1], ::testing::HasSubstr("\"attempt\":\"2\""));
+    EXPECT_THAT(lines[2], ::testing::HasSubstr("\"name\":\"http.request\""));
+    EXPECT_THAT(lines[2], ::testing::Not(::testing::HasSubstr("parentId")));
+    EXPECT_EQ(tracer->exported(), 3u);
+}
+
+// Test an incoming traceparent is continued and its unsampled decision respected
+TEST_F(TracingTest, ContinuesIncomingTrace) {
+    std::mutex mutex;
+    std::string received;
+    LocalHttpServer server([&](const LocalHttpServer::Request& request) {
+        std::lock_guard<std::mutex> lock(mutex);
+        received = request.headers.at("traceparent");
+        return LocalHttpServer::Response();
+    });
+
+    auto tracer = std::make_shared<Tracer>(config(1.0));
+    HttpClient client(5);
+    client.set_tracer(tracer);
+    client.make_request(server.url("/child"), "GET", "",
+                        {"traceparent: 00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-00"});
+    tracer->flush();
+
+    EXPECT_EQ(received.substr(0, 36), "00-4bf92f3577b34da6a3ce929d0e0e4736-");
+    EXPECT_NE(received.substr(36, 16), "00f067aa0ba902b7");
+    EXPECT_EQ(received.substr(52), "-00");
+    EXPECT_TRUE(span_lines().empty());
+}
+
+// Test a full queue drops spans instead of blocking
+TEST_F(TracingTest, DropsWhenQueueFull) {
+    TracerConfig small = config(1.0);
+    small.buffer_spans = 4;
+    Tracer tracer(small);
+
+    SpanRecord span;
+    span.name = "test";
+    int accepted = 0;
+    for (int i = 0; i < 10; ++i) {
+        accepted += tracer.record(span) ? 1 : 0;
+    }
+    EXPECT_EQ(accepted, 4);
+    EXPECT_EQ(tracer.dropped(), 6u);
+
+    tracer.flush();
+    EXPECT_EQ(tracer.exported(), 4u);
+    EXPECT_TRUE(tracer.record(span));
+}
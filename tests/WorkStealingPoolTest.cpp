@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "WorkStealingPool.h"
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+class WorkStealingPoolTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // Redirect cerr to capture log output
+        old_cerr = std::cerr.rdbuf();
+        std::cerr.rdbuf(cerr_buffer.rdbuf());
+    }
+
+    void TearDown() override {
+        std::cerr.rdbuf(old_cerr);
+    }
+
+    std::stringstream cerr_buffer;
+    std::streambuf* old_cerr;
+};
+
+// Test pool sizing
+TEST_F(WorkStealingPoolTest, ConstructorSizes) {
+    WorkStealingPool pool(3);
+    EXPECT_EQ(pool.size(), 3u);
+
+    WorkStealingPool default_pool;
+    EXPECT_GE(default_pool.size(), 1u);
+}
+
+// Test submit returns results through futures
+TEST_F(WorkStealingPoolTest, SubmitReturnsResult) {
+    WorkStealingPool pool(2);
+
+    auto future = pool.submit([] { return 6 * 7; });
+
+    EXPECT_EQ(future.get(), 42);
+}
+
+// Test exceptions propagate through submit futures
+TEST_F(WorkStealingPoolTest, SubmitPropagatesException) {
+    WorkStealingPool pool(2);
+
+    auto future = pool.submit([]() -> int { throw std::runtime_error("boom"); });
+
+    EXPECT_THROW(future.get(), std::runtime_error);
+}
+
+// Test every posted job runs exactly once, including jobs posted by workers
+TEST_F(WorkStealingPoolTest, RunsAllJobsIncludingNested) {
+    std::atomic<int> count{0};
+    {
+        WorkStealingPool pool(4);
+        for (int i = 0; i < 100; ++i) {
+            pool.post([&pool, &count] {
+                for (int j = 0; j < 10; ++j) {
+                    pool.post([&count] { ++count; });
+                }
+                ++count;
+            });
+        }
+    } // Destructor drains all queued work
+
+    EXPECT_EQ(count.load(), 1100);
+}
+
+// Test idle workers steal from a busy worker's deque
+TEST_F(WorkStealingPoolTest, IdleWorkersSteal) {
+    WorkStealingPool pool(4);
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+
+    // One job fans out locally; the rest of the pool must steal to help
+    auto done = pool.submit([&] {
+        std::vector<std::future<void>> children;
+        for (int i = 0; i < 64; ++i) {
+            children.push_back(pool.submit([&] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                std::lock_guard<std::mutex> lock(mutex);
+                threads.insert(std::this_thread::get_id());
+            }));
+        }
+        for (auto& child : children) {
+            child.wait();
+        }
+    });
+    // The parent blocks its worker, so only thieves can run the children
+    done.get();
+
+    EXPECT_GT(pool.steal_count(), 0u);
+    EXPECT_GT(threads.size(), 1u);
+}
+
+// Test failing posted jobs are logged and do not kill the worker
+TEST_F(WorkStealingPoolTest, PostedJobExceptionIsLogged) {
+    WorkStealingPool pool(1);
+
+    pool.post([] { throw std::runtime_error("job exploded"); });
+    auto after = pool.submit([] { return true; });
+
+    EXPECT_TRUE(after.get());
+    EXPECT_THAT(cerr_buffer.str(), ::testing::HasSubstr("job exploded"));
+}
+
+// Test jobs throwing non-std exceptions are logged instead of terminating
+TEST_F(WorkStealingPoolTest, PostedJobNonStdExceptionIsLogged) {
+    WorkStealingPool pool(1);
+
+    pool.post([] { throw 42; });
+    auto after = pool.submit([] { return true; });
+
+    EXPECT_TRUE(after.get());
+    EXPECT_THAT(cerr_buffer.str(), ::testing::HasSubstr("unknown exception"));
+}